@@ -96,6 +96,12 @@ namespace Telerik.UI.Xaml.Controls.Map
         public static readonly DependencyProperty ShapeColorizerProperty =
             DependencyProperty.Register(nameof(ShapeColorizer), typeof(MapShapeColorizer), typeof(MapShapeLayer), new PropertyMetadata(null, OnShapeColorizerPropertyChanged));
 
+        /// <summary>
+        /// Identifies the <see cref="ShapeCacheMode"/> dependency property.
+        /// </summary>
+        public static readonly DependencyProperty ShapeCacheModeProperty =
+            DependencyProperty.Register(nameof(ShapeCacheMode), typeof(ShapeLayerCacheMode), typeof(MapShapeLayer), new PropertyMetadata(ShapeLayerCacheMode.None, OnShapeCacheModePropertyChanged));
+
         internal static int layerIDCounter = 0;
 
         private List<D2DShape> shapes;
@@ -134,6 +140,10 @@ namespace Telerik.UI.Xaml.Controls.Map
 
             this.shapes = new List<D2DShape>();
             this.modelToVisualTable = new Dictionary<IMapShape, D2DShape>();
+
+            // the shapes are drawn by the D2DCanvas of the owning map, so the layer forwards its own visibility and opacity to it
+            this.RegisterPropertyChangedCallback(VisibilityProperty, this.OnAppearancePropertyChanged);
+            this.RegisterPropertyChangedCallback(OpacityProperty, this.OnAppearancePropertyChanged);
         }
 
         /// <summary>
@@ -159,6 +169,21 @@ namespace Telerik.UI.Xaml.Controls.Map
             }
         }
 
+        /// <summary>
+        /// Gets or sets a value indicating whether the shapes within the layer are rendered once to a bitmap that is recomposited while other layers change.
+        /// </summary>
+        public ShapeLayerCacheMode ShapeCacheMode
+        {
+            get
+            {
+                return (ShapeLayerCacheMode)this.GetValue(ShapeCacheModeProperty);
+            }
+            set
+            {
+                this.SetValue(ShapeCacheModeProperty, value);
+            }
+        }
+
         /// <summary>
         /// Gets or sets a value indicating whether the shapes within the layer may be manipulated by a <see cref="MapShapeSelectionBehavior"/> instance.
         /// </summary>
@@ -383,6 +408,21 @@ namespace Telerik.UI.Xaml.Controls.Map
             }
         }
 
+        internal void UpdateZIndex(int zIndex)
+        {
+            if (this.zIndex == zIndex)
+            {
+                return;
+            }
+
+            this.zIndex = zIndex;
+
+            if (this.Owner != null && this.Owner.D2DSurface != null)
+            {
+                this.Owner.D2DSurface.SetLayerZIndex(this.id, zIndex);
+            }
+        }
+
         void IWeakEventListener.ReceiveEvent(object sender, object args)
         {
             var propertyChangedArgs = args as PropertyChangedEventArgs;
@@ -578,6 +618,18 @@ namespace Telerik.UI.Xaml.Controls.Map
             layer.AttachSourceEvent();
         }
 
+        private static void OnShapeCacheModePropertyChanged(DependencyObject d, DependencyPropertyChangedEventArgs e)
+        {
+            var layer = d as MapShapeLayer;
+            if (layer.Owner == null || layer.Owner.D2DSurface == null || !layer.Owner.D2DSurface.HasShapesForLayer(layer.id))
+            {
+                return;
+            }
+
+            // the same shapes with new parameters only update this layer within the canvas
+            layer.Owner.D2DSurface.SetShapesForLayer(layer.shapes, layer.CreateLayerParameters());
+        }
+
         private static void OnShapeLabelAttributeNamePropertyChanged(DependencyObject d, DependencyPropertyChangedEventArgs e)
         {
             var layer = d as MapShapeLayer;
@@ -777,7 +829,8 @@ namespace Telerik.UI.Xaml.Controls.Map
                 this.AddShape(shape, pointModel);
             }
 
-            this.Owner.D2DSurface.SetShapesForLayer(this.shapes, new ShapeLayerParameters() { Id = this.id, ZIndex = this.zIndex, RenderPrecision = ShapeRenderPrecision.Double });
+            this.Owner.D2DSurface.SetShapesForLayer(this.shapes, this.CreateLayerParameters());
+            this.UpdateLayerAppearance();
         }
 
         private void RenderPolylines(bool closed)
@@ -812,9 +865,8 @@ namespace Telerik.UI.Xaml.Controls.Map
                 }
                 else
                 {
-                    // Use ShapeContainer for more than 1 polyline per model
-                    var container = new D2DShapeContainer();
-                    var childShapes = new List<D2DShape>();
+                    // all parts and holes of the model are rendered as the figures of a single geometry
+                    var rings = new List<IEnumerable<DoublePoint>>();
 
                     foreach (LocationCollection locations in shape2DModel.Locations)
                     {
@@ -823,20 +875,45 @@ namespace Telerik.UI.Xaml.Controls.Map
                             continue;
                         }
 
-                        var shape = new D2DPolyline();
-                        shape.IsClosed = closed;
-                        this.SetPolylinePoints(shape, locations);
+                        rings.Add(this.Owner.ConvertGeographicToPixelCoordinates(locations).ToList());
+                    }
 
-                        childShapes.Add(shape);
+                    if (rings.Count == 0)
+                    {
+                        continue;
                     }
 
-                    container.SetShapes(childShapes);
+                    var shape = new D2DMultiPolygon();
+                    shape.IsClosed = closed;
+                    shape.SetPoints(rings);
 
-                    this.AddShape(container, shape2DModel);
+                    this.AddShape(shape, shape2DModel);
                 }
             }
 
-            this.Owner.D2DSurface.SetShapesForLayer(this.shapes, new ShapeLayerParameters() { Id = this.id, ZIndex = this.zIndex, RenderPrecision = ShapeRenderPrecision.Double });
+            this.Owner.D2DSurface.SetShapesForLayer(this.shapes, this.CreateLayerParameters());
+            this.UpdateLayerAppearance();
+        }
+
+        private ShapeLayerParameters CreateLayerParameters()
+        {
+            return new ShapeLayerParameters() { Id = this.id, ZIndex = this.zIndex, RenderPrecision = ShapeRenderPrecision.Double, CacheMode = this.ShapeCacheMode };
+        }
+
+        private void OnAppearancePropertyChanged(DependencyObject sender, DependencyProperty property)
+        {
+            this.UpdateLayerAppearance();
+        }
+
+        private void UpdateLayerAppearance()
+        {
+            if (this.Owner == null || this.Owner.D2DSurface == null)
+            {
+                return;
+            }
+
+            this.Owner.D2DSurface.SetLayerVisibility(this.id, this.Visibility == Visibility.Visible);
+            this.Owner.D2DSurface.SetLayerOpacity(this.id, this.Opacity);
         }
 
         private void SetPolylinePoints(D2DPolyline polyline, LocationCollection locations)
@@ -1071,7 +1148,7 @@ namespace Telerik.UI.Xaml.Controls.Map
 
             if (owner != null)
             {
-                owner.D2DSurface.SetShapesForLayer(null, new ShapeLayerParameters() { Id = this.id, ZIndex = this.zIndex, RenderPrecision = ShapeRenderPrecision.Double });
+                owner.D2DSurface.SetShapesForLayer(null, this.CreateLayerParameters());
             }
             this.shapes.Clear();
 
@@ -43,6 +43,12 @@ namespace Telerik.UI.Xaml.Controls.Map
         public static readonly DependencyProperty MinZoomLevelProperty =
             DependencyProperty.Register(nameof(MinZoomLevel), typeof(double), typeof(RadMap), new PropertyMetadata(1d, OnMinZoomLevelPropertyChanged));
 
+        /// <summary>
+        /// Identifies the <see cref="IsZoomPreviewEnabled"/> dependency property.
+        /// </summary>
+        public static readonly DependencyProperty IsZoomPreviewEnabledProperty =
+            DependencyProperty.Register(nameof(IsZoomPreviewEnabled), typeof(bool), typeof(RadMap), new PropertyMetadata(false, OnIsZoomPreviewEnabledPropertyChanged));
+
         internal Canvas adornerLayer;
 
         private const string LayoutRootPartName = "PART_LayoutRoot";
@@ -164,6 +170,22 @@ namespace Telerik.UI.Xaml.Controls.Map
             }
         }
 
+        /// <summary>
+        /// Gets or sets a value indicating whether a scaled snapshot of the shapes is displayed while the zoom level changes,
+        /// until the shapes are prepared for the new zoom level.
+        /// </summary>
+        public bool IsZoomPreviewEnabled
+        {
+            get
+            {
+                return (bool)this.GetValue(IsZoomPreviewEnabledProperty);
+            }
+            set
+            {
+                this.SetValue(IsZoomPreviewEnabledProperty, value);
+            }
+        }
+
         /// <summary>
         /// Gets the collection with all the <see cref="MapLayer"/> instances currently available within the map.
         /// </summary>
@@ -433,6 +455,8 @@ namespace Telerik.UI.Xaml.Controls.Map
 
             this.renderSurface.Children.Add(presenter);
             presenter.Attach(this);
+
+            this.UpdateShapeLayerZIndices();
         }
 
         internal void OnPresenterRemoved(MapLayer presenter)
@@ -445,6 +469,8 @@ namespace Telerik.UI.Xaml.Controls.Map
 
             this.renderSurface.Children.Remove(presenter);
             presenter.Detach();
+
+            this.UpdateShapeLayerZIndices();
         }
 
         internal DoublePoint ConvertGeographicToPixelCoordinate(Location location)
@@ -551,6 +577,7 @@ namespace Telerik.UI.Xaml.Controls.Map
             this.EnsureZoomLevelInRange();
             this.UpdateZoomLevel();
 
+            this.d2dSurface.IsZoomPreviewEnabled = this.IsZoomPreviewEnabled;
             this.d2dSurface.ZoomFactor = this.CanvasZoomFactor;
             this.d2dSurface.ViewportOrigin = this.scrollOffset;
 
@@ -657,6 +684,15 @@ namespace Telerik.UI.Xaml.Controls.Map
             map.EnsureZoomLevelInRange();
         }
 
+        private static void OnIsZoomPreviewEnabledPropertyChanged(DependencyObject d, DependencyPropertyChangedEventArgs e)
+        {
+            var map = (RadMap)d;
+            if (map.d2dSurface != null)
+            {
+                map.d2dSurface.IsZoomPreviewEnabled = (bool)e.NewValue;
+            }
+        }
+
         private Location CoerceLocation(Location locationToCoerce)
         {
             Location coercedLocation = locationToCoerce;
@@ -837,6 +873,19 @@ namespace Telerik.UI.Xaml.Controls.Map
             this.updatingView = false;
         }
 
+        private void UpdateShapeLayerZIndices()
+        {
+            // the shape layers are drawn in the order of the layers collection, so inserting or removing a layer shifts the ones after it
+            for (int i = 0; i < this.layers.Count; i++)
+            {
+                var shapeLayer = this.layers[i] as MapShapeLayer;
+                if (shapeLayer != null)
+                {
+                    shapeLayer.UpdateZIndex(i);
+                }
+            }
+        }
+
         /// <summary>
         /// Calculates the geo bounds.
         /// </summary>
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+
+namespace Telerik
+{
+	namespace UI
+	{
+		namespace Drawing
+		{
+			// a blocking queue of limited capacity between two stages of a pipeline: a producer that gets ahead waits until
+			// the consumer catches up, which bounds the memory held by the items in flight
+			template<typename T>
+			class D2DBoundedQueue
+			{
+			public:
+				explicit D2DBoundedQueue(size_t capacity) : capacity(capacity), isClosed(false), isCancelled(false)
+				{
+				}
+
+				// waits while the queue is full; returns false (and drops the item) once the queue is closed
+				bool Push(T item)
+				{
+					std::unique_lock<std::mutex> lock(this->mutex);
+					this->notFull.wait(lock, [this]() { return this->items.size() < this->capacity || this->isClosed; });
+
+					if(this->isClosed)
+					{
+						return false;
+					}
+
+					this->items.push_back(std::move(item));
+					this->notEmpty.notify_one();
+
+					return true;
+				}
+
+				// waits while the queue is empty; returns false once it is closed and drained, or cancelled
+				bool Pop(T* item)
+				{
+					std::unique_lock<std::mutex> lock(this->mutex);
+					this->notEmpty.wait(lock, [this]() { return !this->items.empty() || this->isClosed; });
+
+					if(this->items.empty() || this->isCancelled)
+					{
+						return false;
+					}
+
+					*item = std::move(this->items.front());
+					this->items.pop_front();
+					this->notFull.notify_one();
+
+					return true;
+				}
+
+				// no more items are accepted; the consumers still receive the queued ones
+				void Close()
+				{
+					std::lock_guard<std::mutex> lock(this->mutex);
+					this->isClosed = true;
+					this->notEmpty.notify_all();
+					this->notFull.notify_all();
+				}
+
+				// no more items are accepted or handed out, and the queued ones are dropped
+				void Cancel()
+				{
+					std::lock_guard<std::mutex> lock(this->mutex);
+					this->isClosed = true;
+					this->isCancelled = true;
+					this->items.clear();
+					this->notEmpty.notify_all();
+					this->notFull.notify_all();
+				}
+
+			private:
+				D2DBoundedQueue(const D2DBoundedQueue&);
+				D2DBoundedQueue& operator = (const D2DBoundedQueue&);
+
+				std::deque<T> items;
+				std::mutex mutex;
+				std::condition_variable notEmpty;
+				std::condition_variable notFull;
+				size_t capacity;
+				bool isClosed;
+				bool isCancelled;
+			};
+		}
+	}
+}
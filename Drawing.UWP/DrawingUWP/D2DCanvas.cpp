@@ -3,6 +3,8 @@
 #include <thread>
 #include <future>
 #include <cmath>
+#include <chrono>
+#include <algorithm>
 #include "D2DPolyline.h"
 #include "D2DShapeStyle.h"
 
@@ -23,10 +25,48 @@ namespace Telerik
                 this->zoomFactor = 1;
                 this->pixelZoomFactor = 1;
                 this->dpi = DefaultDPI;
+                this->layerCacheMemoryBudget = DefaultLayerCacheMemoryBudget;
 
                 this->resources = ref new D3DResources();
+                this->geometryCache = ref new D2DGeometryCache();
+                this->geometryResidency = ref new D2DGeometryResidency();
 
                 this->updatingShapes = false;
+                this->updateLayerCaches = false;
+
+                this->isZoomPreviewEnabled = false;
+
+                this->isProgressiveRenderingEnabled = false;
+                this->isProgressivePassActive = false;
+                this->isNextFrameRequested = false;
+                this->progressiveFrameBudget = DefaultProgressiveFrameBudget;
+                this->progressiveLayerIndex = 0;
+                this->progressiveShapeIndex = 0;
+                this->progressivePassGeneration = 0;
+                this->renderGeneration = 1;
+
+                this->isPrefetchEnabled = false;
+                this->isPrefetchRequested = false;
+                this->isIdleWorkRequested = false;
+                this->pendingWarmUpCount = 0;
+                this->warmUpGeneration = 0;
+                this->warmUpViewportOrigin.X = 0;
+                this->warmUpViewportOrigin.Y = 0;
+                this->isPartialUpdate = false;
+                this->prefetchDistance = DefaultPrefetchDistance;
+                this->prefetchMemoryBudget = DefaultPrefetchMemoryBudget;
+                this->prefetchHitCount = 0;
+                this->prefetchMissCount = 0;
+                this->panVelocity.X = 0;
+                this->panVelocity.Y = 0;
+                this->bufferZoomFactor = 1;
+
+                TimeSpan settleDuration;
+                settleDuration.Duration = ZoomPreviewSettleDuration;
+
+                this->zoomPreviewTimer = ref new DispatcherTimer();
+                this->zoomPreviewTimer->Interval = settleDuration;
+                this->zoomPreviewTimer->Tick += ref new EventHandler<Object^>(this, &D2DCanvas::OnZoomPreviewTimerTick);
             }
 
             D2DCanvas::~D2DCanvas(void)
@@ -47,6 +87,78 @@ namespace Telerik
             void D2DCanvas::EndShapeUpdate()
             {
                 this->updatingShapes = false;
+                this->InvalidateLayerCaches();
+                this->ResetViewportBuffer();
+            }
+
+            void D2DCanvas::ResetGeometryCacheStatistics()
+            {
+                this->geometryCache->ResetStatistics();
+                this->geometryResidency->ResetStatistics();
+            }
+
+            void D2DCanvas::ResetPrefetchStatistics()
+            {
+                this->prefetchHitCount = 0;
+                this->prefetchMissCount = 0;
+            }
+
+            void D2DCanvas::SetLayerVisibility(int layerId, bool isVisible)
+            {
+                auto layerIndex = this->FindLayerIndexById(layerId);
+                if (layerIndex == -1)
+                {
+                    return;
+                }
+
+                auto layer = this->shapeLayers.at(layerIndex);
+                if (layer->IsVisible == isVisible)
+                {
+                    return;
+                }
+
+                // cached layers keep their bitmaps while hidden so showing them again is a recomposition only
+                layer->IsVisible = isVisible;
+                this->ResetViewportBuffer();
+            }
+
+            void D2DCanvas::SetLayerOpacity(int layerId, double opacity)
+            {
+                auto layerIndex = this->FindLayerIndexById(layerId);
+                if (layerIndex == -1)
+                {
+                    return;
+                }
+
+                float value = static_cast<float>(opacity < 0 ? 0 : (opacity > 1 ? 1 : opacity));
+
+                auto layer = this->shapeLayers.at(layerIndex);
+                if (layer->Opacity == value)
+                {
+                    return;
+                }
+
+                layer->Opacity = value;
+                this->ResetViewportBuffer();
+            }
+
+            void D2DCanvas::SetLayerZIndex(int layerId, int zIndex)
+            {
+                auto layerIndex = this->FindLayerIndexById(layerId);
+                if (layerIndex == -1)
+                {
+                    return;
+                }
+
+                auto layer = this->shapeLayers.at(layerIndex);
+                if (layer->parameters.ZIndex == zIndex)
+                {
+                    return;
+                }
+
+                layer->parameters.ZIndex = zIndex;
+                std::sort(this->shapeLayers.begin(), this->shapeLayers.end());
+
                 this->ResetViewportBuffer();
             }
 
@@ -63,6 +175,11 @@ namespace Telerik
                         continue;
                     }
 
+                    if (!(*layerPtr)->IsVisible)
+                    {
+                        continue;
+                    }
+
                     for (auto shapePtr = (*layerPtr)->shapes.rbegin(); shapePtr != (*layerPtr)->shapes.rend(); ++shapePtr)
                     {
                         if ((*shapePtr)->HitTest(pixelLocation))
@@ -87,14 +204,34 @@ namespace Telerik
 
             void D2DCanvas::SetShapesForLayer(IIterable<D2DShape^>^ shapes, ShapeLayerParameters parameters)
             {
-                this->ResetDrawing(true);
+                std::vector<D2DShape^> layerShapes;
+                if (shapes != nullptr)
+                {
+                    IIterator<D2DShape^>^ iterator = shapes->First();
+                    while (iterator->HasCurrent)
+                    {
+                        layerShapes.push_back(iterator->Current);
+                        iterator->MoveNext();
+                    }
+                }
 
                 auto layerIndex = this->FindLayerIndexById(parameters.Id);
                 if (layerIndex != -1)
                 {
-                    this->ClearLayer(this->shapeLayers.at(layerIndex));
+                    // the same shapes with new parameters only change this layer, the other layers keep their geometry and caches
+                    auto existingLayer = this->shapeLayers.at(layerIndex);
+                    if (!layerShapes.empty() && existingLayer->shapes == layerShapes)
+                    {
+                        this->UpdateLayerParameters(existingLayer, parameters);
+                        return;
+                    }
+
+                    this->ClearLayer(existingLayer);
+                    existingLayer->ResetCache();
                 }
 
+                this->ResetViewportBuffer();
+
                 if (shapes == nullptr)
                 {
                     if (layerIndex != -1)
@@ -117,25 +254,86 @@ namespace Telerik
                 else
                 {
                     layer = this->shapeLayers.at(layerIndex);
+
+                    bool zIndexChanged = layer->parameters.ZIndex != parameters.ZIndex;
+                    layer->parameters = parameters;
+
+                    if (zIndexChanged)
+                    {
+                        std::sort(this->shapeLayers.begin(), this->shapeLayers.end());
+                    }
+                }
+
+                for (auto shapePtr = layerShapes.begin(); shapePtr != layerShapes.end(); ++shapePtr)
+                {
+                    layer->shapes.push_back(*shapePtr);
+                    (*shapePtr)->SetLayerId(parameters.Id);
+                    (*shapePtr)->SetOwner(this);
+
+                    if (parameters.RenderPrecision != ShapeRenderPrecision::Default)
+                    {
+                        (*shapePtr)->SetRenderPrecision(parameters.RenderPrecision);
+                    }
+                }
+            }
+
+            void D2DCanvas::UpdateLayerParameters(D2DShapeLayer^ layer, ShapeLayerParameters parameters)
+            {
+                auto previous = layer->parameters;
+                bool precisionChanged = previous.RenderPrecision != parameters.RenderPrecision && parameters.RenderPrecision != ShapeRenderPrecision::Default;
+                bool contentChanged = precisionChanged || previous.SubPixelMode != parameters.SubPixelMode || previous.MarkerMode != parameters.MarkerMode;
+
+                if (!contentChanged && previous.ZIndex == parameters.ZIndex && previous.CacheMode == parameters.CacheMode)
+                {
+                    return;
+                }
+
+                layer->parameters = parameters;
+
+                if (precisionChanged)
+                {
+                    for (auto shapePtr = layer->shapes.begin(); shapePtr != layer->shapes.end(); ++shapePtr)
+                    {
+                        (*shapePtr)->SetRenderPrecision(parameters.RenderPrecision);
+                    }
+                }
+
+                if (contentChanged)
+                {
+                    layer->ResetCache();
                 }
 
-                IIterator<D2DShape^>^ iterator = shapes->First();
-                while (iterator->HasCurrent)
+                if (previous.ZIndex != parameters.ZIndex)
+                {
+                    std::sort(this->shapeLayers.begin(), this->shapeLayers.end());
+                }
+
+                // a z-index or cache mode change is a recomposition, the valid caches of the other layers are kept
+                this->ResetViewportBuffer();
+            }
+
+            void D2DCanvas::SetFeaturesForLayer(D2DFeatureFile^ features, D2DShapeStyle^ style, ShapeLayerParameters parameters)
+            {
+                // the layer starts empty and the features are loaded by the next render
+                this->SetShapesForLayer(features != nullptr ? ref new Platform::Collections::Vector<D2DShape^>() : nullptr, parameters);
+
+                auto layerIndex = this->FindLayerIndexById(parameters.Id);
+                if (layerIndex != -1)
                 {
-                    layer->shapes.push_back(iterator->Current);
-                    iterator->Current->SetLayerId(parameters.Id);
-                    iterator->Current->SetOwner(this);
-                    iterator->MoveNext();
+                    this->shapeLayers.at(layerIndex)->SetFeatures(features, style);
                 }
             }
 
             void D2DCanvas::ClearLayer(D2DShapeLayer^ layer)
             {
+                layer->ClearFeatures();
+
                 for (auto shape = layer->shapes.begin(); shape != layer->shapes.end(); ++shape)
                 {
                     (*shape)->SetOwner(nullptr);
                 }
                 layer->shapes.clear();
+                layer->ResetCullTable();
             }
 
             int D2DCanvas::FindLayerIndexById(int layerId)
@@ -234,163 +432,866 @@ namespace Telerik
                     }
                 }
 
-                if (!this->renderOffsetReset)
-                {
-                    this->renderOffset.x += static_cast<float>(pixelOrigin.X - this->pixelViewportOrigin.X);
-                    this->renderOffset.y += static_cast<float>(pixelOrigin.Y - this->pixelViewportOrigin.Y);
+                this->UpdatePanVelocity(pixelOrigin);
+
+                if (!this->renderOffsetReset)
+                {
+                    this->renderOffset.x += static_cast<float>(pixelOrigin.X - this->pixelViewportOrigin.X);
+                    this->renderOffset.y += static_cast<float>(pixelOrigin.Y - this->pixelViewportOrigin.Y);
+                }
+
+                this->viewportOrigin = origin;
+                this->pixelViewportOrigin = pixelOrigin;
+                this->InvalidateArrange();
+            }
+
+            Size D2DCanvas::ArrangeOverride(Size finalSize)
+            {
+                if (this->wasUnloaded && this->mainRenderContext == nullptr)
+                {
+                    if (!this->resources->IsReady)
+                    {
+                        this->resources->Initialize();
+                    }
+                    this->InitRenderContext(this->currentSize);
+                }
+
+                this->Render();
+
+                return Panel::ArrangeOverride(finalSize);
+            }
+
+            Size D2DCanvas::MeasureOverride(Size availableSize)
+            {
+                auto size = Panel::MeasureOverride(availableSize);
+
+                if (!this->resources->IsReady)
+                {
+                    this->resources->Initialize();
+                }
+
+                return size;
+            }
+
+            void D2DCanvas::ResetDrawing(bool displayChanged)
+            {
+                this->InvalidateShapes(displayChanged);
+                this->InvalidateLayerCaches();
+                this->ResetViewportBuffer();
+            }
+
+            void D2DCanvas::Render()
+            {
+                if (this->updatingShapes)
+                {
+                    return;
+                }
+
+                if (this->resources == nullptr || !this->resources->IsReady || this->mainRenderContext == nullptr)
+                {
+                    return;
+                }
+
+                if (this->renderOffsetReset)
+                {
+                    this->renderOffsetReset = false;
+                    this->renderOffset = D2D1::Point2F(0, 0);
+                }
+
+                this->UpdateFeatureLayers();
+
+                if (this->zoomPreviewBuffer != nullptr)
+                {
+                    this->BeginDraw();
+                    this->RenderZoomPreview();
+                    this->EndDraw();
+                    return;
+                }
+
+                this->UpdateLayerCaches();
+
+                RECT updateRect;
+                if (this->GetUpdateRect(&updateRect))
+                {
+                    this->BeginDraw(updateRect);
+                    this->DoRender();
+                    this->EndDraw();
+                }
+
+                this->TrimGeometry();
+
+                if (this->isPrefetchEnabled)
+                {
+                    this->RequestPrefetch();
+                }
+
+                // a progressive pass prepares its shapes as it renders them
+                if (!this->isProgressivePassActive)
+                {
+                    this->RequestWarmUp();
+                }
+
+                /*this->waitingThreadCount = 2;
+                this->hasPendingEndDraw = true;
+
+                int shapeCount = this->shapes.size();
+                int chunk = shapeCount / this->waitingThreadCount;
+
+                std::future<void> f1 = std::async(std::launch::async, [this, chunk](){ this->DoRender(this->mainRenderContext, 0, chunk); });
+                std::future<void> f2 = std::async(std::launch::async, [this, chunk, shapeCount](){ this->DoRender(this->bufferRenderContext, chunk, shapeCount); });*/
+            }
+
+            void D2DCanvas::DoRender()
+            {
+                if (this->isProgressiveRenderingEnabled)
+                {
+                    this->RenderProgressive();
+                    return;
+                }
+
+                this->RenderWithViewportCaching();
+
+                this->invalidRects.clear();
+            }
+
+            void D2DCanvas::RenderProgressive()
+            {
+                if (this->isProgressivePassActive && this->progressivePassGeneration != this->RenderGeneration)
+                {
+                    // the pass was superseded by a newer viewport change; the new full render starts over
+                    this->EndProgressivePass();
+                }
+
+                if (!this->isProgressivePassActive)
+                {
+                    // only full viewport renders are split; strips revealed by panning and invalidated shapes are rendered at once
+                    auto fullRect = std::find_if(this->invalidRects.begin(), this->invalidRects.end(), [](Rect rect) { return rect.Width == 0 || rect.Height == 0; });
+                    if (fullRect == this->invalidRects.end())
+                    {
+                        this->RenderWithViewportCaching();
+                        this->invalidRects.clear();
+                        return;
+                    }
+
+                    this->invalidRects.erase(fullRect);
+                    this->BeginProgressivePass();
+                }
+
+                // the viewport buffer holds the slices rendered so far
+                this->RenderWithViewportCaching();
+                this->invalidRects.clear();
+
+                auto deadline = std::chrono::steady_clock::now() + std::chrono::microseconds(static_cast<long long>(this->progressiveFrameBudget * 1000));
+                auto modelTransform = this->ModelTransform;
+
+                Rect invalidRect = Rect(-this->renderOffset.x, -this->renderOffset.y, this->currentPixelSize.Width, this->currentPixelSize.Height);
+                D2D1_RECT_F clip = Extensions::ToRect(invalidRect);
+
+                this->mainRenderContext->PushTransform(D2D1::Matrix3x2F::Translation(this->renderOffset.x, this->renderOffset.y));
+                this->mainRenderContext->DeviceContext->PushAxisAlignedClip(&clip, D2D1_ANTIALIAS_MODE_ALIASED);
+
+                while (this->progressiveLayerIndex < this->shapeLayers.size())
+                {
+                    auto layer = this->shapeLayers.at(this->progressiveLayerIndex);
+
+                    if (layer->IsVisible && layer->Opacity > 0)
+                    {
+                        if (layer->HasValidCache(this->renderOffset))
+                        {
+                            layer->RenderCache(this->mainRenderContext, invalidRect, this->renderOffset);
+                        }
+                        else
+                        {
+                            this->progressiveShapeIndex = layer->RenderQueue(this->mainRenderContext, invalidRect, modelTransform, this->progressiveShapeIndex, deadline);
+                            if (this->progressiveShapeIndex < layer->RenderQueueCount)
+                            {
+                                break;
+                            }
+                        }
+                    }
+
+                    layer->ClearRenderQueue();
+                    this->progressiveLayerIndex++;
+                    this->progressiveShapeIndex = 0;
+                }
+
+                if (this->progressiveLayerIndex == this->shapeLayers.size())
+                {
+                    // render text on last pass
+                    for (auto layerPtr = this->shapeLayers.begin(); layerPtr != this->shapeLayers.end(); ++layerPtr)
+                    {
+                        if ((*layerPtr)->IsVisible && (*layerPtr)->Opacity > 0)
+                        {
+                            (*layerPtr)->RenderLabels(this->mainRenderContext, invalidRect, this->ModelTransform);
+                        }
+                    }
+
+                    this->EndProgressivePass();
+                }
+                else
+                {
+                    this->RequestNextFrame();
+                }
+
+                this->mainRenderContext->DeviceContext->PopAxisAlignedClip();
+                this->mainRenderContext->PopTransform();
+            }
+
+            void D2DCanvas::BeginProgressivePass()
+            {
+                Rect invalidRect = Rect(-this->renderOffset.x, -this->renderOffset.y, this->currentPixelSize.Width, this->currentPixelSize.Height);
+
+                for (auto layerPtr = this->shapeLayers.begin(); layerPtr != this->shapeLayers.end(); ++layerPtr)
+                {
+                    (*layerPtr)->BuildRenderQueue(invalidRect, this->ModelTransform);
+                }
+
+                this->progressiveLayerIndex = 0;
+                this->progressiveShapeIndex = 0;
+                this->progressivePassGeneration = this->RenderGeneration;
+                this->isProgressivePassActive = true;
+            }
+
+            void D2DCanvas::EndProgressivePass()
+            {
+                for (auto layerPtr = this->shapeLayers.begin(); layerPtr != this->shapeLayers.end(); ++layerPtr)
+                {
+                    (*layerPtr)->ClearRenderQueue();
+                }
+
+                this->isProgressivePassActive = false;
+            }
+
+            void D2DCanvas::RequestNextFrame()
+            {
+                if (this->isNextFrameRequested)
+                {
+                    return;
+                }
+
+                this->isNextFrameRequested = true;
+                this->renderingToken = CompositionTarget::Rendering += ref new EventHandler<Object^>(this, &D2DCanvas::OnCompositionTargetRendering);
+            }
+
+            void D2DCanvas::OnCompositionTargetRendering(Object^ sender, Object^ args)
+            {
+                CompositionTarget::Rendering -= this->renderingToken;
+                this->isNextFrameRequested = false;
+
+                this->InvalidateArrange();
+            }
+
+            void D2DCanvas::RenderWithViewportCaching()
+            {
+                if (this->hasBuffer)
+                {
+                    auto rect = this->GetViewportBufferRenderBounds();
+
+                    // do not anti-alias the viewport buffer
+                    this->mainRenderContext->DeviceContext->PushAxisAlignedClip(rect, D2D1_ANTIALIAS_MODE_ALIASED);
+
+                    this->mainRenderContext->DeviceContext->DrawBitmap(
+                        this->viewportBuffer.Get(),
+                        rect,
+                        1.0f,
+                        D2D1_BITMAP_INTERPOLATION_MODE_NEAREST_NEIGHBOR
+                        );
+
+                    this->mainRenderContext->DeviceContext->PopAxisAlignedClip();
+                }
+
+                D2D1::Matrix3x2F transform = D2D1::Matrix3x2F::Translation(this->renderOffset.x, this->renderOffset.y);
+                this->mainRenderContext->PushTransform(transform);
+
+                for (auto rect = this->invalidRects.begin(); rect != this->invalidRects.end(); ++rect)
+                {
+                    this->RenderShapes((*rect));
+                }
+
+                this->mainRenderContext->PopTransform();
+            }
+
+            void D2DCanvas::RenderShapes(Rect invalidRect)
+            {
+                bool clearRect = true;
+                if (invalidRect.Width == 0 || invalidRect.Height == 0)
+                {
+                    // entire viewport is the clip rect
+                    invalidRect = Rect(-this->renderOffset.x, -this->renderOffset.y, this->currentPixelSize.Width, this->currentPixelSize.Height);
+                    clearRect = false;
+                }
+
+                D2D1_RECT_F clip = Extensions::ToRect(invalidRect);
+                this->mainRenderContext->DeviceContext->PushAxisAlignedClip(&clip, D2D1_ANTIALIAS_MODE_ALIASED);
+
+                if (clearRect)
+                {
+                    this->mainRenderContext->Clear();
+                }
+
+                if (!clearRect || !this->TryRenderPrefetched(invalidRect))
+                {
+                    this->RenderLayers(invalidRect, true);
+                }
+
+                this->mainRenderContext->DeviceContext->PopAxisAlignedClip();
+            }
+
+            void D2DCanvas::RenderLayers(Rect invalidRect, bool useLayerCaches)
+            {
+                for (auto layerPtr = this->shapeLayers.begin(); layerPtr != this->shapeLayers.end(); ++layerPtr)
+                {
+                    if (!(*layerPtr)->IsVisible || (*layerPtr)->Opacity <= 0)
+                    {
+                        continue;
+                    }
+
+                    if (useLayerCaches && (*layerPtr)->HasValidCache(this->renderOffset))
+                    {
+                        (*layerPtr)->RenderCache(this->mainRenderContext, invalidRect, this->renderOffset);
+                    }
+                    else
+                    {
+                        (*layerPtr)->Render(this->mainRenderContext, invalidRect, this->ModelTransform);
+                    }
+                }
+
+                // render text on second pass
+                for (auto layerPtr = this->shapeLayers.begin(); layerPtr != this->shapeLayers.end(); ++layerPtr)
+                {
+                    if (!(*layerPtr)->IsVisible || (*layerPtr)->Opacity <= 0)
+                    {
+                        continue;
+                    }
+
+                    (*layerPtr)->RenderLabels(this->mainRenderContext, invalidRect, this->ModelTransform);
+                }
+            }
+
+            void D2DCanvas::UpdatePanVelocity(DoublePoint pixelOrigin)
+            {
+                auto now = std::chrono::steady_clock::now();
+                double elapsed = std::chrono::duration<double>(now - this->lastPanTime).count();
+                this->lastPanTime = now;
+
+                double velocityX = 0;
+                double velocityY = 0;
+
+                // a pause longer than a few frames starts a new gesture
+                if (elapsed > 0 && elapsed < PanVelocityTimeout)
+                {
+                    velocityX = (pixelOrigin.X - this->pixelViewportOrigin.X) / elapsed;
+                    velocityY = (pixelOrigin.Y - this->pixelViewportOrigin.Y) / elapsed;
+
+                    velocityX = this->panVelocity.X + (velocityX - this->panVelocity.X) * PanVelocitySmoothing;
+                    velocityY = this->panVelocity.Y + (velocityY - this->panVelocity.Y) * PanVelocitySmoothing;
+                }
+
+                this->panVelocity.X = velocityX;
+                this->panVelocity.Y = velocityY;
+            }
+
+            void D2DCanvas::RequestPrefetch()
+            {
+                if (this->isPrefetchRequested)
+                {
+                    return;
+                }
+
+                if (abs(this->panVelocity.X) < MinPrefetchVelocity && abs(this->panVelocity.Y) < MinPrefetchVelocity)
+                {
+                    return;
+                }
+
+                // the pan has already stopped
+                if (std::chrono::duration<double>(std::chrono::steady_clock::now() - this->lastPanTime).count() > PanVelocityTimeout)
+                {
+                    return;
+                }
+
+                this->isPrefetchRequested = true;
+                this->idleScheduler.Post(IdleWorkPriority::Prefetch, [this]()
+                {
+                    this->isPrefetchRequested = false;
+
+                    if (this->isPrefetchEnabled && this->hasBuffer)
+                    {
+                        this->Prefetch();
+                    }
+                });
+
+                this->RequestIdleWork();
+            }
+
+            void D2DCanvas::RequestIdleWork()
+            {
+                if (this->isIdleWorkRequested || this->idleScheduler.IsEmpty())
+                {
+                    return;
+                }
+
+                this->isIdleWorkRequested = true;
+                this->Dispatcher->RunIdleAsync(ref new IdleDispatchedHandler(this, &D2DCanvas::OnIdleWork));
+            }
+
+            void D2DCanvas::OnIdleWork(IdleDispatchedHandlerArgs^ args)
+            {
+                this->isIdleWorkRequested = false;
+
+                if (this->mainRenderContext == nullptr || this->updatingShapes)
+                {
+                    return;
+                }
+
+                // yield as soon as input or any other dispatcher work arrives
+                auto deadline = std::chrono::steady_clock::now() + std::chrono::microseconds(IdleWorkSliceDuration);
+                this->idleScheduler.RunUntil(deadline, [args]() { return !args->IsDispatcherIdle; });
+
+                this->RequestIdleWork();
+            }
+
+            void D2DCanvas::CancelIdleWork()
+            {
+                this->idleScheduler.Clear();
+                this->isPrefetchRequested = false;
+
+                // the queued warm-up chunks are gone, so the next request starts it over
+                this->pendingWarmUpCount = 0;
+                this->warmUpGeneration = 0;
+            }
+
+            void D2DCanvas::RequestWarmUp()
+            {
+                // a running warm-up follows the viewport, as each chunk tests its shapes against the current materialization
+                // area; a completed one is repeated once a pan brings other shapes into that area
+                if (this->warmUpGeneration == this->RenderGeneration)
+                {
+                    if (this->pendingWarmUpCount > 0)
+                    {
+                        return;
+                    }
+
+                    if (abs(this->pixelViewportOrigin.X - this->warmUpViewportOrigin.X) < this->currentPixelSize.Width / 4 &&
+                        abs(this->pixelViewportOrigin.Y - this->warmUpViewportOrigin.Y) < this->currentPixelSize.Height / 4)
+                    {
+                        return;
+                    }
+                }
+
+                this->ScheduleWarmUp();
+            }
+
+            void D2DCanvas::ScheduleWarmUp()
+            {
+                unsigned long long generation = this->RenderGeneration;
+
+                this->warmUpGeneration = generation;
+                this->warmUpViewportOrigin = this->pixelViewportOrigin;
+                this->pendingWarmUpCount = 0;
+                for (auto layerPtr = this->shapeLayers.begin(); layerPtr != this->shapeLayers.end(); ++layerPtr)
+                {
+                    if ((*layerPtr)->IsVisible && (*layerPtr)->Opacity > 0 && !(*layerPtr)->shapes.empty())
+                    {
+                        this->PostWarmUp(*layerPtr, 0, generation);
+                        this->pendingWarmUpCount++;
+                    }
+                }
+
+                if (this->pendingWarmUpCount == 0)
+                {
+                    this->OnWarmUpCompleted();
+                    return;
+                }
+
+                this->RequestIdleWork();
+            }
+
+            void D2DCanvas::PostWarmUp(D2DShapeLayer^ layer, size_t start, unsigned long long generation)
+            {
+                this->idleScheduler.Post(IdleWorkPriority::WarmUp, [this, layer, start, generation]()
+                {
+                    this->WarmUp(layer, start, generation);
+                });
+            }
+
+            void D2DCanvas::WarmUp(D2DShapeLayer^ layer, size_t start, unsigned long long generation)
+            {
+                // the shapes were changed or the viewport moved on since the work was posted
+                if (generation != this->RenderGeneration || this->mainRenderContext == nullptr)
+                {
+                    return;
+                }
+
+                // the shapes around the viewport are likely to be rendered next
+                Rect area = this->GetMaterializationArea();
+                D2DCullRect modelArea = this->ToModelRect(area);
+
+                size_t end = (std::min)(start + WarmUpChunkSize, layer->shapes.size());
+                for (size_t i = start; i < end; i++)
+                {
+                    D2DShape^ shape = layer->shapes[i];
+                    if (!this->IsInMaterializationArea(layer, shape, area, modelArea))
+                    {
+                        continue;
+                    }
+
+                    // builds the geometry, the label layout and the bounds of the shape
+                    shape->InitRender(this->mainRenderContext);
+                }
+
+                if (end < layer->shapes.size())
+                {
+                    this->PostWarmUp(layer, end, generation);
+                }
+                else if (--this->pendingWarmUpCount == 0)
+                {
+                    this->OnWarmUpCompleted();
+                }
+
+                this->TrimGeometry();
+            }
+
+            void D2DCanvas::OnWarmUpCompleted()
+            {
+                // the next render only draws prepared shapes, so it replaces the preview without waiting for the timer
+                if (this->zoomPreviewBuffer != nullptr)
+                {
+                    this->EndZoomPreview();
+                }
+            }
+
+            Rect D2DCanvas::GetMaterializationArea()
+            {
+                // the viewport in render space inflated by half its size on each side
+                return Rect(
+                    -this->renderOffset.x - this->currentPixelSize.Width / 2,
+                    -this->renderOffset.y - this->currentPixelSize.Height / 2,
+                    this->currentPixelSize.Width * 2,
+                    this->currentPixelSize.Height * 2);
+            }
+
+            D2DCullRect D2DCanvas::ToModelRect(Rect rect)
+            {
+                auto modelTransform = this->ModelTransform;
+                D2DCullRect modelRect =
+                {
+                    (rect.X - modelTransform._31) / modelTransform._11,
+                    (rect.Y - modelTransform._32) / modelTransform._22,
+                    (rect.X + rect.Width - modelTransform._31) / modelTransform._11,
+                    (rect.Y + rect.Height - modelTransform._32) / modelTransform._22
+                };
+
+                return modelRect;
+            }
+
+            bool D2DCanvas::IsInMaterializationArea(D2DShapeLayer^ layer, D2DShape^ shape, Rect area, const D2DCullRect& modelArea)
+            {
+                // the culling table of the layer is filled from the points of the shapes, so it answers without their geometry
+                bool intersects;
+                if (layer != nullptr && this->pixelZoomFactor > 0 && layer->TryIntersectCullBounds(shape, modelArea, static_cast<float>(1 / this->pixelZoomFactor), &intersects))
+                {
+                    return intersects;
+                }
+
+                // shapes whose bounds are not known without their geometry count as inside
+                Rect bounds = shape->GetBounds();
+                return bounds.Width <= 0 || bounds.Height <= 0 || bounds.IntersectsWith(area);
+            }
+
+            void D2DCanvas::UpdateFeatureLayers()
+            {
+                if (this->currentPixelSize.Width <= 0 || this->currentPixelSize.Height <= 0 || this->pixelZoomFactor <= 0)
+                {
+                    return;
+                }
+
+                // the viewport and the area around it are mapped to model space, where the features are indexed
+                D2DCullRect viewport = this->ToModelRect(Rect(-this->renderOffset.x, -this->renderOffset.y, this->currentPixelSize.Width, this->currentPixelSize.Height));
+                D2DCullRect area = this->ToModelRect(this->GetMaterializationArea());
+
+                bool isChanged = false;
+                for (auto layerPtr = this->shapeLayers.begin(); layerPtr != this->shapeLayers.end(); ++layerPtr)
+                {
+                    if ((*layerPtr)->HasFeatures && (*layerPtr)->IsVisible && (*layerPtr)->UpdateFeatures(this, viewport, area))
+                    {
+                        isChanged = true;
+                    }
+                }
+
+                // a progressive pass keeps the shapes it queued, some of which may have been released
+                if (isChanged && this->isProgressivePassActive)
+                {
+                    this->EndProgressivePass();
+                    this->ResetViewportBuffer();
+                }
+            }
+
+            void D2DCanvas::TrimGeometry()
+            {
+                if (this->geometryResidency->MemoryUsage <= this->geometryResidency->MemoryBudget)
+                {
+                    return;
+                }
+
+                // geometries of the shapes on screen and around it are never released
+                Rect area = this->GetMaterializationArea();
+                D2DCullRect modelArea = this->ToModelRect(area);
+                this->geometryResidency->Trim([this, area, modelArea](D2DGeometryShape^ shape)
+                {
+                    int layerIndex = this->FindLayerIndexById(shape->LayerId);
+                    D2DShapeLayer^ layer = layerIndex != -1 ? this->shapeLayers.at(layerIndex) : nullptr;
+
+                    return !this->IsInMaterializationArea(layer, shape, area, modelArea);
+                });
+            }
+
+            void D2DCanvas::Prefetch()
+            {
+                float distance = static_cast<float>(this->prefetchDistance);
+                if (distance < MinPrefetchDistance)
+                {
+                    return;
+                }
+
+                // shrink the distance until the tiles on the leading edges fit in the memory budget
+                long long size = 0;
+                for (int axis = 0; axis < 2; axis++)
+                {
+                    Rect bounds = this->GetPrefetchBounds(axis, distance);
+                    size += static_cast<long long>(ceilf(bounds.Width)) * static_cast<long long>(ceilf(bounds.Height)) * 4;
+                }
+
+                if (size > this->prefetchMemoryBudget)
+                {
+                    distance = static_cast<float>(distance * this->prefetchMemoryBudget / size);
+                    if (distance < MinPrefetchDistance)
+                    {
+                        this->ResetPrefetch();
+                        return;
+                    }
+                }
+
+                unsigned long long generation = this->RenderGeneration;
+
+                for (int axis = 0; axis < 2; axis++)
+                {
+                    D2DPrefetchTile& tile = this->prefetchTiles[axis];
+
+                    Rect bounds = this->GetPrefetchBounds(axis, distance);
+                    if (bounds.Width <= 0 || bounds.Height <= 0)
+                    {
+                        tile.Bitmap.Reset();
+                        continue;
+                    }
+
+                    // the tile is kept while it still covers the near half of the distance ahead of the viewport
+                    Rect nearBounds = this->GetPrefetchBounds(axis, distance / 2);
+                    if (tile.Bitmap != nullptr && tile.Generation == generation && Extensions::Contains(tile.Bounds, nearBounds))
+                    {
+                        continue;
+                    }
+
+                    this->RenderPrefetchTile(tile, bounds);
                 }
-
-                this->viewportOrigin = origin;
-                this->pixelViewportOrigin = pixelOrigin;
-                this->InvalidateArrange();
             }
 
-            Size D2DCanvas::ArrangeOverride(Size finalSize)
+            Rect D2DCanvas::GetPrefetchBounds(int axis, float distance)
             {
-                if (this->wasUnloaded && this->mainRenderContext == nullptr)
+                // the viewport in render space; the content enters from the side opposite to the change of the viewport origin
+                float left = -this->renderOffset.x;
+                float top = -this->renderOffset.y;
+                float right = left + this->currentPixelSize.Width;
+                float bottom = top + this->currentPixelSize.Height;
+
+                float aheadX = abs(this->panVelocity.X) < MinPrefetchVelocity ? 0 : distance;
+                float aheadY = abs(this->panVelocity.Y) < MinPrefetchVelocity ? 0 : distance;
+
+                if (axis == 0)
                 {
-                    if (!this->resources->IsReady)
+                    if (aheadX == 0)
                     {
-                        this->resources->Initialize();
+                        return Rect(0, 0, 0, 0);
                     }
-                    this->InitRenderContext(this->currentSize);
-                }
 
-                this->Render();
-
-                return Panel::ArrangeOverride(finalSize);
-            }
+                    // the vertical strip also covers the corner the diagonal pan is heading to
+                    float x = this->panVelocity.X > 0 ? left - aheadX : right;
+                    float y = this->panVelocity.Y > 0 ? top - aheadY : top;
 
-            Size D2DCanvas::MeasureOverride(Size availableSize)
-            {
-                auto size = Panel::MeasureOverride(availableSize);
+                    return Rect(x, y, aheadX, bottom - top + aheadY);
+                }
 
-                if (!this->resources->IsReady)
+                if (aheadY == 0)
                 {
-                    this->resources->Initialize();
+                    return Rect(0, 0, 0, 0);
                 }
 
-                return size;
+                float y = this->panVelocity.Y > 0 ? top - aheadY : bottom;
+                return Rect(left, y, right - left, aheadY);
             }
 
-            void D2DCanvas::ResetDrawing(bool displayChanged)
+            void D2DCanvas::RenderPrefetchTile(D2DPrefetchTile& tile, Rect bounds)
             {
-                this->InvalidateShapes(displayChanged);
-                this->ResetViewportBuffer();
-            }
+                auto width = static_cast<UINT32>(ceilf(bounds.Width));
+                auto height = static_cast<UINT32>(ceilf(bounds.Height));
 
-            void D2DCanvas::Render()
-            {
-                if (this->updatingShapes)
+                if (tile.Bitmap != nullptr)
                 {
-                    return;
+                    auto size = tile.Bitmap->GetPixelSize();
+                    if (size.width != width || size.height != height)
+                    {
+                        tile.Bitmap.Reset();
+                    }
                 }
 
-                if (this->resources == nullptr || !this->resources->IsReady || this->mainRenderContext == nullptr)
+                if (tile.Bitmap == nullptr)
                 {
-                    return;
-                }
+                    D2D1_BITMAP_PROPERTIES1 bitmapProperties =
+                        D2D1::BitmapProperties1(
+                        D2D1_BITMAP_OPTIONS_TARGET,
+                        D2D1::PixelFormat(DXGI_FORMAT_B8G8R8A8_UNORM, D2D1_ALPHA_MODE_PREMULTIPLIED),
+                        this->mainRenderContext->DPI,
+                        this->mainRenderContext->DPI
+                        );
 
-                if (this->renderOffsetReset)
-                {
-                    this->renderOffsetReset = false;
-                    this->renderOffset = D2D1::Point2F(0, 0);
+                    HRESULT hr = this->mainRenderContext->DeviceContext->CreateBitmap(
+                        D2D1::SizeU(width, height),
+                        nullptr,
+                        0,
+                        &bitmapProperties,
+                        &tile.Bitmap
+                        );
+
+                    if (!SUCCEEDED(hr))
+                    {
+                        tile.Bitmap.Reset();
+                        return;
+                    }
                 }
 
-                this->BeginDraw();
-                this->DoRender();
-                this->EndDraw();
+                tile.Bounds = Rect(bounds.X, bounds.Y, static_cast<float>(width), static_cast<float>(height));
+                tile.Generation = this->RenderGeneration;
 
-                /*this->waitingThreadCount = 2;
-                this->hasPendingEndDraw = true;
+                this->mainRenderContext->DeviceContext->SetTarget(tile.Bitmap.Get());
+                this->mainRenderContext->BeginDraw();
+                this->mainRenderContext->PushTransform(D2D1::Matrix3x2F::Translation(-tile.Bounds.X, -tile.Bounds.Y));
 
-                int shapeCount = this->shapes.size();
-                int chunk = shapeCount / this->waitingThreadCount;
+                this->RenderLayers(tile.Bounds, false);
 
-                std::future<void> f1 = std::async(std::launch::async, [this, chunk](){ this->DoRender(this->mainRenderContext, 0, chunk); });
-                std::future<void> f2 = std::async(std::launch::async, [this, chunk, shapeCount](){ this->DoRender(this->bufferRenderContext, chunk, shapeCount); });*/
+                this->mainRenderContext->PopTransform();
+                this->mainRenderContext->EndDraw();
+                this->mainRenderContext->DeviceContext->SetTarget(nullptr);
             }
 
-            void D2DCanvas::DoRender()
+            bool D2DCanvas::TryRenderPrefetched(Rect invalidRect)
             {
-                this->RenderWithViewportCaching();
+                if (!this->isPrefetchEnabled)
+                {
+                    return false;
+                }
 
-                this->invalidRects.clear();
-            }
+                unsigned long long generation = this->RenderGeneration;
 
-            void D2DCanvas::RenderWithViewportCaching()
-            {
-                if (this->hasBuffer)
+                for (int axis = 0; axis < 2; axis++)
                 {
-                    auto rect = this->GetViewportBufferRenderBounds();
+                    D2DPrefetchTile& tile = this->prefetchTiles[axis];
+                    if (tile.Bitmap == nullptr || tile.Generation != generation || !Extensions::Contains(tile.Bounds, invalidRect))
+                    {
+                        continue;
+                    }
 
-                    // do not anti-alias the viewport buffer
-                    this->mainRenderContext->DeviceContext->PushAxisAlignedClip(rect, D2D1_ANTIALIAS_MODE_ALIASED);
+                    D2D1_RECT_F source = D2D1::RectF(
+                        invalidRect.X - tile.Bounds.X,
+                        invalidRect.Y - tile.Bounds.Y,
+                        invalidRect.X - tile.Bounds.X + invalidRect.Width,
+                        invalidRect.Y - tile.Bounds.Y + invalidRect.Height);
 
                     this->mainRenderContext->DeviceContext->DrawBitmap(
-                        this->viewportBuffer.Get(),
-                        rect,
+                        tile.Bitmap.Get(),
+                        Extensions::ToRect(invalidRect),
                         1.0f,
-                        D2D1_BITMAP_INTERPOLATION_MODE_NEAREST_NEIGHBOR
+                        D2D1_BITMAP_INTERPOLATION_MODE_NEAREST_NEIGHBOR,
+                        &source
                         );
 
-                    this->mainRenderContext->DeviceContext->PopAxisAlignedClip();
+                    this->prefetchHitCount++;
+                    return true;
                 }
 
-                D2D1::Matrix3x2F transform = D2D1::Matrix3x2F::Translation(this->renderOffset.x, this->renderOffset.y);
-                this->mainRenderContext->PushTransform(transform);
+                this->prefetchMissCount++;
+                return false;
+            }
 
-                for (auto rect = this->invalidRects.begin(); rect != this->invalidRects.end(); ++rect)
+            void D2DCanvas::ResetPrefetch()
+            {
+                for (int axis = 0; axis < 2; axis++)
                 {
-                    this->RenderShapes((*rect));
+                    this->prefetchTiles[axis].Bitmap.Reset();
                 }
-
-                this->mainRenderContext->PopTransform();
             }
 
-            void D2DCanvas::RenderShapes(Rect invalidRect)
+            void D2DCanvas::ResetViewportBuffer()
             {
-                bool clearRect = true;
-                if (invalidRect.Width == 0 || invalidRect.Height == 0)
-                {
-                    // entire viewport is the clip rect
-                    invalidRect = Rect(-this->renderOffset.x, -this->renderOffset.y, this->currentPixelSize.Width, this->currentPixelSize.Height);
-                    clearRect = false;
-                }
+                this->hasBuffer = false;
+                this->invalidRects.clear();
+                this->invalidRects.push_back(Rect(0, 0, 0, 0));
+                this->viewportBuffer.Reset();
+                this->updateLayerCaches = true;
 
-                D2D1_RECT_F clip = Extensions::ToRect(invalidRect);
-                this->mainRenderContext->DeviceContext->PushAxisAlignedClip(&clip, D2D1_ANTIALIAS_MODE_ALIASED);
+                // render work in progress, including a progressive pass, is superseded by the new content
+                this->CancelRender();
 
-                if (clearRect)
-                {
-                    this->mainRenderContext->Clear();
-                }
+                this->InvalidateArrange();
+            }
 
-                for (auto layerPtr = this->shapeLayers.begin(); layerPtr != this->shapeLayers.end(); ++layerPtr)
+            void D2DCanvas::UpdateLayerCaches()
+            {
+                if (!this->updateLayerCaches)
                 {
-                    (*layerPtr)->Render(this->mainRenderContext, invalidRect, this->pixelViewportOrigin);
+                    return;
                 }
 
-                // render text on second pass
+                this->updateLayerCaches = false;
+
+                long long cacheSize = static_cast<long long>(this->currentPixelSize.Width) * static_cast<long long>(this->currentPixelSize.Height) * 4;
+                long long availableMemory = this->layerCacheMemoryBudget;
                 for (auto layerPtr = this->shapeLayers.begin(); layerPtr != this->shapeLayers.end(); ++layerPtr)
                 {
-                    for (auto shapePtr = (*layerPtr)->shapes.begin(); shapePtr != (*layerPtr)->shapes.end(); ++shapePtr)
+                    if (!(*layerPtr)->IsCacheEnabled || availableMemory < cacheSize)
+                    {
+                        // fall back to rendering the layer directly onto the main surface
+                        (*layerPtr)->ResetCache();
+                        continue;
+                    }
+
+                    availableMemory -= cacheSize;
+
+                    if ((*layerPtr)->IsVisible)
                     {
-                        (*shapePtr)->RenderLabel(this->mainRenderContext, invalidRect);
+                        (*layerPtr)->UpdateCache(this->mainRenderContext, this->currentPixelSize, this->renderOffset, this->ModelTransform);
                     }
                 }
+            }
 
-                this->mainRenderContext->DeviceContext->PopAxisAlignedClip();
+            void D2DCanvas::CancelRender()
+            {
+                this->renderGeneration++;
+                this->CancelIdleWork();
             }
 
-            void D2DCanvas::ResetViewportBuffer()
+            void D2DCanvas::InvalidateLayerCaches()
             {
-                this->hasBuffer = false;
-                this->invalidRects.clear();
-                this->invalidRects.push_back(Rect(0, 0, 0, 0));
-                this->viewportBuffer.Reset();
+                for (auto layerPtr = this->shapeLayers.begin(); layerPtr != this->shapeLayers.end(); ++layerPtr)
+                {
+                    (*layerPtr)->InvalidateCache();
+                }
+            }
 
-                this->InvalidateArrange();
+            void D2DCanvas::ResetLayerCaches()
+            {
+                for (auto layerPtr = this->shapeLayers.begin(); layerPtr != this->shapeLayers.end(); ++layerPtr)
+                {
+                    (*layerPtr)->ResetCache();
+                }
             }
 
             D2D1_RECT_F D2DCanvas::GetViewportBufferRenderBounds()
@@ -492,7 +1393,17 @@ namespace Telerik
                 }
 
                 this->viewportBuffer.Reset();
+                this->EndProgressivePass();
+                this->ResetPrefetch();
+                this->CancelIdleWork();
+                this->zoomPreviewTimer->Stop();
+                this->zoomPreviewBuffer.Reset();
                 this->nativeImageSource.Reset();
+                this->ResetLayerCaches();
+
+                // cached geometries belong to the factory of the render context
+                this->geometryResidency->Clear();
+                this->geometryCache->Clear();
             }
 
             void D2DCanvas::InvalidateShapes(bool displayChanged)
@@ -515,13 +1426,67 @@ namespace Telerik
                 }
             }
 
+            bool D2DCanvas::GetUpdateRect(RECT* updateRect)
+            {
+                *updateRect = this->surfaceRect;
+
+                // the whole surface is drawn when there is no content to keep or the content has moved
+                if (!this->hasBuffer || this->viewportBuffer == nullptr || this->isProgressivePassActive ||
+                    this->renderOffset.x != this->pixelBufferOrigin.x || this->renderOffset.y != this->pixelBufferOrigin.y)
+                {
+                    return true;
+                }
+
+                float left = this->currentPixelSize.Width;
+                float top = this->currentPixelSize.Height;
+                float right = 0;
+                float bottom = 0;
+
+                for (auto rect = this->invalidRects.begin(); rect != this->invalidRects.end(); ++rect)
+                {
+                    if (rect->Width == 0 || rect->Height == 0)
+                    {
+                        return true;
+                    }
+
+                    // invalid rects are in render space, which is offset from the surface by the render offset
+                    left = (std::min)(left, rect->X + this->renderOffset.x);
+                    top = (std::min)(top, rect->Y + this->renderOffset.y);
+                    right = (std::max)(right, rect->X + rect->Width + this->renderOffset.x);
+                    bottom = (std::max)(bottom, rect->Y + rect->Height + this->renderOffset.y);
+                }
+
+                updateRect->left = (std::max)(0L, static_cast<LONG>(floorf(left)));
+                updateRect->top = (std::max)(0L, static_cast<LONG>(floorf(top)));
+                updateRect->right = (std::min)(this->surfaceRect.right, static_cast<LONG>(ceilf(right)));
+                updateRect->bottom = (std::min)(this->surfaceRect.bottom, static_cast<LONG>(ceilf(bottom)));
+
+                if (updateRect->right <= updateRect->left || updateRect->bottom <= updateRect->top)
+                {
+                    // nothing visible has changed and the surface keeps its content
+                    this->invalidRects.clear();
+                    return false;
+                }
+
+                return true;
+            }
+
             void D2DCanvas::BeginDraw()
+            {
+                this->BeginDraw(this->surfaceRect);
+            }
+
+            void D2DCanvas::BeginDraw(RECT updateRect)
             {
                 HRESULT result;
 
+                this->updateRect = updateRect;
+                this->isPartialUpdate = updateRect.left != this->surfaceRect.left || updateRect.top != this->surfaceRect.top ||
+                    updateRect.right != this->surfaceRect.right || updateRect.bottom != this->surfaceRect.bottom;
+
                 // Copy the already rendered content to the SurfaceImageSource
                 ComPtr<IDXGISurface> surface;
-                result = this->nativeImageSource->BeginDraw(this->surfaceRect, &surface, &this->surfaceOffset);
+                result = this->nativeImageSource->BeginDraw(updateRect, &surface, &this->surfaceOffset);
 
                 if (result == DXGI_ERROR_DEVICE_REMOVED || result == DXGI_ERROR_DEVICE_RESET)
                 {
@@ -535,6 +1500,24 @@ namespace Telerik
                 this->mainRenderContext->DeviceContext->CreateBitmapFromDxgiSurface(surface.Get(), NULL, &surfaceBitmap);
                 this->mainRenderContext->DeviceContext->SetTarget(surfaceBitmap.Get());
 
+                if (this->isPartialUpdate)
+                {
+                    // the surface outside the update rect keeps its content, so nothing may be drawn or cleared there
+                    this->mainRenderContext->BeginDraw(false);
+                    this->mainRenderContext->PushTransform(D2D1::Matrix3x2F::Translation(
+                        static_cast<float>(this->surfaceOffset.x - updateRect.left),
+                        static_cast<float>(this->surfaceOffset.y - updateRect.top)));
+
+                    D2D1_RECT_F clip = D2D1::RectF(
+                        static_cast<float>(updateRect.left),
+                        static_cast<float>(updateRect.top),
+                        static_cast<float>(updateRect.right),
+                        static_cast<float>(updateRect.bottom));
+                    this->mainRenderContext->DeviceContext->PushAxisAlignedClip(&clip, D2D1_ANTIALIAS_MODE_ALIASED);
+                    this->mainRenderContext->Clear();
+                    return;
+                }
+
                 this->mainRenderContext->BeginDraw();
                 if (this->surfaceOffset.x > 0 || this->surfaceOffset.y > 0)
                 {
@@ -546,15 +1529,24 @@ namespace Telerik
             {
                 HRESULT result;
 
+                if (this->isPartialUpdate)
+                {
+                    this->mainRenderContext->DeviceContext->PopAxisAlignedClip();
+                }
+
                 this->mainRenderContext->PopTransform();
                 this->mainRenderContext->EndDraw();
 
                 ComPtr<ID2D1Image> target;
                 this->mainRenderContext->DeviceContext->GetTarget(&target);
 
-                ComPtr<ID2D1Bitmap> bitmap;
-                target.As(&bitmap);
-                this->CaptureViewport(bitmap);
+                // the zoom preview is a scaled image of the viewport buffer and should not replace it
+                if (this->zoomPreviewBuffer == nullptr)
+                {
+                    ComPtr<ID2D1Bitmap> bitmap;
+                    target.As(&bitmap);
+                    this->CaptureViewport(bitmap);
+                }
 
                 this->mainRenderContext->DeviceContext->SetTarget(nullptr);
 
@@ -567,7 +1559,29 @@ namespace Telerik
 
             void D2DCanvas::CaptureViewport(ComPtr<ID2D1Bitmap> surfaceBitmap)
             {
+                if (this->isPartialUpdate && this->viewportBuffer != nullptr)
+                {
+                    // the rest of the buffer is still in sync with the surface, so only the updated pixels are copied
+                    HRESULT hr = this->viewportBuffer->CopyFromBitmap(
+                        &D2D1::Point2U(this->updateRect.left, this->updateRect.top),
+                        surfaceBitmap.Get(),
+                        &D2D1::RectU(
+                        this->surfaceOffset.x,
+                        this->surfaceOffset.y,
+                        this->surfaceOffset.x + (this->updateRect.right - this->updateRect.left),
+                        this->surfaceOffset.y + (this->updateRect.bottom - this->updateRect.top))
+                        );
+                    if (!SUCCEEDED(hr))
+                    {
+                        throw;
+                    }
+
+                    return;
+                }
+
                 this->pixelBufferOrigin = this->renderOffset;
+                this->bufferZoomFactor = this->pixelZoomFactor;
+                this->bufferViewportOrigin = this->pixelViewportOrigin;
 
                 if (this->viewportBuffer == nullptr)
                 {
@@ -616,17 +1630,85 @@ namespace Telerik
 
                 this->renderOffsetReset = true;
                 this->renderOffset = D2D1::Point2F(0, 0);
+                this->InvalidateLayerCaches();
                 this->ResetViewportBuffer();
+
+                // the shapes are prepared for the new zoom factor while the dispatcher is idle, and the zoom preview,
+                // if displayed, is replaced once they are
+                this->RequestWarmUp();
             }
 
             void D2DCanvas::PrepareZoomIn()
             {
-
+                this->BeginZoomPreview();
             }
 
             void D2DCanvas::PrepareZoomOut()
             {
+                // the areas revealed around the scaled snapshot remain empty until the shapes are rendered
+                this->BeginZoomPreview();
+            }
+
+            void D2DCanvas::BeginZoomPreview()
+            {
+                if (!this->isZoomPreviewEnabled)
+                {
+                    return;
+                }
+
+                if (this->zoomPreviewBuffer == nullptr)
+                {
+                    if (!this->hasBuffer || this->viewportBuffer == nullptr)
+                    {
+                        return;
+                    }
+
+                    // keep the last sharp frame for the whole zoom transition
+                    this->zoomPreviewBuffer = this->viewportBuffer;
+                    this->zoomPreviewZoomFactor = this->bufferZoomFactor;
+                    this->zoomPreviewViewportOrigin = this->bufferViewportOrigin;
+                }
+
+                // restart the fallback timer; the preview normally ends once the warm-up for the new zoom factor completes
+                this->zoomPreviewTimer->Stop();
+                this->zoomPreviewTimer->Start();
+            }
+
+            void D2DCanvas::EndZoomPreview()
+            {
+                this->zoomPreviewTimer->Stop();
+
+                if (this->zoomPreviewBuffer != nullptr)
+                {
+                    this->zoomPreviewBuffer.Reset();
+                    this->InvalidateArrange();
+                }
+            }
+
+            void D2DCanvas::RenderZoomPreview()
+            {
+                double scale = this->pixelZoomFactor / this->zoomPreviewZoomFactor;
+
+                // maps the pixels of the snapshot to the current zoom factor and viewport origin
+                D2D1::Matrix3x2F transform = D2D1::Matrix3x2F::Scale(static_cast<float>(scale), static_cast<float>(scale)) * D2D1::Matrix3x2F::Translation(
+                    static_cast<float>(this->pixelViewportOrigin.X - this->zoomPreviewViewportOrigin.X * scale),
+                    static_cast<float>(this->pixelViewportOrigin.Y - this->zoomPreviewViewportOrigin.Y * scale));
+
+                auto size = this->zoomPreviewBuffer->GetSize();
+
+                this->mainRenderContext->PushTransform(transform);
+                this->mainRenderContext->DeviceContext->DrawBitmap(
+                    this->zoomPreviewBuffer.Get(),
+                    D2D1::RectF(0, 0, size.width, size.height),
+                    1.0f,
+                    D2D1_BITMAP_INTERPOLATION_MODE_LINEAR
+                    );
+                this->mainRenderContext->PopTransform();
+            }
 
+            void D2DCanvas::OnZoomPreviewTimerTick(Object^ sender, Object^ args)
+            {
+                this->EndZoomPreview();
             }
 
             void D2DCanvas::OnLoaded(Object^ sender, RoutedEventArgs^ args)
@@ -654,6 +1736,12 @@ namespace Telerik
 
             void D2DCanvas::CleanUp()
             {
+                if (this->isNextFrameRequested)
+                {
+                    CompositionTarget::Rendering -= this->renderingToken;
+                    this->isNextFrameRequested = false;
+                }
+
                 this->ResetDrawing(true);
                 this->ClearRenderContext();
                 this->Background = nullptr;
@@ -673,6 +1761,66 @@ namespace Telerik
                 this->ClearRenderContext();
             }
 
+            void D2DCanvas::InvalidateShapeBounds(D2DShape^ shape)
+            {
+                auto layerIndex = this->FindLayerIndexById(shape->LayerId);
+                if (layerIndex != -1)
+                {
+                    this->shapeLayers.at(layerIndex)->InvalidateCullBounds(shape);
+                }
+            }
+
+            bool D2DCanvas::AppendShapesToLayer(int layerId, const std::vector<D2DShape^>& shapes)
+            {
+                auto layerIndex = this->FindLayerIndexById(layerId);
+                if (layerIndex == -1)
+                {
+                    return false;
+                }
+
+                D2DShapeLayer^ layer = this->shapeLayers.at(layerIndex);
+                if (shapes.empty())
+                {
+                    return true;
+                }
+
+                Rect area = Rect::Empty;
+                for (auto shapePtr = shapes.begin(); shapePtr != shapes.end(); ++shapePtr)
+                {
+                    D2DShape^ shape = *shapePtr;
+                    shape->SetLayerId(layerId);
+                    shape->SetOwner(this);
+
+                    if (layer->parameters.RenderPrecision != ShapeRenderPrecision::Default)
+                    {
+                        shape->SetRenderPrecision(layer->parameters.RenderPrecision);
+                    }
+
+                    float strokeThickness = shape->CurrentStyle->StrokeThicknessAsFloat;
+
+                    Rect bounds = shape->GetBounds();
+                    bounds.X = floorf(bounds.X - strokeThickness / 2);
+                    bounds.Y = floorf(bounds.Y - strokeThickness / 2);
+                    bounds.Width = ceilf(bounds.Width + strokeThickness);
+                    bounds.Height = ceilf(bounds.Height + strokeThickness);
+                    area.Union(bounds);
+                }
+
+                layer->AppendShapes(shapes);
+                this->updateLayerCaches = true;
+
+                // prefetched pixels do not contain the new shapes
+                this->ResetPrefetch();
+
+                if (!area.IsEmpty)
+                {
+                    this->invalidRects.push_back(area);
+                    this->InvalidateArrange();
+                }
+
+                return true;
+            }
+
             void D2DCanvas::InvalidateShape(D2DShape^ shape)
             {
                 if (this->updatingShapes)
@@ -680,6 +1828,17 @@ namespace Telerik
                     return;
                 }
 
+                auto layerIndex = this->FindLayerIndexById(shape->LayerId);
+                if (layerIndex != -1)
+                {
+                    // the cache is rebuilt before the next render instead of leaving the layer to direct rendering
+                    this->shapeLayers.at(layerIndex)->InvalidateCache();
+                    this->updateLayerCaches = true;
+                }
+
+                // prefetched pixels may contain the previous state of the shape
+                this->ResetPrefetch();
+
                 float strokeThickness = shape->CurrentStyle->StrokeThicknessAsFloat;
 
                 Rect bounds = shape->GetBounds();
@@ -6,10 +6,34 @@
 #include "D2DShape.h"
 #include "D2DShapeLayer.h"
 #include "D2DRenderContext.h"
+#include "D2DGeometryCache.h"
+#include "D2DGeometryResidency.h"
+#include "D2DIdleScheduler.h"
+#include "D2DFeatureFile.h"
 
 using namespace Windows::UI::Core;
 
 const float ClipOffset = 0.5f;
+const long long DefaultLayerCacheMemoryBudget = 64 * 1024 * 1024;
+
+// the time (in 100-nanosecond units) after the last zoom change the zoom preview is replaced even if the shapes
+// are not prepared for the new zoom factor yet
+const long long ZoomPreviewSettleDuration = 1500000;
+
+const double DefaultProgressiveFrameBudget = 12;
+
+const double DefaultPrefetchDistance = 256;
+const long long DefaultPrefetchMemoryBudget = 16 * 1024 * 1024;
+const float MinPrefetchDistance = 16;
+
+// the pan velocity is in pixels per second and is reset when the viewport origin does not change for the timeout (in seconds)
+const double MinPrefetchVelocity = 30;
+const double PanVelocityTimeout = 0.2;
+const double PanVelocitySmoothing = 0.5;
+
+// the time (in microseconds) idle work may run before control is returned to the dispatcher
+const long long IdleWorkSliceDuration = 8000;
+const size_t WarmUpChunkSize = 64;
 
 namespace Telerik
 {
@@ -17,6 +41,14 @@ namespace Telerik
 	{
 		namespace Drawing
 		{
+			// pixels rendered ahead of a pan, beyond one edge of the viewport, in the render space of the canvas
+			struct D2DPrefetchTile
+			{
+				ComPtr<ID2D1Bitmap1> Bitmap;
+				Rect Bounds;
+				unsigned long long Generation;
+			};
+
 			[Windows::Foundation::Metadata::WebHostHidden]
 			public ref class D2DCanvas sealed : Windows::UI::Xaml::Controls::Panel
 			{
@@ -24,7 +56,13 @@ namespace Telerik
 				D2DCanvas(void);
 				virtual ~D2DCanvas(void);
 
+				// passing the shapes the layer already has updates its parameters only, which re-renders that layer
+				// and recomposites the cached bitmaps of the others
 				void SetShapesForLayer(IIterable<D2DShape^>^ shapes, ShapeLayerParameters parameters);
+
+				// streams the shapes of a layer from a feature file; only the features around the viewport are created
+				// as shapes, with the given normal style, and they are released once the viewport moves away from them
+				void SetFeaturesForLayer(D2DFeatureFile^ features, D2DShapeStyle^ style, ShapeLayerParameters parameters);
 				void ResetDrawing(bool displayChanged);
 				void CleanUpOnSuspend(void);
 
@@ -55,12 +93,9 @@ namespace Telerik
 						}
 
 						auto oldZoom = this->zoomFactor;
-						this->zoomFactor = value;
-						this->pixelZoomFactor = value * this->dpi / DefaultDPI;
 
-						this->OnZoomFactorChanged(oldZoom);
-						
-						if(this->zoomFactor > oldZoom)
+						// the zoom preview is prepared from the content rendered for the old zoom factor
+						if(value > oldZoom)
 						{
 							this->PrepareZoomIn();
 						}
@@ -68,6 +103,11 @@ namespace Telerik
 						{
 							this->PrepareZoomOut();
 						}
+
+						this->zoomFactor = value;
+						this->pixelZoomFactor = value * this->dpi / DefaultDPI;
+
+						this->OnZoomFactorChanged(oldZoom);
 						
 						this->InvalidateArrange();
 					}
@@ -78,18 +118,173 @@ namespace Telerik
 
 				bool HasShapesForLayer(int layerId);
 
+				void SetLayerVisibility(int layerId, bool isVisible);
+				void SetLayerOpacity(int layerId, double opacity);
+				void SetLayerZIndex(int layerId, int zIndex);
+
+				// the maximum number of bytes that may be allocated for layers with ShapeLayerCacheMode::Bitmap;
+				// layers that do not fit in the budget are rendered directly onto the main surface
+				property long long LayerCacheMemoryBudget
+				{
+					long long get() { return this->layerCacheMemoryBudget; }
+					void set(long long value)
+					{
+						this->layerCacheMemoryBudget = value;
+						this->ResetViewportBuffer();
+					}
+				}
+
+				// the maximum number of bytes used to keep path geometries built for previously visited zoom levels
+				property long long GeometryCacheMemoryBudget
+				{
+					long long get() { return this->geometryCache->MemoryBudget; }
+					void set(long long value) { this->geometryCache->MemoryBudget = value; }
+				}
+
+				property long long GeometryCacheHitCount
+				{
+					long long get() { return this->geometryCache->HitCount; }
+				}
+
+				property long long GeometryCacheMissCount
+				{
+					long long get() { return this->geometryCache->MissCount; }
+				}
+
+				void ResetGeometryCacheStatistics();
+
+				// the maximum number of bytes of path geometry held by the shapes themselves; geometries are built only for
+				// the shapes around the viewport and released in least recently used order once they are off screen.
+				// pixel-space geometries released this way may still be kept by the geometry cache within its own budget.
+				property long long GeometryMemoryBudget
+				{
+					long long get() { return this->geometryResidency->MemoryBudget; }
+					void set(long long value)
+					{
+						this->geometryResidency->MemoryBudget = value;
+						this->TrimGeometry();
+					}
+				}
+
+				property long long GeometryMemoryUsage
+				{
+					long long get() { return this->geometryResidency->MemoryUsage; }
+				}
+
+				property long long GeometryEvictionCount
+				{
+					long long get() { return this->geometryResidency->EvictionCount; }
+				}
+
+				// the number of shapes holding a path geometry; after the first frame it is at most the number of shapes
+				// whose bounds reach the viewport, and idle warm-up extends it to the shapes around the viewport
+				property int GeometryCount
+				{
+					int get() { return static_cast<int>(this->geometryResidency->Count); }
+				}
+
+				// when enabled, full viewport renders are split in time slices which are presented as soon as they are ready
+				property bool IsProgressiveRenderingEnabled
+				{
+					bool get() { return this->isProgressiveRenderingEnabled; }
+					void set(bool value)
+					{
+						this->isProgressiveRenderingEnabled = value;
+						this->EndProgressivePass();
+						this->ResetViewportBuffer();
+					}
+				}
+
+				// the time, in milliseconds, that a single progressive rendering slice may take
+				property double ProgressiveFrameBudget
+				{
+					double get() { return this->progressiveFrameBudget; }
+					void set(double value)
+					{
+						this->progressiveFrameBudget = value;
+					}
+				}
+
+				// when enabled, a scaled snapshot of the last rendered viewport is displayed while the zoom factor changes and is
+				// replaced as soon as the shapes around the viewport are prepared for the new zoom factor. Disabled by default
+				property bool IsZoomPreviewEnabled
+				{
+					bool get() { return this->isZoomPreviewEnabled; }
+					void set(bool value)
+					{
+						this->isZoomPreviewEnabled = value;
+						if(!value)
+						{
+							this->EndZoomPreview();
+						}
+					}
+				}
+
+				// when enabled, the content about to enter the viewport in the direction of the pan is rendered while the dispatcher is idle
+				property bool IsPrefetchEnabled
+				{
+					bool get() { return this->isPrefetchEnabled; }
+					void set(bool value)
+					{
+						this->isPrefetchEnabled = value;
+						this->ResetPrefetch();
+					}
+				}
+
+				// how far, in pixels, beyond the leading edges of the viewport the content is prefetched
+				property double PrefetchDistance
+				{
+					double get() { return this->prefetchDistance; }
+					void set(double value)
+					{
+						this->prefetchDistance = value;
+						this->ResetPrefetch();
+					}
+				}
+
+				// the maximum number of bytes used by the prefetched pixels; the prefetch distance is reduced to fit it
+				property long long PrefetchMemoryBudget
+				{
+					long long get() { return this->prefetchMemoryBudget; }
+					void set(long long value)
+					{
+						this->prefetchMemoryBudget = value;
+						this->ResetPrefetch();
+					}
+				}
+
+				// the number of partial viewport updates served from prefetched pixels
+				property long long PrefetchHitCount
+				{
+					long long get() { return this->prefetchHitCount; }
+				}
+
+				// the number of partial viewport updates rendered while prefetching was enabled
+				property long long PrefetchMissCount
+				{
+					long long get() { return this->prefetchMissCount; }
+				}
+
+				void ResetPrefetchStatistics();
+
 			protected:
 				virtual Size ArrangeOverride(Size finalSize) override;
 				virtual Size MeasureOverride(Size availableSize) override;
 
 			internal:
 				void BeginDraw();
+				void BeginDraw(RECT updateRect);
 				void EndDraw();
 
 				virtual void PrepareZoomIn();
 				virtual void PrepareZoomOut();
 
 				void InvalidateShape(D2DShape^ shape);
+				void InvalidateShapeBounds(D2DShape^ shape);
+
+				// adds the shapes of a layer that is loading in batches and invalidates only the area they cover;
+				// returns false if the layer has been removed since the load started
+				bool AppendShapesToLayer(int layerId, const std::vector<D2DShape^>& shapes);
 
 				property double PixelZoomFactor
 				{
@@ -101,11 +296,53 @@ namespace Telerik
 					DoublePoint get() { return this->pixelViewportOrigin; }
 				}
 
+				// the viewport origin in the render space of the canvas, i.e. without the pending render offset
+				property DoublePoint PixelRenderOrigin
+				{
+					DoublePoint get()
+					{
+						DoublePoint origin;
+						origin.X = this->pixelViewportOrigin.X - this->renderOffset.x;
+						origin.Y = this->pixelViewportOrigin.Y - this->renderOffset.y;
+						return origin;
+					}
+				}
+
+				// maps model coordinates to the render space of the canvas; shapes rendered with a precision other than Double
+				// keep their geometry in model space and are drawn through this transform
+				property D2D1::Matrix3x2F ModelTransform
+				{
+					D2D1::Matrix3x2F get()
+					{
+						float scale = static_cast<float>(this->pixelZoomFactor);
+						DoublePoint origin = this->PixelRenderOrigin;
+						return D2D1::Matrix3x2F::Scale(scale, scale) * D2D1::Matrix3x2F::Translation(static_cast<float>(origin.X), static_cast<float>(origin.Y));
+					}
+				}
+
+				property D2DGeometryCache^ GeometryCache
+				{
+					D2DGeometryCache^ get() { return this->geometryCache; }
+				}
+
+				property D2DGeometryResidency^ GeometryResidency
+				{
+					D2DGeometryResidency^ get() { return this->geometryResidency; }
+				}
+
+				// incremented whenever the viewport content is invalidated; a progressive pass, a prefetch tile and a warm-up
+				// started for an older generation are dropped at their next slice or work item
+				property unsigned long long RenderGeneration
+				{
+					unsigned long long get() { return this->renderGeneration; }
+				}
+
 			private:
 				void SetViewportOrigin(DoublePoint origin);
 				void Render();
 				void CleanUp();
 				void ClearLayer(D2DShapeLayer^ layer);
+				void UpdateLayerParameters(D2DShapeLayer^ layer, ShapeLayerParameters parameters);
 
 				void RemoveLayerAtIndex(int index);
 				int FindLayerIndexById(int layerId);
@@ -116,13 +353,48 @@ namespace Telerik
 				void InvalidateShapes(bool displayChanged);
 				void CaptureViewport(ComPtr<ID2D1Bitmap> surfaceBitmap);
 				D2D1_RECT_F GetViewportBufferRenderBounds();
+				bool GetUpdateRect(RECT* updateRect);
 				void Resize(Size newSize);
 
 				void RenderWithEntireSceneCaching();
 				void RenderWithViewportCaching();
+				void RenderProgressive();
+				void BeginProgressivePass();
+				void EndProgressivePass();
+				void RequestNextFrame();
+				void OnCompositionTargetRendering(Object^ sender, Object^ args);
 				void RenderShapes(Rect invalidRect);
+				void RenderLayers(Rect invalidRect, bool useLayerCaches);
 				void ResetViewportBuffer();
+				void UpdateLayerCaches();
+				void CancelRender();
+				void InvalidateLayerCaches();
+				void ResetLayerCaches();
 				void OnZoomFactorChanged(double oldZoom);
+				void BeginZoomPreview();
+				void EndZoomPreview();
+				void RenderZoomPreview();
+				void OnZoomPreviewTimerTick(Object^ sender, Object^ args);
+				void UpdatePanVelocity(DoublePoint pixelOrigin);
+				void RequestPrefetch();
+				void RequestIdleWork();
+				void OnIdleWork(IdleDispatchedHandlerArgs^ args);
+				void CancelIdleWork();
+				void RequestWarmUp();
+				void ScheduleWarmUp();
+				void PostWarmUp(D2DShapeLayer^ layer, size_t start, unsigned long long generation);
+				void WarmUp(D2DShapeLayer^ layer, size_t start, unsigned long long generation);
+				void OnWarmUpCompleted();
+				Rect GetMaterializationArea();
+				D2DCullRect ToModelRect(Rect rect);
+				bool IsInMaterializationArea(D2DShapeLayer^ layer, D2DShape^ shape, Rect area, const D2DCullRect& modelArea);
+				void UpdateFeatureLayers();
+				void TrimGeometry();
+				void Prefetch();
+				Rect GetPrefetchBounds(int axis, float distance);
+				void RenderPrefetchTile(D2DPrefetchTile& tile, Rect bounds);
+				bool TryRenderPrefetched(Rect invalidRect);
+				void ResetPrefetch();
 				
 				void OnSizeChanged(Object^ sender, SizeChangedEventArgs^ args);
 				void OnLoaded(Object^ sender, RoutedEventArgs^ args);
@@ -130,13 +402,18 @@ namespace Telerik
 
 				void OnDisplayInvalidated(Windows::Graphics::Display::DisplayInformation^ info, Object^ sender);
 				Windows::Foundation::EventRegistrationToken displayInvalidatedToken;
+				Windows::Foundation::EventRegistrationToken renderingToken;
 
 				D3DResources^ resources;
+				D2DGeometryCache^ geometryCache;
+				D2DGeometryResidency^ geometryResidency;
 				D2DRenderContext^ mainRenderContext;
 				SurfaceImageSource^ imageSource;
 				ImageBrush^ background;
 				ComPtr<ISurfaceImageSourceNative> nativeImageSource;
 				ComPtr<ID2D1Bitmap1> viewportBuffer;
+				ComPtr<ID2D1Bitmap1> zoomPreviewBuffer;
+				DispatcherTimer^ zoomPreviewTimer;
 
 				Windows::Graphics::Display::DisplayInformation^ displayInfo;
 
@@ -150,17 +427,60 @@ namespace Telerik
 				Size currentPixelSize;
 				double zoomFactor;
 				double pixelZoomFactor;
+				long long layerCacheMemoryBudget;
 				RECT surfaceRect;
+
+				// the part of the surface updated by the current frame
+				RECT updateRect;
 				POINT surfaceOffset;
 
 				D2D1_POINT_2F renderOffset;
 				D2D1_POINT_2F pixelBufferOrigin;
+
+				// the zoom factor and viewport origin the viewport buffer was captured with
+				double bufferZoomFactor;
+				DoublePoint bufferViewportOrigin;
+				double progressiveFrameBudget;
+				size_t progressiveLayerIndex;
+				size_t progressiveShapeIndex;
+				unsigned long long progressivePassGeneration;
+				unsigned long long renderGeneration;
+
+				D2DIdleScheduler idleScheduler;
+
+				// the layers whose warm-up for the current render generation has not reached their last shape yet
+				size_t pendingWarmUpCount;
+
+				// the render generation and the viewport origin the last warm-up was scheduled for; render generations start at 1,
+				// so 0 means no warm-up is queued
+				unsigned long long warmUpGeneration;
+				DoublePoint warmUpViewportOrigin;
+
+				// one tile for each axis of the pan
+				D2DPrefetchTile prefetchTiles[2];
+				DoublePoint panVelocity;
+				std::chrono::steady_clock::time_point lastPanTime;
+				double prefetchDistance;
+				long long prefetchMemoryBudget;
+				long long prefetchHitCount;
+				long long prefetchMissCount;
+				double zoomPreviewZoomFactor;
+				DoublePoint zoomPreviewViewportOrigin;
 				float dpi;
 
 				bool hasBuffer;
 				bool updatingShapes;
 				bool wasUnloaded;
 				bool renderOffsetReset;
+				bool updateLayerCaches;
+				bool isZoomPreviewEnabled;
+				bool isProgressiveRenderingEnabled;
+				bool isProgressivePassActive;
+				bool isNextFrameRequested;
+				bool isPrefetchEnabled;
+				bool isPrefetchRequested;
+				bool isIdleWorkRequested;
+				bool isPartialUpdate;
 			};
 		}
 	}
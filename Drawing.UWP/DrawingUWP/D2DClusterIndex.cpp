@@ -0,0 +1,265 @@
+#include "pch.h"
+#include "D2DClusterIndex.h"
+#include "D2DPointKernels.h"
+#include <algorithm>
+#include <cmath>
+
+// cell coordinates are kept in 31 bits so that the column and the row of a cell pack into a single sortable key
+const double MaxCellCoordinate = 2147483647.0;
+
+namespace Telerik
+{
+	namespace UI
+	{
+		namespace Drawing
+		{
+			D2DClusterIndex::D2DClusterIndex()
+			{
+				this->Clear();
+			}
+
+			void D2DClusterIndex::Clear()
+			{
+				this->levels.clear();
+				this->pointCount = 0;
+				this->cellSize = 1;
+				this->originX = 0;
+				this->originY = 0;
+				this->extentX = 0;
+				this->extentY = 0;
+			}
+
+			void D2DClusterIndex::Build(const double* coordinates, size_t pointCount, double cellSize, int minLevel, int maxLevel)
+			{
+				this->Clear();
+
+				D2DPointBounds bounds;
+				if(cellSize <= 0 || minLevel > maxLevel || !D2DPointKernels::ComputeBounds(coordinates, pointCount, &bounds))
+				{
+					return;
+				}
+
+				this->pointCount = pointCount;
+				this->cellSize = cellSize;
+				this->originX = bounds.MinX;
+				this->originY = bounds.MinY;
+				this->extentX = bounds.MaxX - bounds.MinX;
+				this->extentY = bounds.MaxY - bounds.MinY;
+
+				// the finest level must still fit its cell coordinates in the key
+				double extent = (std::max)(this->extentX, this->extentY);
+				if(extent > 0)
+				{
+					int finestLevel = static_cast<int>(floor(log(MaxCellCoordinate * cellSize / extent) / log(2.0)));
+					maxLevel = (std::max)(minLevel, (std::min)(maxLevel, finestLevel));
+				}
+
+				this->levels.reserve(maxLevel - minLevel + 1);
+				this->BuildPointLevel(coordinates, maxLevel);
+
+				for(int number = maxLevel - 1; number >= minLevel; number--)
+				{
+					Level parent;
+					this->BuildParentLevel(this->levels.back(), number, &parent);
+
+					// a finer level that merges nothing more than its parent is replaced, so that the levels
+					// where every point is on its own are stored once instead of once per zoom level
+					if(this->levels.size() == 1 && parent.Clusters.size() == this->levels.back().Clusters.size())
+					{
+						this->levels.back() = std::move(parent);
+					}
+					else
+					{
+						this->levels.push_back(std::move(parent));
+					}
+				}
+			}
+
+			void D2DClusterIndex::BuildPointLevel(const double* coordinates, int number)
+			{
+				Level level;
+				level.Number = number;
+				level.CellSize = this->cellSize / pow(2.0, number);
+
+				std::vector<std::pair<uint64_t, uint32_t>> cells(this->pointCount);
+				for(size_t i = 0; i < this->pointCount; i++)
+				{
+					uint32_t column = static_cast<uint32_t>((coordinates[2 * i] - this->originX) / level.CellSize);
+					uint32_t row = static_cast<uint32_t>((coordinates[2 * i + 1] - this->originY) / level.CellSize);
+					cells[i] = std::make_pair(GetKey(column, row), static_cast<uint32_t>(i));
+				}
+
+				// the points of a cell end up next to each other, with the one of the lowest index first
+				std::sort(cells.begin(), cells.end());
+
+				for(size_t i = 0; i < cells.size(); )
+				{
+					uint64_t key = cells[i].first;
+					D2DPointCluster cluster = { 0, 0, 0, cells[i].second };
+
+					for(; i < cells.size() && cells[i].first == key; i++)
+					{
+						cluster.X += coordinates[2 * cells[i].second];
+						cluster.Y += coordinates[2 * cells[i].second + 1];
+						cluster.Count++;
+					}
+
+					cluster.X /= cluster.Count;
+					cluster.Y /= cluster.Count;
+
+					level.Keys.push_back(key);
+					level.Clusters.push_back(cluster);
+				}
+
+				this->levels.push_back(std::move(level));
+			}
+
+			void D2DClusterIndex::BuildParentLevel(const Level& child, int number, Level* parent)
+			{
+				parent->Number = number;
+				parent->CellSize = child.CellSize * 2;
+
+				// the cells of the parent are twice as large, so the four child cells (2c, 2r) to (2c + 1, 2r + 1) merge into (c, r)
+				std::vector<std::pair<uint64_t, uint32_t>> cells(child.Keys.size());
+				for(size_t i = 0; i < child.Keys.size(); i++)
+				{
+					uint32_t column = static_cast<uint32_t>(child.Keys[i] & 0xFFFFFFFF) >> 1;
+					uint32_t row = static_cast<uint32_t>(child.Keys[i] >> 32) >> 1;
+					cells[i] = std::make_pair(GetKey(column, row), static_cast<uint32_t>(i));
+				}
+
+				// the child keys are sorted by row, so each parent row is made of at most two runs that are already
+				// sorted by the parent key - merging them keeps the build linear instead of sorting every level
+				for(size_t start = 0; start < cells.size(); )
+				{
+					uint64_t parentRow = cells[start].first >> 32;
+					uint64_t childRow = child.Keys[start] >> 32;
+
+					size_t split = start;
+					while(split < cells.size() && (child.Keys[split] >> 32) == childRow)
+					{
+						split++;
+					}
+
+					size_t end = split;
+					while(end < cells.size() && (cells[end].first >> 32) == parentRow)
+					{
+						end++;
+					}
+
+					if(split < end)
+					{
+						std::inplace_merge(cells.begin() + start, cells.begin() + split, cells.begin() + end);
+					}
+
+					start = end;
+				}
+
+				for(size_t i = 0; i < cells.size(); )
+				{
+					uint64_t key = cells[i].first;
+					const D2DPointCluster& first = child.Clusters[cells[i].second];
+					D2DPointCluster cluster = { 0, 0, 0, first.PointIndex };
+
+					for(; i < cells.size() && cells[i].first == key; i++)
+					{
+						const D2DPointCluster& current = child.Clusters[cells[i].second];
+						cluster.X += current.X * current.Count;
+						cluster.Y += current.Y * current.Count;
+						cluster.Count += current.Count;
+						cluster.PointIndex = (std::min)(cluster.PointIndex, current.PointIndex);
+					}
+
+					cluster.X /= cluster.Count;
+					cluster.Y /= cluster.Count;
+
+					parent->Keys.push_back(key);
+					parent->Clusters.push_back(cluster);
+				}
+			}
+
+			int D2DClusterIndex::GetLevel(double zoomFactor) const
+			{
+				if(zoomFactor <= 0)
+				{
+					return 0;
+				}
+
+				return static_cast<int>(floor(log(zoomFactor) / log(2.0)));
+			}
+
+			const D2DClusterIndex::Level& D2DClusterIndex::FindLevel(int level) const
+			{
+				// the levels are contiguous, from the finest kept level down to the coarsest one
+				int index = this->levels.front().Number - level;
+				index = (std::max)(0, (std::min)(index, static_cast<int>(this->levels.size()) - 1));
+
+				return this->levels[index];
+			}
+
+			void D2DClusterIndex::Query(int level, double minX, double minY, double maxX, double maxY, std::vector<D2DPointCluster>& clusters) const
+			{
+				if(this->levels.empty() || minX > maxX || minY > maxY)
+				{
+					return;
+				}
+
+				const Level& data = this->FindLevel(level);
+
+				// the center of a cluster is always inside its cell, so only the cells intersecting the rect are visited
+				double lastColumn = floor(this->extentX / data.CellSize);
+				double lastRow = floor(this->extentY / data.CellSize);
+
+				double firstQueryColumn = (std::max)(0.0, floor((minX - this->originX) / data.CellSize));
+				double firstQueryRow = (std::max)(0.0, floor((minY - this->originY) / data.CellSize));
+				double lastQueryColumn = (std::min)(lastColumn, floor((maxX - this->originX) / data.CellSize));
+				double lastQueryRow = (std::min)(lastRow, floor((maxY - this->originY) / data.CellSize));
+
+				if(firstQueryColumn > lastQueryColumn || firstQueryRow > lastQueryRow)
+				{
+					return;
+				}
+
+				// a rect spanning more rows than there are clusters is faster to answer with a single pass
+				if(lastQueryRow - firstQueryRow + 1 > static_cast<double>(data.Clusters.size()))
+				{
+					for(auto cluster = data.Clusters.begin(); cluster != data.Clusters.end(); ++cluster)
+					{
+						if(cluster->X >= minX && cluster->X <= maxX && cluster->Y >= minY && cluster->Y <= maxY)
+						{
+							clusters.push_back(*cluster);
+						}
+					}
+
+					return;
+				}
+
+				uint32_t firstColumn = static_cast<uint32_t>(firstQueryColumn);
+				uint32_t lastColumnInRow = static_cast<uint32_t>(lastQueryColumn);
+
+				for(uint32_t row = static_cast<uint32_t>(firstQueryRow); row <= static_cast<uint32_t>(lastQueryRow); row++)
+				{
+					uint64_t lastKey = GetKey(lastColumnInRow, row);
+					auto key = std::lower_bound(data.Keys.begin(), data.Keys.end(), GetKey(firstColumn, row));
+
+					for(; key != data.Keys.end() && *key <= lastKey; ++key)
+					{
+						const D2DPointCluster& cluster = data.Clusters[key - data.Keys.begin()];
+						if(cluster.X >= minX && cluster.X <= maxX && cluster.Y >= minY && cluster.Y <= maxY)
+						{
+							clusters.push_back(cluster);
+						}
+					}
+				}
+			}
+
+			void D2DClusterIndex::GetBounds(double* minX, double* minY, double* maxX, double* maxY) const
+			{
+				*minX = this->originX;
+				*minY = this->originY;
+				*maxX = this->originX + this->extentX;
+				*maxY = this->originY + this->extentY;
+			}
+		}
+	}
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+namespace Telerik
+{
+	namespace UI
+	{
+		namespace Drawing
+		{
+			// a group of points that fall in the same grid cell at a zoom level; a cluster of a single point refers to it by index
+			struct D2DPointCluster
+			{
+				double X;
+				double Y;
+				uint32_t Count;
+				uint32_t PointIndex;
+			};
+
+			// clusters points on a hierarchy of grids, one per power-of-two zoom level, where each level merges the cells of
+			// the finer one; built once, after which the clusters of any level are queried by a rect without touching the points.
+			// coordinates are in the space of zoom factor 1 and the cell size is in pixels at the zoom of the level
+			class D2DClusterIndex
+			{
+			public:
+				D2DClusterIndex();
+
+				void Build(const double* coordinates, size_t pointCount, double cellSize, int minLevel, int maxLevel);
+				void Clear();
+
+				bool IsEmpty() const { return this->levels.empty(); }
+				size_t GetPointCount() const { return this->pointCount; }
+
+				// the level whose cells are between one and two cell sizes wide at the zoom factor
+				int GetLevel(double zoomFactor) const;
+
+				// appends the clusters of the level whose center lies in the rect
+				void Query(int level, double minX, double minY, double maxX, double maxY, std::vector<D2DPointCluster>& clusters) const;
+
+				// the bounds of all points, valid if the index is not empty
+				void GetBounds(double* minX, double* minY, double* maxX, double* maxY) const;
+
+			private:
+				struct Level
+				{
+					int Number;
+					double CellSize;
+
+					// sorted by cell key (row, then column)
+					std::vector<uint64_t> Keys;
+					std::vector<D2DPointCluster> Clusters;
+				};
+
+				static uint64_t GetKey(uint32_t column, uint32_t row) { return (static_cast<uint64_t>(row) << 32) | column; }
+
+				void BuildPointLevel(const double* coordinates, int number);
+				void BuildParentLevel(const Level& child, int number, Level* parent);
+				const Level& FindLevel(int level) const;
+
+				// ordered from the finest level to the coarsest one; finer levels that would not merge any points are not kept
+				std::vector<Level> levels;
+
+				size_t pointCount;
+				double cellSize;
+				double originX;
+				double originY;
+				double extentX;
+				double extentY;
+			};
+		}
+	}
+}
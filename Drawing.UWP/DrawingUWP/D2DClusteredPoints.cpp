@@ -0,0 +1,265 @@
+#include "pch.h"
+#include "D2DClusteredPoints.h"
+#include "D2DShapeStyle.h"
+#include "D2DCanvas.h"
+#include <algorithm>
+
+const double DefaultClusterCellSize = 64;
+
+// the zoom levels clustered by the index; finer levels that merge no points are not stored
+const int MinClusterLevel = -8;
+const int MaxClusterLevel = 24;
+
+// the radius of a cluster grows with the binary logarithm of its count
+const float MinClusterRadius = 8;
+const float MaxClusterRadius = 24;
+const float ClusterCountFontSize = 11;
+
+namespace Telerik
+{
+	namespace UI
+	{
+		namespace Drawing
+		{
+			D2DClusteredPoints::D2DClusteredPoints(void)
+			{
+				this->markerSize = Windows::Foundation::Size(5, 5);
+				this->clusterCellSize = DefaultClusterCellSize;
+			}
+
+			void D2DClusteredPoints::SetPoints(IIterable<DoublePoint>^ points)
+			{
+				this->pointsArray.clear();
+
+				if(points != nullptr)
+				{
+					IIterator<DoublePoint>^ iterator = points->First();
+					while(iterator->HasCurrent)
+					{
+						this->pointsArray.push_back(iterator->Current);
+						iterator->MoveNext();
+					}
+				}
+
+				this->BuildIndex();
+				this->Invalidate(true);
+			}
+
+			void D2DClusteredPoints::BuildIndex()
+			{
+				static_assert(sizeof(DoublePoint) == 2 * sizeof(double), "DoublePoint must be laid out as interleaved coordinates");
+
+				this->index.Build(reinterpret_cast<const double*>(this->pointsArray.data()), this->pointsArray.size(), this->clusterCellSize, MinClusterLevel, MaxClusterLevel);
+			}
+
+			void D2DClusteredPoints::InitRenderCore(D2DRenderContext^ context)
+			{
+				D2DShape::InitRenderCore(context);
+
+				if(this->countFormat != nullptr)
+				{
+					return;
+				}
+
+				HRESULT hr = context->WriteFactory->CreateTextFormat(
+					L"Segoe UI",
+					nullptr,
+					DWRITE_FONT_WEIGHT_SEMI_BOLD,
+					DWRITE_FONT_STYLE_NORMAL,
+					DWRITE_FONT_STRETCH_NORMAL,
+					ClusterCountFontSize,
+					L"",
+					&this->countFormat
+					);
+
+				if(SUCCEEDED(hr))
+				{
+					this->countFormat->SetTextAlignment(DWRITE_TEXT_ALIGNMENT_CENTER);
+					this->countFormat->SetParagraphAlignment(DWRITE_PARAGRAPH_ALIGNMENT_CENTER);
+				}
+				else
+				{
+					this->countFormat.Reset();
+				}
+			}
+
+			void D2DClusteredPoints::QueryClusters(Rect rect)
+			{
+				this->clusters.clear();
+
+				double zoomFactor = this->Owner->PixelZoomFactor;
+				if(this->index.IsEmpty() || zoomFactor <= 0)
+				{
+					return;
+				}
+
+				// the rect is inflated by the largest marker, so that clusters centered just outside of it are found too
+				double padding = this->GetPadding();
+				DoublePoint origin = this->Owner->PixelRenderOrigin;
+
+				this->index.Query(
+					this->index.GetLevel(zoomFactor),
+					(rect.X - padding - origin.X) / zoomFactor,
+					(rect.Y - padding - origin.Y) / zoomFactor,
+					(rect.X + rect.Width + padding - origin.X) / zoomFactor,
+					(rect.Y + rect.Height + padding - origin.Y) / zoomFactor,
+					this->clusters);
+			}
+
+			void D2DClusteredPoints::Render(D2DRenderContext^ context, Rect invalidRect)
+			{
+				this->QueryClusters(invalidRect);
+				if(this->clusters.empty())
+				{
+					return;
+				}
+
+				D2DShapeStyle^ style = this->CurrentStyle;
+				ID2D1Brush* fill = style->Fill != nullptr ? style->Fill->NativeBrush.Get() : nullptr;
+				ID2D1Brush* stroke = style->Stroke != nullptr && style->StrokeThickness > 0 ? style->Stroke->NativeBrush.Get() : nullptr;
+				ID2D1Brush* foreground = style->Foreground != nullptr ? style->Foreground->NativeBrush.Get() : stroke;
+				float strokeThickness = style->StrokeThicknessAsFloat;
+
+				double zoomFactor = this->Owner->PixelZoomFactor;
+				DoublePoint origin = this->Owner->PixelRenderOrigin;
+				wchar_t countText[16];
+
+				for(auto cluster = this->clusters.begin(); cluster != this->clusters.end(); ++cluster)
+				{
+					float x = static_cast<float>(cluster->X * zoomFactor + origin.X);
+					float y = static_cast<float>(cluster->Y * zoomFactor + origin.Y);
+
+					// a single point is drawn as the marker of a D2DRectangle would be
+					if(cluster->Count == 1)
+					{
+						D2D1_RECT_F rect = D2D1::RectF(x, y, x + this->markerSize.Width, y + this->markerSize.Height);
+						if(fill != nullptr)
+						{
+							context->DeviceContext->FillRectangle(rect, fill);
+						}
+
+						if(stroke != nullptr)
+						{
+							context->DeviceContext->DrawRectangle(rect, stroke, strokeThickness);
+						}
+
+						continue;
+					}
+
+					float radius = GetClusterRadius(cluster->Count);
+					D2D1_ELLIPSE ellipse = D2D1::Ellipse(D2D1::Point2F(x, y), radius, radius);
+
+					if(fill != nullptr)
+					{
+						context->DeviceContext->FillEllipse(ellipse, fill);
+					}
+
+					if(stroke != nullptr)
+					{
+						context->DeviceContext->DrawEllipse(ellipse, stroke, strokeThickness);
+					}
+
+					if(foreground != nullptr && this->countFormat != nullptr)
+					{
+						int length = swprintf_s(countText, L"%u", cluster->Count);
+						context->DeviceContext->DrawText(
+							countText,
+							static_cast<UINT32>(length),
+							this->countFormat.Get(),
+							D2D1::RectF(x - radius, y - radius, x + radius, y + radius),
+							foreground
+							);
+					}
+				}
+			}
+
+			bool D2DClusteredPoints::HitTest(Point location)
+			{
+				if(this->Owner == nullptr)
+				{
+					return false;
+				}
+
+				this->QueryClusters(Rect(location.X, location.Y, 0, 0));
+
+				double zoomFactor = this->Owner->PixelZoomFactor;
+				DoublePoint origin = this->Owner->PixelRenderOrigin;
+
+				for(auto cluster = this->clusters.begin(); cluster != this->clusters.end(); ++cluster)
+				{
+					float x = static_cast<float>(cluster->X * zoomFactor + origin.X);
+					float y = static_cast<float>(cluster->Y * zoomFactor + origin.Y);
+
+					if(cluster->Count == 1)
+					{
+						if(Rect(x, y, this->markerSize.Width, this->markerSize.Height).Contains(location))
+						{
+							return true;
+						}
+
+						continue;
+					}
+
+					float radius = GetClusterRadius(cluster->Count);
+					float dx = location.X - x;
+					float dy = location.Y - y;
+
+					if(dx * dx + dy * dy <= radius * radius)
+					{
+						return true;
+					}
+				}
+
+				return false;
+			}
+
+			Rect D2DClusteredPoints::GetBoundsCore()
+			{
+				if(this->index.IsEmpty() || this->Owner == nullptr)
+				{
+					return Rect(0, 0, 0, 0);
+				}
+
+				double minX, minY, maxX, maxY;
+				this->index.GetBounds(&minX, &minY, &maxX, &maxY);
+
+				double zoomFactor = this->Owner->PixelZoomFactor;
+				DoublePoint origin = this->Owner->PixelRenderOrigin;
+				float padding = this->GetPadding();
+
+				return Rect(
+					static_cast<float>(minX * zoomFactor + origin.X) - padding,
+					static_cast<float>(minY * zoomFactor + origin.Y) - padding,
+					static_cast<float>((maxX - minX) * zoomFactor) + 2 * padding,
+					static_cast<float>((maxY - minY) * zoomFactor) + 2 * padding);
+			}
+
+			bool D2DClusteredPoints::TryGetCullBounds(D2DCullBounds* bounds)
+			{
+				if(this->index.IsEmpty())
+				{
+					return false;
+				}
+
+				this->index.GetBounds(&bounds->MinX, &bounds->MinY, &bounds->MaxX, &bounds->MaxY);
+				bounds->Padding = this->GetPadding();
+
+				return true;
+			}
+
+			float D2DClusteredPoints::GetPadding()
+			{
+				// markers extend from the point by their size, clusters by their radius, plus the stroke and an anti-aliasing pixel
+				float extent = (std::max)(MaxClusterRadius, (std::max)(this->markerSize.Width, this->markerSize.Height));
+				this->ResolveStyle();
+				return extent + this->CurrentStyle->StrokeThicknessAsFloat / 2 + 1;
+			}
+
+			float D2DClusteredPoints::GetClusterRadius(uint32_t count)
+			{
+				float radius = MinClusterRadius + 2 * static_cast<float>(log(static_cast<double>(count)) / log(2.0));
+				return (std::min)(radius, MaxClusterRadius);
+			}
+		}
+	}
+}
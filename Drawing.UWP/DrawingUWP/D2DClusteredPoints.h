@@ -0,0 +1,78 @@
+#pragma once
+
+#include "D2DShape.h"
+#include "D2DClusterIndex.h"
+#include <collection.h>
+
+namespace Telerik
+{
+	namespace UI
+	{
+		namespace Drawing
+		{
+			// renders a large set of point markers through a cluster index: at each zoom level the points that fall
+			// in the same grid cell are drawn as a single circle with their count, and clusters split as the zoom grows
+			[Windows::Foundation::Metadata::WebHostHidden]
+			public ref class D2DClusteredPoints sealed : D2DShape
+			{
+			public:
+				D2DClusteredPoints(void);
+
+				void SetPoints(IIterable<DoublePoint>^ points);
+
+				// the size of the marker of a single point
+				property Windows::Foundation::Size MarkerSize
+				{
+					Windows::Foundation::Size get() { return this->markerSize; }
+					void set(Windows::Foundation::Size value)
+					{
+						this->markerSize = value;
+						this->Invalidate(true);
+					}
+				}
+
+				// the size, in pixels, of the grid cells points are clustered in
+				property double ClusterCellSize
+				{
+					double get() { return this->clusterCellSize; }
+					void set(double value)
+					{
+						this->clusterCellSize = value;
+						this->BuildIndex();
+						this->Invalidate(true);
+					}
+				}
+
+				property int PointCount
+				{
+					int get() { return static_cast<int>(this->index.GetPointCount()); }
+				}
+
+			internal:
+				virtual void Render(D2DRenderContext^ context, Rect invalidRect) override;
+				virtual Rect GetBoundsCore() override;
+				virtual bool TryGetCullBounds(D2DCullBounds* bounds) override;
+				virtual bool HitTest(Point location) override;
+
+			private protected:
+				virtual void InitRenderCore(D2DRenderContext^ context) override;
+
+			private:
+				void BuildIndex();
+				void QueryClusters(Rect rect);
+				float GetPadding();
+				static float GetClusterRadius(uint32_t count);
+
+				std::vector<DoublePoint> pointsArray;
+				D2DClusterIndex index;
+
+				// the clusters found by the last query, reused between renders
+				std::vector<D2DPointCluster> clusters;
+
+				ComPtr<IDWriteTextFormat> countFormat;
+				Windows::Foundation::Size markerSize;
+				double clusterCellSize;
+			};
+		}
+	}
+}
@@ -0,0 +1,489 @@
+#include "pch.h"
+#include "D2DDensityGrid.h"
+#include "D2DPointKernels.h"
+#include "D2DParallel.h"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <unordered_map>
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__SSE2__) || defined(__x86_64__)
+#include <emmintrin.h>
+#define D2D_DENSITY_GRID_SSE
+#endif
+
+// the points are bucketed so that a bucket holds about this many of them on average
+const double PointsPerBucket = 32;
+const uint32_t MaxBucketsPerSide = 1024;
+
+// the kernel is truncated at its radius, which spans three standard deviations of the Gaussian
+const int MaxKernelRadius = 128;
+const float KernelRadiusInSigmas = 3;
+
+// the blocks of points computed in full to find the highest density
+const size_t MaxDensityBlocks = 8;
+
+namespace Telerik
+{
+	namespace UI
+	{
+		namespace Drawing
+		{
+			// output[x] = sum of input[x + k] * kernel[k] over the kernel
+			static void ConvolveRow(const float* input, float* output, uint32_t count, const float* kernel, int kernelSize)
+			{
+				uint32_t x = 0;
+
+#ifdef D2D_DENSITY_GRID_SSE
+				for(; x + 4 <= count; x += 4)
+				{
+					__m128 sum = _mm_setzero_ps();
+					for(int k = 0; k < kernelSize; k++)
+					{
+						sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(input + x + k), _mm_set1_ps(kernel[k])));
+					}
+
+					_mm_storeu_ps(output + x, sum);
+				}
+#endif
+
+				for(; x < count; x++)
+				{
+					float sum = 0;
+					for(int k = 0; k < kernelSize; k++)
+					{
+						sum += input[x + k] * kernel[k];
+					}
+
+					output[x] = sum;
+				}
+			}
+
+			// output[x] += input[x] * weight
+			static void AddScaledRow(const float* input, float weight, float* output, uint32_t count)
+			{
+				uint32_t x = 0;
+
+#ifdef D2D_DENSITY_GRID_SSE
+				__m128 scale = _mm_set1_ps(weight);
+				for(; x + 4 <= count; x += 4)
+				{
+					_mm_storeu_ps(output + x, _mm_add_ps(_mm_loadu_ps(output + x), _mm_mul_ps(_mm_loadu_ps(input + x), scale)));
+				}
+#endif
+
+				for(; x < count; x++)
+				{
+					output[x] += input[x] * weight;
+				}
+			}
+
+			static float GetMaxValue(const float* values, size_t count)
+			{
+				size_t i = 0;
+				float maxValue = 0;
+
+#ifdef D2D_DENSITY_GRID_SSE
+				__m128 max = _mm_setzero_ps();
+				for(; i + 4 <= count; i += 4)
+				{
+					max = _mm_max_ps(max, _mm_loadu_ps(values + i));
+				}
+
+				float lanes[4];
+				_mm_storeu_ps(lanes, max);
+				maxValue = (std::max)((std::max)(lanes[0], lanes[1]), (std::max)(lanes[2], lanes[3]));
+#endif
+
+				for(; i < count; i++)
+				{
+					maxValue = (std::max)(maxValue, values[i]);
+				}
+
+				return maxValue;
+			}
+
+			D2DDensityGrid::D2DDensityGrid()
+			{
+				this->Clear();
+			}
+
+			void D2DDensityGrid::Clear()
+			{
+				this->pointCount = 0;
+				this->pointsX.clear();
+				this->pointsY.clear();
+				this->pointWeights.clear();
+				this->bucketOffsets.clear();
+
+				this->bucketColumns = 0;
+				this->bucketRows = 0;
+				this->bucketWidth = 1;
+				this->bucketHeight = 1;
+				this->minX = 0;
+				this->minY = 0;
+				this->maxX = 0;
+				this->maxY = 0;
+			}
+
+			void D2DDensityGrid::SetPoints(const double* coordinates, const float* weights, size_t pointCount)
+			{
+				this->Clear();
+
+				D2DPointBounds bounds;
+				if(!D2DPointKernels::ComputeBounds(coordinates, pointCount, &bounds))
+				{
+					return;
+				}
+
+				this->pointCount = pointCount;
+				this->minX = bounds.MinX;
+				this->minY = bounds.MinY;
+				this->maxX = bounds.MaxX;
+				this->maxY = bounds.MaxY;
+
+				uint32_t side = static_cast<uint32_t>(sqrt(pointCount / PointsPerBucket));
+				side = (std::min)((std::max)(side, 1u), MaxBucketsPerSide);
+
+				this->bucketColumns = side;
+				this->bucketRows = side;
+				this->bucketWidth = (std::max)((this->maxX - this->minX) / side, 1e-12);
+				this->bucketHeight = (std::max)((this->maxY - this->minY) / side, 1e-12);
+
+				// a counting sort of the points by bucket
+				std::vector<uint32_t> pointBuckets(pointCount);
+				this->bucketOffsets.assign(static_cast<size_t>(side) * side + 1, 0);
+
+				for(size_t i = 0; i < pointCount; i++)
+				{
+					uint32_t column = (std::min)(static_cast<uint32_t>((coordinates[2 * i] - this->minX) / this->bucketWidth), side - 1);
+					uint32_t row = (std::min)(static_cast<uint32_t>((coordinates[2 * i + 1] - this->minY) / this->bucketHeight), side - 1);
+
+					pointBuckets[i] = row * side + column;
+					this->bucketOffsets[pointBuckets[i] + 1]++;
+				}
+
+				for(size_t bucket = 1; bucket < this->bucketOffsets.size(); bucket++)
+				{
+					this->bucketOffsets[bucket] += this->bucketOffsets[bucket - 1];
+				}
+
+				this->pointsX.resize(pointCount);
+				this->pointsY.resize(pointCount);
+				this->pointWeights.resize(pointCount);
+
+				std::vector<uint32_t> cursors(this->bucketOffsets.begin(), this->bucketOffsets.end() - 1);
+				for(size_t i = 0; i < pointCount; i++)
+				{
+					uint32_t target = cursors[pointBuckets[i]]++;
+
+					this->pointsX[target] = coordinates[2 * i];
+					this->pointsY[target] = coordinates[2 * i + 1];
+					this->pointWeights[target] = weights != nullptr ? weights[i] : 1.0f;
+				}
+			}
+
+			void D2DDensityGrid::GetBounds(double* minX, double* minY, double* maxX, double* maxY) const
+			{
+				*minX = this->minX;
+				*minY = this->minY;
+				*maxX = this->maxX;
+				*maxY = this->maxY;
+			}
+
+			void D2DDensityGrid::AccumulateTiles(D2DDensityTile* tiles, size_t tileCount, uint32_t tileSize, double zoomFactor, float radius) const
+			{
+				if(tileCount == 0)
+				{
+					return;
+				}
+
+				int kernelRadius = GetKernelRadius(radius);
+
+				// the kernel is not normalized, so that a lone point of weight one peaks at one
+				std::vector<float> kernel(2 * kernelRadius + 1);
+				double sigma = kernelRadius / KernelRadiusInSigmas;
+				for(int k = -kernelRadius; k <= kernelRadius; k++)
+				{
+					kernel[k + kernelRadius] = static_cast<float>(exp(-(k * k) / (2 * sigma * sigma)));
+				}
+
+				// the tiles do not share any state, so each worker only needs its own scratch buffers
+				std::vector<Scratch> scratch(D2DParallel::GetWorkerCount(tileCount));
+				D2DParallel::For(tileCount, [&](size_t i, size_t worker)
+				{
+					this->AccumulateTile(&tiles[i], tileSize, zoomFactor, kernelRadius, kernel.data(), &scratch[worker]);
+				});
+			}
+
+			float D2DDensityGrid::GetMaxDensity(double zoomFactor, float radius) const
+			{
+				if(this->pointCount == 0 || zoomFactor <= 0)
+				{
+					return 0;
+				}
+
+				// a cell is as wide as the kernel, so the points a pixel reaches always lie in a block of 2 x 2 cells
+				int kernelRadius = GetKernelRadius(radius);
+				uint32_t cellSize = 2 * kernelRadius + 1;
+
+				std::unordered_map<uint64_t, float> cells;
+				cells.reserve((std::min)(this->pointCount, static_cast<size_t>(1) << 20));
+				for(size_t i = 0; i < this->pointCount; i++)
+				{
+					int32_t column = static_cast<int32_t>(floor(this->pointsX[i] * zoomFactor / cellSize));
+					int32_t row = static_cast<int32_t>(floor(this->pointsY[i] * zoomFactor / cellSize));
+					cells[(static_cast<uint64_t>(static_cast<uint32_t>(row)) << 32) | static_cast<uint32_t>(column)] += this->pointWeights[i];
+				}
+
+				// each of the densest cells starts a block at least as heavy as itself, so the densest blocks all have a
+				// cell of a quarter of that weight at least; the blocks of lighter cells only are never computed
+				float threshold = 0;
+				if(cells.size() > MaxDensityBlocks)
+				{
+					std::vector<float> cellWeights;
+					cellWeights.reserve(cells.size());
+					for(auto cell = cells.begin(); cell != cells.end(); ++cell)
+					{
+						cellWeights.push_back(cell->second);
+					}
+
+					std::nth_element(cellWeights.begin(), cellWeights.begin() + (MaxDensityBlocks - 1), cellWeights.end(), std::greater<float>());
+					threshold = cellWeights[MaxDensityBlocks - 1] / 4;
+				}
+
+				// the blocks are keyed by their top left cell
+				std::vector<uint64_t> blockKeys;
+				for(auto cell = cells.begin(); cell != cells.end(); ++cell)
+				{
+					if(cell->second < threshold)
+					{
+						continue;
+					}
+
+					int32_t column = static_cast<int32_t>(cell->first & 0xFFFFFFFF);
+					int32_t row = static_cast<int32_t>(cell->first >> 32);
+
+					for(int32_t y = row - 1; y <= row; y++)
+					{
+						for(int32_t x = column - 1; x <= column; x++)
+						{
+							blockKeys.push_back((static_cast<uint64_t>(static_cast<uint32_t>(y)) << 32) | static_cast<uint32_t>(x));
+						}
+					}
+				}
+
+				std::sort(blockKeys.begin(), blockKeys.end());
+				blockKeys.erase(std::unique(blockKeys.begin(), blockKeys.end()), blockKeys.end());
+
+				// the weight of a block bounds the density of the pixels whose kernel it covers
+				std::vector<std::pair<float, uint64_t>> densest;
+				densest.reserve(blockKeys.size());
+				for(auto key = blockKeys.begin(); key != blockKeys.end(); ++key)
+				{
+					int32_t column = static_cast<int32_t>(*key & 0xFFFFFFFF);
+					int32_t row = static_cast<int32_t>(*key >> 32);
+
+					float weight = 0;
+					for(int32_t y = row; y <= row + 1; y++)
+					{
+						for(int32_t x = column; x <= column + 1; x++)
+						{
+							auto cell = cells.find((static_cast<uint64_t>(static_cast<uint32_t>(y)) << 32) | static_cast<uint32_t>(x));
+							weight += cell != cells.end() ? cell->second : 0;
+						}
+					}
+
+					densest.push_back(std::make_pair(weight, *key));
+				}
+
+				// the key breaks the ties, so that the same blocks are picked whatever the order of the hash map
+				size_t blockCount = (std::min)(densest.size(), MaxDensityBlocks);
+				std::partial_sort(densest.begin(), densest.begin() + blockCount, densest.end(), std::greater<std::pair<float, uint64_t>>());
+
+				std::vector<uint64_t> tileKeys;
+				for(size_t i = 0; i < blockCount; i++)
+				{
+					int32_t column = static_cast<int32_t>(densest[i].second & 0xFFFFFFFF);
+					int32_t row = static_cast<int32_t>(densest[i].second >> 32);
+
+					for(int32_t y = row; y <= row + 1; y++)
+					{
+						for(int32_t x = column; x <= column + 1; x++)
+						{
+							tileKeys.push_back((static_cast<uint64_t>(static_cast<uint32_t>(y)) << 32) | static_cast<uint32_t>(x));
+						}
+					}
+				}
+
+				std::sort(tileKeys.begin(), tileKeys.end());
+				tileKeys.erase(std::unique(tileKeys.begin(), tileKeys.end()), tileKeys.end());
+
+				// the cells of the blocks are computed as tiles of the cell size
+				std::vector<float> values(tileKeys.size() * cellSize * cellSize);
+				std::vector<D2DDensityTile> tiles(tileKeys.size());
+				for(size_t i = 0; i < tileKeys.size(); i++)
+				{
+					D2DDensityTile tile = { static_cast<int32_t>(tileKeys[i] & 0xFFFFFFFF), static_cast<int32_t>(tileKeys[i] >> 32), &values[i * cellSize * cellSize], 0 };
+					tiles[i] = tile;
+				}
+
+				this->AccumulateTiles(tiles.data(), tiles.size(), cellSize, zoomFactor, radius);
+
+				float maxValue = 0;
+				for(auto tile = tiles.begin(); tile != tiles.end(); ++tile)
+				{
+					maxValue = (std::max)(maxValue, tile->MaxValue);
+				}
+
+				return maxValue;
+			}
+
+			int D2DDensityGrid::GetKernelRadius(float radius)
+			{
+				return (std::min)((std::max)(static_cast<int>(ceilf(radius)), 1), MaxKernelRadius);
+			}
+
+			void D2DDensityGrid::AccumulateTile(D2DDensityTile* tile, uint32_t tileSize, double zoomFactor, int kernelRadius, const float* kernel, Scratch* scratch) const
+			{
+				// the points are binned over the tile extended by the kernel radius, so that points just outside contribute too
+				uint32_t extent = tileSize + 2 * kernelRadius;
+				int kernelSize = 2 * kernelRadius + 1;
+
+				scratch->Bins.assign(static_cast<size_t>(extent) * extent, 0.0f);
+				scratch->Rows.resize(static_cast<size_t>(extent) * tileSize);
+				scratch->IsRowUsed.assign(extent, 0);
+
+				this->BinPoints(
+					static_cast<double>(tile->X) * tileSize - kernelRadius,
+					static_cast<double>(tile->Y) * tileSize - kernelRadius,
+					zoomFactor,
+					extent,
+					scratch);
+
+				// horizontal pass over the rows that have points
+				for(uint32_t y = 0; y < extent; y++)
+				{
+					if(scratch->IsRowUsed[y])
+					{
+						ConvolveRow(&scratch->Bins[static_cast<size_t>(y) * extent], &scratch->Rows[static_cast<size_t>(y) * tileSize], tileSize, kernel, kernelSize);
+					}
+				}
+
+				// vertical pass, skipping the rows the horizontal pass left empty
+				std::fill(tile->Values, tile->Values + static_cast<size_t>(tileSize) * tileSize, 0.0f);
+				for(uint32_t y = 0; y < tileSize; y++)
+				{
+					float* output = tile->Values + static_cast<size_t>(y) * tileSize;
+					for(int k = 0; k < kernelSize; k++)
+					{
+						if(scratch->IsRowUsed[y + k])
+						{
+							AddScaledRow(&scratch->Rows[static_cast<size_t>(y + k) * tileSize], kernel[k], output, tileSize);
+						}
+					}
+				}
+
+				tile->MaxValue = GetMaxValue(tile->Values, static_cast<size_t>(tileSize) * tileSize);
+			}
+
+			void D2DDensityGrid::BinPoints(double originX, double originY, double zoomFactor, uint32_t extent, Scratch* scratch) const
+			{
+				if(this->pointCount == 0 || zoomFactor <= 0)
+				{
+					return;
+				}
+
+				double tileMinX = originX / zoomFactor;
+				double tileMinY = originY / zoomFactor;
+				double tileMaxX = (originX + extent) / zoomFactor;
+				double tileMaxY = (originY + extent) / zoomFactor;
+
+				if(tileMaxX < this->minX || tileMinX > this->maxX || tileMaxY < this->minY || tileMinY > this->maxY)
+				{
+					return;
+				}
+
+				uint32_t firstColumn = static_cast<uint32_t>((std::max)(tileMinX - this->minX, 0.0) / this->bucketWidth);
+				uint32_t lastColumn = static_cast<uint32_t>((std::min)(tileMaxX - this->minX, this->maxX - this->minX) / this->bucketWidth);
+				uint32_t firstRow = static_cast<uint32_t>((std::max)(tileMinY - this->minY, 0.0) / this->bucketHeight);
+				uint32_t lastRow = static_cast<uint32_t>((std::min)(tileMaxY - this->minY, this->maxY - this->minY) / this->bucketHeight);
+
+				lastColumn = (std::min)(lastColumn, this->bucketColumns - 1);
+				lastRow = (std::min)(lastRow, this->bucketRows - 1);
+
+				float* bins = scratch->Bins.data();
+				uint8_t* isRowUsed = scratch->IsRowUsed.data();
+
+				for(uint32_t row = firstRow; row <= lastRow; row++)
+				{
+					// the buckets of a row are contiguous, so their points are visited in a single run
+					uint32_t first = this->bucketOffsets[row * this->bucketColumns + firstColumn];
+					uint32_t last = this->bucketOffsets[row * this->bucketColumns + lastColumn + 1];
+
+					for(uint32_t i = first; i < last; i++)
+					{
+						double x = this->pointsX[i] * zoomFactor - originX;
+						double y = this->pointsY[i] * zoomFactor - originY;
+						if(x < 0 || y < 0 || x >= extent || y >= extent)
+						{
+							continue;
+						}
+
+						uint32_t binX = static_cast<uint32_t>(x);
+						uint32_t binY = static_cast<uint32_t>(y);
+
+						bins[static_cast<size_t>(binY) * extent + binX] += this->pointWeights[i];
+						isRowUsed[binY] = 1;
+					}
+				}
+			}
+
+			void D2DDensityGrid::BuildColorMap(const uint32_t* stops, size_t stopCount, uint32_t* colorMap)
+			{
+				for(int i = 0; i < 256; i++)
+				{
+					if(stopCount == 0)
+					{
+						colorMap[i] = 0;
+						continue;
+					}
+
+					// the position of the entry between two stops and the weight of the second one
+					double position = stopCount > 1 ? i / 255.0 * (stopCount - 1) : 0;
+					size_t first = (std::min)(static_cast<size_t>(position), stopCount - 1);
+					size_t second = (std::min)(first + 1, stopCount - 1);
+					double weight = position - first;
+
+					double channels[4];
+					for(int channel = 0; channel < 4; channel++)
+					{
+						int shift = 24 - 8 * channel;
+						double from = (stops[first] >> shift) & 0xFF;
+						double to = (stops[second] >> shift) & 0xFF;
+						channels[channel] = from + (to - from) * weight;
+					}
+
+					// the bitmap is premultiplied, so the color channels are scaled by the alpha
+					double alpha = channels[0] / 255;
+					colorMap[i] =
+						(static_cast<uint32_t>(channels[0] + 0.5) << 24) |
+						(static_cast<uint32_t>(channels[1] * alpha + 0.5) << 16) |
+						(static_cast<uint32_t>(channels[2] * alpha + 0.5) << 8) |
+						static_cast<uint32_t>(channels[3] * alpha + 0.5);
+				}
+			}
+
+			void D2DDensityGrid::Colorize(const float* values, size_t count, float maxValue, const uint32_t* colorMap, uint32_t* pixels)
+			{
+				float scale = maxValue > 0 ? 255 / maxValue : 0;
+
+				for(size_t i = 0; i < count; i++)
+				{
+					float value = values[i];
+					pixels[i] = value > 0 ? colorMap[static_cast<uint32_t>((std::min)(value * scale, 255.0f))] : 0;
+				}
+			}
+		}
+	}
+}
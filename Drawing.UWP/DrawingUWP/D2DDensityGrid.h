@@ -0,0 +1,88 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+namespace Telerik
+{
+	namespace UI
+	{
+		namespace Drawing
+		{
+			// a square tile of density values; the tile covers the pixels [X * size, (X + 1) * size) at the zoom it is computed for
+			struct D2DDensityTile
+			{
+				int32_t X;
+				int32_t Y;
+				float* Values;
+				float MaxValue;
+			};
+
+			// accumulates weighted points into tiles of float density values with a truncated Gaussian kernel and maps the
+			// values to colors. The points are binned to the pixels of a tile first and the kernel is applied as two
+			// separable passes, so the cost of a tile is bounded by its area rather than by the number of points in it.
+			// coordinates are in the space of zoom factor 1, the kernel radius is in pixels
+			class D2DDensityGrid
+			{
+			public:
+				D2DDensityGrid();
+
+				// the weights may be null, in which case every point weighs one
+				void SetPoints(const double* coordinates, const float* weights, size_t pointCount);
+				void Clear();
+
+				bool IsEmpty() const { return this->pointCount == 0; }
+				size_t GetPointCount() const { return this->pointCount; }
+
+				// the bounds of all points, valid if the grid is not empty
+				void GetBounds(double* minX, double* minY, double* maxX, double* maxY) const;
+
+				// fills the values of the tiles, sized tileSize * tileSize, spreading the tiles over the hardware threads
+				void AccumulateTiles(D2DDensityTile* tiles, size_t tileCount, uint32_t tileSize, double zoomFactor, float radius) const;
+
+				// the highest density of all points at the zoom factor, independent of the tiles computed so far. The density
+				// around a pixel is bounded by the weight of the points within the kernel radius, so only the densest blocks of
+				// the points are computed; the result is exact unless more than a few blocks are about as dense as the densest one
+				float GetMaxDensity(double zoomFactor, float radius) const;
+
+				// builds a map of 256 premultiplied BGRA colors from evenly spaced, straight ARGB gradient stops
+				static void BuildColorMap(const uint32_t* stops, size_t stopCount, uint32_t* colorMap);
+
+				// maps the values to pixels of the color map, saturating at the max value; zero values stay transparent
+				static void Colorize(const float* values, size_t count, float maxValue, const uint32_t* colorMap, uint32_t* pixels);
+
+			private:
+				// the buffers of a worker, reused between the tiles it computes
+				struct Scratch
+				{
+					std::vector<float> Bins;
+					std::vector<float> Rows;
+					std::vector<uint8_t> IsRowUsed;
+				};
+
+				static int GetKernelRadius(float radius);
+
+				void AccumulateTile(D2DDensityTile* tile, uint32_t tileSize, double zoomFactor, int kernelRadius, const float* kernel, Scratch* scratch) const;
+				void BinPoints(double minX, double minY, double zoomFactor, uint32_t extent, Scratch* scratch) const;
+
+				size_t pointCount;
+
+				// the points sorted by the bucket of a coarse uniform grid, so that a tile only visits the buckets it overlaps
+				std::vector<double> pointsX;
+				std::vector<double> pointsY;
+				std::vector<float> pointWeights;
+				std::vector<uint32_t> bucketOffsets;
+
+				uint32_t bucketColumns;
+				uint32_t bucketRows;
+				double bucketWidth;
+				double bucketHeight;
+				double minX;
+				double minY;
+				double maxX;
+				double maxY;
+			};
+		}
+	}
+}
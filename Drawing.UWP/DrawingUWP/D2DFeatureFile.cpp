@@ -0,0 +1,175 @@
+#include "pch.h"
+#include "D2DFeatureFile.h"
+#include "D2DMultiPolygon.h"
+#include "D2DRectangle.h"
+
+namespace Telerik
+{
+	namespace UI
+	{
+		namespace Drawing
+		{
+			D2DFeatureFile::D2DFeatureFile(void)
+			{
+			}
+
+			D2DFeatureFile^ D2DFeatureFile::Open(Platform::String^ path)
+			{
+				if(path == nullptr)
+				{
+					return nullptr;
+				}
+
+				// the file stays mapped while the feature file is alive
+				D2DFeatureFile^ featureFile = ref new D2DFeatureFile();
+				if(!featureFile->reader.Open(path->Data()))
+				{
+					return nullptr;
+				}
+
+				return featureFile;
+			}
+
+			bool D2DFeatureFile::WriteShapefile(D2DShapefile^ shapefile, Platform::String^ path)
+			{
+				if(shapefile == nullptr)
+				{
+					return false;
+				}
+
+				const D2DShapefileGeometry& geometry = shapefile->GetGeometry();
+
+				std::vector<D2DFeatureKind> kinds(geometry.RecordShapeTypes.size());
+				for(size_t record = 0; record < kinds.size(); record++)
+				{
+					kinds[record] = GetShapefileKind(geometry.RecordShapeTypes[record]);
+				}
+
+				return Write(kinds.data(), kinds.size(), geometry.PartOffsets, geometry.PointOffsets, geometry.Coordinates, path);
+			}
+
+			D2DFeatureKind D2DFeatureFile::GetShapefileKind(int32_t shapeType)
+			{
+				switch(shapeType)
+				{
+					case 1:
+					case 11:
+					case 21:
+						return D2DFeatureKind::Point;
+
+					case 3:
+					case 13:
+					case 23:
+						return D2DFeatureKind::Line;
+
+					case 5:
+					case 15:
+					case 25:
+						return D2DFeatureKind::Polygon;
+
+					default:
+						return D2DFeatureKind::None;
+				}
+			}
+
+			bool D2DFeatureFile::WriteGeoJson(D2DGeoJson^ geoJson, Platform::String^ path)
+			{
+				if(geoJson == nullptr)
+				{
+					return false;
+				}
+
+				const D2DGeoJsonGeometry& geometry = geoJson->GetData().Geometry;
+
+				std::vector<D2DFeatureKind> kinds(geometry.FeatureTypes.size());
+				for(size_t feature = 0; feature < kinds.size(); feature++)
+				{
+					switch(geometry.FeatureTypes[feature])
+					{
+						case D2DGeoJsonGeometryType::Point:
+							kinds[feature] = D2DFeatureKind::Point;
+							break;
+
+						case D2DGeoJsonGeometryType::LineString:
+						case D2DGeoJsonGeometryType::MultiLineString:
+							kinds[feature] = D2DFeatureKind::Line;
+							break;
+
+						case D2DGeoJsonGeometryType::Polygon:
+						case D2DGeoJsonGeometryType::MultiPolygon:
+							kinds[feature] = D2DFeatureKind::Polygon;
+							break;
+
+						default:
+							kinds[feature] = D2DFeatureKind::None;
+							break;
+					}
+				}
+
+				return Write(kinds.data(), kinds.size(), geometry.PartOffsets, geometry.PointOffsets, geometry.Coordinates, path);
+			}
+
+			bool D2DFeatureFile::Write(const D2DFeatureKind* kinds, size_t count, const std::vector<uint32_t>& partOffsets, const std::vector<uint32_t>& pointOffsets, const std::vector<double>& coordinates, Platform::String^ path)
+			{
+				if(path == nullptr)
+				{
+					return false;
+				}
+
+				D2DFeatureSource source = { count, kinds, partOffsets.data(), pointOffsets.data(), coordinates.data() };
+				return D2DFeatureStreamWriter::Write(source, path->Data());
+			}
+
+			int D2DFeatureFile::GetSourceIndex(int feature)
+			{
+				D2DFeatureRecord record;
+				if(feature < 0 || !this->reader.GetFeature(static_cast<uint32_t>(feature), &record))
+				{
+					throw ref new Platform::OutOfBoundsException();
+				}
+
+				return static_cast<int>(record.SourceIndex);
+			}
+
+			D2DShape^ D2DFeatureFile::CreateShape(int feature)
+			{
+				if(feature < 0 || feature >= this->FeatureCount)
+				{
+					throw ref new Platform::OutOfBoundsException();
+				}
+
+				D2DFeatureRecord record;
+				if(!this->reader.GetFeature(static_cast<uint32_t>(feature), &record) || record.PartCount == 0 || record.PointCount == 0)
+				{
+					return nullptr;
+				}
+
+				switch(record.Kind)
+				{
+					case D2DFeatureKind::Point:
+					{
+						DoublePoint location;
+						location.X = record.Coordinates[0];
+						location.Y = record.Coordinates[1];
+
+						D2DRectangle^ marker = ref new D2DRectangle();
+						marker->Location = location;
+						return marker;
+					}
+
+					case D2DFeatureKind::Line:
+					case D2DFeatureKind::Polygon:
+					{
+						D2DMultiPolygon^ shape = ref new D2DMultiPolygon();
+						shape->IsClosed = record.Kind == D2DFeatureKind::Polygon;
+						shape->SetRings(record.Coordinates, record.PointOffsets, record.PartCount);
+						return shape;
+					}
+
+					default:
+						return nullptr;
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "D2DShape.h"
+#include "D2DShapefile.h"
+#include "D2DGeoJson.h"
+#include "D2DFeatureStream.h"
+
+namespace Telerik
+{
+	namespace UI
+	{
+		namespace Drawing
+		{
+			// a spatially indexed feature file opened from a memory-mapped view; a layer set with D2DCanvas::SetFeaturesForLayer
+			// creates shapes only for the features around the viewport and releases them once the viewport moves away
+			public ref class D2DFeatureFile sealed
+			{
+			public:
+				// returns null if the file is missing or is not a feature file; only the header is read
+				static D2DFeatureFile^ Open(Platform::String^ path);
+
+				// writes the points, lines and polygons of a decoded source; returns false if the file cannot be written
+				static bool WriteShapefile(D2DShapefile^ shapefile, Platform::String^ path);
+				static bool WriteGeoJson(D2DGeoJson^ geoJson, Platform::String^ path);
+
+				property int FeatureCount
+				{
+					int get() { return static_cast<int>(this->reader.GetFeatureCount()); }
+				}
+
+				// the record or the feature of the source the feature was written from
+				int GetSourceIndex(int feature);
+
+				// a D2DRectangle for a point and a D2DMultiPolygon for a line or a polygon; null if the record is damaged
+				D2DShape^ CreateShape(int feature);
+
+			internal:
+				const D2DFeatureStreamReader& GetReader() { return this->reader; }
+
+				// the kind of feature an ESRI shape type is stored as; None for null shapes and multipoints
+				static D2DFeatureKind GetShapefileKind(int32_t shapeType);
+
+			private:
+				D2DFeatureFile(void);
+
+				static bool Write(const D2DFeatureKind* kinds, size_t count, const std::vector<uint32_t>& partOffsets, const std::vector<uint32_t>& pointOffsets, const std::vector<double>& coordinates, Platform::String^ path);
+
+				D2DFeatureStreamReader reader;
+			};
+		}
+	}
+}
@@ -0,0 +1,356 @@
+#include "pch.h"
+#include "D2DFeatureStream.h"
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+// the number of children of each node of the index; larger nodes make a flatter tree with more boxes tested per node
+const uint16_t FeatureIndexNodeSize = 16;
+
+const char FeatureFileMagic[8] = { 'D', '2', 'D', 'F', 'E', 'A', 'T', 0 };
+const uint32_t FeatureFileVersion = 1;
+
+// the fixed part of a record: the kind, the source index, the part count and the point count
+const size_t FeatureRecordHeaderSize = 16;
+
+// the records are written through a buffer of this many bytes
+const size_t FeatureWriteBufferSize = 1 << 20;
+
+namespace Telerik
+{
+	namespace UI
+	{
+		namespace Drawing
+		{
+			// the header at the start of a feature file; the index and the records follow at the offsets it holds
+			struct D2DFeatureFileHeader
+			{
+				char Magic[8];
+				uint32_t Version;
+				uint16_t NodeSize;
+				uint16_t Reserved;
+				uint64_t FeatureCount;
+				double MinX;
+				double MinY;
+				double MaxX;
+				double MaxY;
+				uint64_t NodeCount;
+				uint64_t IndexOffset;
+				uint64_t RecordsOffset;
+				uint64_t RecordsSize;
+				uint64_t Padding[5];
+			};
+
+			static_assert(sizeof(D2DFeatureFileHeader) == 128, "The feature file header must keep its size.");
+			static_assert(sizeof(D2DRTreeNode) == 40, "The index nodes must be stored without padding.");
+
+			static size_t AlignRecordSize(size_t size)
+			{
+				return (size + 7) & ~static_cast<size_t>(7);
+			}
+
+			static size_t GetPointOffsetsSize(uint32_t partCount)
+			{
+				return AlignRecordSize((static_cast<size_t>(partCount) + 1) * sizeof(uint32_t));
+			}
+
+			D2DFeatureStreamReader::D2DFeatureStreamReader()
+			{
+				this->Close();
+			}
+
+			bool D2DFeatureStreamReader::Open(const D2DPathChar* path)
+			{
+				this->Close();
+
+				if(!this->file.Open(path) || this->file.GetSize() < sizeof(D2DFeatureFileHeader))
+				{
+					this->Close();
+					return false;
+				}
+
+				D2DFeatureFileHeader header;
+				memcpy(&header, this->file.GetData(), sizeof(header));
+
+				size_t size = this->file.GetSize();
+				bool isValid = memcmp(header.Magic, FeatureFileMagic, sizeof(FeatureFileMagic)) == 0 &&
+					header.Version == FeatureFileVersion &&
+					header.NodeSize >= 2 &&
+					header.FeatureCount <= (std::numeric_limits<uint32_t>::max)() &&
+					header.NodeCount == D2DPackedRTree::GetNodeCount(static_cast<size_t>(header.FeatureCount), header.NodeSize) &&
+					header.IndexOffset % 8 == 0 && header.IndexOffset <= size &&
+					header.NodeCount <= (size - header.IndexOffset) / sizeof(D2DRTreeNode) &&
+					header.RecordsOffset % 8 == 0 && header.RecordsOffset <= size &&
+					header.RecordsSize <= size - header.RecordsOffset;
+
+				if(!isValid)
+				{
+					this->Close();
+					return false;
+				}
+
+				this->nodes = reinterpret_cast<const D2DRTreeNode*>(this->file.GetData() + header.IndexOffset);
+				this->records = this->file.GetData() + header.RecordsOffset;
+				this->nodeCount = static_cast<size_t>(header.NodeCount);
+				this->featureCount = static_cast<size_t>(header.FeatureCount);
+				this->recordsSize = static_cast<size_t>(header.RecordsSize);
+				this->nodeSize = header.NodeSize;
+				this->bounds[0] = header.MinX;
+				this->bounds[1] = header.MinY;
+				this->bounds[2] = header.MaxX;
+				this->bounds[3] = header.MaxY;
+
+				return true;
+			}
+
+			void D2DFeatureStreamReader::Close()
+			{
+				this->file.Close();
+				this->nodes = nullptr;
+				this->records = nullptr;
+				this->nodeCount = 0;
+				this->featureCount = 0;
+				this->recordsSize = 0;
+				this->nodeSize = FeatureIndexNodeSize;
+				this->bounds[0] = this->bounds[1] = this->bounds[2] = this->bounds[3] = 0;
+			}
+
+			void D2DFeatureStreamReader::GetBounds(double* minX, double* minY, double* maxX, double* maxY) const
+			{
+				*minX = this->bounds[0];
+				*minY = this->bounds[1];
+				*maxX = this->bounds[2];
+				*maxY = this->bounds[3];
+			}
+
+			void D2DFeatureStreamReader::Query(double minX, double minY, double maxX, double maxY, std::vector<uint32_t>* features) const
+			{
+				D2DPackedRTree::Search(this->nodes, this->nodeCount, this->featureCount, this->nodeSize, minX, minY, maxX, maxY, features);
+			}
+
+			bool D2DFeatureStreamReader::GetFeature(uint32_t feature, D2DFeatureRecord* record) const
+			{
+				if(feature >= this->featureCount)
+				{
+					return false;
+				}
+
+				uint64_t offset = this->nodes[this->nodeCount - this->featureCount + feature].Offset;
+				if(offset % 8 != 0 || offset > this->recordsSize || this->recordsSize - offset < FeatureRecordHeaderSize)
+				{
+					return false;
+				}
+
+				const uint8_t* data = this->records + offset;
+				size_t available = this->recordsSize - static_cast<size_t>(offset) - FeatureRecordHeaderSize;
+
+				record->Kind = static_cast<D2DFeatureKind>(data[0]);
+				memcpy(&record->SourceIndex, data + 4, sizeof(uint32_t));
+				memcpy(&record->PartCount, data + 8, sizeof(uint32_t));
+				memcpy(&record->PointCount, data + 12, sizeof(uint32_t));
+
+				size_t offsetsSize = GetPointOffsetsSize(record->PartCount);
+				if(offsetsSize > available || static_cast<uint64_t>(record->PointCount) * 2 * sizeof(double) > available - offsetsSize)
+				{
+					return false;
+				}
+
+				record->PointOffsets = reinterpret_cast<const uint32_t*>(data + FeatureRecordHeaderSize);
+				record->Coordinates = reinterpret_cast<const double*>(data + FeatureRecordHeaderSize + offsetsSize);
+
+				// the parts must not reach outside of the coordinates of the record
+				if(record->PointOffsets[0] != 0 || record->PointOffsets[record->PartCount] != record->PointCount)
+				{
+					return false;
+				}
+
+				for(uint32_t part = 0; part < record->PartCount; part++)
+				{
+					if(record->PointOffsets[part] > record->PointOffsets[part + 1])
+					{
+						return false;
+					}
+				}
+
+				return true;
+			}
+
+			D2DFeatureFileOutput::D2DFeatureFileOutput(const D2DPathChar* path)
+			{
+#ifdef _WIN32
+				if(_wfopen_s(&this->file, path, L"wb") != 0)
+				{
+					this->file = nullptr;
+				}
+#else
+				this->file = fopen(path, "wb");
+#endif
+				this->isFailed = this->file == nullptr;
+				this->buffer.reserve(FeatureWriteBufferSize);
+			}
+
+			D2DFeatureFileOutput::~D2DFeatureFileOutput()
+			{
+				this->Close();
+			}
+
+			void D2DFeatureFileOutput::Write(const void* data, size_t size)
+			{
+				if(this->buffer.size() + size > FeatureWriteBufferSize)
+				{
+					this->Flush();
+				}
+
+				if(size > FeatureWriteBufferSize)
+				{
+					this->isFailed |= this->file == nullptr || fwrite(data, 1, size, this->file) != size;
+					return;
+				}
+
+				const uint8_t* bytes = static_cast<const uint8_t*>(data);
+				this->buffer.insert(this->buffer.end(), bytes, bytes + size);
+			}
+
+			void D2DFeatureFileOutput::WritePadding(size_t size)
+			{
+				uint64_t zero = 0;
+				this->Write(&zero, AlignRecordSize(size) - size);
+			}
+
+			bool D2DFeatureFileOutput::Close()
+			{
+				if(this->file != nullptr)
+				{
+					this->Flush();
+					this->isFailed |= fclose(this->file) != 0;
+					this->file = nullptr;
+				}
+
+				return !this->isFailed;
+			}
+
+			void D2DFeatureFileOutput::Flush()
+			{
+				if(!this->buffer.empty())
+				{
+					this->isFailed |= this->file == nullptr || fwrite(this->buffer.data(), 1, this->buffer.size(), this->file) != this->buffer.size();
+					this->buffer.clear();
+				}
+			}
+
+			bool D2DFeatureStreamWriter::Write(const D2DFeatureSource& source, const D2DPathChar* path)
+			{
+				D2DFeatureFileHeader header;
+				memset(&header, 0, sizeof(header));
+				memcpy(header.Magic, FeatureFileMagic, sizeof(FeatureFileMagic));
+				header.Version = FeatureFileVersion;
+				header.NodeSize = FeatureIndexNodeSize;
+				header.MinX = header.MinY = (std::numeric_limits<double>::max)();
+				header.MaxX = header.MaxY = -(std::numeric_limits<double>::max)();
+
+				// the bounds of the features with points, which keep their source index in the offset until they are sorted
+				std::vector<D2DRTreeNode> boxes;
+				for(size_t feature = 0; feature < source.FeatureCount; feature++)
+				{
+					uint32_t firstPoint = source.PointOffsets[source.PartOffsets[feature]];
+					uint32_t endPoint = source.PointOffsets[source.PartOffsets[feature + 1]];
+					if(source.Kinds[feature] == D2DFeatureKind::None || endPoint <= firstPoint)
+					{
+						continue;
+					}
+
+					D2DRTreeNode box = { source.Coordinates[2 * static_cast<size_t>(firstPoint)], source.Coordinates[2 * static_cast<size_t>(firstPoint) + 1], 0, 0, feature };
+					box.MaxX = box.MinX;
+					box.MaxY = box.MinY;
+
+					for(const double* point = source.Coordinates + 2 * static_cast<size_t>(firstPoint); point != source.Coordinates + 2 * static_cast<size_t>(endPoint); point += 2)
+					{
+						box.MinX = (std::min)(box.MinX, point[0]);
+						box.MinY = (std::min)(box.MinY, point[1]);
+						box.MaxX = (std::max)(box.MaxX, point[0]);
+						box.MaxY = (std::max)(box.MaxY, point[1]);
+					}
+
+					// coordinates that are not numbers cannot be indexed
+					if(!(box.MinX <= box.MaxX && box.MinY <= box.MaxY))
+					{
+						continue;
+					}
+
+					header.MinX = (std::min)(header.MinX, box.MinX);
+					header.MinY = (std::min)(header.MinY, box.MinY);
+					header.MaxX = (std::max)(header.MaxX, box.MaxX);
+					header.MaxY = (std::max)(header.MaxY, box.MaxY);
+					boxes.push_back(box);
+				}
+
+				if(boxes.empty())
+				{
+					header.MinX = header.MinY = header.MaxX = header.MaxY = 0;
+				}
+
+				std::vector<uint32_t> order;
+				D2DPackedRTree::SortByHilbert(boxes.data(), boxes.size(), header.MinX, header.MinY, header.MaxX, header.MaxY, &order);
+
+				size_t nodeCount = D2DPackedRTree::GetNodeCount(boxes.size(), FeatureIndexNodeSize);
+				std::vector<D2DRTreeNode> nodes(nodeCount);
+				D2DRTreeNode* leaves = nodes.data() + nodeCount - boxes.size();
+
+				// the records are laid out in the order of the leaves
+				uint64_t recordOffset = 0;
+				for(size_t i = 0; i < order.size(); i++)
+				{
+					leaves[i] = boxes[order[i]];
+					size_t feature = static_cast<size_t>(leaves[i].Offset);
+					uint32_t partCount = source.PartOffsets[feature + 1] - source.PartOffsets[feature];
+					uint32_t pointCount = source.PointOffsets[source.PartOffsets[feature + 1]] - source.PointOffsets[source.PartOffsets[feature]];
+
+					leaves[i].Offset = recordOffset;
+					recordOffset += FeatureRecordHeaderSize + GetPointOffsetsSize(partCount) + static_cast<uint64_t>(pointCount) * 2 * sizeof(double);
+				}
+
+				D2DPackedRTree::Build(nodes.data(), nodeCount, boxes.size(), FeatureIndexNodeSize);
+
+				header.FeatureCount = boxes.size();
+				header.NodeCount = nodeCount;
+				header.IndexOffset = sizeof(D2DFeatureFileHeader);
+				header.RecordsOffset = header.IndexOffset + nodeCount * sizeof(D2DRTreeNode);
+				header.RecordsSize = recordOffset;
+
+				D2DFeatureFileOutput output(path);
+				output.Write(&header, sizeof(header));
+				output.Write(nodes.data(), nodeCount * sizeof(D2DRTreeNode));
+
+				std::vector<uint32_t> pointOffsets;
+				for(size_t i = 0; i < order.size(); i++)
+				{
+					size_t feature = static_cast<size_t>(boxes[order[i]].Offset);
+					uint32_t firstPart = source.PartOffsets[feature];
+					uint32_t partCount = source.PartOffsets[feature + 1] - firstPart;
+					uint32_t firstPoint = source.PointOffsets[firstPart];
+					uint32_t pointCount = source.PointOffsets[firstPart + partCount] - firstPoint;
+
+					uint8_t recordHeader[FeatureRecordHeaderSize] = { static_cast<uint8_t>(source.Kinds[feature]) };
+					uint32_t sourceIndex = static_cast<uint32_t>(feature);
+					memcpy(recordHeader + 4, &sourceIndex, sizeof(uint32_t));
+					memcpy(recordHeader + 8, &partCount, sizeof(uint32_t));
+					memcpy(recordHeader + 12, &pointCount, sizeof(uint32_t));
+					output.Write(recordHeader, sizeof(recordHeader));
+
+					// the point offsets of a record index its own coordinates
+					pointOffsets.resize(static_cast<size_t>(partCount) + 1);
+					for(uint32_t part = 0; part <= partCount; part++)
+					{
+						pointOffsets[part] = source.PointOffsets[firstPart + part] - firstPoint;
+					}
+
+					output.Write(pointOffsets.data(), pointOffsets.size() * sizeof(uint32_t));
+					output.WritePadding(pointOffsets.size() * sizeof(uint32_t));
+					output.Write(source.Coordinates + 2 * static_cast<size_t>(firstPoint), static_cast<size_t>(pointCount) * 2 * sizeof(double));
+				}
+
+				return output.Close();
+			}
+		}
+	}
+}
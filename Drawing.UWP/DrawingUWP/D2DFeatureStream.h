@@ -0,0 +1,109 @@
+#pragma once
+
+#include "D2DMappedFile.h"
+#include "D2DPackedRTree.h"
+#include <cstdio>
+
+namespace Telerik
+{
+	namespace UI
+	{
+		namespace Drawing
+		{
+			enum class D2DFeatureKind : uint8_t
+			{
+				None,
+				Point,
+				Line,
+				Polygon
+			};
+
+			// the features to write, in the flat layout of the shapefile and GeoJSON readers: feature f owns the parts
+			// [PartOffsets[f], PartOffsets[f + 1]) and part p owns the interleaved x, y of [PointOffsets[p], PointOffsets[p + 1])
+			struct D2DFeatureSource
+			{
+				size_t FeatureCount;
+				const D2DFeatureKind* Kinds;
+				const uint32_t* PartOffsets;
+				const uint32_t* PointOffsets;
+				const double* Coordinates;
+			};
+
+			// a feature read in place from a mapped feature file; its point offsets start at 0 and index its own coordinates
+			struct D2DFeatureRecord
+			{
+				D2DFeatureKind Kind;
+				uint32_t SourceIndex;
+				uint32_t PartCount;
+				uint32_t PointCount;
+				const uint32_t* PointOffsets;
+				const double* Coordinates;
+			};
+
+			// a feature file, modelled on FlatGeobuf: a fixed header, a packed Hilbert R-tree over the bounds of the features
+			// and the feature records in the order of the tree leaves, each leaf holding the offset of its record. All parts are
+			// little-endian and 8-byte aligned, so the file is searched and read straight from a mapped view; opening it only
+			// checks the header, and the pages of the index and of the records are loaded as the queries touch them
+			class D2DFeatureStreamReader
+			{
+			public:
+				D2DFeatureStreamReader();
+
+				bool Open(const D2DPathChar* path);
+				void Close();
+
+				size_t GetFeatureCount() const { return this->featureCount; }
+				void GetBounds(double* minX, double* minY, double* maxX, double* maxY) const;
+
+				// appends the features whose bounds intersect the rect, in the order of the tree
+				void Query(double minX, double minY, double maxX, double maxY, std::vector<uint32_t>* features) const;
+
+				// returns false if the feature is out of range or its record does not fit in the file
+				bool GetFeature(uint32_t feature, D2DFeatureRecord* record) const;
+
+			private:
+				D2DMappedFile file;
+				const D2DRTreeNode* nodes;
+				const uint8_t* records;
+				size_t nodeCount;
+				size_t featureCount;
+				size_t recordsSize;
+				uint16_t nodeSize;
+				double bounds[4];
+			};
+
+			// writes a file through a buffer and remembers whether any of the writes failed
+			class D2DFeatureFileOutput
+			{
+			public:
+				D2DFeatureFileOutput(const D2DPathChar* path);
+				~D2DFeatureFileOutput();
+
+				void Write(const void* data, size_t size);
+
+				// pads the data written after a section of the given size to the next multiple of 8 bytes
+				void WritePadding(size_t size);
+
+				// returns false if any of the writes failed
+				bool Close();
+
+			private:
+				D2DFeatureFileOutput(const D2DFeatureFileOutput&);
+				D2DFeatureFileOutput& operator = (const D2DFeatureFileOutput&);
+
+				void Flush();
+
+				FILE* file;
+				std::vector<uint8_t> buffer;
+				bool isFailed;
+			};
+
+			class D2DFeatureStreamWriter
+			{
+			public:
+				// features without points are left out; the others keep their index in the source as their SourceIndex
+				static bool Write(const D2DFeatureSource& source, const D2DPathChar* path);
+			};
+		}
+	}
+}
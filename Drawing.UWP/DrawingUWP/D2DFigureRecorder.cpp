@@ -0,0 +1,123 @@
+#include "pch.h"
+#include "D2DFigureRecorder.h"
+
+namespace Telerik
+{
+	namespace UI
+	{
+		namespace Drawing
+		{
+			D2DFigureRecorder::D2DFigureRecorder(ComPtr<ID2D1GeometrySink> sink)
+			{
+				this->sink = sink;
+				this->ringOffsets.push_back(0);
+				this->isTessellable = true;
+				this->isRecording = false;
+			}
+
+			void D2DFigureRecorder::SetFillMode(D2D1_FILL_MODE fillMode)
+			{
+				if(fillMode != D2D1_FILL_MODE_ALTERNATE)
+				{
+					this->isTessellable = false;
+				}
+
+				this->sink->SetFillMode(fillMode);
+			}
+
+			void D2DFigureRecorder::SetSegmentFlags(D2D1_PATH_SEGMENT vertexFlags)
+			{
+				this->sink->SetSegmentFlags(vertexFlags);
+			}
+
+			void D2DFigureRecorder::BeginFigure(D2D1_POINT_2F startPoint, D2D1_FIGURE_BEGIN figureBegin)
+			{
+				// hollow figures are only stroked
+				this->isRecording = this->isTessellable && figureBegin == D2D1_FIGURE_BEGIN_FILLED;
+				if(this->isRecording)
+				{
+					this->AddPoint(startPoint);
+				}
+
+				this->sink->BeginFigure(startPoint, figureBegin);
+			}
+
+			void D2DFigureRecorder::AddLines(const D2D1_POINT_2F* points, UINT32 pointsCount)
+			{
+				if(this->isRecording)
+				{
+					this->coordinates.reserve(this->coordinates.size() + 2 * static_cast<size_t>(pointsCount));
+					for(UINT32 i = 0; i < pointsCount; i++)
+					{
+						this->AddPoint(points[i]);
+					}
+				}
+
+				this->sink->AddLines(points, pointsCount);
+			}
+
+			void D2DFigureRecorder::AddLine(D2D1_POINT_2F point)
+			{
+				if(this->isRecording)
+				{
+					this->AddPoint(point);
+				}
+
+				this->sink->AddLine(point);
+			}
+
+			void D2DFigureRecorder::EndFigure(D2D1_FIGURE_END figureEnd)
+			{
+				// a filled figure is closed for the fill whether or not its stroke is
+				if(this->isRecording)
+				{
+					this->ringOffsets.push_back(static_cast<uint32_t>(this->coordinates.size() / 2));
+					this->isRecording = false;
+				}
+
+				this->sink->EndFigure(figureEnd);
+			}
+
+			HRESULT D2DFigureRecorder::Close()
+			{
+				return this->sink->Close();
+			}
+
+			void D2DFigureRecorder::AddBeziers(const D2D1_BEZIER_SEGMENT* beziers, UINT32 beziersCount)
+			{
+				this->isTessellable = this->isTessellable && !this->isRecording;
+				this->sink->AddBeziers(beziers, beziersCount);
+			}
+
+			void D2DFigureRecorder::AddBezier(const D2D1_BEZIER_SEGMENT* bezier)
+			{
+				this->isTessellable = this->isTessellable && !this->isRecording;
+				this->sink->AddBezier(bezier);
+			}
+
+			void D2DFigureRecorder::AddQuadraticBezier(const D2D1_QUADRATIC_BEZIER_SEGMENT* bezier)
+			{
+				this->isTessellable = this->isTessellable && !this->isRecording;
+				this->sink->AddQuadraticBezier(bezier);
+			}
+
+			void D2DFigureRecorder::AddQuadraticBeziers(const D2D1_QUADRATIC_BEZIER_SEGMENT* beziers, UINT32 beziersCount)
+			{
+				this->isTessellable = this->isTessellable && !this->isRecording;
+				this->sink->AddQuadraticBeziers(beziers, beziersCount);
+			}
+
+			void D2DFigureRecorder::AddArc(const D2D1_ARC_SEGMENT* arc)
+			{
+				this->isTessellable = this->isTessellable && !this->isRecording;
+				this->sink->AddArc(arc);
+			}
+
+			void D2DFigureRecorder::AddPoint(D2D1_POINT_2F point)
+			{
+				this->coordinates.push_back(point.x);
+				this->coordinates.push_back(point.y);
+			}
+		}
+	}
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <vector>
+
+namespace Telerik
+{
+	namespace UI
+	{
+		namespace Drawing
+		{
+			// a geometry sink that passes everything on to the sink of a path geometry and keeps a copy of the filled figures
+			// made of lines, so that the fill of the geometry can be tessellated once the geometry is built
+			class D2DFigureRecorder : public RuntimeClass<RuntimeClassFlags<ClassicCom>, ChainInterfaces<ID2D1GeometrySink, ID2D1SimplifiedGeometrySink>>
+			{
+			public:
+				D2DFigureRecorder(ComPtr<ID2D1GeometrySink> sink);
+
+				STDMETHOD_(void, SetFillMode)(D2D1_FILL_MODE fillMode) override;
+				STDMETHOD_(void, SetSegmentFlags)(D2D1_PATH_SEGMENT vertexFlags) override;
+				STDMETHOD_(void, BeginFigure)(D2D1_POINT_2F startPoint, D2D1_FIGURE_BEGIN figureBegin) override;
+				STDMETHOD_(void, AddLines)(const D2D1_POINT_2F* points, UINT32 pointsCount) override;
+				STDMETHOD_(void, AddBeziers)(const D2D1_BEZIER_SEGMENT* beziers, UINT32 beziersCount) override;
+				STDMETHOD_(void, EndFigure)(D2D1_FIGURE_END figureEnd) override;
+				STDMETHOD(Close)() override;
+
+				STDMETHOD_(void, AddLine)(D2D1_POINT_2F point) override;
+				STDMETHOD_(void, AddBezier)(const D2D1_BEZIER_SEGMENT* bezier) override;
+				STDMETHOD_(void, AddQuadraticBezier)(const D2D1_QUADRATIC_BEZIER_SEGMENT* bezier) override;
+				STDMETHOD_(void, AddQuadraticBeziers)(const D2D1_QUADRATIC_BEZIER_SEGMENT* beziers, UINT32 beziersCount) override;
+				STDMETHOD_(void, AddArc)(const D2D1_ARC_SEGMENT* arc) override;
+
+				// false when a filled figure has curves, or the figures are filled by the nonzero winding rule, which the recorded
+				// rings cannot describe
+				bool IsTessellable() const { return this->isTessellable; }
+
+				// the interleaved x, y points of the recorded rings and the offset of the first point of each ring, followed by
+				// the total point count, as D2DTessellator::Tessellate expects them
+				const std::vector<float>& GetCoordinates() const { return this->coordinates; }
+				const std::vector<uint32_t>& GetRingOffsets() const { return this->ringOffsets; }
+				size_t GetRingCount() const { return this->ringOffsets.size() - 1; }
+
+			private:
+				void AddPoint(D2D1_POINT_2F point);
+
+				ComPtr<ID2D1GeometrySink> sink;
+				std::vector<float> coordinates;
+				std::vector<uint32_t> ringOffsets;
+				bool isTessellable;
+				bool isRecording;
+			};
+		}
+	}
+}
@@ -0,0 +1,166 @@
+#include "pch.h"
+#include "D2DGeoJson.h"
+#include "D2DMappedFile.h"
+#include "D2DMultiPolygon.h"
+#include "D2DProjection.h"
+#include "D2DRectangle.h"
+#include <algorithm>
+
+namespace Telerik
+{
+	namespace UI
+	{
+		namespace Drawing
+		{
+			static Platform::String^ ConvertFromUtf8(const char* text, size_t length)
+			{
+				if(length == 0)
+				{
+					return nullptr;
+				}
+
+				int characterCount = MultiByteToWideChar(CP_UTF8, 0, text, static_cast<int>(length), nullptr, 0);
+				if(characterCount <= 0)
+				{
+					return nullptr;
+				}
+
+				std::vector<wchar_t> characters(characterCount);
+				MultiByteToWideChar(CP_UTF8, 0, text, static_cast<int>(length), characters.data(), characterCount);
+
+				return ref new Platform::String(characters.data(), static_cast<unsigned int>(characterCount));
+			}
+
+			D2DGeoJson::D2DGeoJson(void)
+			{
+			}
+
+			D2DGeoJson^ D2DGeoJson::Open(Platform::String^ path)
+			{
+				D2DMappedFile file;
+				if(path == nullptr || !file.Open(path->Data()))
+				{
+					return nullptr;
+				}
+
+				return Read(reinterpret_cast<const char*>(file.GetData()), file.GetSize());
+			}
+
+			D2DGeoJson^ D2DGeoJson::Parse(Platform::String^ json)
+			{
+				if(json == nullptr || json->Length() == 0)
+				{
+					return nullptr;
+				}
+
+				int length = WideCharToMultiByte(CP_UTF8, 0, json->Data(), static_cast<int>(json->Length()), nullptr, 0, nullptr, nullptr);
+				if(length <= 0)
+				{
+					return nullptr;
+				}
+
+				std::vector<char> utf8(length);
+				WideCharToMultiByte(CP_UTF8, 0, json->Data(), static_cast<int>(json->Length()), utf8.data(), length, nullptr, nullptr);
+
+				return Read(utf8.data(), utf8.size());
+			}
+
+			D2DGeoJson^ D2DGeoJson::Read(const char* json, size_t size)
+			{
+				D2DGeoJson^ geoJson = ref new D2DGeoJson();
+				if(!D2DGeoJsonReader::Read(json, size, &geoJson->data))
+				{
+					return nullptr;
+				}
+
+				return geoJson;
+			}
+
+			Platform::String^ D2DGeoJson::GetFieldName(int field)
+			{
+				const D2DGeoJsonColumn& column = this->GetColumn(0, field);
+				return ConvertFromUtf8(column.Name.data(), column.Name.size());
+			}
+
+			bool D2DGeoJson::IsNumericField(int field)
+			{
+				return !this->GetColumn(0, field).HasText;
+			}
+
+			double D2DGeoJson::GetNumber(int record, int field)
+			{
+				return this->GetColumn(record, field).Numbers[record];
+			}
+
+			Platform::String^ D2DGeoJson::GetText(int record, int field)
+			{
+				const D2DGeoJsonColumn& column = this->GetColumn(record, field);
+				uint32_t start = column.TextOffsets[record];
+
+				return ConvertFromUtf8(column.Text.data() + start, column.TextOffsets[record + 1] - start);
+			}
+
+			void D2DGeoJson::ProjectMercator(double worldSize)
+			{
+				D2DProjection::ProjectMercatorInParallel(this->data.Geometry.Coordinates.data(), this->data.Geometry.Coordinates.size() / 2, worldSize);
+			}
+
+			D2DShape^ D2DGeoJson::CreateShape(int record)
+			{
+				if(record < 0 || record >= this->FeatureCount)
+				{
+					throw ref new Platform::OutOfBoundsException();
+				}
+
+				const D2DGeoJsonGeometry& geometry = this->data.Geometry;
+				uint32_t firstPart = geometry.PartOffsets[record];
+				uint32_t partCount = geometry.PartOffsets[record + 1] - firstPart;
+				if(partCount == 0)
+				{
+					return nullptr;
+				}
+
+				D2DGeoJsonGeometryType type = geometry.FeatureTypes[record];
+				switch(type)
+				{
+					case D2DGeoJsonGeometryType::Point:
+					{
+						const double* point = geometry.Coordinates.data() + 2 * static_cast<size_t>(geometry.PointOffsets[firstPart]);
+
+						DoublePoint location;
+						location.X = point[0];
+						location.Y = point[1];
+
+						D2DRectangle^ marker = ref new D2DRectangle();
+						marker->Location = location;
+						return marker;
+					}
+
+					case D2DGeoJsonGeometryType::LineString:
+					case D2DGeoJsonGeometryType::MultiLineString:
+					case D2DGeoJsonGeometryType::Polygon:
+					case D2DGeoJsonGeometryType::MultiPolygon:
+					{
+						D2DMultiPolygon^ shape = ref new D2DMultiPolygon();
+						shape->IsClosed = type == D2DGeoJsonGeometryType::Polygon || type == D2DGeoJsonGeometryType::MultiPolygon;
+						shape->SetRings(geometry.Coordinates.data(), &geometry.PointOffsets[firstPart], partCount);
+						return shape;
+					}
+
+					default:
+						return nullptr;
+				}
+			}
+
+			const D2DGeoJsonColumn& D2DGeoJson::GetColumn(int record, int field)
+			{
+				if(field < 0 || field >= this->FieldCount || record < 0 || record >= (std::max)(this->FeatureCount, 1))
+				{
+					throw ref new Platform::OutOfBoundsException();
+				}
+
+				return this->data.Columns[field];
+			}
+		}
+	}
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "D2DShape.h"
+#include "D2DGeoJsonReader.h"
+
+namespace Telerik
+{
+	namespace UI
+	{
+		namespace Drawing
+		{
+			// GeoJSON features parsed natively into flat coordinate buffers and a columnar property table;
+			// shapes are created from the buffers directly, without marshaling their points
+			public ref class D2DGeoJson sealed
+			{
+			public:
+				// returns null if the data is not valid GeoJSON
+				static D2DGeoJson^ Open(Platform::String^ path);
+				static D2DGeoJson^ Parse(Platform::String^ json);
+
+				property int FeatureCount
+				{
+					int get() { return static_cast<int>(this->data.Geometry.FeatureTypes.size()); }
+				}
+
+				property int FieldCount
+				{
+					int get() { return static_cast<int>(this->data.Columns.size()); }
+				}
+
+				Platform::String^ GetFieldName(int field);
+
+				// whether all values of the property are numbers or booleans
+				bool IsNumericField(int field);
+
+				// the value of a number or boolean property, NaN if the feature has none
+				double GetNumber(int record, int field);
+
+				// the value of a string property, or the JSON of a nested object or array
+				Platform::String^ GetText(int record, int field);
+
+				// a D2DRectangle for a point and a D2DMultiPolygon for lines and polygons; null for other features
+				D2DShape^ CreateShape(int record);
+
+				// projects the coordinates in place from longitude and latitude to the spherical Mercator of RadMap, with the
+				// world a square of worldSize units (512 in the model space of RadMap); see D2DShapefile::ProjectMercator
+				void ProjectMercator(double worldSize);
+
+			internal:
+				const D2DGeoJsonData& GetData() { return this->data; }
+
+			private:
+				D2DGeoJson(void);
+
+				static D2DGeoJson^ Read(const char* json, size_t size);
+				const D2DGeoJsonColumn& GetColumn(int record, int field);
+
+				D2DGeoJsonData data;
+			};
+		}
+	}
+}
@@ -0,0 +1,1021 @@
+#include "pch.h"
+#include "D2DGeoJsonReader.h"
+#include "D2DParallel.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <unordered_map>
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__SSE2__) || defined(__x86_64__)
+#include <emmintrin.h>
+#define D2D_GEOJSON_SSE
+#endif
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// the features are parsed in chunks of this many features, so that each worker is handed a sizeable piece of work
+const size_t FeaturesPerChunk = 1024;
+
+// numbers longer than this are not valid coordinates or properties worth keeping exactly
+const size_t MaxNumberLength = 64;
+
+namespace Telerik
+{
+	namespace UI
+	{
+		namespace Drawing
+		{
+#ifdef D2D_GEOJSON_SSE
+			static int FirstBit(unsigned int mask)
+			{
+#ifdef _MSC_VER
+				unsigned long index;
+				_BitScanForward(&index, mask);
+				return static_cast<int>(index);
+#else
+				return __builtin_ctz(mask);
+#endif
+			}
+
+			static int BitCount(unsigned int mask)
+			{
+				int count = 0;
+				for(; mask != 0; mask &= mask - 1)
+				{
+					count++;
+				}
+
+				return count;
+			}
+#endif
+
+			static bool IsWhitespace(char c)
+			{
+				return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+			}
+
+			static const char* SkipWhitespace(const char* p, const char* end)
+			{
+#ifdef D2D_GEOJSON_SSE
+				// indented files have long runs of spaces, which are skipped 16 bytes at a time
+				while(p + 16 <= end && IsWhitespace(*p))
+				{
+					__m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+					__m128i spaces = _mm_or_si128(
+						_mm_or_si128(_mm_cmpeq_epi8(block, _mm_set1_epi8(' ')), _mm_cmpeq_epi8(block, _mm_set1_epi8('\n'))),
+						_mm_or_si128(_mm_cmpeq_epi8(block, _mm_set1_epi8('\r')), _mm_cmpeq_epi8(block, _mm_set1_epi8('\t'))));
+
+					unsigned int mask = ~static_cast<unsigned int>(_mm_movemask_epi8(spaces)) & 0xFFFF;
+					if(mask != 0)
+					{
+						return p + FirstBit(mask);
+					}
+
+					p += 16;
+				}
+#endif
+
+				while(p < end && IsWhitespace(*p))
+				{
+					p++;
+				}
+
+				return p;
+			}
+
+			// p follows the opening quote; returns the position after the closing quote, or null if the string is not closed
+			static const char* SkipString(const char* p, const char* end)
+			{
+				for(;;)
+				{
+#ifdef D2D_GEOJSON_SSE
+					while(p + 16 <= end)
+					{
+						__m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+						unsigned int mask = static_cast<unsigned int>(_mm_movemask_epi8(_mm_or_si128(
+							_mm_cmpeq_epi8(block, _mm_set1_epi8('"')),
+							_mm_cmpeq_epi8(block, _mm_set1_epi8('\\')))));
+
+						if(mask != 0)
+						{
+							p += FirstBit(mask);
+							break;
+						}
+
+						p += 16;
+					}
+#endif
+
+					while(p < end && *p != '"' && *p != '\\')
+					{
+						p++;
+					}
+
+					if(p >= end)
+					{
+						return nullptr;
+					}
+
+					if(*p == '"')
+					{
+						return p + 1;
+					}
+
+					// an escape, whose second character may be a quote
+					p += 2;
+				}
+			}
+
+			// skips an object or an array; p follows its opening bracket
+			static const char* SkipContainer(const char* p, const char* end)
+			{
+				int depth = 1;
+				while(p < end)
+				{
+#ifdef D2D_GEOJSON_SSE
+					// a block of 16 bytes without quotes, in which the depth cannot reach zero, is accounted for at once
+					// by counting its brackets; coordinate arrays are mostly such blocks
+					while(p + 16 <= end)
+					{
+						__m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+						unsigned int quotes = static_cast<unsigned int>(_mm_movemask_epi8(_mm_cmpeq_epi8(block, _mm_set1_epi8('"'))));
+						unsigned int opening = static_cast<unsigned int>(_mm_movemask_epi8(_mm_or_si128(
+							_mm_cmpeq_epi8(block, _mm_set1_epi8('[')),
+							_mm_cmpeq_epi8(block, _mm_set1_epi8('{')))));
+						unsigned int closing = static_cast<unsigned int>(_mm_movemask_epi8(_mm_or_si128(
+							_mm_cmpeq_epi8(block, _mm_set1_epi8(']')),
+							_mm_cmpeq_epi8(block, _mm_set1_epi8('}')))));
+
+						int closingCount = BitCount(closing);
+						if(quotes != 0 || closingCount >= depth)
+						{
+							// the block is walked byte by byte up to its first quote or closing bracket
+							unsigned int stops = quotes | closing;
+							p += stops != 0 ? FirstBit(stops) : 0;
+							depth += BitCount(opening & (stops != 0 ? (1u << FirstBit(stops)) - 1 : 0));
+							break;
+						}
+
+						depth += BitCount(opening) - closingCount;
+						p += 16;
+					}
+
+					if(p >= end)
+					{
+						break;
+					}
+#endif
+
+					switch(*p++)
+					{
+						case '"':
+							p = SkipString(p, end);
+							if(p == nullptr)
+							{
+								return nullptr;
+							}
+							break;
+						case '[':
+						case '{':
+							depth++;
+							break;
+						case ']':
+						case '}':
+							if(--depth == 0)
+							{
+								return p;
+							}
+							break;
+					}
+				}
+
+				return nullptr;
+			}
+
+			// skips any value; p is at its first character
+			static const char* SkipValue(const char* p, const char* end)
+			{
+				if(p >= end)
+				{
+					return nullptr;
+				}
+
+				if(*p == '"')
+				{
+					return SkipString(p + 1, end);
+				}
+
+				if(*p == '{' || *p == '[')
+				{
+					return SkipContainer(p + 1, end);
+				}
+
+				// a number or a literal
+				const char* start = p;
+				while(p < end && *p != ',' && *p != '}' && *p != ']' && !IsWhitespace(*p))
+				{
+					p++;
+				}
+
+				return p > start ? p : nullptr;
+			}
+
+			static bool IsLiteral(const char* p, const char* end, const char* literal)
+			{
+				size_t length = strlen(literal);
+				return static_cast<size_t>(end - p) >= length && memcmp(p, literal, length) == 0;
+			}
+
+			static bool IsNumberStart(char c)
+			{
+				return c == '-' || (c >= '0' && c <= '9');
+			}
+
+			static const char* ParseNumber(const char* p, const char* end, double* value)
+			{
+				static const double PowersOfTen[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+
+				const char* start = p;
+				bool isNegative = p < end && *p == '-';
+				if(isNegative)
+				{
+					p++;
+				}
+
+				uint64_t mantissa = 0;
+				int digits = 0;
+				int exponent = 0;
+				bool hasDigits = false;
+
+				for(; p < end && *p >= '0' && *p <= '9'; p++, hasDigits = true)
+				{
+					mantissa = mantissa * 10 + (*p - '0');
+					digits += mantissa != 0 ? 1 : 0;
+				}
+
+				if(p < end && *p == '.')
+				{
+					for(p++; p < end && *p >= '0' && *p <= '9'; p++)
+					{
+						mantissa = mantissa * 10 + (*p - '0');
+						digits += mantissa != 0 ? 1 : 0;
+						exponent--;
+					}
+				}
+
+				if(!hasDigits)
+				{
+					return nullptr;
+				}
+
+				if(p < end && (*p == 'e' || *p == 'E'))
+				{
+					bool isExponentNegative = false;
+					if(++p < end && (*p == '-' || *p == '+'))
+					{
+						isExponentNegative = *p == '-';
+						p++;
+					}
+
+					int explicitExponent = 0;
+					for(; p < end && *p >= '0' && *p <= '9'; p++)
+					{
+						explicitExponent = (std::min)(explicitExponent * 10 + (*p - '0'), 9999);
+					}
+
+					exponent += isExponentNegative ? -explicitExponent : explicitExponent;
+				}
+
+				// a mantissa of up to 15 digits and a power of ten up to 22 are both exact doubles, so a single
+				// multiplication or division rounds correctly; anything else is left to the C library
+				if(digits <= 15 && exponent >= -22 && exponent <= 22)
+				{
+					double result = static_cast<double>(mantissa);
+					result = exponent >= 0 ? result * PowersOfTen[exponent] : result / PowersOfTen[-exponent];
+					*value = isNegative ? -result : result;
+					return p;
+				}
+
+				size_t length = static_cast<size_t>(p - start);
+				if(length >= MaxNumberLength)
+				{
+					return nullptr;
+				}
+
+				char buffer[MaxNumberLength];
+				memcpy(buffer, start, length);
+				buffer[length] = '\0';
+
+				*value = strtod(buffer, nullptr);
+				return p;
+			}
+
+			static void AppendUtf8(uint32_t codePoint, std::string* text)
+			{
+				if(codePoint < 0x80)
+				{
+					text->push_back(static_cast<char>(codePoint));
+				}
+				else if(codePoint < 0x800)
+				{
+					text->push_back(static_cast<char>(0xC0 | (codePoint >> 6)));
+					text->push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+				}
+				else if(codePoint < 0x10000)
+				{
+					text->push_back(static_cast<char>(0xE0 | (codePoint >> 12)));
+					text->push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+					text->push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+				}
+				else
+				{
+					text->push_back(static_cast<char>(0xF0 | (codePoint >> 18)));
+					text->push_back(static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F)));
+					text->push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+					text->push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+				}
+			}
+
+			static bool ParseHex(const char* p, const char* end, uint32_t* value)
+			{
+				if(end - p < 4)
+				{
+					return false;
+				}
+
+				*value = 0;
+				for(int i = 0; i < 4; i++)
+				{
+					char c = p[i];
+					uint32_t digit = c >= '0' && c <= '9' ? c - '0' : c >= 'a' && c <= 'f' ? c - 'a' + 10 : c >= 'A' && c <= 'F' ? c - 'A' + 10 : 16;
+					if(digit > 15)
+					{
+						return false;
+					}
+
+					*value = *value * 16 + digit;
+				}
+
+				return true;
+			}
+
+			// appends the unescaped string to the text; p is at the opening quote
+			static const char* ParseString(const char* p, const char* end, std::string* text)
+			{
+				const char* stringEnd = SkipString(p + 1, end);
+				if(stringEnd == nullptr)
+				{
+					return nullptr;
+				}
+
+				const char* content = p + 1;
+				const char* contentEnd = stringEnd - 1;
+
+				while(content < contentEnd)
+				{
+					// the runs between escapes are copied as they are
+					const char* escape = static_cast<const char*>(memchr(content, '\\', contentEnd - content));
+					if(escape == nullptr)
+					{
+						text->append(content, contentEnd);
+						break;
+					}
+
+					text->append(content, escape);
+					content = escape + 2;
+
+					switch(escape[1])
+					{
+						case 'b': text->push_back('\b'); break;
+						case 'f': text->push_back('\f'); break;
+						case 'n': text->push_back('\n'); break;
+						case 'r': text->push_back('\r'); break;
+						case 't': text->push_back('\t'); break;
+						case 'u':
+						{
+							uint32_t codePoint;
+							if(!ParseHex(content, contentEnd, &codePoint))
+							{
+								return nullptr;
+							}
+
+							content += 4;
+
+							// a surrogate pair stands for a single code point
+							uint32_t low;
+							if(codePoint >= 0xD800 && codePoint < 0xDC00 && contentEnd - content >= 6 && content[0] == '\\' && content[1] == 'u' &&
+								ParseHex(content + 2, contentEnd, &low) && low >= 0xDC00 && low < 0xE000)
+							{
+								codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (low - 0xDC00);
+								content += 6;
+							}
+
+							AppendUtf8(codePoint, text);
+							break;
+						}
+						default:
+							text->push_back(escape[1]);
+							break;
+					}
+				}
+
+				return stringEnd;
+			}
+
+			// iterates the members of an object; p is at the opening brace. The handler gets the key and the position of the
+			// value and returns the position after it, or null to stop with an error
+			template<typename Handler>
+			static const char* ParseObject(const char* p, const char* end, std::string* key, const Handler& handler)
+			{
+				if(p >= end || *p != '{')
+				{
+					return nullptr;
+				}
+
+				p = SkipWhitespace(p + 1, end);
+				if(p < end && *p == '}')
+				{
+					return p + 1;
+				}
+
+				while(p < end)
+				{
+					if(*p != '"')
+					{
+						return nullptr;
+					}
+
+					key->clear();
+					p = ParseString(p, end, key);
+					if(p == nullptr)
+					{
+						return nullptr;
+					}
+
+					p = SkipWhitespace(p, end);
+					if(p >= end || *p != ':')
+					{
+						return nullptr;
+					}
+
+					p = handler(SkipWhitespace(p + 1, end));
+					if(p == nullptr)
+					{
+						return nullptr;
+					}
+
+					p = SkipWhitespace(p, end);
+					if(p < end && *p == '}')
+					{
+						return p + 1;
+					}
+
+					if(p >= end || *p != ',')
+					{
+						return nullptr;
+					}
+
+					p = SkipWhitespace(p + 1, end);
+				}
+
+				return nullptr;
+			}
+
+			static D2DGeoJsonGeometryType GetGeometryType(const std::string& name)
+			{
+				if(name == "Point") return D2DGeoJsonGeometryType::Point;
+				if(name == "MultiPoint") return D2DGeoJsonGeometryType::MultiPoint;
+				if(name == "LineString") return D2DGeoJsonGeometryType::LineString;
+				if(name == "MultiLineString") return D2DGeoJsonGeometryType::MultiLineString;
+				if(name == "Polygon") return D2DGeoJsonGeometryType::Polygon;
+				if(name == "MultiPolygon") return D2DGeoJsonGeometryType::MultiPolygon;
+
+				return D2DGeoJsonGeometryType::None;
+			}
+
+			// the features of a chunk, parsed into buffers of their own that are merged in order once all chunks are done
+			class D2DGeoJsonReader::Chunk
+			{
+			public:
+				Chunk() : isValid(true)
+				{
+				}
+
+				void ParseFeatures(const Range* features, size_t count, bool isSingleGeometry)
+				{
+					for(size_t i = 0; i < count && this->isValid; i++)
+					{
+						this->geometry.PartOffsets.push_back(static_cast<uint32_t>(this->geometry.PointOffsets.size()));
+
+						D2DGeoJsonGeometryType type = D2DGeoJsonGeometryType::None;
+						const char* end = isSingleGeometry ?
+							this->ParseGeometry(features[i].Begin, features[i].End, &type) :
+							this->ParseFeature(features[i].Begin, features[i].End, &type);
+
+						this->geometry.FeatureTypes.push_back(type);
+						this->isValid = end != nullptr;
+					}
+				}
+
+				bool IsValid() const { return this->isValid; }
+				size_t GetFeatureCount() const { return this->geometry.FeatureTypes.size(); }
+
+				D2DGeoJsonGeometry geometry;
+				std::vector<D2DGeoJsonColumn> columns;
+
+			private:
+				const char* ParseFeature(const char* p, const char* end, D2DGeoJsonGeometryType* type)
+				{
+					size_t feature = this->GetFeatureCount();
+					std::string key;
+
+					return ParseObject(p, end, &key, [&](const char* value) -> const char*
+					{
+						if(key == "geometry")
+						{
+							return this->ParseGeometry(value, end, type);
+						}
+
+						if(key == "properties")
+						{
+							return this->ParseProperties(value, end, feature);
+						}
+
+						return SkipValue(value, end);
+					});
+				}
+
+				const char* ParseGeometry(const char* p, const char* end, D2DGeoJsonGeometryType* type)
+				{
+					if(IsLiteral(p, end, "null"))
+					{
+						return p + 4;
+					}
+
+					// the coordinates may precede the type, so they are read without knowing the kind of geometry
+					std::string key;
+					std::string name;
+
+					return ParseObject(p, end, &key, [&](const char* value) -> const char*
+					{
+						if(key == "type" && value < end && *value == '"')
+						{
+							const char* valueEnd = ParseString(value, end, &name);
+							*type = GetGeometryType(name);
+							return valueEnd;
+						}
+
+						if(key == "coordinates")
+						{
+							bool isPosition;
+							return this->ParseCoordinates(value, end, true, &isPosition);
+						}
+
+						if(key == "geometries" && value < end && *value == '[')
+						{
+							// the parts of the members of a geometry collection become parts of the feature
+							return this->ParseArray(value, end, [&](const char* member) -> const char*
+							{
+								D2DGeoJsonGeometryType memberType = D2DGeoJsonGeometryType::None;
+								return this->ParseGeometry(member, end, &memberType);
+							});
+						}
+
+						return SkipValue(value, end);
+					});
+				}
+
+				// every array of positions becomes a part, at whatever depth it is, which covers all geometry types;
+				// a position on its own (a Point) is a part of one point
+				const char* ParseCoordinates(const char* p, const char* end, bool isTopLevel, bool* isPosition)
+				{
+					if(p >= end || *p != '[')
+					{
+						return nullptr;
+					}
+
+					const char* first = SkipWhitespace(p + 1, end);
+					*isPosition = first < end && IsNumberStart(*first);
+
+					if(*isPosition)
+					{
+						double x, y;
+						p = ParseNumber(first, end, &x);
+						p = p != nullptr ? SkipWhitespace(p, end) : nullptr;
+						if(p == nullptr || p >= end || *p != ',')
+						{
+							return nullptr;
+						}
+
+						p = ParseNumber(SkipWhitespace(p + 1, end), end, &y);
+						if(p == nullptr)
+						{
+							return nullptr;
+						}
+
+						if(isTopLevel)
+						{
+							this->geometry.PointOffsets.push_back(this->GetPointCount());
+						}
+
+						this->geometry.Coordinates.push_back(x);
+						this->geometry.Coordinates.push_back(y);
+
+						// the altitude and any other values of the position are skipped
+						p = SkipWhitespace(p, end);
+						return p < end && *p == ']' ? p + 1 : SkipContainer(p, end);
+					}
+
+					bool hasPart = false;
+					return this->ParseArray(p, end, [&](const char* element) -> const char*
+					{
+						bool isElementPosition;
+						uint32_t pointCount = this->GetPointCount();
+
+						const char* elementEnd = this->ParseCoordinates(element, end, false, &isElementPosition);
+						if(elementEnd != nullptr && isElementPosition && !hasPart)
+						{
+							this->geometry.PointOffsets.push_back(pointCount);
+							hasPart = true;
+						}
+
+						return elementEnd;
+					});
+				}
+
+				const char* ParseProperties(const char* p, const char* end, size_t feature)
+				{
+					if(IsLiteral(p, end, "null"))
+					{
+						return p + 4;
+					}
+
+					std::string key;
+					return ParseObject(p, end, &key, [&](const char* value) -> const char*
+					{
+						if(value >= end)
+						{
+							return nullptr;
+						}
+
+						D2DGeoJsonColumn* column = this->GetColumn(key, feature);
+						bool isSet = column->Numbers.size() > feature;
+
+						if(*value == '"')
+						{
+							if(isSet)
+							{
+								return SkipValue(value, end);
+							}
+
+							this->AddValue(column, std::numeric_limits<double>::quiet_NaN());
+							column->HasText = true;
+							return ParseString(value, end, &column->Text);
+						}
+
+						if(IsNumberStart(*value))
+						{
+							double number;
+							const char* valueEnd = ParseNumber(value, end, &number);
+							if(!isSet)
+							{
+								this->AddValue(column, number);
+							}
+
+							return valueEnd;
+						}
+
+						if(IsLiteral(value, end, "true") || IsLiteral(value, end, "false"))
+						{
+							if(!isSet)
+							{
+								this->AddValue(column, *value == 't' ? 1 : 0);
+							}
+
+							return value + (*value == 't' ? 4 : 5);
+						}
+
+						const char* valueEnd = SkipValue(value, end);
+						if(valueEnd != nullptr && !isSet && *value != 'n')
+						{
+							// nested objects and arrays are kept as their JSON
+							this->AddValue(column, std::numeric_limits<double>::quiet_NaN());
+							column->Text.append(value, valueEnd);
+							column->HasText = true;
+						}
+
+						return valueEnd;
+					});
+				}
+
+				template<typename Handler>
+				const char* ParseArray(const char* p, const char* end, const Handler& handler)
+				{
+					p = SkipWhitespace(p + 1, end);
+					if(p < end && *p == ']')
+					{
+						return p + 1;
+					}
+
+					while(p < end)
+					{
+						p = handler(p);
+						if(p == nullptr)
+						{
+							return nullptr;
+						}
+
+						p = SkipWhitespace(p, end);
+						if(p < end && *p == ']')
+						{
+							return p + 1;
+						}
+
+						if(p >= end || *p != ',')
+						{
+							return nullptr;
+						}
+
+						p = SkipWhitespace(p + 1, end);
+					}
+
+					return nullptr;
+				}
+
+				// the column of the property, with the values of the features before this one padded as missing
+				D2DGeoJsonColumn* GetColumn(const std::string& name, size_t feature)
+				{
+					auto index = this->columnIndices.find(name);
+					if(index == this->columnIndices.end())
+					{
+						index = this->columnIndices.insert(std::make_pair(name, this->columns.size())).first;
+
+						D2DGeoJsonColumn column;
+						column.Name = name;
+						column.HasText = false;
+						this->columns.push_back(column);
+					}
+
+					D2DGeoJsonColumn* column = &this->columns[index->second];
+					PadColumn(column, feature);
+
+					return column;
+				}
+
+				void AddValue(D2DGeoJsonColumn* column, double number)
+				{
+					column->Numbers.push_back(number);
+					column->TextOffsets.push_back(static_cast<uint32_t>(column->Text.size()));
+				}
+
+				uint32_t GetPointCount() const
+				{
+					return static_cast<uint32_t>(this->geometry.Coordinates.size() / 2);
+				}
+
+			public:
+				static void PadColumn(D2DGeoJsonColumn* column, size_t featureCount)
+				{
+					if(column->Numbers.size() < featureCount)
+					{
+						column->Numbers.resize(featureCount, std::numeric_limits<double>::quiet_NaN());
+						column->TextOffsets.resize(featureCount, static_cast<uint32_t>(column->Text.size()));
+					}
+				}
+
+			private:
+				std::unordered_map<std::string, size_t> columnIndices;
+				bool isValid;
+			};
+
+			bool D2DGeoJsonReader::Read(const char* data, size_t size, D2DGeoJsonData* result)
+			{
+				result->Geometry.FeatureTypes.clear();
+				result->Geometry.PartOffsets.assign(1, 0);
+				result->Geometry.PointOffsets.assign(1, 0);
+				result->Geometry.Coordinates.clear();
+				result->Columns.clear();
+
+				std::vector<Range> features;
+				bool isSingleGeometry = false;
+				if(!FindFeatures(data, size, &features, &isSingleGeometry))
+				{
+					return false;
+				}
+
+				size_t chunkCount = (features.size() + FeaturesPerChunk - 1) / FeaturesPerChunk;
+				std::vector<Chunk> chunks(chunkCount);
+
+				D2DParallel::For(chunkCount, [&](size_t chunk, size_t)
+				{
+					size_t begin = chunk * FeaturesPerChunk;
+					size_t count = (std::min)(FeaturesPerChunk, features.size() - begin);
+					chunks[chunk].ParseFeatures(&features[begin], count, isSingleGeometry);
+				});
+
+				for(auto chunk = chunks.begin(); chunk != chunks.end(); ++chunk)
+				{
+					if(!chunk->IsValid())
+					{
+						return false;
+					}
+				}
+
+				// the offsets are 32-bit, as in the other layer buffers
+				size_t pointCount = 0;
+				for(auto chunk = chunks.begin(); chunk != chunks.end(); ++chunk)
+				{
+					pointCount += chunk->geometry.Coordinates.size() / 2;
+				}
+
+				if(pointCount >= UINT32_MAX)
+				{
+					return false;
+				}
+
+				Merge(chunks, result);
+				return true;
+			}
+
+			bool D2DGeoJsonReader::FindFeatures(const char* data, size_t size, std::vector<Range>* features, bool* isSingleGeometry)
+			{
+				const char* end = data + size;
+				const char* p = data;
+
+				// a UTF-8 byte order mark
+				if(size >= 3 && memcmp(p, "\xEF\xBB\xBF", 3) == 0)
+				{
+					p += 3;
+				}
+
+				p = SkipWhitespace(p, end);
+				const char* objectBegin = p;
+
+				std::string key;
+				std::string type;
+				bool hasFeatures = false;
+
+				const char* objectEnd = ParseObject(p, end, &key, [&](const char* value) -> const char*
+				{
+					if(key == "type" && value < end && *value == '"')
+					{
+						return ParseString(value, end, &type);
+					}
+
+					if(key == "features" && value < end && *value == '[')
+					{
+						// only the extent of each feature is found here, the features are parsed in parallel
+						hasFeatures = true;
+						const char* element = SkipWhitespace(value + 1, end);
+						if(element < end && *element == ']')
+						{
+							return element + 1;
+						}
+
+						while(element < end)
+						{
+							const char* elementEnd = SkipValue(element, end);
+							if(elementEnd == nullptr)
+							{
+								return nullptr;
+							}
+
+							Range range = { element, elementEnd };
+							features->push_back(range);
+
+							element = SkipWhitespace(elementEnd, end);
+							if(element < end && *element == ']')
+							{
+								return element + 1;
+							}
+
+							if(element >= end || *element != ',')
+							{
+								return nullptr;
+							}
+
+							element = SkipWhitespace(element + 1, end);
+						}
+
+						return nullptr;
+					}
+
+					return SkipValue(value, end);
+				});
+
+				if(objectEnd == nullptr)
+				{
+					return false;
+				}
+
+				if(type == "FeatureCollection")
+				{
+					return hasFeatures;
+				}
+
+				// a single feature or a bare geometry is read as a collection of one
+				features->clear();
+				Range range = { objectBegin, objectEnd };
+				features->push_back(range);
+
+				*isSingleGeometry = type != "Feature";
+				return true;
+			}
+
+			void D2DGeoJsonReader::Merge(std::vector<Chunk>& chunks, D2DGeoJsonData* result)
+			{
+				D2DGeoJsonGeometry& geometry = result->Geometry;
+
+				// the place of each chunk in the merged buffers, so that the geometries are copied in parallel
+				std::vector<size_t> firstFeatures(chunks.size() + 1, 0);
+				std::vector<size_t> firstParts(chunks.size() + 1, 0);
+				std::vector<size_t> firstPoints(chunks.size() + 1, 0);
+				for(size_t i = 0; i < chunks.size(); i++)
+				{
+					firstFeatures[i + 1] = firstFeatures[i] + chunks[i].GetFeatureCount();
+					firstParts[i + 1] = firstParts[i] + chunks[i].geometry.PointOffsets.size();
+					firstPoints[i + 1] = firstPoints[i] + chunks[i].geometry.Coordinates.size() / 2;
+				}
+
+				geometry.FeatureTypes.resize(firstFeatures.back());
+				geometry.PartOffsets.resize(firstFeatures.back() + 1);
+				geometry.PointOffsets.resize(firstParts.back() + 1);
+				geometry.Coordinates.resize(firstPoints.back() * 2);
+
+				D2DParallel::For(chunks.size(), [&](size_t i, size_t)
+				{
+					const D2DGeoJsonGeometry& chunkGeometry = chunks[i].geometry;
+					uint32_t firstPart = static_cast<uint32_t>(firstParts[i]);
+					uint32_t firstPoint = static_cast<uint32_t>(firstPoints[i]);
+
+					std::copy(chunkGeometry.FeatureTypes.begin(), chunkGeometry.FeatureTypes.end(), geometry.FeatureTypes.begin() + firstFeatures[i]);
+					for(size_t feature = 0; feature < chunkGeometry.PartOffsets.size(); feature++)
+					{
+						geometry.PartOffsets[firstFeatures[i] + feature] = chunkGeometry.PartOffsets[feature] + firstPart;
+					}
+
+					for(size_t part = 0; part < chunkGeometry.PointOffsets.size(); part++)
+					{
+						geometry.PointOffsets[firstParts[i] + part] = chunkGeometry.PointOffsets[part] + firstPoint;
+					}
+
+					std::copy(chunkGeometry.Coordinates.begin(), chunkGeometry.Coordinates.end(), geometry.Coordinates.begin() + 2 * firstPoints[i]);
+				});
+
+				geometry.PartOffsets.back() = static_cast<uint32_t>(firstParts.back());
+				geometry.PointOffsets.back() = static_cast<uint32_t>(firstPoints.back());
+
+				std::unordered_map<std::string, size_t> columnIndices;
+				size_t featureCount = 0;
+
+				for(auto chunk = chunks.begin(); chunk != chunks.end(); ++chunk)
+				{
+					// the columns are matched by name; a column missing from a chunk is missing for all of its features
+					size_t chunkFeatureCount = chunk->GetFeatureCount();
+					for(auto chunkColumn = chunk->columns.begin(); chunkColumn != chunk->columns.end(); ++chunkColumn)
+					{
+						auto index = columnIndices.find(chunkColumn->Name);
+						if(index == columnIndices.end())
+						{
+							index = columnIndices.insert(std::make_pair(chunkColumn->Name, result->Columns.size())).first;
+
+							D2DGeoJsonColumn column;
+							column.Name = chunkColumn->Name;
+							column.HasText = false;
+							result->Columns.push_back(column);
+						}
+
+						D2DGeoJsonColumn& column = result->Columns[index->second];
+						Chunk::PadColumn(&column, featureCount);
+						Chunk::PadColumn(&*chunkColumn, chunkFeatureCount);
+
+						uint32_t firstText = static_cast<uint32_t>(column.Text.size());
+						column.Numbers.insert(column.Numbers.end(), chunkColumn->Numbers.begin(), chunkColumn->Numbers.end());
+						for(auto offset = chunkColumn->TextOffsets.begin(); offset != chunkColumn->TextOffsets.end(); ++offset)
+						{
+							column.TextOffsets.push_back(*offset + firstText);
+						}
+
+						column.Text.append(chunkColumn->Text);
+						column.HasText = column.HasText || chunkColumn->HasText;
+					}
+
+					featureCount += chunkFeatureCount;
+
+					// the buffers of the chunk are released as soon as they are merged
+					*chunk = Chunk();
+				}
+
+				for(auto column = result->Columns.begin(); column != result->Columns.end(); ++column)
+				{
+					Chunk::PadColumn(&*column, featureCount);
+					column->TextOffsets.push_back(static_cast<uint32_t>(column->Text.size()));
+				}
+			}
+		}
+	}
+}
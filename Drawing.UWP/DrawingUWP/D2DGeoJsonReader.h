@@ -0,0 +1,78 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <cstddef>
+#include <cstdint>
+
+namespace Telerik
+{
+	namespace UI
+	{
+		namespace Drawing
+		{
+			enum class D2DGeoJsonGeometryType : uint8_t
+			{
+				None,
+				Point,
+				MultiPoint,
+				LineString,
+				MultiLineString,
+				Polygon,
+				MultiPolygon
+			};
+
+			// the geometries of the features laid out as D2DShapefileGeometry: feature f owns the parts
+			// [PartOffsets[f], PartOffsets[f + 1]) and part p owns the points [PointOffsets[p], PointOffsets[p + 1]).
+			// a part is a ring or a line; a point and a multipoint own one part, the rings of all polygons of a multipolygon
+			// are parts of the same feature
+			struct D2DGeoJsonGeometry
+			{
+				std::vector<D2DGeoJsonGeometryType> FeatureTypes;
+				std::vector<uint32_t> PartOffsets;
+				std::vector<uint32_t> PointOffsets;
+				std::vector<double> Coordinates;
+			};
+
+			// a property of the features: numbers and booleans go to Numbers (NaN when missing), strings (UTF-8) and nested
+			// values (as JSON) go to the text of the feature, [TextOffsets[f], TextOffsets[f + 1]) of Text
+			struct D2DGeoJsonColumn
+			{
+				std::string Name;
+				bool HasText;
+
+				std::vector<double> Numbers;
+				std::vector<uint32_t> TextOffsets;
+				std::string Text;
+			};
+
+			struct D2DGeoJsonData
+			{
+				D2DGeoJsonGeometry Geometry;
+				std::vector<D2DGeoJsonColumn> Columns;
+			};
+
+			// reads a GeoJSON FeatureCollection, Feature or bare geometry. The features array is split into the byte ranges of
+			// its features by a structural scan, after which chunks of features are parsed in parallel straight into their own
+			// buffers and merged in order. Strings and whitespace are skipped 16 bytes at a time where SSE2 is available
+			class D2DGeoJsonReader
+			{
+			public:
+				// returns false if the data is not valid GeoJSON; the data is UTF-8 and need not be null-terminated
+				static bool Read(const char* data, size_t size, D2DGeoJsonData* result);
+
+			private:
+				struct Range
+				{
+					const char* Begin;
+					const char* End;
+				};
+
+				class Chunk;
+
+				static bool FindFeatures(const char* data, size_t size, std::vector<Range>* features, bool* isSingleGeometry);
+				static void Merge(std::vector<Chunk>& chunks, D2DGeoJsonData* result);
+			};
+		}
+	}
+}
@@ -0,0 +1,89 @@
+#include "pch.h"
+#include "D2DGeometryCache.h"
+
+const long long DefaultGeometryCacheMemoryBudget = 64 * 1024 * 1024;
+
+namespace Telerik
+{
+	namespace UI
+	{
+		namespace Drawing
+		{
+			D2DGeometryCache::D2DGeometryCache(void)
+			{
+				this->memoryBudget = DefaultGeometryCacheMemoryBudget;
+				this->memoryUsage = 0;
+				this->hitCount = 0;
+				this->missCount = 0;
+			}
+
+			bool D2DGeometryCache::TryGetGeometry(unsigned long long key, int band, D2DCachedGeometry *geometry)
+			{
+				CacheKey cacheKey = { key, band };
+
+				auto entry = this->entryMap.find(cacheKey);
+				if(entry == this->entryMap.end())
+				{
+					this->missCount++;
+					return false;
+				}
+
+				// move the entry to the front of the list as the most recently used one
+				this->entries.splice(this->entries.begin(), this->entries, entry->second);
+				*geometry = entry->second->second;
+
+				this->hitCount++;
+				return true;
+			}
+
+			void D2DGeometryCache::AddGeometry(unsigned long long key, int band, const D2DCachedGeometry& geometry)
+			{
+				if(geometry.Cost > this->memoryBudget)
+				{
+					return;
+				}
+
+				CacheKey cacheKey = { key, band };
+
+				auto entry = this->entryMap.find(cacheKey);
+				if(entry != this->entryMap.end())
+				{
+					this->memoryUsage -= entry->second->second.Cost;
+					this->entries.erase(entry->second);
+					this->entryMap.erase(entry);
+				}
+
+				this->entries.push_front(std::make_pair(cacheKey, geometry));
+				this->entryMap[cacheKey] = this->entries.begin();
+				this->memoryUsage += geometry.Cost;
+
+				this->Evict();
+			}
+
+			void D2DGeometryCache::Evict()
+			{
+				while(this->memoryUsage > this->memoryBudget && !this->entries.empty())
+				{
+					auto& last = this->entries.back();
+
+					this->memoryUsage -= last.second.Cost;
+					this->entryMap.erase(last.first);
+					this->entries.pop_back();
+				}
+			}
+
+			void D2DGeometryCache::Clear()
+			{
+				this->entries.clear();
+				this->entryMap.clear();
+				this->memoryUsage = 0;
+			}
+
+			void D2DGeometryCache::ResetStatistics()
+			{
+				this->hitCount = 0;
+				this->missCount = 0;
+			}
+		}
+	}
+}
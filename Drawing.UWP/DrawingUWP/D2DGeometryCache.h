@@ -0,0 +1,89 @@
+#pragma once
+
+#include <list>
+#include <unordered_map>
+
+namespace Telerik
+{
+	namespace UI
+	{
+		namespace Drawing
+		{
+			// a path geometry built for a particular zoom factor and viewport origin, with the mesh its fill is drawn from
+			// when it has one
+			struct D2DCachedGeometry
+			{
+				ComPtr<ID2D1PathGeometry1> Geometry;
+				ComPtr<ID2D1Mesh> FillMesh;
+				double ZoomFactor;
+				DoublePoint Origin;
+				Rect Bounds;
+				long long Cost;
+			};
+
+			ref class D2DGeometryCache
+			{
+			internal:
+				D2DGeometryCache(void);
+
+				bool TryGetGeometry(unsigned long long key, int band, D2DCachedGeometry *geometry);
+				void AddGeometry(unsigned long long key, int band, const D2DCachedGeometry& geometry);
+				void Clear();
+				void ResetStatistics();
+
+				property long long MemoryBudget
+				{
+					long long get() { return this->memoryBudget; }
+					void set(long long value)
+					{
+						this->memoryBudget = value;
+						this->Evict();
+					}
+				}
+
+				property long long MemoryUsage
+				{
+					long long get() { return this->memoryUsage; }
+				}
+
+				property long long HitCount
+				{
+					long long get() { return this->hitCount; }
+				}
+
+				property long long MissCount
+				{
+					long long get() { return this->missCount; }
+				}
+
+			private:
+				struct CacheKey
+				{
+					unsigned long long ShapeKey;
+					int Band;
+
+					bool operator == (const CacheKey& other) const { return this->ShapeKey == other.ShapeKey && this->Band == other.Band; }
+				};
+
+				struct CacheKeyHash
+				{
+					size_t operator () (const CacheKey& key) const { return std::hash<unsigned long long>()(key.ShapeKey * 31 + static_cast<unsigned long long>(key.Band)); }
+				};
+
+				typedef std::list<std::pair<CacheKey, D2DCachedGeometry>> EntryList;
+
+				void Evict();
+
+				// most recently used entries are at the front
+				EntryList entries;
+				std::unordered_map<CacheKey, EntryList::iterator, CacheKeyHash> entryMap;
+
+				long long memoryBudget;
+				long long memoryUsage;
+				long long hitCount;
+				long long missCount;
+			};
+		}
+	}
+}
+
@@ -0,0 +1,97 @@
+#include "pch.h"
+#include "D2DGeometryResidency.h"
+#include "D2DGeometryShape.h"
+
+const long long DefaultGeometryResidencyMemoryBudget = 64 * 1024 * 1024;
+
+namespace Telerik
+{
+	namespace UI
+	{
+		namespace Drawing
+		{
+			D2DGeometryResidency::D2DGeometryResidency(void)
+			{
+				this->memoryBudget = DefaultGeometryResidencyMemoryBudget;
+				this->memoryUsage = 0;
+				this->evictionCount = 0;
+			}
+
+			void D2DGeometryResidency::Touch(D2DGeometryShape^ shape, long long cost)
+			{
+				if(shape->isResident)
+				{
+					// move the entry to the front of the list as the most recently used one
+					this->entries.splice(this->entries.begin(), this->entries, shape->residencyEntry);
+
+					this->memoryUsage += cost - shape->residencyEntry->Cost;
+					shape->residencyEntry->Cost = cost;
+					return;
+				}
+
+				Entry entry = { shape, cost };
+				this->entries.push_front(entry);
+				this->memoryUsage += cost;
+
+				shape->residencyEntry = this->entries.begin();
+				shape->isResident = true;
+			}
+
+			void D2DGeometryResidency::Remove(D2DGeometryShape^ shape)
+			{
+				if(!shape->isResident)
+				{
+					return;
+				}
+
+				this->memoryUsage -= shape->residencyEntry->Cost;
+				this->entries.erase(shape->residencyEntry);
+				shape->isResident = false;
+			}
+
+			void D2DGeometryResidency::Trim(const std::function<bool(D2DGeometryShape^)>& canEvict)
+			{
+				// each entry is visited at most once; the ones that have to stay are moved to the front
+				size_t remaining = this->entries.size();
+
+				while(this->memoryUsage > this->memoryBudget && remaining > 0)
+				{
+					remaining--;
+
+					auto last = std::prev(this->entries.end());
+					D2DGeometryShape^ shape = last->Shape;
+
+					if(!canEvict(shape))
+					{
+						this->entries.splice(this->entries.begin(), this->entries, last);
+						continue;
+					}
+
+					this->memoryUsage -= last->Cost;
+					this->entries.erase(last);
+					shape->isResident = false;
+
+					shape->ReleaseGeometry();
+					this->evictionCount++;
+				}
+			}
+
+			void D2DGeometryResidency::Clear()
+			{
+				for(auto entry = this->entries.begin(); entry != this->entries.end(); ++entry)
+				{
+					entry->Shape->isResident = false;
+					entry->Shape->ReleaseGeometry();
+				}
+
+				this->entries.clear();
+				this->memoryUsage = 0;
+			}
+
+			void D2DGeometryResidency::ResetStatistics()
+			{
+				this->evictionCount = 0;
+			}
+		}
+	}
+}
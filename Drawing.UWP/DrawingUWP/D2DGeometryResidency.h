@@ -0,0 +1,69 @@
+#pragma once
+
+#include <list>
+#include <functional>
+
+namespace Telerik
+{
+	namespace UI
+	{
+		namespace Drawing
+		{
+			ref class D2DGeometryShape;
+
+			// the geometry shapes that currently hold a path geometry, in least recently used order;
+			// geometries of shapes that are not on screen are released once their total cost exceeds the budget
+			ref class D2DGeometryResidency
+			{
+			internal:
+				struct Entry
+				{
+					D2DGeometryShape^ Shape;
+					long long Cost;
+				};
+
+				typedef std::list<Entry> EntryList;
+
+				D2DGeometryResidency(void);
+
+				// marks the geometry of the shape as the most recently used one
+				void Touch(D2DGeometryShape^ shape, long long cost);
+				void Remove(D2DGeometryShape^ shape);
+
+				// releases the least recently used geometries that may be evicted until the usage fits in the budget
+				void Trim(const std::function<bool(D2DGeometryShape^)>& canEvict);
+				void Clear();
+				void ResetStatistics();
+
+				property long long MemoryBudget
+				{
+					long long get() { return this->memoryBudget; }
+					void set(long long value) { this->memoryBudget = value; }
+				}
+
+				property long long MemoryUsage
+				{
+					long long get() { return this->memoryUsage; }
+				}
+
+				property long long EvictionCount
+				{
+					long long get() { return this->evictionCount; }
+				}
+
+				property size_t Count
+				{
+					size_t get() { return this->entries.size(); }
+				}
+
+			private:
+				// most recently used entries are at the front
+				EntryList entries;
+
+				long long memoryBudget;
+				long long memoryUsage;
+				long long evictionCount;
+			};
+		}
+	}
+}
@@ -2,7 +2,21 @@
 #include "D2DGeometryShape.h"
 #include "D2DCanvas.h"
 #include "D2DShapeStyle.h"
+#include "D2DFigureRecorder.h"
+#include "D2DTessellator.h"
+#include "D2DZoomGeometry.h"
 #include <thread>
+#include <atomic>
+
+// approximate memory used by a path geometry, used to account for it in the geometry cache
+const long long GeometryCostOverhead = 256;
+const long long GeometrySegmentCost = 2 * sizeof(D2D1_POINT_2F);
+const long long MeshTriangleCost = sizeof(D2D1_TRIANGLE);
+
+// closed geometries with fewer points are cheap enough for Direct2D to tessellate on every draw
+const size_t MeshFillMinPointCount = 32;
+
+static std::atomic<unsigned long long> nextGeometryKey(1);
 
 namespace Telerik
 {
@@ -15,17 +29,53 @@ namespace Telerik
 				this->isClosed = false;
 				this->renderPrecision = ShapeRenderPrecision::Double;
 				this->fillMode = GeometryFillMode::Alternate;
-				this->scaleTransform = D2D1::Matrix3x2F::Identity();
+				this->geometryZoomFactor = 1;
+				this->geometryKey = nextGeometryKey++;
+				this->hasPointBounds = false;
+				this->geometryCost = 0;
+				this->isResident = false;
+			}
+
+			void D2DGeometryShape::ResetPointBounds()
+			{
+				this->hasPointBounds = false;
+			}
+
+			void D2DGeometryShape::IncludePointBounds(const double* coordinates, size_t pointCount)
+			{
+				D2DPointBounds bounds;
+				if(!D2DPointKernels::ComputeBounds(coordinates, pointCount, &bounds))
+				{
+					return;
+				}
+
+				if(this->hasPointBounds)
+				{
+					D2DPointKernels::UnionBounds(&this->pointBounds, bounds);
+				}
+				else
+				{
+					this->pointBounds = bounds;
+					this->hasPointBounds = true;
+				}
+			}
+
+			void D2DGeometryShape::SetPointBounds(const D2DPointBounds& bounds)
+			{
+				this->pointBounds = bounds;
+				this->hasPointBounds = true;
 			}
 
 			bool D2DGeometryShape::HitTest(Point location)
 			{
 				if(this->geometry != nullptr)
 				{
+					D2D1::Matrix3x2F transform = this->GetGeometryTransform();
+
 					BOOL contains;
 					HRESULT hr = this->geometry->FillContainsPoint(
-						D2D1::Point2F(location.X, location.Y), 
-						&this->scaleTransform, 
+						D2D1::Point2F(location.X, location.Y),
+						&transform,
 						&contains
 						);
 
@@ -47,100 +97,185 @@ namespace Telerik
 				if(clearCache)
 				{
 					this->ResetModelGeometry();
-					this->ResetScaledGeometry();
+
+					// geometries cached for other zoom bands are no longer valid
+					this->geometryKey = nextGeometryKey++;
 				}
 			}
 
+			void D2DGeometryShape::SetOwner(D2DCanvas^ owner)
+			{
+				if(this->isResident && this->Owner != owner)
+				{
+					this->Owner->GeometryResidency->Remove(this);
+				}
+
+				D2DShape::SetOwner(owner);
+			}
+
+			void D2DGeometryShape::ReleaseGeometry()
+			{
+				this->ResetModelGeometry();
+
+				// the next InitRender looks the geometry up in the geometry cache or builds it again
+				this->Invalidate(false);
+			}
+
 			void D2DGeometryShape::ResetModelGeometry()
 			{
+				if(this->isResident)
+				{
+					this->Owner->GeometryResidency->Remove(this);
+				}
+
 				this->geometry.Reset();
 				this->geometry = nullptr;
+				this->fillMesh.Reset();
 				this->modelBounds = Rect(0, 0, 0, 0);
 			}
 
-			void D2DGeometryShape::ResetScaledGeometry()
+			void D2DGeometryShape::Render(D2DRenderContext^ context, Rect invalidRect)
 			{
-				this->scaledGeometry.Reset();
-				this->scaledGeometry = nullptr;
+				if(this->geometry != nullptr)
+				{
+					this->Owner->GeometryResidency->Touch(this, this->geometryCost);
+				}
+
+				// model-space shapes are rendered through the transform pushed by the layer
+				if(this->geometry == nullptr || this->UsesModelTransform())
+				{
+					D2DShape::Render(context, invalidRect);
+					return;
+				}
 
-				this->cachedBounds = Rect(0, 0, 0, 0);
-				this->UpdateScaleTransform();
+				D2D1::Matrix3x2F transform = this->GetGeometryTransform();
+				if(transform.IsIdentity())
+				{
+					D2DShape::Render(context, invalidRect);
+					return;
+				}
+
+				// the geometry was built for another zoom level within the same zoom band
+				context->PushTransform(transform);
+				D2DShape::Render(context, invalidRect);
+				context->PopTransform();
 			}
 
 			Rect D2DGeometryShape::GetBoundsCore()
 			{
 				if(this->geometry == nullptr)
 				{
-					return Rect(0, 0, 0, 0);
-				}
-
-				if(this->modelBounds.Width == 0)
-				{
-					D2D1_RECT_F bounds;
-					if (this->isClosed)
+					if(!this->hasPointBounds || this->Owner == nullptr)
 					{
-						this->geometry->GetBounds(nullptr, &bounds);
-					}
-					else
-					{
-						this->geometry->GetWidenedBounds(
-							this->CurrentStyle->StrokeThicknessAsFloat,
-							nullptr,
-							nullptr,
-							&bounds
-							);
+						return Rect(0, 0, 0, 0);
 					}
 
-					auto width = bounds.right - bounds.left;
-					auto height = bounds.bottom - bounds.top;
+					// known from the points, so off-screen shapes are skipped without materializing their geometry
+					double scale = this->Owner->PixelZoomFactor;
+					DoublePoint origin = this->Owner->PixelRenderOrigin;
 
-					if(width < 0 || height < 0)
-					{
-						this->modelBounds = Rect(0, 0, 0, 0);
-					}
-					else
-					{
-						this->modelBounds = Rect(bounds.left, bounds.top, width, height);
-						this->ApplyStrokeOffsetToBounds(&this->modelBounds);
-					}
+					Rect bounds = Rect(
+						static_cast<float>(this->pointBounds.MinX * scale + origin.X),
+						static_cast<float>(this->pointBounds.MinY * scale + origin.Y),
+						static_cast<float>((this->pointBounds.MaxX - this->pointBounds.MinX) * scale),
+						static_cast<float>((this->pointBounds.MaxY - this->pointBounds.MinY) * scale));
+
+					this->ApplyStrokeOffsetToBounds(&bounds);
+					return bounds;
 				}
 
-				if(this->renderPrecision == ShapeRenderPrecision::Double)
+				D2D1::Matrix3x2F transform = this->GetGeometryTransform();
+				bool usesModelTransform = this->UsesModelTransform();
+
+				if(!usesModelTransform && transform.IsIdentity())
 				{
 					return this->modelBounds;
 				}
 
-				if(this->cachedBounds.Width == 0)
+				// the bounds are mapped to pixels on demand so that zooming and panning never touch the geometry
+				D2D1_POINT_2F location = transform.TransformPoint(D2D1::Point2F(this->modelBounds.X, this->modelBounds.Y));
+
+				Rect bounds = Rect(
+					location.x,
+					location.y,
+					this->modelBounds.Width * transform._11,
+					this->modelBounds.Height * transform._22);
+
+				if(usesModelTransform)
 				{
-					Rect bounds;
+					this->ApplyStrokeOffsetToBounds(&bounds);
+				}
 
-					if(this->Owner->PixelZoomFactor > 1)
-					{
-						D2D1_POINT_2F location = this->scaleTransform.TransformPoint(D2D1::Point2F(this->modelBounds.X, this->modelBounds.Y));
-						bounds = Rect(
-							location.x, 
-							location.y, 
-							this->modelBounds.Width * this->scaleTransform._11, 
-							this->modelBounds.Height * this->scaleTransform._22);
-					}
-					else
-					{
-						bounds = this->modelBounds;
-					}
+				return bounds;
+			}
 
-					this->cachedBounds = bounds;
-					this->ApplyStrokeOffsetToBounds(&this->cachedBounds);
+			Rect D2DGeometryShape::ComputeModelBounds()
+			{
+				if(this->hasPointBounds)
+				{
+					return this->ComputeModelBoundsFromPoints();
 				}
 
-				return this->cachedBounds;
+				D2D1_RECT_F bounds;
+				bool usesModelTransform = this->UsesModelTransform();
+
+				if (this->isClosed || usesModelTransform)
+				{
+					this->geometry->GetBounds(nullptr, &bounds);
+				}
+				else
+				{
+					this->geometry->GetWidenedBounds(
+						this->CurrentStyle->StrokeThicknessAsFloat,
+						nullptr,
+						nullptr,
+						&bounds
+						);
+				}
+
+				auto width = bounds.right - bounds.left;
+				auto height = bounds.bottom - bounds.top;
+
+				if(width < 0 || height < 0)
+				{
+					return Rect(0, 0, 0, 0);
+				}
+
+				Rect modelBounds = Rect(bounds.left, bounds.top, width, height);
+				if(!usesModelTransform)
+				{
+					this->ApplyStrokeOffsetToBounds(&modelBounds);
+				}
+
+				return modelBounds;
+			}
+
+			Rect D2DGeometryShape::ComputeModelBoundsFromPoints()
+			{
+				// the point bounds are mapped to the space the geometry is built in, so the result matches GetBounds of the geometry
+				double scale = this->geometryZoomFactor;
+				Rect modelBounds = Rect(
+					static_cast<float>(this->pointBounds.MinX * scale + this->geometryOrigin.X),
+					static_cast<float>(this->pointBounds.MinY * scale + this->geometryOrigin.Y),
+					static_cast<float>((this->pointBounds.MaxX - this->pointBounds.MinX) * scale),
+					static_cast<float>((this->pointBounds.MaxY - this->pointBounds.MinY) * scale));
+
+				if(!this->UsesModelTransform())
+				{
+					this->ApplyStrokeOffsetToBounds(&modelBounds);
+				}
+
+				return modelBounds;
 			}
 
 			void D2DGeometryShape::ApplyStrokeOffsetToBounds(Rect *bounds)
 			{
 				float strokeThickness = 0;
+				this->ResolveStyle();
 
-				// stroke adjustment necessary only for closed shapes (polygons) as bounds for polylines are already widened by the stroke thickness.
-				if(this->isClosed && this->CurrentStyle->Stroke != nullptr)
+				// stroke adjustment not necessary for pixel-space polylines measured through GetWidenedBounds as their bounds are already widened by the stroke thickness.
+				// bounds computed from the points are inflated analytically instead - round joins never extend a stroke further than half its thickness.
+				if((this->isClosed || this->hasPointBounds || this->UsesModelTransform()) && this->CurrentStyle->Stroke != nullptr)
 				{
 					strokeThickness = this->CurrentStyle->StrokeThicknessAsFloat / 2;
 				}
@@ -159,64 +294,223 @@ namespace Telerik
 				return this->modelBounds;
 			}
 
+			bool D2DGeometryShape::TryGetCullBounds(D2DCullBounds* bounds)
+			{
+				if(this->hasPointBounds)
+				{
+					// known from the points, so culling never forces the geometry to be built
+					bounds->MinX = this->pointBounds.MinX;
+					bounds->MinY = this->pointBounds.MinY;
+					bounds->MaxX = this->pointBounds.MaxX;
+					bounds->MaxY = this->pointBounds.MaxY;
+				}
+				else
+				{
+					if(this->geometry == nullptr)
+					{
+						return false;
+					}
+
+					D2D1_RECT_F geometryBounds;
+					this->geometry->GetBounds(nullptr, &geometryBounds);
+
+					if(geometryBounds.right < geometryBounds.left || geometryBounds.bottom < geometryBounds.top)
+					{
+						return false;
+					}
+
+					// maps the bounds from the space the geometry was built in back to model space
+					double scale = 1 / this->geometryZoomFactor;
+					bounds->MinX = (geometryBounds.left - this->geometryOrigin.X) * scale;
+					bounds->MinY = (geometryBounds.top - this->geometryOrigin.Y) * scale;
+					bounds->MaxX = (geometryBounds.right - this->geometryOrigin.X) * scale;
+					bounds->MaxY = (geometryBounds.bottom - this->geometryOrigin.Y) * scale;
+				}
+
+				// strokes use round joins and never extend further than half their thickness, plus an anti-aliasing pixel
+				this->ResolveStyle();
+				bounds->Padding = 1;
+				if(this->CurrentStyle->Stroke != nullptr)
+				{
+					bounds->Padding += this->CurrentStyle->StrokeThicknessAsFloat / 2;
+				}
+
+				return true;
+			}
+
 			void D2DGeometryShape::OnZoomFactorChanged()
 			{
 				D2DShape::OnZoomFactorChanged();
 
-				if(this->renderPrecision == ShapeRenderPrecision::Double)
+				// model-space geometry is scaled by the layer transform and is never rebuilt on zoom, while pixel-space geometry
+				// is drawn through GetGeometryTransform within its zoom band and looked up in the geometry cache for another band
+				if(this->geometry != nullptr &&
+					D2DZoomGeometry::GetZoomAction(this->UsesModelTransform(), this->geometryZoomFactor, this->Owner->PixelZoomFactor) == D2DZoomAction::Rebuild)
 				{
 					this->ResetModelGeometry();
 				}
-				this->ResetScaledGeometry();
 			}
 
-			void D2DGeometryShape::UpdateScaleTransform()
+			bool D2DGeometryShape::UsesModelTransform()
+			{
+				return this->renderPrecision != ShapeRenderPrecision::Double;
+			}
+
+			void D2DGeometryShape::SetRenderPrecision(ShapeRenderPrecision precision)
 			{
-				if(this->Owner == nullptr)
+				if(this->renderPrecision == precision)
 				{
 					return;
 				}
 
-				if(this->Owner->PixelZoomFactor > 1 && this->renderPrecision != ShapeRenderPrecision::Double)
+				this->renderPrecision = precision;
+
+				// the geometry is built in a different coordinate space, so drop it even if the shape is not rendered yet
+				this->ResetModelGeometry();
+				this->geometryKey = nextGeometryKey++;
+				this->Invalidate(false);
+			}
+
+			void D2DGeometryShape::InitRenderCore(D2DRenderContext^ context)
+			{
+				D2DShape::InitRenderCore(context);
+
+				if(this->geometry != nullptr)
 				{
-					this->scaleTransform = D2D1::Matrix3x2F::Scale(
-						static_cast<float>(this->Owner->PixelZoomFactor),
-						static_cast<float>(this->Owner->PixelZoomFactor),
-						D2D1::Point2F(0, 0)
-						);
+					return;
+				}
+
+				if(this->UsesModelTransform())
+				{
+					this->BuildGeometry(context);
 				}
 				else
 				{
-					this->scaleTransform = D2D1::Matrix3x2F::Identity();
+					auto cache = this->Owner->GeometryCache;
+					int band = D2DZoomGeometry::GetZoomBand(this->Owner->PixelZoomFactor);
+
+					D2DCachedGeometry cachedGeometry;
+					if(cache->TryGetGeometry(this->geometryKey, band, &cachedGeometry))
+					{
+						this->geometry = cachedGeometry.Geometry;
+						this->fillMesh = cachedGeometry.FillMesh;
+						this->geometryZoomFactor = cachedGeometry.ZoomFactor;
+						this->geometryOrigin = cachedGeometry.Origin;
+						this->modelBounds = cachedGeometry.Bounds;
+						this->geometryCost = cachedGeometry.Cost;
+					}
+					else
+					{
+						this->BuildGeometry(context);
+
+						cachedGeometry.Geometry = this->geometry;
+						cachedGeometry.FillMesh = this->fillMesh;
+						cachedGeometry.ZoomFactor = this->geometryZoomFactor;
+						cachedGeometry.Origin = this->geometryOrigin;
+						cachedGeometry.Bounds = this->modelBounds;
+						cachedGeometry.Cost = this->geometryCost;
+
+						cache->AddGeometry(this->geometryKey, band, cachedGeometry);
+					}
 				}
+
+				// only the shapes that are rendered or about to be rendered get here, so the resident geometries follow the viewport
+				this->Owner->GeometryResidency->Touch(this, this->geometryCost);
 			}
 
-			void D2DGeometryShape::InitRenderCore(D2DRenderContext^ context)
+			void D2DGeometryShape::BuildGeometry(D2DRenderContext^ context)
 			{
-				D2DShape::InitRenderCore(context);
+				context->Factory->CreatePathGeometry(&this->geometry);
 
-				if(this->geometry == nullptr)
+				ComPtr<ID2D1GeometrySink> sink;
+				this->geometry->Open(&sink);
+
+				// the figures of a closed geometry are recorded on their way to the sink, so that its fill can be tessellated
+				ComPtr<D2DFigureRecorder> recorder;
+				if(this->isClosed)
 				{
-					context->Factory->CreatePathGeometry(&this->geometry);
+					recorder = Make<D2DFigureRecorder>(sink);
+					this->Populate(recorder);
+				}
+				else
+				{
+					this->Populate(sink);
+				}
 
-					ComPtr<ID2D1GeometrySink> sink;
-					this->geometry->Open(&sink);
+				sink->Close();
 
-					this->Populate(sink);
+				UINT32 segmentCount = 0;
+				this->geometry->GetSegmentCount(&segmentCount);
+				this->geometryCost = GeometryCostOverhead + static_cast<long long>(segmentCount) * GeometrySegmentCost;
+
+				this->fillMesh.Reset();
+				if(recorder != nullptr && recorder->IsTessellable() && recorder->GetCoordinates().size() / 2 >= MeshFillMinPointCount)
+				{
+					this->BuildFillMesh(context, recorder.Get());
+				}
+
+				// model-space geometry is not scaled or translated at all
+				if(this->UsesModelTransform())
+				{
+					this->geometryZoomFactor = 1;
+					this->geometryOrigin.X = 0;
+					this->geometryOrigin.Y = 0;
+				}
+				else
+				{
+					this->geometryZoomFactor = this->Owner->PixelZoomFactor;
+					this->geometryOrigin = this->Owner->PixelViewportOrigin;
+				}
+
+				this->modelBounds = this->ComputeModelBounds();
+			}
 
-					sink->Close();
+			void D2DGeometryShape::BuildFillMesh(D2DRenderContext^ context, const D2DFigureRecorder* recorder)
+			{
+				// the points are in the space the geometry is built in, so the mesh is drawn through the same transform
+				const std::vector<float>& coordinates = recorder->GetCoordinates();
+				std::vector<uint32_t> indices;
+				size_t triangleCount = D2DTessellator::Tessellate(coordinates.data(), recorder->GetRingOffsets().data(), recorder->GetRingCount(), &indices);
+				if(triangleCount == 0)
+				{
+					return;
 				}
 
-				this->UpdateScaleTransform();
+				std::vector<D2D1_TRIANGLE> triangles(triangleCount);
+				for(size_t i = 0; i < triangleCount; i++)
+				{
+					const uint32_t* triangle = indices.data() + 3 * i;
+					triangles[i].point1 = D2D1::Point2F(coordinates[2 * triangle[0]], coordinates[2 * triangle[0] + 1]);
+					triangles[i].point2 = D2D1::Point2F(coordinates[2 * triangle[1]], coordinates[2 * triangle[1] + 1]);
+					triangles[i].point3 = D2D1::Point2F(coordinates[2 * triangle[2]], coordinates[2 * triangle[2] + 1]);
+				}
 
-				if(this->renderPrecision != ShapeRenderPrecision::Double && this->Owner->PixelZoomFactor > 1 && this->scaledGeometry == nullptr)
+				ComPtr<ID2D1Mesh> mesh;
+				ComPtr<ID2D1TessellationSink> sink;
+				if(FAILED(context->DeviceContext->CreateMesh(&mesh)) || FAILED(mesh->Open(&sink)))
 				{
-					context->Factory->CreateTransformedGeometry(
-						this->geometry.Get(),
-						&this->scaleTransform,
-						&this->scaledGeometry
-						);
+					return;
+				}
+
+				sink->AddTriangles(triangles.data(), static_cast<UINT32>(triangleCount));
+				if(FAILED(sink->Close()))
+				{
+					return;
 				}
+
+				this->fillMesh = mesh;
+				this->geometryCost += static_cast<long long>(triangleCount) * MeshTriangleCost;
+			}
+
+			D2D1::Matrix3x2F D2DGeometryShape::GetGeometryTransform()
+			{
+				// maps the geometry from the space it was built in to the current render space of the canvas
+				double scale = this->Owner->PixelZoomFactor / this->geometryZoomFactor;
+				DoublePoint origin = this->Owner->PixelRenderOrigin;
+
+				return D2D1::Matrix3x2F::Scale(static_cast<float>(scale), static_cast<float>(scale)) * D2D1::Matrix3x2F::Translation(
+					static_cast<float>(origin.X - this->geometryOrigin.X * scale),
+					static_cast<float>(origin.Y - this->geometryOrigin.Y * scale));
 			}
 
 			void D2DGeometryShape::Populate(ComPtr<ID2D1GeometrySink> sink)
@@ -231,43 +525,35 @@ namespace Telerik
 					return;
 				}
 
-				if(this->Owner->PixelZoomFactor > 1 && this->renderPrecision != ShapeRenderPrecision::Double)
-				{
-					context->DeviceContext->FillGeometry(
-						this->scaledGeometry.Get(),
-						this->CurrentStyle->Fill->NativeBrush.Get()
-						);
-				}
-				else
+				// meshes are only drawn aliased, so the mesh is used when a stroke of at least a pixel covers its jagged edge
+				if(this->fillMesh != nullptr && this->CurrentStyle->Stroke != nullptr && this->CurrentStyle->StrokeThicknessAsFloat >= 1)
 				{
-					context->DeviceContext->FillGeometry(
-						this->geometry.Get(),
+					auto antialiasMode = context->DeviceContext->GetAntialiasMode();
+					context->DeviceContext->SetAntialiasMode(D2D1_ANTIALIAS_MODE_ALIASED);
+					context->DeviceContext->FillMesh(
+						this->fillMesh.Get(),
 						this->CurrentStyle->Fill->NativeBrush.Get()
 						);
+					context->DeviceContext->SetAntialiasMode(antialiasMode);
+					return;
 				}
+
+				context->DeviceContext->FillGeometry(
+					this->geometry.Get(),
+					this->CurrentStyle->Fill->NativeBrush.Get()
+					);
 			}
 
 			void D2DGeometryShape::RenderStroke(D2DRenderContext^ context)
 			{
-				if(this->Owner->PixelZoomFactor > 1 && this->renderPrecision != ShapeRenderPrecision::Double)
-				{
-					context->DeviceContext->DrawGeometry(
-						this->scaledGeometry.Get(),
-						this->CurrentStyle->Stroke->NativeBrush.Get(),
-						this->CurrentStyle->StrokeThicknessAsFloat,
-						context->StrokeStyle.Get()
-						);
-				}
-				else
-				{
-					context->DeviceContext->DrawGeometry(
-						this->geometry.Get(),
-						this->CurrentStyle->Stroke->NativeBrush.Get(),
-						this->CurrentStyle->StrokeThicknessAsFloat,
-						context->StrokeStyle.Get()
-						);
-				}
-			}			
+				// the fixed stroke style keeps the stroke thickness in pixels while the geometry is scaled by a transform
+				context->DeviceContext->DrawGeometry(
+					this->geometry.Get(),
+					this->CurrentStyle->Stroke->NativeBrush.Get(),
+					this->CurrentStyle->StrokeThicknessAsFloat,
+					context->FixedStrokeStyle.Get()
+					);
+			}
 		}
 	}
 }
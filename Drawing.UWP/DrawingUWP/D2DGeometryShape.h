@@ -1,6 +1,8 @@
 #pragma once
 
 #include "D2DShape.h"
+#include "D2DPointKernels.h"
+#include "D2DGeometryResidency.h"
 
 namespace Telerik
 {
@@ -8,6 +10,8 @@ namespace Telerik
 	{
 		namespace Drawing
 		{
+			class D2DFigureRecorder;
+
 			[Windows::Foundation::Metadata::WebHostHidden]
 			public ref class D2DGeometryShape : D2DShape
 			{
@@ -37,45 +41,77 @@ namespace Telerik
 					ShapeRenderPrecision get() { return this->renderPrecision; }
 					void set(ShapeRenderPrecision value)
 					{
-						this->renderPrecision = value;
-						this->Invalidate(true);
+						this->SetRenderPrecision(value);
 					}
 				}
 
 			internal:
 				D2DGeometryShape(void);
 
+				virtual void Render(D2DRenderContext^ context, Rect invalidRect) override;
 				virtual Rect GetBoundsCore() override;
 				virtual Rect GetModelBoundsCore() override;
+				virtual bool TryGetCullBounds(D2DCullBounds* bounds) override;
 
 				virtual void Populate(ComPtr<ID2D1GeometrySink> sink);
 
 				virtual void OnZoomFactorChanged() override;
+				virtual bool UsesModelTransform() override;
+				virtual void SetRenderPrecision(ShapeRenderPrecision precision) override;
 
 				virtual bool HitTest(Point location) override;
+				virtual void SetOwner(D2DCanvas^ owner) override;
+
+				// drops the geometry of a shape that is off screen; it is materialized again on the next render
+				void ReleaseGeometry();
 
 			private protected:
-				void UpdateScaleTransform();
 				virtual void RenderFill(D2DRenderContext^ context) override;
 				virtual void RenderStroke(D2DRenderContext^ context) override;
 				
 				virtual void InvalidateCore(bool clearCache) override;
 				virtual void InitRenderCore(D2DRenderContext^ context) override;
 
-				D2D1::Matrix3x2F scaleTransform;
 				ShapeRenderPrecision renderPrecision;
 
+				// the model bounds of the source points, known without building the geometry
+				void ResetPointBounds();
+				void IncludePointBounds(const double* coordinates, size_t pointCount);
+				void SetPointBounds(const D2DPointBounds& bounds);
+
 			private:
 				void ResetModelGeometry();
-				void ResetScaledGeometry();
+				void BuildGeometry(D2DRenderContext^ context);
+				void BuildFillMesh(D2DRenderContext^ context, const D2DFigureRecorder* recorder);
+				Rect ComputeModelBounds();
+				Rect ComputeModelBoundsFromPoints();
 				void ApplyStrokeOffsetToBounds(Rect *bounds);
+				D2D1::Matrix3x2F GetGeometryTransform();
 
 				ComPtr<ID2D1PathGeometry1> geometry;
-				ComPtr<ID2D1TransformedGeometry> scaledGeometry;
+
+				// the triangles of the fill of a closed geometry, built with it, which spare Direct2D from tessellating the
+				// geometry again on every draw
+				ComPtr<ID2D1Mesh> fillMesh;
+
 				GeometryFillMode fillMode;
 				bool isClosed;
 				Rect modelBounds;
-				Rect cachedBounds;
+				D2DPointBounds pointBounds;
+				bool hasPointBounds;
+
+				// the zoom factor and viewport origin the geometry was built for
+				double geometryZoomFactor;
+				DoublePoint geometryOrigin;
+
+				// identifies the geometry of this shape in the canvas geometry cache; renewed whenever the geometry source changes
+				unsigned long long geometryKey;
+
+				// the approximate memory used by the geometry and its entry in the residency list of the owner
+				friend ref class D2DGeometryResidency;
+				long long geometryCost;
+				bool isResident;
+				D2DGeometryResidency::EntryList::iterator residencyEntry;
 			};
 		}
 	}
@@ -0,0 +1,351 @@
+#include "pch.h"
+#include "D2DHeatmap.h"
+#include "D2DShapeStyle.h"
+#include "D2DCanvas.h"
+#include <algorithm>
+
+// the size, in pixels, of the tiles the density is computed and cached in
+const uint32_t DensityTileSize = 256;
+
+// the tiles kept besides the visible ones, so that panning back and forth does not compute them again
+const size_t MinCachedDensityTiles = 16;
+
+const float DefaultDensityRadius = 24;
+
+// transparent blue to red through cyan, lime and yellow, as straight ARGB
+const uint32_t DefaultDensityGradient[] = { 0x000000FF, 0xFF0000FF, 0xFF00FFFF, 0xFF00FF00, 0xFFFFFF00, 0xFFFF0000 };
+
+namespace Telerik
+{
+	namespace UI
+	{
+		namespace Drawing
+		{
+			D2DHeatmap::D2DHeatmap(void)
+			{
+				this->radius = DefaultDensityRadius;
+				this->maximumDensity = 0;
+				this->tilesZoomFactor = 0;
+				this->tilesMaxValue = -1;
+
+				this->colorMap.resize(256);
+				D2DDensityGrid::BuildColorMap(DefaultDensityGradient, sizeof(DefaultDensityGradient) / sizeof(DefaultDensityGradient[0]), this->colorMap.data());
+			}
+
+			void D2DHeatmap::SetPoints(IIterable<DoublePoint>^ points, IIterable<float>^ weights)
+			{
+				static_assert(sizeof(DoublePoint) == 2 * sizeof(double), "DoublePoint must be laid out as interleaved coordinates");
+
+				std::vector<DoublePoint> pointsArray;
+				std::vector<float> weightsArray;
+
+				if(points != nullptr)
+				{
+					IIterator<DoublePoint>^ iterator = points->First();
+					while(iterator->HasCurrent)
+					{
+						pointsArray.push_back(iterator->Current);
+						iterator->MoveNext();
+					}
+				}
+
+				if(weights != nullptr)
+				{
+					IIterator<float>^ iterator = weights->First();
+					while(iterator->HasCurrent && weightsArray.size() < pointsArray.size())
+					{
+						weightsArray.push_back(iterator->Current);
+						iterator->MoveNext();
+					}
+
+					// points without a weight weigh one
+					weightsArray.resize(pointsArray.size(), 1.0f);
+				}
+
+				this->grid.SetPoints(reinterpret_cast<const double*>(pointsArray.data()), weights != nullptr ? weightsArray.data() : nullptr, pointsArray.size());
+				this->ResetTiles();
+				this->Invalidate(true);
+			}
+
+			void D2DHeatmap::SetGradient(IIterable<Windows::UI::Color>^ colors)
+			{
+				std::vector<uint32_t> stops;
+
+				if(colors != nullptr)
+				{
+					IIterator<Windows::UI::Color>^ iterator = colors->First();
+					while(iterator->HasCurrent)
+					{
+						auto color = iterator->Current;
+						stops.push_back((static_cast<uint32_t>(color.A) << 24) | (static_cast<uint32_t>(color.R) << 16) | (static_cast<uint32_t>(color.G) << 8) | color.B);
+						iterator->MoveNext();
+					}
+				}
+
+				if(stops.empty())
+				{
+					stops.assign(DefaultDensityGradient, DefaultDensityGradient + sizeof(DefaultDensityGradient) / sizeof(DefaultDensityGradient[0]));
+				}
+
+				D2DDensityGrid::BuildColorMap(stops.data(), stops.size(), this->colorMap.data());
+
+				// the values of the tiles stay valid, only their bitmaps are colored again
+				for(auto tile = this->tiles.begin(); tile != this->tiles.end(); ++tile)
+				{
+					tile->second.ColorizedMaxValue = -1;
+				}
+
+				this->Invalidate(false);
+			}
+
+			void D2DHeatmap::Render(D2DRenderContext^ context, Rect invalidRect)
+			{
+				double zoomFactor = this->Owner->PixelZoomFactor;
+				if(this->grid.IsEmpty() || zoomFactor <= 0)
+				{
+					return;
+				}
+
+				// the kernel is sized in pixels, so every tile changes with the zoom factor
+				if(zoomFactor != this->tilesZoomFactor)
+				{
+					this->ResetTiles();
+					this->tilesZoomFactor = zoomFactor;
+				}
+
+				// the tiles in view, limited to the ones the points can reach
+				Rect bounds = this->GetBounds();
+				if(!bounds.IntersectsWith(invalidRect))
+				{
+					return;
+				}
+
+				DoublePoint origin = this->Owner->PixelRenderOrigin;
+				float left = (std::max)(bounds.X, invalidRect.X);
+				float top = (std::max)(bounds.Y, invalidRect.Y);
+				float right = (std::min)(bounds.X + bounds.Width, invalidRect.X + invalidRect.Width);
+				float bottom = (std::min)(bounds.Y + bounds.Height, invalidRect.Y + invalidRect.Height);
+
+				int32_t firstX = static_cast<int32_t>(floor((left - origin.X) / DensityTileSize));
+				int32_t firstY = static_cast<int32_t>(floor((top - origin.Y) / DensityTileSize));
+				int32_t lastX = static_cast<int32_t>(floor((right - origin.X) / DensityTileSize));
+				int32_t lastY = static_cast<int32_t>(floor((bottom - origin.Y) / DensityTileSize));
+
+				std::vector<uint64_t> visibleKeys;
+				std::vector<uint64_t> missingKeys;
+				for(int32_t y = firstY; y <= lastY; y++)
+				{
+					for(int32_t x = firstX; x <= lastX; x++)
+					{
+						uint64_t key = GetTileKey(x, y);
+						visibleKeys.push_back(key);
+
+						if(this->tiles.find(key) == this->tiles.end())
+						{
+							missingKeys.push_back(key);
+						}
+					}
+				}
+
+				this->ComputeTiles(missingKeys);
+
+				// the scale is taken from all points rather than from the cached tiles, which change as the view is panned; the
+				// tiles of the viewport buffer are colored on the same scale as the tiles rendered after them
+				float maxValue = this->maximumDensity;
+				if(maxValue <= 0)
+				{
+					if(this->tilesMaxValue < 0)
+					{
+						this->tilesMaxValue = this->grid.GetMaxDensity(this->tilesZoomFactor, this->radius);
+					}
+
+					maxValue = this->tilesMaxValue;
+				}
+
+				for(auto key = visibleKeys.begin(); key != visibleKeys.end(); ++key)
+				{
+					this->DrawTile(context, &this->tiles[*key], static_cast<int32_t>(*key & 0xFFFFFFFF), static_cast<int32_t>(*key >> 32), maxValue);
+				}
+
+				this->TrimTiles(visibleKeys);
+			}
+
+			void D2DHeatmap::ComputeTiles(const std::vector<uint64_t>& keys)
+			{
+				if(keys.empty())
+				{
+					return;
+				}
+
+				std::vector<D2DDensityTile> requests;
+				for(auto key = keys.begin(); key != keys.end(); ++key)
+				{
+					Tile& tile = this->tiles[*key];
+					tile.Values.resize(DensityTileSize * DensityTileSize);
+					tile.MaxValue = 0;
+					tile.ColorizedMaxValue = -1;
+
+					D2DDensityTile request = { static_cast<int32_t>(*key & 0xFFFFFFFF), static_cast<int32_t>(*key >> 32), tile.Values.data(), 0 };
+					requests.push_back(request);
+				}
+
+				this->grid.AccumulateTiles(requests.data(), requests.size(), DensityTileSize, this->tilesZoomFactor, this->radius);
+
+				for(auto request = requests.begin(); request != requests.end(); ++request)
+				{
+					this->tiles[GetTileKey(request->X, request->Y)].MaxValue = request->MaxValue;
+				}
+			}
+
+			void D2DHeatmap::DrawTile(D2DRenderContext^ context, Tile* tile, int32_t x, int32_t y, float maxValue)
+			{
+				if(tile->MaxValue <= 0)
+				{
+					return;
+				}
+
+				if(tile->Bitmap == nullptr || tile->ColorizedMaxValue != maxValue)
+				{
+					this->pixels.resize(DensityTileSize * DensityTileSize);
+					D2DDensityGrid::Colorize(tile->Values.data(), tile->Values.size(), maxValue, this->colorMap.data(), this->pixels.data());
+
+					UINT32 pitch = DensityTileSize * sizeof(uint32_t);
+					if(tile->Bitmap == nullptr)
+					{
+						D2D1_BITMAP_PROPERTIES properties = D2D1::BitmapProperties(
+							D2D1::PixelFormat(DXGI_FORMAT_B8G8R8A8_UNORM, D2D1_ALPHA_MODE_PREMULTIPLIED),
+							context->DPI,
+							context->DPI);
+
+						if(!SUCCEEDED(context->DeviceContext->CreateBitmap(D2D1::SizeU(DensityTileSize, DensityTileSize), this->pixels.data(), pitch, properties, &tile->Bitmap)))
+						{
+							tile->Bitmap.Reset();
+							return;
+						}
+					}
+					else
+					{
+						tile->Bitmap->CopyFromMemory(nullptr, this->pixels.data(), pitch);
+					}
+
+					tile->ColorizedMaxValue = maxValue;
+				}
+
+				DoublePoint origin = this->Owner->PixelRenderOrigin;
+				float left = static_cast<float>(static_cast<double>(x) * DensityTileSize + origin.X);
+				float top = static_cast<float>(static_cast<double>(y) * DensityTileSize + origin.Y);
+
+				context->DeviceContext->DrawBitmap(
+					tile->Bitmap.Get(),
+					D2D1::RectF(left, top, left + DensityTileSize, top + DensityTileSize),
+					1,
+					D2D1_BITMAP_INTERPOLATION_MODE_LINEAR
+					);
+			}
+
+			void D2DHeatmap::TrimTiles(const std::vector<uint64_t>& visibleKeys)
+			{
+				if(this->tiles.size() <= 2 * visibleKeys.size() + MinCachedDensityTiles)
+				{
+					return;
+				}
+
+				std::unordered_map<uint64_t, Tile> visibleTiles;
+				for(auto key = visibleKeys.begin(); key != visibleKeys.end(); ++key)
+				{
+					auto tile = this->tiles.find(*key);
+					if(tile != this->tiles.end())
+					{
+						visibleTiles[*key] = std::move(tile->second);
+					}
+				}
+
+				this->tiles.swap(visibleTiles);
+			}
+
+			void D2DHeatmap::ResetTiles()
+			{
+				this->tiles.clear();
+				this->tilesZoomFactor = 0;
+				this->tilesMaxValue = -1;
+			}
+
+			void D2DHeatmap::OnDisplayInvalidated()
+			{
+				D2DShape::OnDisplayInvalidated();
+
+				// the bitmaps belong to the device of the render context, while the values can be colored again on the new one
+				for(auto tile = this->tiles.begin(); tile != this->tiles.end(); ++tile)
+				{
+					tile->second.Bitmap.Reset();
+				}
+			}
+
+			bool D2DHeatmap::HitTest(Point location)
+			{
+				if(this->Owner == nullptr || this->tilesZoomFactor != this->Owner->PixelZoomFactor)
+				{
+					return false;
+				}
+
+				DoublePoint origin = this->Owner->PixelRenderOrigin;
+				double x = location.X - origin.X;
+				double y = location.Y - origin.Y;
+				int32_t tileX = static_cast<int32_t>(floor(x / DensityTileSize));
+				int32_t tileY = static_cast<int32_t>(floor(y / DensityTileSize));
+
+				auto tile = this->tiles.find(GetTileKey(tileX, tileY));
+				if(tile == this->tiles.end() || tile->second.MaxValue <= 0)
+				{
+					return false;
+				}
+
+				// the pixels with any density are part of the shape
+				uint32_t column = (std::min)(static_cast<uint32_t>(x - static_cast<double>(tileX) * DensityTileSize), DensityTileSize - 1);
+				uint32_t row = (std::min)(static_cast<uint32_t>(y - static_cast<double>(tileY) * DensityTileSize), DensityTileSize - 1);
+
+				return tile->second.Values[row * DensityTileSize + column] > 0;
+			}
+
+			Rect D2DHeatmap::GetBoundsCore()
+			{
+				if(this->grid.IsEmpty() || this->Owner == nullptr)
+				{
+					return Rect(0, 0, 0, 0);
+				}
+
+				double minX, minY, maxX, maxY;
+				this->grid.GetBounds(&minX, &minY, &maxX, &maxY);
+
+				double zoomFactor = this->Owner->PixelZoomFactor;
+				DoublePoint origin = this->Owner->PixelRenderOrigin;
+				float padding = this->GetPadding();
+
+				return Rect(
+					static_cast<float>(minX * zoomFactor + origin.X) - padding,
+					static_cast<float>(minY * zoomFactor + origin.Y) - padding,
+					static_cast<float>((maxX - minX) * zoomFactor) + 2 * padding,
+					static_cast<float>((maxY - minY) * zoomFactor) + 2 * padding);
+			}
+
+			bool D2DHeatmap::TryGetCullBounds(D2DCullBounds* bounds)
+			{
+				if(this->grid.IsEmpty())
+				{
+					return false;
+				}
+
+				this->grid.GetBounds(&bounds->MinX, &bounds->MinY, &bounds->MaxX, &bounds->MaxY);
+				bounds->Padding = this->GetPadding();
+
+				return true;
+			}
+
+			float D2DHeatmap::GetPadding()
+			{
+				// the kernel reaches its radius around a point, plus a pixel for the point's own bin
+				return ceilf(this->radius) + 1;
+			}
+		}
+	}
+}
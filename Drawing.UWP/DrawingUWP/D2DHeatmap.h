@@ -0,0 +1,98 @@
+#pragma once
+
+#include "D2DShape.h"
+#include "D2DDensityGrid.h"
+#include <collection.h>
+#include <unordered_map>
+
+namespace Telerik
+{
+	namespace UI
+	{
+		namespace Drawing
+		{
+			// renders the density of a large set of weighted points as a color-mapped image: the density is computed in
+			// tiles aligned to the pixels of the zoom factor, so panning only computes the tiles that come into view
+			[Windows::Foundation::Metadata::WebHostHidden]
+			public ref class D2DHeatmap sealed : D2DShape
+			{
+			public:
+				D2DHeatmap(void);
+
+				// the weights may be null, in which case every point weighs one
+				void SetPoints(IIterable<DoublePoint>^ points, IIterable<float>^ weights);
+
+				// the colors of the gradient, evenly spaced from the lowest density to the highest one
+				void SetGradient(IIterable<Windows::UI::Color>^ colors);
+
+				// the radius, in pixels, of the kernel spread around each point
+				property float Radius
+				{
+					float get() { return this->radius; }
+					void set(float value)
+					{
+						this->radius = value;
+						this->ResetTiles();
+						this->Invalidate(true);
+					}
+				}
+
+				// the density mapped to the last color of the gradient; when zero, the highest density of all points at the current zoom
+				// is used, so that the colors of a tile do not depend on the tiles that were computed before it
+				property float MaximumDensity
+				{
+					float get() { return this->maximumDensity; }
+					void set(float value)
+					{
+						this->maximumDensity = value;
+						this->Invalidate(false);
+					}
+				}
+
+				property int PointCount
+				{
+					int get() { return static_cast<int>(this->grid.GetPointCount()); }
+				}
+
+			internal:
+				virtual void Render(D2DRenderContext^ context, Rect invalidRect) override;
+				virtual Rect GetBoundsCore() override;
+				virtual bool TryGetCullBounds(D2DCullBounds* bounds) override;
+				virtual bool HitTest(Point location) override;
+				virtual void OnDisplayInvalidated() override;
+
+			private:
+				struct Tile
+				{
+					std::vector<float> Values;
+					float MaxValue;
+
+					// the max value the bitmap was colored for; the bitmap is colored again when the max value changes
+					ComPtr<ID2D1Bitmap> Bitmap;
+					float ColorizedMaxValue;
+				};
+
+				static uint64_t GetTileKey(int32_t x, int32_t y) { return (static_cast<uint64_t>(static_cast<uint32_t>(y)) << 32) | static_cast<uint32_t>(x); }
+
+				void ComputeTiles(const std::vector<uint64_t>& keys);
+				void DrawTile(D2DRenderContext^ context, Tile* tile, int32_t x, int32_t y, float maxValue);
+				void TrimTiles(const std::vector<uint64_t>& visibleKeys);
+				void ResetTiles();
+				float GetPadding();
+
+				D2DDensityGrid grid;
+				std::unordered_map<uint64_t, Tile> tiles;
+				double tilesZoomFactor;
+
+				// the highest density at the zoom factor of the tiles, negative until it is computed
+				float tilesMaxValue;
+
+				std::vector<uint32_t> colorMap;
+				std::vector<uint32_t> pixels;
+
+				float radius;
+				float maximumDensity;
+			};
+		}
+	}
+}
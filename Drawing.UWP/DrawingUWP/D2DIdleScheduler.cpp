@@ -0,0 +1,54 @@
+#include "pch.h"
+#include "D2DIdleScheduler.h"
+
+namespace Telerik
+{
+	namespace UI
+	{
+		namespace Drawing
+		{
+			D2DIdleScheduler::D2DIdleScheduler()
+				: clock(std::chrono::steady_clock::now), nextSequence(0)
+			{
+			}
+
+			D2DIdleScheduler::D2DIdleScheduler(Clock clock)
+				: clock(clock), nextSequence(0)
+			{
+			}
+
+			void D2DIdleScheduler::Post(IdleWorkPriority priority, std::function<void()> work)
+			{
+				WorkItem item = { static_cast<int>(priority), this->nextSequence++, work };
+				this->items.push(item);
+			}
+
+			size_t D2DIdleScheduler::RunUntil(TimePoint deadline, const std::function<bool()>& shouldYield)
+			{
+				size_t count = 0;
+
+				while(!this->items.empty())
+				{
+					if(this->clock() >= deadline || (shouldYield && shouldYield()))
+					{
+						break;
+					}
+
+					// the item is removed before it runs as it may post new work
+					std::function<void()> work = this->items.top().Work;
+					this->items.pop();
+
+					work();
+					count++;
+				}
+
+				return count;
+			}
+
+			void D2DIdleScheduler::Clear()
+			{
+				this->items = std::priority_queue<WorkItem, std::vector<WorkItem>, WorkItemOrder>();
+			}
+		}
+	}
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <queue>
+#include <vector>
+
+namespace Telerik
+{
+	namespace UI
+	{
+		namespace Drawing
+		{
+			// the priority of work executed while the canvas is idle; lower values run first
+			enum class IdleWorkPriority
+			{
+				Prefetch = 0,
+				WarmUp = 1
+			};
+
+			// runs queued work items by priority (and in order of posting within a priority) until a deadline passes
+			// or the owner asks to yield; it does not depend on the platform so that it can be driven by a fake clock
+			class D2DIdleScheduler
+			{
+			public:
+				typedef std::chrono::steady_clock::time_point TimePoint;
+				typedef std::function<TimePoint()> Clock;
+
+				D2DIdleScheduler();
+				explicit D2DIdleScheduler(Clock clock);
+
+				void Post(IdleWorkPriority priority, std::function<void()> work);
+
+				// returns the number of work items executed; a work item is never interrupted once started
+				size_t RunUntil(TimePoint deadline, const std::function<bool()>& shouldYield);
+				void Clear();
+
+				size_t GetPendingCount() const { return this->items.size(); }
+				bool IsEmpty() const { return this->items.empty(); }
+
+			private:
+				struct WorkItem
+				{
+					int Priority;
+					unsigned long long Sequence;
+					std::function<void()> Work;
+				};
+
+				struct WorkItemOrder
+				{
+					bool operator () (const WorkItem& first, const WorkItem& second) const
+					{
+						if(first.Priority != second.Priority)
+						{
+							return first.Priority > second.Priority;
+						}
+
+						return first.Sequence > second.Sequence;
+					}
+				};
+
+				std::priority_queue<WorkItem, std::vector<WorkItem>, WorkItemOrder> items;
+				Clock clock;
+				unsigned long long nextSequence;
+			};
+		}
+	}
+}
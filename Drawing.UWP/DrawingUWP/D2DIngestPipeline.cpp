@@ -0,0 +1,263 @@
+#include "pch.h"
+#include "D2DIngestPipeline.h"
+#include "D2DLayerCacheFile.h"
+#include "D2DPointKernels.h"
+#include <algorithm>
+#include <limits>
+#include <map>
+
+// each queue holds up to this many batches per worker of the stage reading it: enough to keep the workers busy while the
+// stage before them is briefly slower, and few enough that a slow consumer stalls the decoder after a handful of batches
+const size_t IngestQueueBatchesPerWorker = 2;
+
+namespace Telerik
+{
+	namespace UI
+	{
+		namespace Drawing
+		{
+			D2DIngestPipeline::D2DIngestPipeline() : status(D2DIngestStatus::Completed), publishedFeatureCount(0)
+			{
+			}
+
+			D2DIngestPipeline::~D2DIngestPipeline()
+			{
+				this->Cancel();
+				this->Wait();
+			}
+
+			bool D2DIngestPipeline::Start(const Decoder& decoder, const Projector& projector, const Consumer& consumer, const Completion& completion, size_t workerCount)
+			{
+				if(!this->threads.empty() || !decoder || !consumer)
+				{
+					return false;
+				}
+
+				if(workerCount == 0)
+				{
+					workerCount = (std::max)(std::thread::hardware_concurrency(), 1u);
+				}
+
+				std::vector<std::function<void (D2DIngestBatch*)>> bodies;
+				if(projector)
+				{
+					bodies.push_back(projector);
+				}
+
+				// the simplification ranks are computed from the projected coordinates, the same as in a layer cache
+				bodies.push_back(&D2DIngestPipeline::RankBatch);
+				bodies.push_back(&D2DIngestPipeline::BoundBatch);
+
+				this->stages.clear();
+				for(auto body = bodies.begin(); body != bodies.end(); ++body)
+				{
+					std::unique_ptr<Stage> stage(new Stage());
+					stage->Body = *body;
+					stage->Input.reset(new BatchQueue(workerCount * IngestQueueBatchesPerWorker));
+					stage->RunningWorkers = workerCount;
+					this->stages.push_back(std::move(stage));
+				}
+
+				// publishing is sequential, so its queue only needs to absorb the batches that finish out of order
+				this->publishQueue.reset(new BatchQueue(workerCount * IngestQueueBatchesPerWorker));
+
+				// the batches the queues hold, one in each worker, one being decoded and one being consumed
+				size_t stageCount = this->stages.size();
+				this->batchSlots.reset(new D2DBoundedQueue<size_t>((stageCount + 1) * workerCount * IngestQueueBatchesPerWorker + stageCount * workerCount + 2));
+				this->publishedFeatureCount = 0;
+				this->status = D2DIngestStatus::Running;
+
+				this->threads.push_back(std::thread(&D2DIngestPipeline::Decode, this, decoder));
+				for(size_t i = 0; i < this->stages.size(); i++)
+				{
+					BatchQueue* output = i + 1 < this->stages.size() ? this->stages[i + 1]->Input.get() : this->publishQueue.get();
+					for(size_t worker = 0; worker < workerCount; worker++)
+					{
+						this->threads.push_back(std::thread(&D2DIngestPipeline::Transform, this, this->stages[i].get(), output));
+					}
+				}
+				this->threads.push_back(std::thread(&D2DIngestPipeline::Publish, this, consumer, completion));
+
+				return true;
+			}
+
+			void D2DIngestPipeline::Cancel()
+			{
+				this->Finish(D2DIngestStatus::Cancelled);
+				this->CancelQueues();
+			}
+
+			D2DIngestStatus D2DIngestPipeline::Wait()
+			{
+				// must not be called from the consumer, which runs on one of the joined threads
+				for(auto thread = this->threads.begin(); thread != this->threads.end(); ++thread)
+				{
+					thread->join();
+				}
+				this->threads.clear();
+
+				return this->status.load();
+			}
+
+			void D2DIngestPipeline::Decode(Decoder decoder)
+			{
+				BatchQueue* output = this->stages.front()->Input.get();
+
+				size_t firstFeature = 0;
+				for(size_t sequence = 0; this->status.load() == D2DIngestStatus::Running; sequence++)
+				{
+					// blocks while the consumer is behind; fails once the pipeline is cancelled
+					if(!this->batchSlots->Push(sequence))
+					{
+						return;
+					}
+
+					std::unique_ptr<D2DIngestBatch> batch(new D2DIngestBatch());
+					batch->Sequence = sequence;
+					batch->FirstFeature = firstFeature;
+
+					D2DDecodeResult result = decoder(batch.get());
+					if(result == D2DDecodeResult::Failed)
+					{
+						this->Finish(D2DIngestStatus::Failed);
+						this->CancelQueues();
+						return;
+					}
+
+					if(result == D2DDecodeResult::Done)
+					{
+						break;
+					}
+
+					firstFeature += batch->GetFeatureCount();
+
+					// blocks while the next stage is behind; fails once the pipeline is cancelled
+					if(!output->Push(std::move(batch)))
+					{
+						return;
+					}
+				}
+
+				output->Close();
+			}
+
+			void D2DIngestPipeline::Transform(Stage* stage, BatchQueue* output)
+			{
+				std::unique_ptr<D2DIngestBatch> batch;
+				while(stage->Input->Pop(&batch))
+				{
+					stage->Body(batch.get());
+
+					if(!output->Push(std::move(batch)))
+					{
+						break;
+					}
+				}
+
+				// the last worker of a stage to run out of batches tells the next stage that no more are coming
+				if(stage->RunningWorkers.fetch_sub(1) == 1)
+				{
+					output->Close();
+				}
+			}
+
+			void D2DIngestPipeline::Publish(Consumer consumer, Completion completion)
+			{
+				// the parallel stages finish the batches out of order; they are held back until their predecessors arrive
+				std::map<size_t, std::unique_ptr<D2DIngestBatch>> pending;
+				size_t nextSequence = 0;
+
+				std::unique_ptr<D2DIngestBatch> batch;
+				while(this->publishQueue->Pop(&batch))
+				{
+					size_t sequence = batch->Sequence;
+					pending[sequence] = std::move(batch);
+
+					while(!pending.empty() && pending.begin()->first == nextSequence)
+					{
+						std::unique_ptr<D2DIngestBatch> next = std::move(pending.begin()->second);
+						pending.erase(pending.begin());
+
+						size_t featureCount = next->GetFeatureCount();
+						if(!consumer(std::move(next)))
+						{
+							this->Cancel();
+							break;
+						}
+
+						this->publishedFeatureCount += featureCount;
+						nextSequence++;
+
+						size_t slot;
+						this->batchSlots->Pop(&slot);
+					}
+				}
+
+				// a cancelled or failed pipeline keeps its status
+				this->Finish(D2DIngestStatus::Completed);
+
+				if(completion)
+				{
+					completion(this->status.load());
+				}
+			}
+
+			void D2DIngestPipeline::Finish(D2DIngestStatus status)
+			{
+				D2DIngestStatus running = D2DIngestStatus::Running;
+				this->status.compare_exchange_strong(running, status);
+			}
+
+			void D2DIngestPipeline::CancelQueues()
+			{
+				for(auto stage = this->stages.begin(); stage != this->stages.end(); ++stage)
+				{
+					(*stage)->Input->Cancel();
+				}
+
+				if(this->publishQueue)
+				{
+					this->publishQueue->Cancel();
+				}
+
+				if(this->batchSlots)
+				{
+					this->batchSlots->Cancel();
+				}
+			}
+
+			void D2DIngestPipeline::RankBatch(D2DIngestBatch* batch)
+			{
+				size_t partCount = batch->PointOffsets.size() - 1;
+				batch->Ranks.resize(batch->Coordinates.size() / 2);
+
+				for(size_t part = 0; part < partCount; part++)
+				{
+					uint32_t start = batch->PointOffsets[part];
+					D2DLayerCacheWriter::RankPoints(batch->Coordinates.data() + 2 * static_cast<size_t>(start), batch->PointOffsets[part + 1] - start, batch->Ranks.data() + start);
+				}
+			}
+
+			void D2DIngestPipeline::BoundBatch(D2DIngestBatch* batch)
+			{
+				size_t featureCount = batch->GetFeatureCount();
+				batch->Bounds.assign(4 * featureCount, std::numeric_limits<double>::quiet_NaN());
+
+				for(size_t feature = 0; feature < featureCount; feature++)
+				{
+					uint32_t start = batch->PointOffsets[batch->PartOffsets[feature]];
+					uint32_t end = batch->PointOffsets[batch->PartOffsets[feature + 1]];
+
+					D2DPointBounds bounds;
+					if(D2DPointKernels::ComputeBounds(batch->Coordinates.data() + 2 * static_cast<size_t>(start), end - start, &bounds))
+					{
+						batch->Bounds[4 * feature] = bounds.MinX;
+						batch->Bounds[4 * feature + 1] = bounds.MinY;
+						batch->Bounds[4 * feature + 2] = bounds.MaxX;
+						batch->Bounds[4 * feature + 3] = bounds.MaxY;
+					}
+				}
+			}
+		}
+	}
+}
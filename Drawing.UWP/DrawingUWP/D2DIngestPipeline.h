@@ -0,0 +1,124 @@
+#pragma once
+
+#include "D2DBoundedQueue.h"
+#include "D2DFeatureStream.h"
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace Telerik
+{
+	namespace UI
+	{
+		namespace Drawing
+		{
+			// a run of consecutive features of a source as it moves through the ingest pipeline. Feature f of the batch owns
+			// the parts [PartOffsets[f], PartOffsets[f + 1]) and part p owns the points [PointOffsets[p], PointOffsets[p + 1]);
+			// the offsets start at 0 within each batch. Ranks and Bounds are filled by the simplify and bounds stages
+			struct D2DIngestBatch
+			{
+				size_t Sequence;
+				size_t FirstFeature;
+
+				std::vector<D2DFeatureKind> Kinds;
+				std::vector<uint32_t> PartOffsets;
+				std::vector<uint32_t> PointOffsets;
+				std::vector<double> Coordinates;
+
+				// the Douglas-Peucker rank of each point, as D2DLayerCacheView::Ranks
+				std::vector<float> Ranks;
+
+				// minX, minY, maxX and maxY of each feature; features without points have empty (NaN) bounds
+				std::vector<double> Bounds;
+
+				size_t GetFeatureCount() const { return this->Kinds.size(); }
+			};
+
+			enum class D2DIngestStatus
+			{
+				Running,
+				Completed,
+				Cancelled,
+				Failed
+			};
+
+			enum class D2DDecodeResult
+			{
+				Decoded,
+				Done,
+				Failed
+			};
+
+			// loads a source in batches through concurrent stages joined by bounded queues: decode, project, simplify and
+			// bounds, then publish, which hands the batches to the consumer in the order they were decoded, so that they can
+			// be inserted into a layer and shown while the rest of the source is still loading. A stage that gets ahead of the
+			// next one blocks on the full queue between them, which keeps only a few batches in memory at any time
+			class D2DIngestPipeline
+			{
+			public:
+				// fills the kinds, offsets and coordinates of the next batch; called from a single thread
+				typedef std::function<D2DDecodeResult (D2DIngestBatch* batch)> Decoder;
+
+				// converts the coordinates of a batch in place; called from several threads at once
+				typedef std::function<void (D2DIngestBatch* batch)> Projector;
+
+				// receives the batches in order from a single thread; returning false cancels the pipeline
+				typedef std::function<bool (std::unique_ptr<D2DIngestBatch> batch)> Consumer;
+
+				// called once from the thread of the consumer after the last batch, however the pipeline ended
+				typedef std::function<void (D2DIngestStatus status)> Completion;
+
+				D2DIngestPipeline();
+				~D2DIngestPipeline();
+
+				// the projector and the completion are optional; the worker count of each parallel stage is 0 for the hardware threads
+				bool Start(const Decoder& decoder, const Projector& projector, const Consumer& consumer, const Completion& completion, size_t workerCount);
+
+				// stops the stages as soon as they finish their current batch; the batches in flight are dropped
+				void Cancel();
+
+				// waits for the stages to finish and returns how the pipeline ended
+				D2DIngestStatus Wait();
+
+				D2DIngestStatus GetStatus() const { return this->status.load(); }
+				size_t GetPublishedFeatureCount() const { return this->publishedFeatureCount.load(); }
+
+				// fills the ranks and the bounds of a batch, as the simplify and bounds stages do
+				static void RankBatch(D2DIngestBatch* batch);
+				static void BoundBatch(D2DIngestBatch* batch);
+
+			private:
+				D2DIngestPipeline(const D2DIngestPipeline&);
+				D2DIngestPipeline& operator = (const D2DIngestPipeline&);
+
+				typedef D2DBoundedQueue<std::unique_ptr<D2DIngestBatch>> BatchQueue;
+
+				struct Stage
+				{
+					std::function<void (D2DIngestBatch*)> Body;
+					std::unique_ptr<BatchQueue> Input;
+					std::atomic<size_t> RunningWorkers;
+				};
+
+				void Decode(Decoder decoder);
+				void Transform(Stage* stage, BatchQueue* output);
+				void Publish(Consumer consumer, Completion completion);
+				void Finish(D2DIngestStatus status);
+				void CancelQueues();
+
+				std::vector<std::unique_ptr<Stage>> stages;
+				std::unique_ptr<BatchQueue> publishQueue;
+
+				// an item for each batch between the decoder and the consumer, so that the batches the publisher holds back
+				// for a late predecessor count against the same bound as the batches in the queues
+				std::unique_ptr<D2DBoundedQueue<size_t>> batchSlots;
+				std::vector<std::thread> threads;
+
+				std::atomic<D2DIngestStatus> status;
+				std::atomic<size_t> publishedFeatureCount;
+			};
+		}
+	}
+}
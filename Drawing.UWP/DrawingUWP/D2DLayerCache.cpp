@@ -0,0 +1,166 @@
+#include "pch.h"
+#include "D2DLayerCache.h"
+#include "D2DMultiPolygon.h"
+#include "D2DPolyline.h"
+#include "D2DRectangle.h"
+#include <limits>
+
+namespace Telerik
+{
+	namespace UI
+	{
+		namespace Drawing
+		{
+			D2DLayerCache::D2DLayerCache(void)
+			{
+			}
+
+			D2DLayerCache^ D2DLayerCache::Open(Platform::String^ path, uint64 stamp)
+			{
+				if(path == nullptr)
+				{
+					return nullptr;
+				}
+
+				// the file stays mapped while the cache or any shape created from it is alive
+				D2DLayerCache^ cache = ref new D2DLayerCache();
+				if(!cache->reader.Open(path->Data(), stamp))
+				{
+					return nullptr;
+				}
+
+				return cache;
+			}
+
+			bool D2DLayerCache::Write(IIterable<D2DShape^>^ shapes, Platform::String^ path, uint64 stamp)
+			{
+				if(shapes == nullptr || path == nullptr)
+				{
+					return false;
+				}
+
+				std::vector<D2DFeatureKind> kinds;
+				std::vector<uint32_t> partOffsets(1, 0);
+				std::vector<uint32_t> pointOffsets(1, 0);
+				std::vector<double> coordinates;
+
+				auto addPart = [&](const DoublePoint* points, size_t count)
+				{
+					const double* values = reinterpret_cast<const double*>(points);
+					coordinates.insert(coordinates.end(), values, values + 2 * count);
+					pointOffsets.push_back(static_cast<uint32_t>(coordinates.size() / 2));
+				};
+
+				IIterator<D2DShape^>^ iterator = shapes->First();
+				while(iterator->HasCurrent)
+				{
+					D2DShape^ shape = iterator->Current;
+					D2DFeatureKind kind = D2DFeatureKind::None;
+
+					D2DRectangle^ rectangle = dynamic_cast<D2DRectangle^>(shape);
+					D2DPolyline^ polyline = dynamic_cast<D2DPolyline^>(shape);
+					D2DMultiPolygon^ multiPolygon = dynamic_cast<D2DMultiPolygon^>(shape);
+
+					if(rectangle != nullptr)
+					{
+						DoublePoint location = rectangle->Location;
+						kind = D2DFeatureKind::Point;
+						addPart(&location, 1);
+					}
+					else if(polyline != nullptr)
+					{
+						const std::vector<DoublePoint>& points = polyline->GetPoints();
+						kind = polyline->IsClosed ? D2DFeatureKind::Polygon : D2DFeatureKind::Line;
+						addPart(points.data(), points.size());
+					}
+					else if(multiPolygon != nullptr)
+					{
+						const uint32_t* ringOffsets;
+						size_t ringCount;
+						const DoublePoint* points = multiPolygon->GetRings(&ringOffsets, &ringCount);
+
+						kind = multiPolygon->IsClosed ? D2DFeatureKind::Polygon : D2DFeatureKind::Line;
+						for(size_t ring = 0; ring < ringCount; ring++)
+						{
+							addPart(points + ringOffsets[ring], ringOffsets[ring + 1] - ringOffsets[ring]);
+						}
+					}
+
+					if(coordinates.size() / 2 > (std::numeric_limits<uint32_t>::max)())
+					{
+						return false;
+					}
+
+					kinds.push_back(kind);
+					partOffsets.push_back(static_cast<uint32_t>(pointOffsets.size() - 1));
+					iterator->MoveNext();
+				}
+
+				D2DFeatureSource source = { kinds.size(), kinds.data(), partOffsets.data(), pointOffsets.data(), coordinates.data() };
+				return D2DLayerCacheWriter::Write(source, stamp, path->Data());
+			}
+
+			D2DShape^ D2DLayerCache::CreateShape(int feature)
+			{
+				const D2DLayerCacheView& view = this->reader.GetView();
+				if(feature < 0 || static_cast<size_t>(feature) >= view.FeatureCount)
+				{
+					throw ref new Platform::OutOfBoundsException();
+				}
+
+				uint32_t firstPart = view.PartOffsets[feature];
+				uint32_t partCount = view.PartOffsets[feature + 1] - firstPart;
+				if(partCount == 0 || view.PointOffsets[firstPart + partCount] == view.PointOffsets[firstPart])
+				{
+					return nullptr;
+				}
+
+				switch(view.Kinds[feature])
+				{
+					case D2DFeatureKind::Point:
+					{
+						const double* point = view.Coordinates + 2 * static_cast<size_t>(view.PointOffsets[firstPart]);
+
+						DoublePoint location;
+						location.X = point[0];
+						location.Y = point[1];
+
+						D2DRectangle^ marker = ref new D2DRectangle();
+						marker->Location = location;
+						return marker;
+					}
+
+					case D2DFeatureKind::Line:
+					case D2DFeatureKind::Polygon:
+					{
+						const double* bounds = view.Bounds + 4 * static_cast<size_t>(feature);
+						D2DPointBounds pointBounds = { bounds[0], bounds[1], bounds[2], bounds[3] };
+
+						// the shape keeps the cache, and with it the mapped file, alive
+						D2DMultiPolygon^ shape = ref new D2DMultiPolygon();
+						shape->IsClosed = view.Kinds[feature] == D2DFeatureKind::Polygon;
+						shape->SetMappedRings(this, view.Coordinates, view.PointOffsets + firstPart, partCount, view.Ranks, pointBounds);
+						return shape;
+					}
+
+					default:
+						return nullptr;
+				}
+			}
+
+			IVector<int>^ D2DLayerCache::Query(double minX, double minY, double maxX, double maxY)
+			{
+				std::vector<uint32_t> features;
+				this->reader.Query(minX, minY, maxX, maxY, &features);
+
+				auto result = ref new Platform::Collections::Vector<int>();
+				for(auto feature = features.begin(); feature != features.end(); ++feature)
+				{
+					result->Append(static_cast<int>(*feature));
+				}
+
+				return result;
+			}
+		}
+	}
+}
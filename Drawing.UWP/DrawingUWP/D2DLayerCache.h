@@ -0,0 +1,53 @@
+#pragma once
+
+#include "D2DShape.h"
+#include "D2DLayerCacheFile.h"
+#include <collection.h>
+
+namespace Telerik
+{
+	namespace UI
+	{
+		namespace Drawing
+		{
+			// the projected geometry of a layer saved once and memory-mapped on later launches: the shapes created from a
+			// cache read their points in place from the file, with their bounds and simplification ranks precomputed, so the
+			// first frame needs neither parsing nor projection. Styles, labels and models are not part of the cache
+			public ref class D2DLayerCache sealed
+			{
+			public:
+				// returns null if the file is missing, damaged, of another version or was written with another stamp
+				static D2DLayerCache^ Open(Platform::String^ path, uint64 stamp);
+
+				// writes the geometry of D2DRectangle, D2DPolyline and D2DMultiPolygon shapes in model space; other shapes are
+				// kept as empty features, so feature i always stands for the shape at index i. The stamp should identify the
+				// source data and the projection, for example by their modification time and version
+				static bool Write(IIterable<D2DShape^>^ shapes, Platform::String^ path, uint64 stamp);
+
+				property int FeatureCount
+				{
+					int get() { return static_cast<int>(this->reader.GetView().FeatureCount); }
+				}
+
+				property int PointCount
+				{
+					int get() { return static_cast<int>(this->reader.GetView().PointCount); }
+				}
+
+				// a D2DRectangle for a point and a D2DMultiPolygon for a line or a polygon; null for an empty feature
+				D2DShape^ CreateShape(int feature);
+
+				// the indices of the features whose bounds intersect the rect, in ascending order; the rect is in model space
+				IVector<int>^ Query(double minX, double minY, double maxX, double maxY);
+
+			internal:
+				const D2DLayerCacheReader& GetReader() { return this->reader; }
+
+			private:
+				D2DLayerCache(void);
+
+				D2DLayerCacheReader reader;
+			};
+		}
+	}
+}
@@ -0,0 +1,403 @@
+#include "pch.h"
+#include "D2DLayerCacheFile.h"
+#include "D2DParallel.h"
+#include "D2DPointKernels.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+// the features are ranked and measured in chunks of this many features, so that each worker is handed a sizeable piece of work
+const size_t CacheFeaturesPerChunk = 1024;
+
+const uint16_t CacheIndexNodeSize = 16;
+
+const char LayerCacheMagic[8] = { 'D', '2', 'D', 'L', 'A', 'Y', 'E', 'R' };
+
+// incremented whenever the layout of the file or the meaning of its sections changes
+const uint32_t LayerCacheVersion = 1;
+
+namespace Telerik
+{
+	namespace UI
+	{
+		namespace Drawing
+		{
+			struct D2DLayerCacheHeader
+			{
+				char Magic[8];
+				uint32_t Version;
+				uint16_t NodeSize;
+				uint16_t Reserved;
+				uint64_t Stamp;
+				uint64_t FeatureCount;
+				uint64_t PartCount;
+				uint64_t PointCount;
+				uint64_t IndexedCount;
+				uint64_t NodeCount;
+				double MinX;
+				double MinY;
+				double MaxX;
+				double MaxY;
+				uint64_t KindsOffset;
+				uint64_t PartOffsetsOffset;
+				uint64_t PointOffsetsOffset;
+				uint64_t CoordinatesOffset;
+				uint64_t BoundsOffset;
+				uint64_t RanksOffset;
+				uint64_t IndexOffset;
+				uint64_t Padding;
+			};
+
+			static_assert(sizeof(D2DLayerCacheHeader) == 160, "The layer cache header must keep its size.");
+
+			static uint64_t AlignSectionSize(uint64_t size)
+			{
+				return (size + 7) & ~static_cast<uint64_t>(7);
+			}
+
+			// whether a section of count elements of the given size starting at offset fits in the file
+			static bool IsSectionValid(uint64_t offset, uint64_t count, size_t elementSize, size_t fileSize)
+			{
+				return offset % 8 == 0 && offset <= fileSize && count <= (fileSize - offset) / elementSize;
+			}
+
+			D2DLayerCacheReader::D2DLayerCacheReader()
+			{
+				this->Close();
+			}
+
+			bool D2DLayerCacheReader::Open(const D2DPathChar* path, uint64_t stamp)
+			{
+				this->Close();
+
+				if(!this->file.Open(path) || this->file.GetSize() < sizeof(D2DLayerCacheHeader))
+				{
+					this->Close();
+					return false;
+				}
+
+				D2DLayerCacheHeader header;
+				memcpy(&header, this->file.GetData(), sizeof(header));
+
+				size_t size = this->file.GetSize();
+				bool isValid = memcmp(header.Magic, LayerCacheMagic, sizeof(LayerCacheMagic)) == 0 &&
+					header.Version == LayerCacheVersion &&
+					header.Stamp == stamp &&
+					header.NodeSize >= 2 &&
+					header.PointCount <= (std::numeric_limits<uint32_t>::max)() &&
+					header.PartCount <= (std::numeric_limits<uint32_t>::max)() &&
+					header.IndexedCount <= header.FeatureCount &&
+					header.NodeCount == D2DPackedRTree::GetNodeCount(static_cast<size_t>(header.IndexedCount), header.NodeSize) &&
+					IsSectionValid(header.KindsOffset, header.FeatureCount, sizeof(D2DFeatureKind), size) &&
+					IsSectionValid(header.PartOffsetsOffset, header.FeatureCount + 1, sizeof(uint32_t), size) &&
+					IsSectionValid(header.PointOffsetsOffset, header.PartCount + 1, sizeof(uint32_t), size) &&
+					IsSectionValid(header.CoordinatesOffset, header.PointCount * 2, sizeof(double), size) &&
+					IsSectionValid(header.BoundsOffset, header.FeatureCount * 4, sizeof(double), size) &&
+					IsSectionValid(header.RanksOffset, header.PointCount, sizeof(float), size) &&
+					IsSectionValid(header.IndexOffset, header.NodeCount, sizeof(D2DRTreeNode), size);
+
+				if(!isValid)
+				{
+					this->Close();
+					return false;
+				}
+
+				const uint8_t* data = this->file.GetData();
+				this->view.FeatureCount = static_cast<size_t>(header.FeatureCount);
+				this->view.PartCount = static_cast<size_t>(header.PartCount);
+				this->view.PointCount = static_cast<size_t>(header.PointCount);
+				this->view.Kinds = reinterpret_cast<const D2DFeatureKind*>(data + header.KindsOffset);
+				this->view.PartOffsets = reinterpret_cast<const uint32_t*>(data + header.PartOffsetsOffset);
+				this->view.PointOffsets = reinterpret_cast<const uint32_t*>(data + header.PointOffsetsOffset);
+				this->view.Coordinates = reinterpret_cast<const double*>(data + header.CoordinatesOffset);
+				this->view.Bounds = reinterpret_cast<const double*>(data + header.BoundsOffset);
+				this->view.Ranks = reinterpret_cast<const float*>(data + header.RanksOffset);
+				this->nodes = reinterpret_cast<const D2DRTreeNode*>(data + header.IndexOffset);
+				this->nodeCount = static_cast<size_t>(header.NodeCount);
+				this->indexedCount = static_cast<size_t>(header.IndexedCount);
+				this->nodeSize = header.NodeSize;
+				this->bounds[0] = header.MinX;
+				this->bounds[1] = header.MinY;
+				this->bounds[2] = header.MaxX;
+				this->bounds[3] = header.MaxY;
+
+				if(!this->ValidateOffsets())
+				{
+					this->Close();
+					return false;
+				}
+
+				return true;
+			}
+
+			bool D2DLayerCacheReader::ValidateOffsets() const
+			{
+				// the shapes read their points in place, so no offset may reach outside of the coordinates; the offsets are
+				// a small fraction of the file and checking them leaves the pages of the coordinates untouched
+				const uint32_t* partOffsets = this->view.PartOffsets;
+				if(partOffsets[0] != 0 || partOffsets[this->view.FeatureCount] != this->view.PartCount)
+				{
+					return false;
+				}
+
+				for(size_t feature = 0; feature < this->view.FeatureCount; feature++)
+				{
+					if(partOffsets[feature] > partOffsets[feature + 1] || this->view.Kinds[feature] > D2DFeatureKind::Polygon)
+					{
+						return false;
+					}
+				}
+
+				const uint32_t* pointOffsets = this->view.PointOffsets;
+				if(pointOffsets[0] != 0 || pointOffsets[this->view.PartCount] != this->view.PointCount)
+				{
+					return false;
+				}
+
+				for(size_t part = 0; part < this->view.PartCount; part++)
+				{
+					if(pointOffsets[part] > pointOffsets[part + 1])
+					{
+						return false;
+					}
+				}
+
+				for(size_t leaf = this->nodeCount - this->indexedCount; leaf < this->nodeCount; leaf++)
+				{
+					if(this->nodes[leaf].Offset >= this->view.FeatureCount)
+					{
+						return false;
+					}
+				}
+
+				return true;
+			}
+
+			void D2DLayerCacheReader::Close()
+			{
+				this->file.Close();
+				memset(&this->view, 0, sizeof(this->view));
+				this->nodes = nullptr;
+				this->nodeCount = 0;
+				this->indexedCount = 0;
+				this->nodeSize = CacheIndexNodeSize;
+				this->bounds[0] = this->bounds[1] = this->bounds[2] = this->bounds[3] = 0;
+			}
+
+			void D2DLayerCacheReader::GetBounds(double* minX, double* minY, double* maxX, double* maxY) const
+			{
+				*minX = this->bounds[0];
+				*minY = this->bounds[1];
+				*maxX = this->bounds[2];
+				*maxY = this->bounds[3];
+			}
+
+			void D2DLayerCacheReader::Query(double minX, double minY, double maxX, double maxY, std::vector<uint32_t>* features) const
+			{
+				size_t start = features->size();
+				D2DPackedRTree::Search(this->nodes, this->nodeCount, this->indexedCount, this->nodeSize, minX, minY, maxX, maxY, features);
+
+				// the leaves hold the indices of the features
+				const D2DRTreeNode* leaves = this->nodes + this->nodeCount - this->indexedCount;
+				for(auto feature = features->begin() + start; feature != features->end(); ++feature)
+				{
+					*feature = static_cast<uint32_t>(leaves[*feature].Offset);
+				}
+
+				std::sort(features->begin() + start, features->end());
+			}
+
+			void D2DLayerCacheWriter::RankPoints(const double* coordinates, size_t pointCount, float* ranks)
+			{
+				if(pointCount == 0)
+				{
+					return;
+				}
+
+				std::fill(ranks, ranks + pointCount, 0.0f);
+				ranks[0] = ranks[pointCount - 1] = (std::numeric_limits<float>::max)();
+
+				// the spans still to split with the rank of the split that produced them
+				struct Span
+				{
+					size_t First;
+					size_t Last;
+					float Rank;
+				};
+
+				std::vector<Span> stack;
+				Span part = { 0, pointCount - 1, (std::numeric_limits<float>::max)() };
+				stack.push_back(part);
+
+				while(!stack.empty())
+				{
+					Span span = stack.back();
+					stack.pop_back();
+
+					if(span.Last - span.First < 2)
+					{
+						continue;
+					}
+
+					double ax = coordinates[2 * span.First];
+					double ay = coordinates[2 * span.First + 1];
+					double dx = coordinates[2 * span.Last] - ax;
+					double dy = coordinates[2 * span.Last + 1] - ay;
+					double length = dx * dx + dy * dy;
+
+					// the distance to the segment, so that the first and last points of a closed ring split it as well
+					double maxDistance = -1;
+					size_t farthest = span.First + 1;
+					for(size_t i = span.First + 1; i < span.Last; i++)
+					{
+						double px = coordinates[2 * i] - ax;
+						double py = coordinates[2 * i + 1] - ay;
+
+						double t = length > 0 ? (std::max)(0.0, (std::min)(1.0, (px * dx + py * dy) / length)) : 0;
+						double ex = px - t * dx;
+						double ey = py - t * dy;
+						double distance = ex * ex + ey * ey;
+
+						if(distance > maxDistance)
+						{
+							maxDistance = distance;
+							farthest = i;
+						}
+					}
+
+					float rank = (std::min)(static_cast<float>(sqrt(maxDistance)), span.Rank);
+					ranks[farthest] = rank;
+
+					Span before = { span.First, farthest, rank };
+					Span after = { farthest, span.Last, rank };
+					stack.push_back(before);
+					stack.push_back(after);
+				}
+			}
+
+			bool D2DLayerCacheWriter::Write(const D2DFeatureSource& source, uint64_t stamp, const D2DPathChar* path)
+			{
+				size_t featureCount = source.FeatureCount;
+				uint32_t firstPart = source.PartOffsets[0];
+				uint32_t firstPoint = source.PointOffsets[firstPart];
+				size_t partCount = source.PartOffsets[featureCount] - firstPart;
+				size_t pointCount = source.PointOffsets[firstPart + partCount] - firstPoint;
+				const double* coordinates = source.Coordinates + 2 * static_cast<size_t>(firstPoint);
+
+				// the offsets are stored relative to the first part and point of the source
+				std::vector<uint32_t> partOffsets(featureCount + 1);
+				for(size_t feature = 0; feature <= featureCount; feature++)
+				{
+					partOffsets[feature] = source.PartOffsets[feature] - firstPart;
+				}
+
+				std::vector<uint32_t> pointOffsets(partCount + 1);
+				for(size_t part = 0; part <= partCount; part++)
+				{
+					pointOffsets[part] = source.PointOffsets[firstPart + part] - firstPoint;
+				}
+
+				std::vector<double> bounds(4 * featureCount, std::numeric_limits<double>::quiet_NaN());
+				std::vector<float> ranks(pointCount);
+
+				size_t chunkCount = (featureCount + CacheFeaturesPerChunk - 1) / CacheFeaturesPerChunk;
+				D2DParallel::For(chunkCount, [&](size_t chunk, size_t)
+				{
+					size_t end = (std::min)((chunk + 1) * CacheFeaturesPerChunk, featureCount);
+					for(size_t feature = chunk * CacheFeaturesPerChunk; feature < end; feature++)
+					{
+						uint32_t start = pointOffsets[partOffsets[feature]];
+						D2DPointBounds featureBounds;
+						if(D2DPointKernels::ComputeBounds(coordinates + 2 * static_cast<size_t>(start), pointOffsets[partOffsets[feature + 1]] - start, &featureBounds))
+						{
+							bounds[4 * feature] = featureBounds.MinX;
+							bounds[4 * feature + 1] = featureBounds.MinY;
+							bounds[4 * feature + 2] = featureBounds.MaxX;
+							bounds[4 * feature + 3] = featureBounds.MaxY;
+						}
+
+						for(uint32_t part = partOffsets[feature]; part < partOffsets[feature + 1]; part++)
+						{
+							RankPoints(coordinates + 2 * static_cast<size_t>(pointOffsets[part]), pointOffsets[part + 1] - pointOffsets[part], ranks.data() + pointOffsets[part]);
+						}
+					}
+				});
+
+				D2DLayerCacheHeader header;
+				memset(&header, 0, sizeof(header));
+				memcpy(header.Magic, LayerCacheMagic, sizeof(LayerCacheMagic));
+				header.Version = LayerCacheVersion;
+				header.NodeSize = CacheIndexNodeSize;
+				header.Stamp = stamp;
+				header.FeatureCount = featureCount;
+				header.PartCount = partCount;
+				header.PointCount = pointCount;
+				header.MinX = header.MinY = (std::numeric_limits<double>::max)();
+				header.MaxX = header.MaxY = -(std::numeric_limits<double>::max)();
+
+				// only the features with points are indexed; the leaves keep the index of their feature
+				std::vector<D2DRTreeNode> boxes;
+				for(size_t feature = 0; feature < featureCount; feature++)
+				{
+					const double* featureBounds = &bounds[4 * feature];
+					if(!(featureBounds[0] <= featureBounds[2] && featureBounds[1] <= featureBounds[3]))
+					{
+						continue;
+					}
+
+					D2DRTreeNode box = { featureBounds[0], featureBounds[1], featureBounds[2], featureBounds[3], feature };
+					boxes.push_back(box);
+
+					header.MinX = (std::min)(header.MinX, box.MinX);
+					header.MinY = (std::min)(header.MinY, box.MinY);
+					header.MaxX = (std::max)(header.MaxX, box.MaxX);
+					header.MaxY = (std::max)(header.MaxY, box.MaxY);
+				}
+
+				if(boxes.empty())
+				{
+					header.MinX = header.MinY = header.MaxX = header.MaxY = 0;
+				}
+
+				std::vector<uint32_t> order;
+				D2DPackedRTree::SortByHilbert(boxes.data(), boxes.size(), header.MinX, header.MinY, header.MaxX, header.MaxY, &order);
+
+				size_t nodeCount = D2DPackedRTree::GetNodeCount(boxes.size(), CacheIndexNodeSize);
+				std::vector<D2DRTreeNode> nodes(nodeCount);
+				for(size_t i = 0; i < order.size(); i++)
+				{
+					nodes[nodeCount - boxes.size() + i] = boxes[order[i]];
+				}
+
+				D2DPackedRTree::Build(nodes.data(), nodeCount, boxes.size(), CacheIndexNodeSize);
+
+				header.IndexedCount = boxes.size();
+				header.NodeCount = nodeCount;
+				header.KindsOffset = sizeof(D2DLayerCacheHeader);
+				header.PartOffsetsOffset = header.KindsOffset + AlignSectionSize(featureCount * sizeof(D2DFeatureKind));
+				header.PointOffsetsOffset = header.PartOffsetsOffset + AlignSectionSize(partOffsets.size() * sizeof(uint32_t));
+				header.CoordinatesOffset = header.PointOffsetsOffset + AlignSectionSize(pointOffsets.size() * sizeof(uint32_t));
+				header.BoundsOffset = header.CoordinatesOffset + pointCount * 2 * sizeof(double);
+				header.RanksOffset = header.BoundsOffset + bounds.size() * sizeof(double);
+				header.IndexOffset = header.RanksOffset + AlignSectionSize(ranks.size() * sizeof(float));
+
+				D2DFeatureFileOutput output(path);
+				output.Write(&header, sizeof(header));
+				output.Write(source.Kinds, featureCount * sizeof(D2DFeatureKind));
+				output.WritePadding(featureCount * sizeof(D2DFeatureKind));
+				output.Write(partOffsets.data(), partOffsets.size() * sizeof(uint32_t));
+				output.WritePadding(partOffsets.size() * sizeof(uint32_t));
+				output.Write(pointOffsets.data(), pointOffsets.size() * sizeof(uint32_t));
+				output.WritePadding(pointOffsets.size() * sizeof(uint32_t));
+				output.Write(coordinates, pointCount * 2 * sizeof(double));
+				output.Write(bounds.data(), bounds.size() * sizeof(double));
+				output.Write(ranks.data(), ranks.size() * sizeof(float));
+				output.WritePadding(ranks.size() * sizeof(float));
+				output.Write(nodes.data(), nodes.size() * sizeof(D2DRTreeNode));
+
+				return output.Close();
+			}
+		}
+	}
+}
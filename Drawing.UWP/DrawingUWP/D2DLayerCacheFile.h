@@ -0,0 +1,73 @@
+#pragma once
+
+#include "D2DFeatureStream.h"
+
+namespace Telerik
+{
+	namespace UI
+	{
+		namespace Drawing
+		{
+			// the geometry of a layer as stored in a layer cache file; all pointers reference the mapped file. Feature f owns
+			// the parts [PartOffsets[f], PartOffsets[f + 1]), part p owns the points [PointOffsets[p], PointOffsets[p + 1]),
+			// and point i has the coordinates Coordinates[2 * i], Coordinates[2 * i + 1] and the simplification rank Ranks[i]
+			struct D2DLayerCacheView
+			{
+				size_t FeatureCount;
+				size_t PartCount;
+				size_t PointCount;
+				const D2DFeatureKind* Kinds;
+				const uint32_t* PartOffsets;
+				const uint32_t* PointOffsets;
+				const double* Coordinates;
+
+				// minX, minY, maxX and maxY of each feature; features without points have empty (NaN) bounds
+				const double* Bounds;
+
+				// the largest distance from the simplified part at which the point is still left out, found by
+				// Douglas-Peucker; never above the ranks of the points the simplification keeps it between
+				const float* Ranks;
+			};
+
+			// a versioned, memory-mapped snapshot of the projected geometry of a layer together with everything derived from
+			// it: the bounds of the features, the simplification ranks of the points and a packed R-tree over the features.
+			// All sections are 8-byte aligned and used in place, so opening a cache only validates its header and offsets
+			class D2DLayerCacheReader
+			{
+			public:
+				D2DLayerCacheReader();
+
+				// returns false if the file is missing, damaged, of another version or written for another stamp
+				bool Open(const D2DPathChar* path, uint64_t stamp);
+				void Close();
+
+				const D2DLayerCacheView& GetView() const { return this->view; }
+				void GetBounds(double* minX, double* minY, double* maxX, double* maxY) const;
+
+				// appends the features whose bounds intersect the rect, in ascending order
+				void Query(double minX, double minY, double maxX, double maxY, std::vector<uint32_t>* features) const;
+
+			private:
+				bool ValidateOffsets() const;
+
+				D2DMappedFile file;
+				D2DLayerCacheView view;
+				const D2DRTreeNode* nodes;
+				size_t nodeCount;
+				size_t indexedCount;
+				uint16_t nodeSize;
+				double bounds[4];
+			};
+
+			class D2DLayerCacheWriter
+			{
+			public:
+				// the stamp identifies the source data and its projection; a cache is only opened with the stamp it was written with
+				static bool Write(const D2DFeatureSource& source, uint64_t stamp, const D2DPathChar* path);
+
+				// ranks the points of a part for Douglas-Peucker simplification; the end points get the highest rank
+				static void RankPoints(const double* coordinates, size_t pointCount, float* ranks);
+			};
+		}
+	}
+}
@@ -0,0 +1,261 @@
+#include "pch.h"
+#include "D2DLayerLoader.h"
+#include "D2DFeatureFile.h"
+#include "D2DMultiPolygon.h"
+#include "D2DProjection.h"
+#include "D2DRectangle.h"
+#include "D2DShapefileReader.h"
+
+// records per batch: small enough that the first shapes show within a frame or two, large enough to amortize the hand-offs
+const size_t LoaderRecordsPerBatch = 1024;
+
+// batches waiting for the UI thread; the pipeline stalls behind them when the UI thread is busy
+const size_t LoaderMaxReadyBatches = 4;
+
+namespace Telerik
+{
+	namespace UI
+	{
+		namespace Drawing
+		{
+			D2DLayerLoader::D2DLayerLoader(D2DCanvas^ canvas, D2DShapeStyle^ style, int layerId)
+				: canvas(canvas), style(style), layerId(layerId), fileOffset(0), isDrainScheduled(false), isPipelineFinished(false), isCancelled(false),
+				pipelineStatus(D2DIngestStatus::Running), loadStatus(D2DIngestStatus::Running), loadedCount(0)
+			{
+				this->dispatcher = canvas->Dispatcher;
+			}
+
+			D2DLayerLoader::~D2DLayerLoader(void)
+			{
+				this->Cancel();
+				this->pipeline.Wait();
+			}
+
+			D2DLayerLoader^ D2DLayerLoader::LoadShapefile(D2DCanvas^ canvas, Platform::String^ shapePath, D2DShapeStyle^ style, ShapeLayerParameters parameters, double mercatorSize)
+			{
+				if(canvas == nullptr || shapePath == nullptr)
+				{
+					return nullptr;
+				}
+
+				D2DLayerLoader^ loader = ref new D2DLayerLoader(canvas, style, parameters.Id);
+
+				// the file stays mapped until the pipeline is done with it; only the header is checked up front
+				D2DShapefileGeometry header;
+				size_t offset = 0;
+				if(!loader->file.Open(shapePath->Data()) || !D2DShapefileReader::ReadShapeBatch(loader->file.GetData(), loader->file.GetSize(), &offset, 0, &header))
+				{
+					return nullptr;
+				}
+
+				canvas->SetShapesForLayer(ref new Platform::Collections::Vector<D2DShape^>(), parameters);
+
+				// the callbacks run on the pipeline threads, which the loader joins before it is destroyed, so they must not
+				// hold a reference to it: the last one could otherwise be released on the thread that is being joined
+				D2DLayerLoader* target = loader;
+
+				auto decoder = [target](D2DIngestBatch* batch) -> D2DDecodeResult
+				{
+					D2DShapefileGeometry geometry;
+					if(!D2DShapefileReader::ReadShapeBatch(target->file.GetData(), target->file.GetSize(), &target->fileOffset, LoaderRecordsPerBatch, &geometry))
+					{
+						return D2DDecodeResult::Failed;
+					}
+
+					if(geometry.RecordShapeTypes.empty())
+					{
+						return D2DDecodeResult::Done;
+					}
+
+					batch->Kinds.resize(geometry.RecordShapeTypes.size());
+					for(size_t record = 0; record < batch->Kinds.size(); record++)
+					{
+						batch->Kinds[record] = D2DFeatureFile::GetShapefileKind(geometry.RecordShapeTypes[record]);
+					}
+
+					batch->PartOffsets.swap(geometry.PartOffsets);
+					batch->PointOffsets.swap(geometry.PointOffsets);
+					batch->Coordinates.swap(geometry.Coordinates);
+
+					return D2DDecodeResult::Decoded;
+				};
+
+				D2DIngestPipeline::Projector projector;
+				if(mercatorSize > 0)
+				{
+					projector = [mercatorSize](D2DIngestBatch* batch)
+					{
+						D2DProjection::ProjectMercator(batch->Coordinates.data(), batch->Coordinates.size() / 2, mercatorSize);
+					};
+				}
+
+				auto consumer = [target](std::unique_ptr<D2DIngestBatch> batch) { return target->QueueBatch(std::move(batch)); };
+				auto completion = [target](D2DIngestStatus status) { target->QueueCompletion(status); };
+
+				loader->self = loader;
+				if(!loader->pipeline.Start(decoder, projector, consumer, completion, 0))
+				{
+					loader->self = nullptr;
+					return nullptr;
+				}
+
+				return loader;
+			}
+
+			void D2DLayerLoader::Cancel()
+			{
+				{
+					std::lock_guard<std::mutex> lock(this->mutex);
+					this->isCancelled = true;
+					this->readyBatches.clear();
+				}
+
+				// a consumer waiting for the UI thread gives up and the pipeline reports its completion
+				this->batchesDrained.notify_all();
+				this->pipeline.Cancel();
+			}
+
+			bool D2DLayerLoader::QueueBatch(std::unique_ptr<D2DIngestBatch> batch)
+			{
+				std::unique_lock<std::mutex> lock(this->mutex);
+				this->batchesDrained.wait(lock, [this]() { return this->readyBatches.size() < LoaderMaxReadyBatches || this->isCancelled; });
+
+				if(this->isCancelled)
+				{
+					return false;
+				}
+
+				this->readyBatches.push_back(std::move(batch));
+				this->ScheduleDrain();
+
+				return true;
+			}
+
+			void D2DLayerLoader::QueueCompletion(D2DIngestStatus status)
+			{
+				std::lock_guard<std::mutex> lock(this->mutex);
+				this->isPipelineFinished = true;
+				this->pipelineStatus = status;
+				this->ScheduleDrain();
+			}
+
+			void D2DLayerLoader::ScheduleDrain()
+			{
+				// called under the lock; one drain at a time takes all the batches that are ready
+				if(this->isDrainScheduled)
+				{
+					return;
+				}
+
+				this->isDrainScheduled = true;
+
+				D2DLayerLoader^ loader = this;
+				this->dispatcher->RunAsync(CoreDispatcherPriority::Normal, ref new DispatchedHandler([loader]()
+				{
+					loader->DrainBatches();
+				}));
+			}
+
+			void D2DLayerLoader::DrainBatches()
+			{
+				std::deque<std::unique_ptr<D2DIngestBatch>> batches;
+				bool isFinished;
+				D2DIngestStatus status;
+				{
+					std::lock_guard<std::mutex> lock(this->mutex);
+					batches.swap(this->readyBatches);
+					this->isDrainScheduled = false;
+
+					// the completion is queued after the last batch, so a finished pipeline has nothing more to hand over
+					isFinished = this->isPipelineFinished;
+					status = this->isCancelled ? D2DIngestStatus::Cancelled : this->pipelineStatus;
+				}
+				this->batchesDrained.notify_all();
+
+				for(auto batch = batches.begin(); batch != batches.end(); ++batch)
+				{
+					this->AddBatch(std::move(*batch));
+				}
+
+				if(isFinished && this->loadStatus == D2DIngestStatus::Running)
+				{
+					this->loadStatus = status;
+					this->self = nullptr;
+				}
+			}
+
+			void D2DLayerLoader::AddBatch(std::unique_ptr<D2DIngestBatch> batch)
+			{
+				D2DIngestBatchOwner^ owner = ref new D2DIngestBatchOwner();
+				owner->Batch = std::move(batch);
+
+				const D2DIngestBatch& data = *owner->Batch;
+				size_t featureCount = data.GetFeatureCount();
+
+				std::vector<D2DShape^> shapes;
+				shapes.reserve(featureCount);
+
+				for(size_t feature = 0; feature < featureCount; feature++)
+				{
+					uint32_t firstPart = data.PartOffsets[feature];
+					uint32_t partCount = data.PartOffsets[feature + 1] - firstPart;
+					if(partCount == 0 || data.PointOffsets[firstPart + partCount] == data.PointOffsets[firstPart])
+					{
+						continue;
+					}
+
+					D2DShape^ shape;
+					switch(data.Kinds[feature])
+					{
+						case D2DFeatureKind::Point:
+						{
+							const double* point = data.Coordinates.data() + 2 * static_cast<size_t>(data.PointOffsets[firstPart]);
+
+							DoublePoint location;
+							location.X = point[0];
+							location.Y = point[1];
+
+							D2DRectangle^ marker = ref new D2DRectangle();
+							marker->Location = location;
+							shape = marker;
+							break;
+						}
+
+						case D2DFeatureKind::Line:
+						case D2DFeatureKind::Polygon:
+						{
+							const double* bounds = data.Bounds.data() + 4 * feature;
+							D2DPointBounds pointBounds = { bounds[0], bounds[1], bounds[2], bounds[3] };
+
+							// the points are used in place from the batch, which the shape keeps alive through its owner
+							D2DMultiPolygon^ multiPolygon = ref new D2DMultiPolygon();
+							multiPolygon->IsClosed = data.Kinds[feature] == D2DFeatureKind::Polygon;
+							multiPolygon->SetMappedRings(owner, data.Coordinates.data(), data.PointOffsets.data() + firstPart, partCount, data.Ranks.data(), pointBounds);
+							shape = multiPolygon;
+							break;
+						}
+
+						default:
+							continue;
+					}
+
+					if(this->style != nullptr)
+					{
+						shape->NormalStyle = this->style;
+					}
+
+					shapes.push_back(shape);
+				}
+
+				// the layer may have been removed by the time the batch arrives
+				if(!this->canvas->AppendShapesToLayer(this->layerId, shapes))
+				{
+					this->Cancel();
+					return;
+				}
+
+				this->loadedCount += featureCount;
+			}
+		}
+	}
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include "D2DCanvas.h"
+#include "D2DIngestPipeline.h"
+#include "D2DMappedFile.h"
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+
+namespace Telerik
+{
+	namespace UI
+	{
+		namespace Drawing
+		{
+			// keeps a loaded batch, and with it the points of the shapes created from it, alive
+			ref class D2DIngestBatchOwner sealed
+			{
+			internal:
+				std::unique_ptr<D2DIngestBatch> Batch;
+			};
+
+			// loads a layer in the background through a D2DIngestPipeline: the records are decoded, simplified and bounded
+			// in batches on worker threads, and each batch is added to the layer on the UI thread as soon as it is ready,
+			// so the first shapes appear while the rest of the file is still being read
+			public ref class D2DLayerLoader sealed
+			{
+			public:
+				virtual ~D2DLayerLoader(void);
+
+				// replaces the shapes of the layer with the shapes of a shapefile, in the order of its records, with the given
+				// normal style. With a positive Mercator size the longitudes and latitudes of the file are projected as by
+				// D2DShapefile::ProjectMercator, otherwise the coordinates are used as stored. Returns null if the file is not a shapefile
+				static D2DLayerLoader^ LoadShapefile(D2DCanvas^ canvas, Platform::String^ shapePath, D2DShapeStyle^ style, ShapeLayerParameters parameters, double mercatorSize);
+
+				// stops loading; the shapes added so far stay in the layer
+				void Cancel();
+
+				// true once all records are in the layer; false while loading and after a cancelled or failed load
+				property bool IsCompleted
+				{
+					bool get() { return this->loadStatus == D2DIngestStatus::Completed; }
+				}
+
+				property bool IsLoading
+				{
+					bool get() { return this->loadStatus == D2DIngestStatus::Running; }
+				}
+
+				// the number of records added to the layer so far
+				property int LoadedCount
+				{
+					int get() { return static_cast<int>(this->loadedCount); }
+				}
+
+			private:
+				D2DLayerLoader(D2DCanvas^ canvas, D2DShapeStyle^ style, int layerId);
+
+				// the pipeline side: called from its publishing thread
+				bool QueueBatch(std::unique_ptr<D2DIngestBatch> batch);
+				void QueueCompletion(D2DIngestStatus status);
+				void ScheduleDrain();
+
+				// the UI side: adds the queued batches to the layer
+				void DrainBatches();
+				void AddBatch(std::unique_ptr<D2DIngestBatch> batch);
+
+				D2DCanvas^ canvas;
+				D2DShapeStyle^ style;
+				int layerId;
+				CoreDispatcher^ dispatcher;
+
+				// the loader keeps itself alive while its pipeline is running
+				D2DLayerLoader^ self;
+
+				D2DMappedFile file;
+				size_t fileOffset;
+				D2DIngestPipeline pipeline;
+
+				std::mutex mutex;
+				std::condition_variable batchesDrained;
+				std::deque<std::unique_ptr<D2DIngestBatch>> readyBatches;
+				bool isDrainScheduled;
+				bool isPipelineFinished;
+				bool isCancelled;
+				D2DIngestStatus pipelineStatus;
+
+				D2DIngestStatus loadStatus;
+				size_t loadedCount;
+			};
+		}
+	}
+}
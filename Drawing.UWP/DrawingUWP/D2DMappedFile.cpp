@@ -0,0 +1,134 @@
+#include "pch.h"
+#include "D2DMappedFile.h"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace Telerik
+{
+	namespace UI
+	{
+		namespace Drawing
+		{
+			D2DMappedFile::D2DMappedFile()
+			{
+				this->data = nullptr;
+				this->size = 0;
+
+#ifdef _WIN32
+				this->file = INVALID_HANDLE_VALUE;
+				this->mapping = nullptr;
+#else
+				this->file = -1;
+#endif
+			}
+
+			D2DMappedFile::~D2DMappedFile()
+			{
+				this->Close();
+			}
+
+			bool D2DMappedFile::Open(const D2DPathChar* path)
+			{
+				this->Close();
+
+#ifdef _WIN32
+				// the FromApp variants are the ones allowed to store apps
+				this->file = CreateFile2(path, GENERIC_READ, FILE_SHARE_READ, OPEN_EXISTING, nullptr);
+				if(this->file == INVALID_HANDLE_VALUE)
+				{
+					return false;
+				}
+
+				LARGE_INTEGER fileSize;
+				if(!GetFileSizeEx(this->file, &fileSize) || fileSize.QuadPart == 0 || static_cast<unsigned long long>(fileSize.QuadPart) > SIZE_MAX)
+				{
+					this->Close();
+					return false;
+				}
+
+				this->mapping = CreateFileMappingFromApp(this->file, nullptr, PAGE_READONLY, 0, nullptr);
+				if(this->mapping == nullptr)
+				{
+					this->Close();
+					return false;
+				}
+
+				this->data = static_cast<const uint8_t*>(MapViewOfFileFromApp(this->mapping, FILE_MAP_READ, 0, 0));
+				this->size = static_cast<size_t>(fileSize.QuadPart);
+#else
+				this->file = open(path, O_RDONLY);
+				if(this->file < 0)
+				{
+					return false;
+				}
+
+				struct stat status;
+				if(fstat(this->file, &status) != 0 || status.st_size == 0)
+				{
+					this->Close();
+					return false;
+				}
+
+				void* view = mmap(nullptr, static_cast<size_t>(status.st_size), PROT_READ, MAP_PRIVATE, this->file, 0);
+				if(view != MAP_FAILED)
+				{
+					// the records are decoded front to back by each worker
+					madvise(view, static_cast<size_t>(status.st_size), MADV_SEQUENTIAL);
+
+					this->data = static_cast<const uint8_t*>(view);
+					this->size = static_cast<size_t>(status.st_size);
+				}
+#endif
+
+				if(this->data == nullptr)
+				{
+					this->Close();
+					return false;
+				}
+
+				return true;
+			}
+
+			void D2DMappedFile::Close()
+			{
+#ifdef _WIN32
+				if(this->data != nullptr)
+				{
+					UnmapViewOfFile(this->data);
+				}
+
+				if(this->mapping != nullptr)
+				{
+					CloseHandle(this->mapping);
+					this->mapping = nullptr;
+				}
+
+				if(this->file != INVALID_HANDLE_VALUE)
+				{
+					CloseHandle(this->file);
+					this->file = INVALID_HANDLE_VALUE;
+				}
+#else
+				if(this->data != nullptr)
+				{
+					munmap(const_cast<uint8_t*>(this->data), this->size);
+				}
+
+				if(this->file >= 0)
+				{
+					close(this->file);
+					this->file = -1;
+				}
+#endif
+
+				this->data = nullptr;
+				this->size = 0;
+			}
+		}
+	}
+}
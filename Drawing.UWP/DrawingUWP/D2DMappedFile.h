@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Telerik
+{
+	namespace UI
+	{
+		namespace Drawing
+		{
+#ifdef _WIN32
+			typedef wchar_t D2DPathChar;
+#else
+			typedef char D2DPathChar;
+#endif
+
+			// maps a whole file for reading; the pages are loaded by the system as they are touched, so large files are
+			// decoded without being copied into the process first
+			class D2DMappedFile
+			{
+			public:
+				D2DMappedFile();
+				~D2DMappedFile();
+
+				bool Open(const D2DPathChar* path);
+				void Close();
+
+				bool IsOpen() const { return this->data != nullptr; }
+				const uint8_t* GetData() const { return this->data; }
+				size_t GetSize() const { return this->size; }
+
+			private:
+				D2DMappedFile(const D2DMappedFile&);
+				D2DMappedFile& operator = (const D2DMappedFile&);
+
+				const uint8_t* data;
+				size_t size;
+
+#ifdef _WIN32
+				void* file;
+				void* mapping;
+#else
+				int file;
+#endif
+			};
+		}
+	}
+}
@@ -0,0 +1,90 @@
+#include "pch.h"
+#include "D2DMarkerAtlas.h"
+
+// the empty pixels kept around each symbol, so that sampling never bleeds into a neighbour
+const uint32_t SymbolGutter = 1;
+
+namespace Telerik
+{
+	namespace UI
+	{
+		namespace Drawing
+		{
+			D2DMarkerAtlas::D2DMarkerAtlas()
+			{
+				this->Reset(0, 0);
+			}
+
+			void D2DMarkerAtlas::Reset(uint32_t width, uint32_t height)
+			{
+				this->width = width;
+				this->height = height;
+				this->shelfX = 0;
+				this->shelfY = 0;
+				this->shelfHeight = 0;
+
+				this->symbols.clear();
+				this->ClearSprites();
+			}
+
+			int D2DMarkerAtlas::AddSymbol(uint32_t width, uint32_t height)
+			{
+				uint32_t slotWidth = width + 2 * SymbolGutter;
+				uint32_t slotHeight = height + 2 * SymbolGutter;
+
+				if(slotWidth > this->width)
+				{
+					return -1;
+				}
+
+				// start a new shelf below the current one when the symbol does not fit in the rest of the row
+				if(this->shelfX + slotWidth > this->width)
+				{
+					this->shelfY += this->shelfHeight;
+					this->shelfX = 0;
+					this->shelfHeight = 0;
+				}
+
+				if(this->shelfY + slotHeight > this->height)
+				{
+					return -1;
+				}
+
+				D2DAtlasRect symbol =
+				{
+					this->shelfX + SymbolGutter,
+					this->shelfY + SymbolGutter,
+					this->shelfX + SymbolGutter + width,
+					this->shelfY + SymbolGutter + height
+				};
+
+				this->shelfX += slotWidth;
+				this->shelfHeight = slotHeight > this->shelfHeight ? slotHeight : this->shelfHeight;
+
+				this->symbols.push_back(symbol);
+				return static_cast<int>(this->symbols.size() - 1);
+			}
+
+			void D2DMarkerAtlas::ClearSprites()
+			{
+				this->destinations.clear();
+				this->sources.clear();
+			}
+
+			void D2DMarkerAtlas::AddSprite(float x, float y, int symbol)
+			{
+				const D2DAtlasRect& source = this->symbols[symbol];
+				D2DSpriteRect destination =
+				{
+					x,
+					y,
+					x + static_cast<float>(source.Right - source.Left),
+					y + static_cast<float>(source.Bottom - source.Top)
+				};
+
+				this->destinations.push_back(destination);
+				this->sources.push_back(source);
+			}
+		}
+	}
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+namespace Telerik
+{
+	namespace UI
+	{
+		namespace Drawing
+		{
+			// a rect in the pixels of the atlas, laid out as D2D1_RECT_U
+			struct D2DAtlasRect
+			{
+				uint32_t Left;
+				uint32_t Top;
+				uint32_t Right;
+				uint32_t Bottom;
+			};
+
+			// a destination rect of a sprite, laid out as D2D1_RECT_F
+			struct D2DSpriteRect
+			{
+				float Left;
+				float Top;
+				float Right;
+				float Bottom;
+			};
+
+			// packs marker symbols into the rows (shelves) of an atlas of a fixed size and builds the per-frame sprite
+			// lists that draw the markers from it; independent of Direct2D so that it can be measured on its own
+			class D2DMarkerAtlas
+			{
+			public:
+				D2DMarkerAtlas();
+
+				// forgets all symbols and sprites
+				void Reset(uint32_t width, uint32_t height);
+
+				// returns the index of the slot reserved for the symbol, or -1 if the atlas is full
+				int AddSymbol(uint32_t width, uint32_t height);
+				const D2DAtlasRect& GetSymbol(int symbol) const { return this->symbols[symbol]; }
+				size_t GetSymbolCount() const { return this->symbols.size(); }
+
+				uint32_t GetWidth() const { return this->width; }
+				uint32_t GetHeight() const { return this->height; }
+
+				void ClearSprites();
+				void AddSprite(float x, float y, int symbol);
+
+				size_t GetSpriteCount() const { return this->destinations.size(); }
+				const D2DSpriteRect* GetDestinations() const { return this->destinations.data(); }
+				const D2DAtlasRect* GetSources() const { return this->sources.data(); }
+
+			private:
+				uint32_t width;
+				uint32_t height;
+
+				// the shelf being filled and the top of the next one
+				uint32_t shelfX;
+				uint32_t shelfY;
+				uint32_t shelfHeight;
+
+				std::vector<D2DAtlasRect> symbols;
+
+				// the sprites of the current frame as two parallel arrays, as a sprite batch takes them
+				std::vector<D2DSpriteRect> destinations;
+				std::vector<D2DAtlasRect> sources;
+			};
+		}
+	}
+}
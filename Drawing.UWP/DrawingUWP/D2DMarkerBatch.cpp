@@ -0,0 +1,244 @@
+#include "pch.h"
+#include "D2DMarkerBatch.h"
+#include "D2DShapeStyle.h"
+#include <tuple>
+
+// the size of the atlas bitmap in pixels
+const uint32_t MarkerAtlasSize = 1024;
+
+// markers larger than this (in pixels) are rendered as shapes, as they would fill the atlas with few symbols
+const float MaxMarkerSymbolSize = 128;
+
+namespace Telerik
+{
+	namespace UI
+	{
+		namespace Drawing
+		{
+			bool D2DMarkerBatch::SymbolKey::operator < (const SymbolKey& other) const
+			{
+				return std::tie(this->Fill, this->Stroke, this->StrokeThickness, this->CornerRadius, this->Width, this->Height) <
+					std::tie(other.Fill, other.Stroke, other.StrokeThickness, other.CornerRadius, other.Width, other.Height);
+			}
+
+			D2DMarkerBatch::D2DMarkerBatch()
+			{
+				this->atlasDeviceContext = nullptr;
+				this->isAtlasCleared = false;
+			}
+
+			bool D2DMarkerBatch::TryAdd(D2DRenderContext^ context, D2DRectangle^ marker, Rect invalidRect)
+			{
+				auto size = marker->Size;
+				if(size.Width <= 0 || size.Height <= 0 || size.Width > MaxMarkerSymbolSize || size.Height > MaxMarkerSymbolSize)
+				{
+					return false;
+				}
+
+				auto location = marker->GetLocation();
+				if(!Rect(location, size).IntersectsWith(invalidRect))
+				{
+					// nothing to draw, the same as D2DShape::Render
+					return true;
+				}
+
+				if(!this->EnsureAtlas(context))
+				{
+					return false;
+				}
+
+				D2DShapeStyle^ style = marker->CurrentStyle;
+				D2DBrush^ fill = style->Fill;
+				D2DBrush^ stroke = style->Stroke != nullptr && style->StrokeThickness > 0 ? style->Stroke : nullptr;
+
+				SymbolKey key =
+				{
+					fill != nullptr ? fill->NativeBrush.Get() : nullptr,
+					stroke != nullptr ? stroke->NativeBrush.Get() : nullptr,
+					stroke != nullptr ? style->StrokeThicknessAsFloat : 0,
+					marker->CornerRadius,
+					size.Width,
+					size.Height
+				};
+
+				auto symbol = this->symbols.find(key);
+				if(symbol == this->symbols.end())
+				{
+					int slot = this->atlas.AddSymbol(static_cast<uint32_t>(ceilf(size.Width)), static_cast<uint32_t>(ceilf(size.Height)));
+					if(slot < 0)
+					{
+						return false;
+					}
+
+					Symbol newSymbol;
+					newSymbol.Fill = key.Fill;
+					newSymbol.Stroke = key.Stroke;
+					newSymbol.Key = key;
+					newSymbol.Slot = slot;
+
+					symbol = this->symbols.insert(std::make_pair(key, newSymbol)).first;
+					this->pendingSymbols.push_back(newSymbol);
+				}
+
+				// the sprites are placed on whole pixels, as they are sampled without filtering
+				this->atlas.AddSprite(floorf(location.X + 0.5f), floorf(location.Y + 0.5f), symbol->second.Slot);
+				return true;
+			}
+
+			void D2DMarkerBatch::Flush(D2DRenderContext^ context)
+			{
+				size_t spriteCount = this->atlas.GetSpriteCount();
+				if(spriteCount == 0)
+				{
+					return;
+				}
+
+				this->RasterizePendingSymbols();
+
+				if(this->spriteContext != nullptr && this->spriteBatch != nullptr)
+				{
+					this->spriteBatch->Clear();
+					this->spriteBatch->AddSprites(
+						static_cast<UINT32>(spriteCount),
+						reinterpret_cast<const D2D1_RECT_F*>(this->atlas.GetDestinations()),
+						reinterpret_cast<const D2D1_RECT_U*>(this->atlas.GetSources()),
+						nullptr,
+						nullptr,
+						sizeof(D2D1_RECT_F),
+						sizeof(D2D1_RECT_U),
+						0,
+						0);
+
+					// sprite batches are only drawn with aliased antialiasing
+					auto antialiasMode = this->spriteContext->GetAntialiasMode();
+					this->spriteContext->SetAntialiasMode(D2D1_ANTIALIAS_MODE_ALIASED);
+					this->spriteContext->DrawSpriteBatch(
+						this->spriteBatch.Get(),
+						this->atlasBitmap.Get(),
+						D2D1_BITMAP_INTERPOLATION_MODE_NEAREST_NEIGHBOR,
+						D2D1_SPRITE_OPTIONS_NONE);
+					this->spriteContext->SetAntialiasMode(antialiasMode);
+				}
+				else
+				{
+					const D2DSpriteRect* destinations = this->atlas.GetDestinations();
+					const D2DAtlasRect* sources = this->atlas.GetSources();
+
+					for(size_t i = 0; i < spriteCount; i++)
+					{
+						context->DeviceContext->DrawBitmap(
+							this->atlasBitmap.Get(),
+							D2D1::RectF(destinations[i].Left, destinations[i].Top, destinations[i].Right, destinations[i].Bottom),
+							1,
+							D2D1_BITMAP_INTERPOLATION_MODE_NEAREST_NEIGHBOR,
+							D2D1::RectF(static_cast<float>(sources[i].Left), static_cast<float>(sources[i].Top), static_cast<float>(sources[i].Right), static_cast<float>(sources[i].Bottom)));
+					}
+				}
+
+				this->atlas.ClearSprites();
+			}
+
+			void D2DMarkerBatch::Reset()
+			{
+				this->atlas.Reset(0, 0);
+				this->symbols.clear();
+				this->pendingSymbols.clear();
+
+				this->atlasDeviceContext = nullptr;
+				this->atlasTarget.Reset();
+				this->atlasBitmap.Reset();
+				this->isAtlasCleared = false;
+
+				this->spriteContext.Reset();
+				this->spriteBatch.Reset();
+			}
+
+			bool D2DMarkerBatch::EnsureAtlas(D2DRenderContext^ context)
+			{
+				ID2D1DeviceContext* deviceContext = context->DeviceContext.Get();
+				if(this->atlasTarget != nullptr && this->atlasDeviceContext == deviceContext)
+				{
+					return true;
+				}
+
+				// the sprites collected so far refer to the previous atlas
+				this->Reset();
+
+				if(!SUCCEEDED(deviceContext->CreateCompatibleRenderTarget(D2D1::SizeF(static_cast<float>(MarkerAtlasSize), static_cast<float>(MarkerAtlasSize)), &this->atlasTarget)) ||
+					!SUCCEEDED(this->atlasTarget->GetBitmap(&this->atlasBitmap)))
+				{
+					this->atlasTarget.Reset();
+					return false;
+				}
+
+				this->atlasDeviceContext = deviceContext;
+				this->atlas.Reset(MarkerAtlasSize, MarkerAtlasSize);
+
+				if(SUCCEEDED(context->DeviceContext.As(&this->spriteContext)))
+				{
+					if(!SUCCEEDED(this->spriteContext->CreateSpriteBatch(&this->spriteBatch)))
+					{
+						this->spriteContext.Reset();
+					}
+				}
+
+				return true;
+			}
+
+			void D2DMarkerBatch::RasterizePendingSymbols()
+			{
+				if(this->pendingSymbols.empty())
+				{
+					return;
+				}
+
+				// the symbols are drawn the same way D2DRectangle draws itself, offset to their slots in the atlas
+				this->atlasTarget->BeginDraw();
+				if(!this->isAtlasCleared)
+				{
+					this->atlasTarget->Clear(D2D1::ColorF(0, 0));
+					this->isAtlasCleared = true;
+				}
+
+				for(auto symbol = this->pendingSymbols.begin(); symbol != this->pendingSymbols.end(); ++symbol)
+				{
+					const D2DAtlasRect& slot = this->atlas.GetSymbol(symbol->Slot);
+					const SymbolKey& key = symbol->Key;
+
+					float left = static_cast<float>(slot.Left);
+					float top = static_cast<float>(slot.Top);
+
+					if(symbol->Fill != nullptr)
+					{
+						D2D1_RECT_F rect = D2D1::RectF(left, top, left + key.Width, top + key.Height);
+						if(key.CornerRadius > 0)
+						{
+							this->atlasTarget->FillRoundedRectangle(D2D1::RoundedRect(rect, key.CornerRadius, key.CornerRadius), symbol->Fill.Get());
+						}
+						else
+						{
+							this->atlasTarget->FillRectangle(rect, symbol->Fill.Get());
+						}
+					}
+
+					if(symbol->Stroke != nullptr)
+					{
+						float strokeOffset = key.StrokeThickness / 2.0f;
+						D2D1_RECT_F rect = D2D1::RectF(left + strokeOffset, top + strokeOffset, left + key.Width - strokeOffset, top + key.Height - strokeOffset);
+						if(key.CornerRadius > 0)
+						{
+							this->atlasTarget->DrawRoundedRectangle(D2D1::RoundedRect(rect, key.CornerRadius, key.CornerRadius), symbol->Stroke.Get(), key.StrokeThickness);
+						}
+						else
+						{
+							this->atlasTarget->DrawRectangle(rect, symbol->Stroke.Get(), key.StrokeThickness);
+						}
+					}
+				}
+
+				this->atlasTarget->EndDraw();
+				this->pendingSymbols.clear();
+			}
+		}
+	}
+}
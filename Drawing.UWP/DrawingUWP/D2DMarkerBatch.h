@@ -0,0 +1,71 @@
+#pragma once
+
+#include <d2d1_3.h>
+#include <map>
+#include <vector>
+#include "D2DMarkerAtlas.h"
+#include "D2DRenderContext.h"
+#include "D2DRectangle.h"
+
+namespace Telerik
+{
+	namespace UI
+	{
+		namespace Drawing
+		{
+			// draws rectangle markers as sprites of a symbol atlas: each distinct symbol is rasterized into the atlas once
+			// and the markers collected between two flushes are submitted to the device context as a single sprite batch
+			class D2DMarkerBatch
+			{
+			public:
+				D2DMarkerBatch();
+
+				// returns false if the marker cannot be drawn from the atlas and has to be rendered as a shape
+				bool TryAdd(D2DRenderContext^ context, D2DRectangle^ marker, Rect invalidRect);
+				void Flush(D2DRenderContext^ context);
+				bool IsEmpty() const { return this->atlas.GetSpriteCount() == 0; }
+
+				// releases the atlas, which belongs to the device of the render context
+				void Reset();
+
+			private:
+				struct SymbolKey
+				{
+					ID2D1Brush* Fill;
+					ID2D1Brush* Stroke;
+					float StrokeThickness;
+					float CornerRadius;
+					float Width;
+					float Height;
+
+					bool operator < (const SymbolKey& other) const;
+				};
+
+				struct Symbol
+				{
+					// the brushes are kept alive so that their addresses are not reused by other brushes while the key is in use
+					ComPtr<ID2D1Brush> Fill;
+					ComPtr<ID2D1Brush> Stroke;
+					SymbolKey Key;
+					int Slot;
+				};
+
+				bool EnsureAtlas(D2DRenderContext^ context);
+				void RasterizePendingSymbols();
+
+				D2DMarkerAtlas atlas;
+				std::map<SymbolKey, Symbol> symbols;
+				std::vector<Symbol> pendingSymbols;
+
+				ID2D1DeviceContext* atlasDeviceContext;
+				ComPtr<ID2D1BitmapRenderTarget> atlasTarget;
+				ComPtr<ID2D1Bitmap> atlasBitmap;
+				bool isAtlasCleared;
+
+				// sprite batches need ID2D1DeviceContext3; older devices draw the sprites one by one from the atlas
+				ComPtr<ID2D1DeviceContext3> spriteContext;
+				ComPtr<ID2D1SpriteBatch> spriteBatch;
+			};
+		}
+	}
+}
@@ -1,6 +1,8 @@
 #include "pch.h"
 #include "D2DMultiPolygon.h"
 #include "D2DShapeStyle.h"
+#include "D2DCanvas.h"
+#include "D2DZoomGeometry.h"
 
 namespace Telerik
 {
@@ -10,37 +12,185 @@ namespace Telerik
 		{
 			D2DMultiPolygon::D2DMultiPolygon(void)
 			{
+				this->UseOwnRings();
 			}
 
-			void D2DMultiPolygon::SetPoints(IIterable<IIterable<Point>^>^ points)
+			void D2DMultiPolygon::UseOwnRings()
 			{
+				if(this->ringOffsetsArray.empty())
+				{
+					this->ringOffsetsArray.push_back(0);
+				}
+
+				this->points = this->pointsArray.data();
+				this->ringOffsets = this->ringOffsetsArray.data();
+				this->ringCount = this->ringOffsetsArray.size() - 1;
+				this->pointRanks = nullptr;
+				this->pointSource = nullptr;
+			}
+
+			void D2DMultiPolygon::SetPoints(IIterable<IIterable<DoublePoint>^>^ points)
+			{
+				this->pointsArray.clear();
+				this->ringOffsetsArray.assign(1, 0);
+
+				if(points != nullptr)
+				{
+					IIterator<IIterable<DoublePoint>^>^ rings = points->First();
+					while(rings->HasCurrent)
+					{
+						size_t ringStart = this->pointsArray.size();
+
+						IIterator<DoublePoint>^ iterator = rings->Current->First();
+						while(iterator->HasCurrent)
+						{
+							this->pointsArray.push_back(iterator->Current);
+							iterator->MoveNext();
+						}
+
+						// a single point produces no figure
+						if(this->pointsArray.size() - ringStart > 1)
+						{
+							this->ringOffsetsArray.push_back(static_cast<uint32_t>(this->pointsArray.size()));
+						}
+						else
+						{
+							this->pointsArray.resize(ringStart);
+						}
+
+						rings->MoveNext();
+					}
+				}
+
+				static_assert(sizeof(DoublePoint) == 2 * sizeof(double), "DoublePoint must be laid out as interleaved coordinates");
+
+				this->UseOwnRings();
+
+				// the rings are stored back to back, so the bounds of all of them are computed in a single pass
+				this->ResetPointBounds();
+				this->IncludePointBounds(reinterpret_cast<const double*>(this->pointsArray.data()), this->pointsArray.size());
+
+				this->Invalidate(true);
+			}
+
+			void D2DMultiPolygon::SetRings(const double* coordinates, const uint32_t* pointOffsets, size_t ringCount)
+			{
+				this->pointsArray.clear();
+				this->ringOffsetsArray.assign(1, 0);
+
+				const DoublePoint* points = reinterpret_cast<const DoublePoint*>(coordinates);
+				for(size_t i = 0; i < ringCount; i++)
+				{
+					// a single point produces no figure
+					if(pointOffsets[i + 1] - pointOffsets[i] > 1)
+					{
+						this->pointsArray.insert(this->pointsArray.end(), points + pointOffsets[i], points + pointOffsets[i + 1]);
+						this->ringOffsetsArray.push_back(static_cast<uint32_t>(this->pointsArray.size()));
+					}
+				}
+
+				this->UseOwnRings();
+				this->ResetPointBounds();
+				this->IncludePointBounds(reinterpret_cast<const double*>(this->pointsArray.data()), this->pointsArray.size());
+
+				this->Invalidate(true);
+			}
+
+			void D2DMultiPolygon::SetMappedRings(Platform::Object^ source, const double* coordinates, const uint32_t* pointOffsets, size_t ringCount, const float* ranks, const D2DPointBounds& bounds)
+			{
+				this->pointsArray.clear();
+				this->pointsArray.shrink_to_fit();
+				this->ringOffsetsArray.assign(1, 0);
+				this->ringOffsetsArray.shrink_to_fit();
+
+				this->points = reinterpret_cast<const DoublePoint*>(coordinates);
+				this->ringOffsets = pointOffsets;
+				this->ringCount = ringCount;
+				this->pointRanks = ranks;
+				this->pointSource = source;
+
+				// the pages of the points are not touched until the geometry is built
+				this->SetPointBounds(bounds);
+
+				this->Invalidate(true);
+			}
+
+			const DoublePoint* D2DMultiPolygon::GetRings(const uint32_t** pointOffsets, size_t* ringCount)
+			{
+				*pointOffsets = this->ringOffsets;
+				*ringCount = this->ringCount;
+
+				return this->points;
 			}
 
 			void D2DMultiPolygon::Populate(ComPtr<ID2D1GeometrySink> sink)
 			{
-				if(this->pointsArray.size() == 0)
+				if(this->ringCount == 0)
 				{
 					return;
 				}
 
-				D2D1_FIGURE_BEGIN begin = this->CurrentStyle->Fill == nullptr ? D2D1_FIGURE_BEGIN_HOLLOW : D2D1_FIGURE_BEGIN_FILLED;
+				// open shapes are multi-part polylines and are only stroked
+				D2D1_FIGURE_BEGIN begin = this->IsClosed ? D2D1_FIGURE_BEGIN_FILLED : D2D1_FIGURE_BEGIN_HOLLOW;
+				D2D1_FIGURE_END end = this->IsClosed ? D2D1_FIGURE_END_CLOSED : D2D1_FIGURE_END_OPEN;
 				sink->SetFillMode(static_cast<D2D1_FILL_MODE>(this->FillMode));
 
-				for(auto i = this->pointsArray.begin(); i != this->pointsArray.end(); ++i)
+				for(size_t i = 0; i < this->ringCount; i++)
 				{
-					if((*i).size() <= 1)
+					// a single point produces no figure
+					if(this->ringOffsets[i + 1] - this->ringOffsets[i] > 1)
 					{
-						continue;
+						this->PopulateRing(sink, this->ringOffsets[i], this->ringOffsets[i + 1], begin, end);
 					}
+				}
 
-					D2D_POINT_2F pt = (*i).at(0);
-					sink->BeginFigure(pt, begin);
+				// the buffer is not kept while the shape is idle
+				this->figurePoints.clear();
+				this->figurePoints.shrink_to_fit();
+			}
+
+			void D2DMultiPolygon::PopulateRing(ComPtr<ID2D1GeometrySink> sink, size_t start, size_t end, D2D1_FIGURE_BEGIN begin, D2D1_FIGURE_END figureEnd)
+			{
+				// model-space geometry keeps the points as they are
+				double zoomFactor = 1;
+				DoublePoint offset;
+				offset.X = 0;
+				offset.Y = 0;
+
+				if(this->renderPrecision == ShapeRenderPrecision::Double)
+				{
+					zoomFactor = this->Owner->PixelZoomFactor;
+					offset = this->Owner->PixelViewportOrigin;
+				}
 
-					D2D_POINT_2F *allPoints = &(*i)[0];
-					sink->AddLines(allPoints, (UINT32)(*i).size());
+				// pixel-space geometry is built for a single zoom band, so the points that stay within a fraction of a pixel
+				// of the simplified ring are left out; their ranks are never above those of the points kept around them
+				float tolerance = 0;
+				if(this->pointRanks != nullptr && this->renderPrecision == ShapeRenderPrecision::Double)
+				{
+					tolerance = D2DZoomGeometry::GetSimplificationTolerance(zoomFactor);
+				}
+
+				this->figurePoints.resize(end - start);
+				size_t count = D2DZoomGeometry::BuildRingPoints(
+					reinterpret_cast<const double*>(this->points + start),
+					this->pointRanks != nullptr ? this->pointRanks + start : nullptr,
+					end - start,
+					zoomFactor,
+					offset.X,
+					offset.Y,
+					tolerance,
+					reinterpret_cast<float*>(this->figurePoints.data()));
+				this->figurePoints.resize(count);
 
-					sink->EndFigure(D2D1_FIGURE_END_CLOSED);
+				if(this->figurePoints.size() < 2)
+				{
+					return;
 				}
+
+				sink->BeginFigure(this->figurePoints[0], begin);
+				sink->AddLines(this->figurePoints.data() + 1, static_cast<UINT32>(this->figurePoints.size() - 1));
+				sink->EndFigure(figureEnd);
 			}
 		}
 	}
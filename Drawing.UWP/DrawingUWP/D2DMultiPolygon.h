@@ -9,20 +9,48 @@ namespace Telerik
 	{
 		namespace Drawing
 		{
+			// renders all parts and holes of a shape as figures of a single geometry;
+			// holes are cut out by the fill mode (Alternate) or by their opposite winding (Winding)
 			public ref class D2DMultiPolygon sealed : D2DGeometryShape
 			{
 			public:
 				D2DMultiPolygon(void);
 
-				void SetPoints(IIterable<IIterable<Point>^>^ points);
+				void SetPoints(IIterable<IIterable<DoublePoint>^>^ points);
 
 			internal:
+				// sets the rings from flat buffers without marshaling the points one by one;
+				// ring i spans the interleaved coordinates of the points [pointOffsets[i], pointOffsets[i + 1])
+				void SetRings(const double* coordinates, const uint32_t* pointOffsets, size_t ringCount);
+
+				// uses the rings in place instead of copying them; the source keeps the buffers alive for as long as the shape
+				// references them. The ranks, if any, are the simplification tolerances (in model units) below which the
+				// points are dropped from pixel-space geometry, and the bounds spare a pass over the points
+				void SetMappedRings(Platform::Object^ source, const double* coordinates, const uint32_t* pointOffsets, size_t ringCount, const float* ranks, const D2DPointBounds& bounds);
+
+				// the rings as they are stored, including rings of a single point
+				const DoublePoint* GetRings(const uint32_t** pointOffsets, size_t* ringCount);
+
 				virtual void Populate(ComPtr<ID2D1GeometrySink> sink) override;
 
 			private:
-				std::vector<std::vector<D2D_POINT_2F>> pointsArray;
+				void PopulateRing(ComPtr<ID2D1GeometrySink> sink, size_t start, size_t end, D2D1_FIGURE_BEGIN begin, D2D1_FIGURE_END figureEnd);
+				void UseOwnRings();
+
+				// the points of all rings are stored back to back; ring i spans the points [ringOffsets[i], ringOffsets[i + 1]).
+				// they point either to the buffers of the shape or to buffers kept alive by the source
+				const DoublePoint* points;
+				const uint32_t* ringOffsets;
+				const float* pointRanks;
+				size_t ringCount;
+				Platform::Object^ pointSource;
+
+				std::vector<DoublePoint> pointsArray;
+				std::vector<uint32_t> ringOffsetsArray;
+
+				// reused between the figures to pass each ring to the sink in a single call
+				std::vector<D2D1_POINT_2F> figurePoints;
 			};
 		}
 	}
 }
-
@@ -0,0 +1,209 @@
+#include "pch.h"
+#include "D2DPackedRTree.h"
+#include <algorithm>
+
+// the centers of the items are snapped to a grid of this many cells on each axis before their Hilbert values are computed
+const double HilbertGridSize = 65535;
+
+namespace Telerik
+{
+	namespace UI
+	{
+		namespace Drawing
+		{
+			size_t D2DPackedRTree::GetNodeCount(size_t count, uint16_t nodeSize)
+			{
+				if(count == 0 || nodeSize < 2)
+				{
+					return 0;
+				}
+
+				std::vector<size_t> levelBounds;
+				GetLevelBounds(count, nodeSize, &levelBounds);
+
+				return levelBounds[1];
+			}
+
+			void D2DPackedRTree::GetLevelBounds(size_t count, uint16_t nodeSize, std::vector<size_t>* levelBounds)
+			{
+				std::vector<size_t> levelCounts;
+				size_t levelCount = count;
+				size_t nodeCount = count;
+
+				levelCounts.push_back(levelCount);
+				do
+				{
+					levelCount = (levelCount + nodeSize - 1) / nodeSize;
+					levelCounts.push_back(levelCount);
+					nodeCount += levelCount;
+				}
+				while(levelCount != 1);
+
+				// each level is stored before the one below it
+				levelBounds->clear();
+				size_t end = nodeCount;
+				for(auto size = levelCounts.begin(); size != levelCounts.end(); ++size)
+				{
+					levelBounds->push_back(end - *size);
+					levelBounds->push_back(end);
+					end -= *size;
+				}
+			}
+
+			uint32_t D2DPackedRTree::GetHilbertValue(uint32_t x, uint32_t y)
+			{
+				// the branch-free conversion of the 16-bit grid coordinates to their distance along the curve
+				uint32_t a = x ^ y;
+				uint32_t b = 0xFFFF ^ a;
+				uint32_t c = 0xFFFF ^ (x | y);
+				uint32_t d = x & (y ^ 0xFFFF);
+
+				uint32_t A = a | (b >> 1);
+				uint32_t B = (a >> 1) ^ a;
+				uint32_t C = ((c >> 1) ^ (b & (d >> 1))) ^ c;
+				uint32_t D = ((a & (c >> 1)) ^ (d >> 1)) ^ d;
+
+				a = A; b = B; c = C; d = D;
+				A = ((a & (a >> 2)) ^ (b & (b >> 2)));
+				B = ((a & (b >> 2)) ^ (b & ((a ^ b) >> 2)));
+				C ^= ((a & (c >> 2)) ^ (b & (d >> 2)));
+				D ^= ((b & (c >> 2)) ^ ((a ^ b) & (d >> 2)));
+
+				a = A; b = B; c = C; d = D;
+				A = ((a & (a >> 4)) ^ (b & (b >> 4)));
+				B = ((a & (b >> 4)) ^ (b & ((a ^ b) >> 4)));
+				C ^= ((a & (c >> 4)) ^ (b & (d >> 4)));
+				D ^= ((b & (c >> 4)) ^ ((a ^ b) & (d >> 4)));
+
+				a = A; b = B; c = C; d = D;
+				C ^= ((a & (c >> 8)) ^ (b & (d >> 8)));
+				D ^= ((b & (c >> 8)) ^ ((a ^ b) & (d >> 8)));
+
+				a = C ^ (C >> 1);
+				b = D ^ (D >> 1);
+
+				uint32_t i0 = x ^ y;
+				uint32_t i1 = b | (0xFFFF ^ (i0 | a));
+
+				i0 = (i0 | (i0 << 8)) & 0x00FF00FF;
+				i0 = (i0 | (i0 << 4)) & 0x0F0F0F0F;
+				i0 = (i0 | (i0 << 2)) & 0x33333333;
+				i0 = (i0 | (i0 << 1)) & 0x55555555;
+
+				i1 = (i1 | (i1 << 8)) & 0x00FF00FF;
+				i1 = (i1 | (i1 << 4)) & 0x0F0F0F0F;
+				i1 = (i1 | (i1 << 2)) & 0x33333333;
+				i1 = (i1 | (i1 << 1)) & 0x55555555;
+
+				return (i1 << 1) | i0;
+			}
+
+			void D2DPackedRTree::SortByHilbert(const D2DRTreeNode* boxes, size_t count, double minX, double minY, double maxX, double maxY, std::vector<uint32_t>* order)
+			{
+				double scaleX = maxX > minX ? HilbertGridSize / (maxX - minX) : 0;
+				double scaleY = maxY > minY ? HilbertGridSize / (maxY - minY) : 0;
+
+				// the value and the index are sorted together as a single key, which keeps equal values in input order
+				std::vector<uint64_t> keys(count);
+				for(size_t i = 0; i < count; i++)
+				{
+					const D2DRTreeNode& box = boxes[i];
+					uint32_t x = static_cast<uint32_t>(((box.MinX + box.MaxX) / 2 - minX) * scaleX);
+					uint32_t y = static_cast<uint32_t>(((box.MinY + box.MaxY) / 2 - minY) * scaleY);
+
+					keys[i] = (static_cast<uint64_t>(GetHilbertValue((std::min)(x, 0xFFFFu), (std::min)(y, 0xFFFFu))) << 32) | i;
+				}
+
+				std::sort(keys.begin(), keys.end());
+
+				order->resize(count);
+				for(size_t i = 0; i < count; i++)
+				{
+					(*order)[i] = static_cast<uint32_t>(keys[i]);
+				}
+			}
+
+			bool D2DPackedRTree::Build(D2DRTreeNode* nodes, size_t nodeCount, size_t count, uint16_t nodeSize)
+			{
+				if(nodeCount == 0 || nodeCount != GetNodeCount(count, nodeSize))
+				{
+					return false;
+				}
+
+				std::vector<size_t> levelBounds;
+				GetLevelBounds(count, nodeSize, &levelBounds);
+
+				// each group of nodeSize nodes gets a parent in the level above
+				size_t levelCount = levelBounds.size() / 2;
+				for(size_t level = 0; level + 1 < levelCount; level++)
+				{
+					size_t start = levelBounds[2 * level];
+					size_t end = levelBounds[2 * level + 1];
+					size_t parent = levelBounds[2 * (level + 1)];
+
+					for(size_t child = start; child < end; child += nodeSize, parent++)
+					{
+						D2DRTreeNode& node = nodes[parent];
+						node = nodes[child];
+						node.Offset = child;
+
+						size_t childEnd = (std::min)(child + nodeSize, end);
+						for(size_t i = child + 1; i < childEnd; i++)
+						{
+							node.MinX = (std::min)(node.MinX, nodes[i].MinX);
+							node.MinY = (std::min)(node.MinY, nodes[i].MinY);
+							node.MaxX = (std::max)(node.MaxX, nodes[i].MaxX);
+							node.MaxY = (std::max)(node.MaxY, nodes[i].MaxY);
+						}
+					}
+				}
+
+				return true;
+			}
+
+			void D2DPackedRTree::Search(const D2DRTreeNode* nodes, size_t nodeCount, size_t count, uint16_t nodeSize, double minX, double minY, double maxX, double maxY, std::vector<uint32_t>* leaves)
+			{
+				if(nodeCount == 0)
+				{
+					return;
+				}
+
+				std::vector<size_t> levelBounds;
+				GetLevelBounds(count, nodeSize, &levelBounds);
+
+				size_t leafStart = nodeCount - count;
+
+				// pairs of the first node of a group and its level
+				std::vector<std::pair<size_t, size_t>> stack;
+				stack.push_back(std::make_pair(static_cast<size_t>(0), levelBounds.size() / 2 - 1));
+
+				while(!stack.empty())
+				{
+					size_t start = stack.back().first;
+					size_t level = stack.back().second;
+					stack.pop_back();
+
+					size_t end = (std::min)(start + nodeSize, levelBounds[2 * level + 1]);
+					for(size_t i = start; i < end; i++)
+					{
+						const D2DRTreeNode& node = nodes[i];
+						if(node.MaxX < minX || node.MaxY < minY || node.MinX > maxX || node.MinY > maxY)
+						{
+							continue;
+						}
+
+						if(i >= leafStart)
+						{
+							leaves->push_back(static_cast<uint32_t>(i - leafStart));
+						}
+						else if(node.Offset < nodeCount && level > 0)
+						{
+							// an offset read from a file is checked before it is followed
+							stack.push_back(std::make_pair(static_cast<size_t>(node.Offset), level - 1));
+						}
+					}
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+namespace Telerik
+{
+	namespace UI
+	{
+		namespace Drawing
+		{
+			// a node of a packed R-tree; a leaf holds the bounds of an item and an offset chosen by the caller,
+			// any other node holds the bounds of its children and the index of the first one
+			struct D2DRTreeNode
+			{
+				double MinX;
+				double MinY;
+				double MaxX;
+				double MaxY;
+				uint64_t Offset;
+			};
+
+			// a static R-tree packed into a flat array of nodes, as in FlatGeobuf: the items are sorted along a Hilbert curve
+			// and grouped NodeSize at a time, level by level, with the root first and the leaves last. The array needs no
+			// pointers, so a tree written to a file is searched in place from a mapped view
+			class D2DPackedRTree
+			{
+			public:
+				// the number of nodes of a tree over count items, 0 if there are no items
+				static size_t GetNodeCount(size_t count, uint16_t nodeSize);
+
+				// the order in which the items are stored: the indices of the boxes sorted by the Hilbert value of their centers
+				static void SortByHilbert(const D2DRTreeNode* boxes, size_t count, double minX, double minY, double maxX, double maxY, std::vector<uint32_t>* order);
+
+				// builds the inner levels over the leaves, which the caller stores at the end of the nodes in their final order
+				static bool Build(D2DRTreeNode* nodes, size_t nodeCount, size_t count, uint16_t nodeSize);
+
+				// appends the indices (in storage order) of the leaves intersecting the rect
+				static void Search(const D2DRTreeNode* nodes, size_t nodeCount, size_t count, uint16_t nodeSize, double minX, double minY, double maxX, double maxY, std::vector<uint32_t>* leaves);
+
+			private:
+				// the [start, end) nodes of each level, from the leaves up to the root
+				static void GetLevelBounds(size_t count, uint16_t nodeSize, std::vector<size_t>* levelBounds);
+				static uint32_t GetHilbertValue(uint32_t x, uint32_t y);
+			};
+		}
+	}
+}
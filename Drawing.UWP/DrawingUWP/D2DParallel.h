@@ -0,0 +1,57 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace Telerik
+{
+	namespace UI
+	{
+		namespace Drawing
+		{
+			// runs a loop over the hardware threads; the indices are handed out one at a time, so each one should stand for a
+			// coarse piece of work (a tile, a chunk of records) rather than a single element
+			class D2DParallel
+			{
+			public:
+				static size_t GetWorkerCount(size_t count)
+				{
+					size_t threadCount = (std::max)(std::thread::hardware_concurrency(), 1u);
+					return (std::min)(count, threadCount);
+				}
+
+				// calls body(index, worker) for each index in [0, count); the worker is below GetWorkerCount(count),
+				// so that callers can keep a buffer per worker. The calling thread is one of the workers
+				template<typename Body>
+				static void For(size_t count, const Body& body)
+				{
+					size_t workerCount = GetWorkerCount(count);
+					std::atomic<size_t> nextIndex(0);
+
+					auto work = [&](size_t worker)
+					{
+						for(size_t i = nextIndex.fetch_add(1); i < count; i = nextIndex.fetch_add(1))
+						{
+							body(i, worker);
+						}
+					};
+
+					std::vector<std::thread> workers;
+					for(size_t worker = 1; worker < workerCount; worker++)
+					{
+						workers.push_back(std::thread(work, worker));
+					}
+
+					work(0);
+
+					for(auto thread = workers.begin(); thread != workers.end(); ++thread)
+					{
+						thread->join();
+					}
+				}
+			};
+		}
+	}
+}
@@ -0,0 +1,108 @@
+#include "pch.h"
+#include "D2DPointKernels.h"
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__SSE2__) || defined(__x86_64__)
+#include <emmintrin.h>
+#define D2D_POINT_KERNELS_SSE
+#endif
+
+namespace Telerik
+{
+	namespace UI
+	{
+		namespace Drawing
+		{
+			bool D2DPointKernels::ComputeBounds(const double* coordinates, size_t pointCount, D2DPointBounds* bounds)
+			{
+				if(pointCount == 0)
+				{
+					return false;
+				}
+
+#ifdef D2D_POINT_KERNELS_SSE
+				// each register holds one (x, y) pair; two independent accumulators hide the latency of min/max
+				__m128d min0 = _mm_loadu_pd(coordinates);
+				__m128d max0 = min0;
+				__m128d min1 = min0;
+				__m128d max1 = min0;
+
+				size_t i = 1;
+				for(; i + 1 < pointCount; i += 2)
+				{
+					__m128d first = _mm_loadu_pd(coordinates + 2 * i);
+					__m128d second = _mm_loadu_pd(coordinates + 2 * i + 2);
+
+					min0 = _mm_min_pd(min0, first);
+					max0 = _mm_max_pd(max0, first);
+					min1 = _mm_min_pd(min1, second);
+					max1 = _mm_max_pd(max1, second);
+				}
+
+				if(i < pointCount)
+				{
+					__m128d last = _mm_loadu_pd(coordinates + 2 * i);
+					min0 = _mm_min_pd(min0, last);
+					max0 = _mm_max_pd(max0, last);
+				}
+
+				double minValues[2];
+				double maxValues[2];
+				_mm_storeu_pd(minValues, _mm_min_pd(min0, min1));
+				_mm_storeu_pd(maxValues, _mm_max_pd(max0, max1));
+
+				bounds->MinX = minValues[0];
+				bounds->MinY = minValues[1];
+				bounds->MaxX = maxValues[0];
+				bounds->MaxY = maxValues[1];
+#else
+				bounds->MinX = bounds->MaxX = coordinates[0];
+				bounds->MinY = bounds->MaxY = coordinates[1];
+
+				for(size_t i = 1; i < pointCount; i++)
+				{
+					double x = coordinates[2 * i];
+					double y = coordinates[2 * i + 1];
+
+					bounds->MinX = x < bounds->MinX ? x : bounds->MinX;
+					bounds->MinY = y < bounds->MinY ? y : bounds->MinY;
+					bounds->MaxX = x > bounds->MaxX ? x : bounds->MaxX;
+					bounds->MaxY = y > bounds->MaxY ? y : bounds->MaxY;
+				}
+#endif
+
+				return true;
+			}
+
+			void D2DPointKernels::UnionBounds(D2DPointBounds* bounds, const D2DPointBounds& other)
+			{
+				bounds->MinX = other.MinX < bounds->MinX ? other.MinX : bounds->MinX;
+				bounds->MinY = other.MinY < bounds->MinY ? other.MinY : bounds->MinY;
+				bounds->MaxX = other.MaxX > bounds->MaxX ? other.MaxX : bounds->MaxX;
+				bounds->MaxY = other.MaxY > bounds->MaxY ? other.MaxY : bounds->MaxY;
+			}
+
+			void D2DPointKernels::TransformPoints(const double* coordinates, size_t pointCount, double scale, double offsetX, double offsetY, float* output)
+			{
+				size_t i = 0;
+
+#ifdef D2D_POINT_KERNELS_SSE
+				// two points are converted to floats at a time and stored as one register
+				__m128d factor = _mm_set1_pd(scale);
+				__m128d offset = _mm_setr_pd(offsetX, offsetY);
+				for(; i + 2 <= pointCount; i += 2)
+				{
+					__m128 first = _mm_cvtpd_ps(_mm_add_pd(_mm_mul_pd(_mm_loadu_pd(coordinates + 2 * i), factor), offset));
+					__m128 second = _mm_cvtpd_ps(_mm_add_pd(_mm_mul_pd(_mm_loadu_pd(coordinates + 2 * i + 2), factor), offset));
+					_mm_storeu_ps(output + 2 * i, _mm_movelh_ps(first, second));
+				}
+#endif
+
+				for(; i < pointCount; i++)
+				{
+					output[2 * i] = static_cast<float>(coordinates[2 * i] * scale + offsetX);
+					output[2 * i + 1] = static_cast<float>(coordinates[2 * i + 1] * scale + offsetY);
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+
+namespace Telerik
+{
+	namespace UI
+	{
+		namespace Drawing
+		{
+			struct D2DPointBounds
+			{
+				double MinX;
+				double MinY;
+				double MaxX;
+				double MaxY;
+			};
+
+			// bulk operations over interleaved (x, y) double coordinates
+			class D2DPointKernels
+			{
+			public:
+				// returns false if there are no points
+				static bool ComputeBounds(const double* coordinates, size_t pointCount, D2DPointBounds* bounds);
+
+				// extends the bounds with another set of points
+				static void UnionBounds(D2DPointBounds* bounds, const D2DPointBounds& other);
+
+				// scales and offsets the points into interleaved float (x, y) output, laid out as D2D1_POINT_2F
+				static void TransformPoints(const double* coordinates, size_t pointCount, double scale, double offsetX, double offsetY, float* output);
+			};
+		}
+	}
+}
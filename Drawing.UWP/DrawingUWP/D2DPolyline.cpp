@@ -28,6 +28,15 @@ namespace Telerik
 					iterator->MoveNext();
 				}
 
+				static_assert(sizeof(DoublePoint) == 2 * sizeof(double), "DoublePoint must be laid out as interleaved coordinates");
+
+				// a single point produces no figure and therefore has no bounds
+				this->ResetPointBounds();
+				if(this->pointsArray.size() > 1)
+				{
+					this->IncludePointBounds(reinterpret_cast<const double*>(this->pointsArray.data()), this->pointsArray.size());
+				}
+
 				this->Invalidate(true);
 			}
 
@@ -23,6 +23,8 @@ namespace Telerik
 			internal:
 				virtual void Populate(ComPtr<ID2D1GeometrySink> sink) override;
 
+				const std::vector<DoublePoint>& GetPoints() { return this->pointsArray; }
+
 			private:
 				void PopulateSinglePrecision(ComPtr<ID2D1GeometrySink> sink, D2D1_FIGURE_BEGIN begin);
 				void PopulateDoublePrecision(ComPtr<ID2D1GeometrySink> sink, D2D1_FIGURE_BEGIN begin);
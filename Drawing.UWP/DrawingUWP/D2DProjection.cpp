@@ -0,0 +1,196 @@
+#include "pch.h"
+#include "D2DProjection.h"
+#include "D2DParallel.h"
+#include <algorithm>
+#include <cmath>
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__SSE2__) || defined(__x86_64__)
+#include <emmintrin.h>
+#define D2D_PROJECTION_SSE
+#endif
+
+// the constants of MercatorProjection: ScaleX and -ScaleY (SpatialReference.HalfPI, which is 1 / 2pi) and the offsets
+const double DegreesToRadians = 0.017453292519943295;
+const double MercatorScale = 0.159154943091895;
+const double MercatorOffset = 0.5;
+
+// points are projected in chunks of this many points when the work is split over the hardware threads
+const size_t ProjectionPointsPerChunk = 65536;
+
+#ifdef D2D_PROJECTION_SSE
+// the vector path covers the latitudes up to this many degrees; the poles, where 1 - sin(latitude) cancels to zero,
+// and damaged values take the scalar formula. Every map shows at most 85.05 degrees, so in practice all points are vectorized
+const double VectorLatitudeLimit = 89.0;
+
+// Taylor coefficients of sin(x) from x^3 to x^21; on [-pi/2, pi/2] the first term left out is below 2e-18
+const double SinCoefficients[] =
+{
+	-1.0 / 6.0, 1.0 / 120.0, -1.0 / 5040.0, 1.0 / 362880.0, -1.0 / 39916800.0, 1.0 / 6227020800.0, -1.0 / 1307674368000.0,
+	1.0 / 355687428096000.0, -1.0 / 121645100408832000.0, 1.0 / 51090942171709440000.0
+};
+
+// coefficients of atanh(z) = z + z^3 / 3 + z^5 / 5 + ... up to z^21; the reduced argument stays below 0.172, where the
+// first term left out is below 1e-17
+const double AtanhCoefficients[] =
+{
+	1.0 / 3.0, 1.0 / 5.0, 1.0 / 7.0, 1.0 / 9.0, 1.0 / 11.0, 1.0 / 13.0, 1.0 / 15.0, 1.0 / 17.0, 1.0 / 19.0, 1.0 / 21.0
+};
+
+const double Ln2 = 0.69314718055994530942;
+const double Sqrt2 = 1.41421356237309504880;
+#endif
+
+namespace Telerik
+{
+	namespace UI
+	{
+		namespace Drawing
+		{
+#ifdef D2D_PROJECTION_SSE
+			// c[0] + c[1] t + ... + c[9] t^9 by Estrin's scheme: the terms are paired and combined with t^2, t^4 and t^8,
+			// which makes the dependency chain a third as long as Horner's, where every step waits for the one before
+			static inline __m128d EvaluatePolynomial(const double* c, __m128d t)
+			{
+				__m128d t2 = _mm_mul_pd(t, t);
+				__m128d t4 = _mm_mul_pd(t2, t2);
+				__m128d t8 = _mm_mul_pd(t4, t4);
+
+				__m128d a0 = _mm_add_pd(_mm_set1_pd(c[0]), _mm_mul_pd(_mm_set1_pd(c[1]), t));
+				__m128d a1 = _mm_add_pd(_mm_set1_pd(c[2]), _mm_mul_pd(_mm_set1_pd(c[3]), t));
+				__m128d a2 = _mm_add_pd(_mm_set1_pd(c[4]), _mm_mul_pd(_mm_set1_pd(c[5]), t));
+				__m128d a3 = _mm_add_pd(_mm_set1_pd(c[6]), _mm_mul_pd(_mm_set1_pd(c[7]), t));
+				__m128d a4 = _mm_add_pd(_mm_set1_pd(c[8]), _mm_mul_pd(_mm_set1_pd(c[9]), t));
+
+				__m128d b0 = _mm_add_pd(a0, _mm_mul_pd(a1, t2));
+				__m128d b1 = _mm_add_pd(a2, _mm_mul_pd(a3, t2));
+
+				return _mm_add_pd(_mm_add_pd(b0, _mm_mul_pd(b1, t4)), _mm_mul_pd(a4, t8));
+			}
+
+			// ln(tan(pi / 4 + phi / 2)) of two latitudes in radians, computed as its equal atanh(sin(phi)) = ln(r) / 2 with
+			// r = (1 + sin(phi)) / (1 - sin(phi)): r is split into 2^e * m with m in [sqrt(2) / 2, sqrt(2)], and ln(m) is
+			// 2 * atanh((m - 1) / (m + 1)), a quickly converging odd series
+			static inline __m128d MercatorY(__m128d phi)
+			{
+				__m128d one = _mm_set1_pd(1.0);
+
+				__m128d phi2 = _mm_mul_pd(phi, phi);
+				__m128d sinSeries = EvaluatePolynomial(SinCoefficients, phi2);
+				__m128d sine = _mm_add_pd(phi, _mm_mul_pd(_mm_mul_pd(phi, phi2), sinSeries));
+
+				__m128d ratio = _mm_div_pd(_mm_add_pd(one, sine), _mm_sub_pd(one, sine));
+
+				// the ratio is positive and finite here, so its exponent and mantissa can be read from its bits
+				__m128i bits = _mm_castpd_si128(ratio);
+				__m128i exponentBits = _mm_srli_epi64(bits, 52);
+				__m128d exponent = _mm_sub_pd(_mm_cvtepi32_pd(_mm_shuffle_epi32(exponentBits, _MM_SHUFFLE(3, 3, 2, 0))), _mm_set1_pd(1023.0));
+
+				__m128i mantissaMask = _mm_set_epi32(0x000FFFFF, static_cast<int>(0xFFFFFFFF), 0x000FFFFF, static_cast<int>(0xFFFFFFFF));
+				__m128d mantissa = _mm_or_pd(_mm_castsi128_pd(_mm_and_si128(bits, mantissaMask)), one);
+
+				__m128d isLarge = _mm_cmpgt_pd(mantissa, _mm_set1_pd(Sqrt2));
+				mantissa = _mm_or_pd(_mm_and_pd(isLarge, _mm_mul_pd(mantissa, _mm_set1_pd(0.5))), _mm_andnot_pd(isLarge, mantissa));
+				exponent = _mm_add_pd(exponent, _mm_and_pd(isLarge, one));
+
+				__m128d z = _mm_div_pd(_mm_sub_pd(mantissa, one), _mm_add_pd(mantissa, one));
+				__m128d z2 = _mm_mul_pd(z, z);
+				__m128d atanhSeries = EvaluatePolynomial(AtanhCoefficients, z2);
+				__m128d atanhZ = _mm_add_pd(z, _mm_mul_pd(_mm_mul_pd(z, z2), atanhSeries));
+
+				// ln(r) / 2 = e * ln(2) / 2 + atanh(z)
+				return _mm_add_pd(_mm_mul_pd(exponent, _mm_set1_pd(Ln2 * 0.5)), atanhZ);
+			}
+#endif
+
+			void D2DProjection::ProjectMercator(double* coordinates, size_t pointCount, double worldSize)
+			{
+				size_t i = 0;
+
+#ifdef D2D_PROJECTION_SSE
+				__m128d degreesToRadians = _mm_set1_pd(DegreesToRadians);
+				__m128d scaleX = _mm_set1_pd(MercatorScale);
+				__m128d scaleY = _mm_set1_pd(-MercatorScale);
+				__m128d offset = _mm_set1_pd(MercatorOffset);
+				__m128d size = _mm_set1_pd(worldSize);
+				__m128d bottom = _mm_set1_pd(1.0);
+				__m128d limit = _mm_set1_pd(VectorLatitudeLimit);
+				__m128d absoluteMask = _mm_castsi128_pd(_mm_set_epi32(0x7FFFFFFF, static_cast<int>(0xFFFFFFFF), 0x7FFFFFFF, static_cast<int>(0xFFFFFFFF)));
+
+				// four points per iteration, with the longitudes and the latitudes of each two gathered into one register:
+				// the series are long dependency chains, and two independent ones keep the multipliers busy
+				for(; i + 3 < pointCount; i += 4)
+				{
+					double* points = coordinates + 2 * i;
+					__m128d first = _mm_loadu_pd(points);
+					__m128d second = _mm_loadu_pd(points + 2);
+					__m128d third = _mm_loadu_pd(points + 4);
+					__m128d fourth = _mm_loadu_pd(points + 6);
+
+					__m128d longitudes0 = _mm_unpacklo_pd(first, second);
+					__m128d latitudes0 = _mm_unpackhi_pd(first, second);
+					__m128d longitudes1 = _mm_unpacklo_pd(third, fourth);
+					__m128d latitudes1 = _mm_unpackhi_pd(third, fourth);
+
+					// NaN fails the comparison as well
+					__m128d isInRange0 = _mm_cmple_pd(_mm_and_pd(latitudes0, absoluteMask), limit);
+					__m128d isInRange1 = _mm_cmple_pd(_mm_and_pd(latitudes1, absoluteMask), limit);
+					if(_mm_movemask_pd(_mm_and_pd(isInRange0, isInRange1)) != 3)
+					{
+						for(size_t point = 0; point < 4; point++)
+						{
+							ProjectMercatorPoint(points + 2 * point, worldSize);
+						}
+						continue;
+					}
+
+					__m128d x0 = _mm_add_pd(_mm_mul_pd(_mm_mul_pd(longitudes0, degreesToRadians), scaleX), offset);
+					__m128d x1 = _mm_add_pd(_mm_mul_pd(_mm_mul_pd(longitudes1, degreesToRadians), scaleX), offset);
+					__m128d y0 = _mm_add_pd(_mm_mul_pd(MercatorY(_mm_mul_pd(latitudes0, degreesToRadians)), scaleY), offset);
+					__m128d y1 = _mm_add_pd(_mm_mul_pd(MercatorY(_mm_mul_pd(latitudes1, degreesToRadians)), scaleY), offset);
+
+					x0 = _mm_mul_pd(x0, size);
+					x1 = _mm_mul_pd(x1, size);
+					y0 = _mm_mul_pd(_mm_min_pd(y0, bottom), size);
+					y1 = _mm_mul_pd(_mm_min_pd(y1, bottom), size);
+
+					_mm_storeu_pd(points, _mm_unpacklo_pd(x0, y0));
+					_mm_storeu_pd(points + 2, _mm_unpackhi_pd(x0, y0));
+					_mm_storeu_pd(points + 4, _mm_unpacklo_pd(x1, y1));
+					_mm_storeu_pd(points + 6, _mm_unpackhi_pd(x1, y1));
+				}
+#endif
+
+				for(; i < pointCount; i++)
+				{
+					ProjectMercatorPoint(coordinates + 2 * i, worldSize);
+				}
+			}
+
+			void D2DProjection::ProjectMercatorInParallel(double* coordinates, size_t pointCount, double worldSize)
+			{
+				size_t chunkCount = (pointCount + ProjectionPointsPerChunk - 1) / ProjectionPointsPerChunk;
+				D2DParallel::For(chunkCount, [&](size_t chunk, size_t)
+				{
+					size_t start = chunk * ProjectionPointsPerChunk;
+					ProjectMercator(coordinates + 2 * start, (std::min)(ProjectionPointsPerChunk, pointCount - start), worldSize);
+				});
+			}
+
+			void D2DProjection::ProjectMercatorPoint(double* point, double worldSize)
+			{
+				double sine = sin(point[1] * DegreesToRadians);
+
+				double x = point[0] * DegreesToRadians * MercatorScale + MercatorOffset;
+				double y = 0.5 * log((1.0 + sine) / (1.0 - sine)) * -MercatorScale + MercatorOffset;
+
+				if(y > 1)
+				{
+					y = 1;
+				}
+
+				point[0] = x * worldSize;
+				point[1] = y * worldSize;
+			}
+		}
+	}
+}
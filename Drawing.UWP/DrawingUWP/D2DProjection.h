@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstddef>
+
+namespace Telerik
+{
+	namespace UI
+	{
+		namespace Drawing
+		{
+			// bulk map projections over interleaved (longitude, latitude) double coordinates, in place
+			class D2DProjection
+			{
+			public:
+				// the spherical Mercator of MercatorProjection and RadMap::ConvertGeographicToPixelCoordinate: the world maps
+				// to a square of worldSize units (RadMap uses 512), with y growing to the south and clamped at the bottom edge
+				static void ProjectMercator(double* coordinates, size_t pointCount, double worldSize);
+
+				// the same, split into chunks over the hardware threads; for whole decoded files rather than single batches
+				static void ProjectMercatorInParallel(double* coordinates, size_t pointCount, double worldSize);
+
+				// the scalar formula of SpatialReference::ConvertGeographicToLogicalCoordinate for a single point
+				static void ProjectMercatorPoint(double* point, double worldSize);
+			};
+		}
+	}
+}
@@ -48,12 +48,14 @@ namespace Telerik
 				virtual Windows::Foundation::Rect GetBoundsCore() override;
 				virtual bool HitTest(Point location) override;
 
+				// the top-left corner of the rectangle in render space
+				Point GetLocation();
+
 			private protected:
 				virtual void RenderFill(D2DRenderContext^ context) override;
 				virtual void RenderStroke(D2DRenderContext^ context) override;
 
 			private:
-				Point GetLocation();
 				float cornerRadius;
 				DoublePoint location;
 				Windows::Foundation::Size size;
@@ -50,6 +50,13 @@ namespace Telerik
 					&this->strokeStyle
 					);
 
+				this->factory->CreateStrokeStyle(
+					D2D1::StrokeStyleProperties1(D2D1_CAP_STYLE_FLAT, D2D1_CAP_STYLE_FLAT, D2D1_CAP_STYLE_FLAT, D2D1_LINE_JOIN_ROUND, 10.0f, D2D1_DASH_STYLE_SOLID, 0.0f, D2D1_STROKE_TRANSFORM_TYPE_FIXED),
+					nullptr,
+					0,
+					&this->fixedStrokeStyle
+					);
+
 				this->context->SetDpi(dpi, dpi);
 
 				result = DWriteCreateFactory(DWRITE_FACTORY_TYPE_SHARED, __uuidof(IDWriteFactory1), &this->writeFactory);
@@ -71,9 +78,15 @@ namespace Telerik
 				this->factory.Reset();
 				this->writeFactory.Reset();
 				this->strokeStyle.Reset();
+				this->fixedStrokeStyle.Reset();
 			}
 
 			void D2DRenderContext::BeginDraw()
+			{
+				this->BeginDraw(true);
+			}
+
+			void D2DRenderContext::BeginDraw(bool clear)
 			{
 				if(this->canDraw)
 				{
@@ -82,7 +95,11 @@ namespace Telerik
 
 				this->context->BeginDraw();
 				this->canDraw = true;
-				this->Clear();
+
+				if(clear)
+				{
+					this->Clear();
+				}
 			}
 
 			void D2DRenderContext::EndDraw()
@@ -122,7 +139,8 @@ namespace Telerik
 				this->context->GetTransform(&currentTransform);
 				this->transforms.push(currentTransform);
 
-				this->context->SetTransform(currentTransform * matrix);
+				// the pushed matrix is applied in the local space of the current transform
+				this->context->SetTransform(matrix * currentTransform);
 			}
 
 			void D2DRenderContext::PopTransform()
@@ -22,6 +22,8 @@ namespace Telerik
 				void Uninitialize();
 
 				void BeginDraw();
+				// the target is not cleared when only a part of it is updated
+				void BeginDraw(bool clear);
 				void EndDraw();
 
 				void PushTransform(D2D1::Matrix3x2F matrix);
@@ -59,6 +61,12 @@ namespace Telerik
 					ComPtr<ID2D1StrokeStyle> get() { return this->strokeStyle; }
 				}
 
+				// the stroke width of this style is not affected by the world transform
+				property ComPtr<ID2D1StrokeStyle1> FixedStrokeStyle
+				{
+					ComPtr<ID2D1StrokeStyle1> get() { return this->fixedStrokeStyle; }
+				}
+
 				property UINT PixelWidth
 				{
 					UINT get() { return this->pixelWidth; }
@@ -82,6 +90,7 @@ namespace Telerik
 				ComPtr<ID2D1Bitmap1> bitmap;
 
 				ComPtr<ID2D1StrokeStyle> strokeStyle;
+				ComPtr<ID2D1StrokeStyle1> fixedStrokeStyle;
 
 				UINT pixelWidth;
 				UINT pixelHeight;
@@ -2,6 +2,7 @@
 #include "D2DShape.h"
 #include "D2DShapeStyle.h"
 #include "D2DCanvas.h"
+#include "D2DShapeContainer.h"
 
 namespace Telerik
 {
@@ -14,6 +15,8 @@ namespace Telerik
 				this->currentStyle = ref new D2DShapeStyle();
 				this->isCurrentStyleValid = false;
 				this->isValid = false;
+				this->cullIndex = 0;
+				this->parentIndex = 0;
 
 				this->labelVisibility = ShapeLabelVisibility::Auto;
 
@@ -142,6 +145,17 @@ namespace Telerik
 			}
 
 			void D2DShape::InitRender(D2DRenderContext^ context)
+			{
+				this->InitStyle(context);
+
+				if (!this->isValid)
+				{
+					this->InitRenderCore(context);
+					this->isValid = true;
+				}
+			}
+
+			void D2DShape::InitStyle(D2DRenderContext^ context)
 			{
 				if (!this->isCurrentStyleValid)
 				{
@@ -149,11 +163,14 @@ namespace Telerik
 					this->currentStyle->InitRender(context);
 					this->isCurrentStyleValid = true;
 				}
+			}
 
-				if (!this->isValid)
+			void D2DShape::ResolveStyle()
+			{
+				// InitStyle resolves the style again when it prepares the brushes
+				if (!this->isCurrentStyleValid)
 				{
-					this->InitRenderCore(context);
-					this->isValid = true;
+					this->UpdateCurrentStyle();
 				}
 			}
 
@@ -167,6 +184,12 @@ namespace Telerik
 
 			void D2DShape::Invalidate(bool clearCache)
 			{
+				// the geometry may change even if the shape was not rendered since the last invalidation
+				if(clearCache)
+				{
+					this->InvalidateBounds();
+				}
+
 				if(!this->isValid)
 				{
 					return;
@@ -185,11 +208,45 @@ namespace Telerik
 				this->owner = owner;
 			}
 
+			void D2DShape::SetParent(D2DShapeContainer^ parent, size_t index)
+			{
+				this->parent = parent != nullptr ? Platform::WeakReference(parent) : Platform::WeakReference();
+				this->parentIndex = index;
+			}
+
+			void D2DShape::InvalidateBounds()
+			{
+				// children of a container have no row in the culling table; the container updates its own bounds instead
+				D2DShapeContainer^ container = this->parent.Resolve<D2DShapeContainer>();
+				if(container != nullptr)
+				{
+					container->InvalidateChildBounds(this->parentIndex);
+				}
+				else if(this->owner != nullptr)
+				{
+					this->owner->InvalidateShapeBounds(this);
+				}
+			}
+
 			void D2DShape::OnZoomFactorChanged()
 			{
 				this->Invalidate(false);
 			}
 
+			bool D2DShape::UsesModelTransform()
+			{
+				return false;
+			}
+
+			void D2DShape::SetRenderPrecision(ShapeRenderPrecision precision)
+			{
+			}
+
+			bool D2DShape::TryGetCullBounds(D2DCullBounds* bounds)
+			{
+				return false;
+			}
+
 			void D2DShape::OnStyleChanged(D2DShapeStyle^ sender)
 			{
 				this->OnUIChanged(true);
@@ -220,6 +277,9 @@ namespace Telerik
 				this->Invalidate(false);
 				this->isCurrentStyleValid = false;
 
+				// the stroke thickness of the new style changes the padding used for culling
+				this->InvalidateBounds();
+
 				if(requestInvalidate && this->owner != nullptr)
 				{
 					this->owner->InvalidateShape(this);
@@ -3,6 +3,7 @@
 #include "D2DBrush.h"
 #include "D2DTextBlock.h"
 #include "D2DRenderContext.h"
+#include "D2DShapeTable.h"
 
 namespace Telerik
 {
@@ -12,6 +13,7 @@ namespace Telerik
 		{
 			ref class D2DCanvas;
 			ref class D2DShapeStyle;
+			ref class D2DShapeContainer;
 			[Windows::Foundation::Metadata::WebHostHidden]
 			public ref class D2DShape : Windows::UI::Xaml::DependencyObject
 			{
@@ -19,6 +21,13 @@ namespace Telerik
 				D2DShape(void);
 
 				void InitRender(D2DRenderContext^ context);
+
+				// prepares the brushes of the current style only, without building the geometry of the shape
+				void InitStyle(D2DRenderContext^ context);
+
+				// resolves the current style from the UI state without preparing its brushes, so that the stroke is known
+				// for the bounds of a shape that has not been rendered yet
+				void ResolveStyle();
 				virtual void Render(D2DRenderContext^ context, Rect invalidRect);
 				void RenderLabel(D2DRenderContext^ context, Rect invalidRect);
 				void Invalidate(bool clearCache);
@@ -29,6 +38,13 @@ namespace Telerik
 
 				virtual void OnZoomFactorChanged();
 
+				// shapes that keep their geometry in model space are rendered through the owner's model transform
+				virtual bool UsesModelTransform();
+				virtual void SetRenderPrecision(ShapeRenderPrecision precision);
+
+				// the bounds used by the culling table of the layer; returns false while they are not known
+				virtual bool TryGetCullBounds(D2DCullBounds* bounds);
+
 				virtual void SetOwner(D2DCanvas^ canvas);
 				void OnStyleChanged(D2DShapeStyle^ sender);
 
@@ -38,6 +54,9 @@ namespace Telerik
 
 				void SetLayerId(int id);
 
+				// the container, if any, is notified when the bounds of the shape change
+				void SetParent(D2DShapeContainer^ parent, size_t index);
+
 				property D2DShapeStyle^ CurrentStyle
 				{
 					D2DShapeStyle^ get() { return this->currentStyle; }
@@ -48,6 +67,13 @@ namespace Telerik
 					D2DCanvas^ get() { return this->owner; }
 				}
 
+				// the row of the shape in the culling table of its layer
+				property size_t CullIndex
+				{
+					size_t get() { return this->cullIndex; }
+					void set(size_t value) { this->cullIndex = value; }
+				}
+
 			public:
 
 				Rect GetBounds();
@@ -153,6 +179,9 @@ namespace Telerik
 				virtual void SetHoverStyle(D2DShapeStyle^ style);
 				virtual void SetSelectedStyle(D2DShapeStyle^ style);
 
+				// notifies the culling table of the layer or the container of the shape
+				void InvalidateBounds();
+
 			private:
 				Point GetLabelRenderLocation(Rect bounds, Size labelSize);
 				void OnUIChanged(bool requestInvalidate);
@@ -172,6 +201,11 @@ namespace Telerik
 				bool isCurrentStyleValid;
 
 				int layerId;
+				size_t cullIndex;
+
+				// a weak reference as the container keeps its children alive
+				Platform::WeakReference parent;
+				size_t parentIndex;
 
 				// stores a reference to the model shape
 				Object^ model;
@@ -10,48 +10,159 @@ namespace Telerik
 		{
 			D2DShapeContainer::D2DShapeContainer(void)
 			{
+				this->hasBounds = false;
+				this->unknownChildCount = 0;
 			}
 
 			Rect D2DShapeContainer::GetBoundsCore()
 			{
-				if(this->cachedBounds.Width > 0 && this->cachedBounds.Height > 0)
+				if(this->childShapes.size() == 0)
 				{
-					return this->cachedBounds;
+					return Rect(0, 0, 0, 0);
 				}
 
-				if(this->childShapes.size() == 0)
+				// the model-space bounds are mapped to pixels on demand, so zooming never requires a pass over the children
+				if(this->hasBounds && this->unknownChildCount == 0 && this->Owner != nullptr)
 				{
-					return Rect(0, 0, 0, 0);
+					double scale = this->Owner->PixelZoomFactor;
+					DoublePoint origin = this->Owner->PixelRenderOrigin;
+					float padding = this->bounds.Padding;
+
+					return Rect(
+						static_cast<float>(this->bounds.MinX * scale + origin.X) - padding,
+						static_cast<float>(this->bounds.MinY * scale + origin.Y) - padding,
+						static_cast<float>((this->bounds.MaxX - this->bounds.MinX) * scale) + 2 * padding,
+						static_cast<float>((this->bounds.MaxY - this->bounds.MinY) * scale) + 2 * padding);
 				}
 
-				this->cachedBounds = this->childShapes.at(0)->GetBounds();
+				Rect bounds = this->childShapes.at(0)->GetBounds();
 				for(auto i = this->childShapes.begin() + 1; i != this->childShapes.end(); ++i)
 				{
-					this->cachedBounds.Union((*i)->GetBounds());
+					bounds.Union((*i)->GetBounds());
 				}
 
-				return this->cachedBounds;
+				return bounds;
 			}
 
 			void D2DShapeContainer::SetShapes(IIterable<D2DShape^>^ shapes)
 			{
+				for(auto i = this->childShapes.begin(); i != this->childShapes.end(); ++i)
+				{
+					(*i)->SetParent(nullptr, 0);
+				}
+
 				this->childShapes.clear();
+				this->childBounds.clear();
+				this->hasBounds = false;
+				this->unknownChildCount = 0;
+
+				if(shapes != nullptr)
+				{
+					IIterator<D2DShape^>^ iterator = shapes->First();
+					while(iterator->HasCurrent)
+					{
+						this->childShapes.push_back(iterator->Current);
+						iterator->Current->SetOwner(this->Owner);
+						iterator->Current->NormalStyle = this->NormalStyle;
+						iterator->Current->PointerOverStyle = this->PointerOverStyle;
+						iterator->Current->SelectedStyle = this->SelectedStyle;
+						iterator->MoveNext();
+					}
+				}
+
+				ChildBounds unknownBounds = { };
+				this->childBounds.resize(this->childShapes.size(), unknownBounds);
+				this->unknownChildCount = this->childShapes.size();
+
+				// the children are attached after their styles are set, so the style changes above do not notify the container one by one
+				for(size_t i = 0; i < this->childShapes.size(); i++)
+				{
+					this->childShapes[i]->SetParent(this, i);
+					this->UpdateChildBounds(i);
+				}
+
+				this->InvalidateBounds();
+			}
+
+			void D2DShapeContainer::InvalidateChildBounds(size_t index)
+			{
+				if(index >= this->childShapes.size())
+				{
+					return;
+				}
+
+				this->UpdateChildBounds(index);
+				this->InvalidateBounds();
+			}
+
+			void D2DShapeContainer::UpdateChildBounds(size_t index)
+			{
+				ChildBounds& entry = this->childBounds[index];
+				bool wasKnown = entry.IsKnown;
+
+				entry.IsKnown = this->childShapes[index]->TryGetCullBounds(&entry.Bounds);
+
+				if(!wasKnown && entry.IsKnown)
+				{
+					this->unknownChildCount--;
+				}
+				else if(wasKnown && !entry.IsKnown)
+				{
+					this->unknownChildCount++;
+				}
 
-				if(shapes == nullptr)
+				// a child that shrinks leaves the bounds of the container larger than needed, which is still safe for culling
+				if(entry.IsKnown)
 				{
+					this->IncludeBounds(entry.Bounds);
+				}
+			}
+
+			void D2DShapeContainer::IncludeBounds(const D2DCullBounds& bounds)
+			{
+				if(!this->hasBounds)
+				{
+					this->bounds = bounds;
+					this->hasBounds = true;
 					return;
 				}
 
-				IIterator<D2DShape^>^ iterator = shapes->First();
-				while(iterator->HasCurrent)
+				this->bounds.MinX = (std::min)(this->bounds.MinX, bounds.MinX);
+				this->bounds.MinY = (std::min)(this->bounds.MinY, bounds.MinY);
+				this->bounds.MaxX = (std::max)(this->bounds.MaxX, bounds.MaxX);
+				this->bounds.MaxY = (std::max)(this->bounds.MaxY, bounds.MaxY);
+				this->bounds.Padding = (std::max)(this->bounds.Padding, bounds.Padding);
+			}
+
+			bool D2DShapeContainer::TryGetModelArea(Rect rect, D2DCullBounds* area, double* paddingScale)
+			{
+				if(this->Owner == nullptr || this->Owner->PixelZoomFactor <= 0)
 				{
-					this->childShapes.push_back(iterator->Current);
-					iterator->Current->SetOwner(this->Owner);
-					iterator->Current->NormalStyle = this->NormalStyle;
-					iterator->Current->PointerOverStyle = this->PointerOverStyle;
-					iterator->Current->SelectedStyle = this->SelectedStyle;
-					iterator->MoveNext();
+					return false;
 				}
+
+				// maps a rect in render space to model space, where the bounds of the children are kept
+				double scale = 1 / this->Owner->PixelZoomFactor;
+				DoublePoint origin = this->Owner->PixelRenderOrigin;
+
+				area->MinX = (rect.X - origin.X) * scale;
+				area->MinY = (rect.Y - origin.Y) * scale;
+				area->MaxX = (rect.X + rect.Width - origin.X) * scale;
+				area->MaxY = (rect.Y + rect.Height - origin.Y) * scale;
+				area->Padding = 0;
+
+				*paddingScale = scale;
+				return true;
+			}
+
+			bool D2DShapeContainer::Intersects(const D2DCullBounds& bounds, const D2DCullBounds& area, double paddingScale)
+			{
+				double padding = bounds.Padding * paddingScale;
+
+				return bounds.MinX - padding <= area.MaxX &&
+					bounds.MaxX + padding >= area.MinX &&
+					bounds.MinY - padding <= area.MaxY &&
+					bounds.MaxY + padding >= area.MinY;
 			}
 
 			void D2DShapeContainer::SetOwner(D2DCanvas^ owner)
@@ -66,9 +177,23 @@ namespace Telerik
 
 			bool D2DShapeContainer::HitTest(Point location)
 			{
-				for(auto i = this->childShapes.begin(); i != this->childShapes.end(); ++i)
+				D2DCullBounds area;
+				double paddingScale;
+				bool canCull = this->TryGetModelArea(Rect(location.X, location.Y, 0, 0), &area, &paddingScale);
+
+				if(canCull && this->hasBounds && this->unknownChildCount == 0 && !Intersects(this->bounds, area, paddingScale))
+				{
+					return false;
+				}
+
+				for(size_t i = 0; i < this->childShapes.size(); i++)
 				{
-					if((*i)->HitTest(location))
+					if(canCull && this->childBounds[i].IsKnown && !Intersects(this->childBounds[i].Bounds, area, paddingScale))
+					{
+						continue;
+					}
+
+					if(this->childShapes[i]->HitTest(location))
 					{
 						return true;
 					}
@@ -79,12 +204,36 @@ namespace Telerik
 
 			void D2DShapeContainer::Render(D2DRenderContext^ context, Rect invalidRect)
 			{
-				for(auto i = this->childShapes.begin(); i != this->childShapes.end(); ++i)
+				D2DCullBounds area;
+				double paddingScale;
+				bool canCull = this->TryGetModelArea(invalidRect, &area, &paddingScale);
+
+				// the whole subtree is rejected when the container does not intersect the invalid rect
+				if(canCull && this->hasBounds && this->unknownChildCount == 0 && !Intersects(this->bounds, area, paddingScale))
 				{
-					(*i)->Render(context, invalidRect);
+					return;
 				}
 
-				if(this->Label != nullptr)
+				for(size_t i = 0; i < this->childShapes.size(); i++)
+				{
+					if(canCull && this->childBounds[i].IsKnown && !Intersects(this->childBounds[i].Bounds, area, paddingScale))
+					{
+						continue;
+					}
+
+					// children are initialized only when visible, so off-screen parts never build their geometry
+					D2DShape^ child = this->childShapes[i];
+					child->InitRender(context);
+					child->Render(context, invalidRect);
+
+					if(!this->childBounds[i].IsKnown)
+					{
+						this->UpdateChildBounds(i);
+					}
+				}
+
+				// labels are positioned in pixels and cannot be rendered while the model transform is applied
+				if(this->Label != nullptr && !this->UsesModelTransform())
 				{
 					this->RenderLabel(context, invalidRect);
 				}
@@ -92,11 +241,6 @@ namespace Telerik
 
 			void D2DShapeContainer::InvalidateCore(bool clearCache)
 			{
-				if(clearCache)
-				{
-					this->cachedBounds = Rect(0, 0, 0, 0);
-				}
-
 				for(auto i = this->childShapes.begin(); i != this->childShapes.end(); ++i)
 				{
 					(*i)->Invalidate(clearCache);
@@ -105,12 +249,8 @@ namespace Telerik
 
 			void D2DShapeContainer::InitRenderCore(D2DRenderContext^ context)
 			{
+				// the children are initialized by Render once they are known to be visible
 				D2DShape::InitRenderCore(context);
-
-				for(auto i = this->childShapes.begin(); i != this->childShapes.end(); ++i)
-				{
-					(*i)->InitRender(context);
-				}
 			}
 
 			void D2DShapeContainer::OnDisplayInvalidated()
@@ -127,14 +267,58 @@ namespace Telerik
 			{
 				D2DShape::OnZoomFactorChanged();
 
-				this->cachedBounds = Rect(0, 0, 0, 0);
-
 				for(auto i = this->childShapes.begin(); i != this->childShapes.end(); ++i)
 				{
 					(*i)->OnZoomFactorChanged();
 				}
 			}
 
+			bool D2DShapeContainer::UsesModelTransform()
+			{
+				if(this->childShapes.size() == 0)
+				{
+					return false;
+				}
+
+				for(auto i = this->childShapes.begin(); i != this->childShapes.end(); ++i)
+				{
+					if(!(*i)->UsesModelTransform())
+					{
+						return false;
+					}
+				}
+
+				return true;
+			}
+
+			bool D2DShapeContainer::TryGetCullBounds(D2DCullBounds* bounds)
+			{
+				// the children whose bounds were not known before may have been rendered since
+				for(size_t i = 0; i < this->childShapes.size() && this->unknownChildCount > 0; i++)
+				{
+					if(!this->childBounds[i].IsKnown)
+					{
+						this->UpdateChildBounds(i);
+					}
+				}
+
+				if(!this->hasBounds || this->unknownChildCount > 0)
+				{
+					return false;
+				}
+
+				*bounds = this->bounds;
+				return true;
+			}
+
+			void D2DShapeContainer::SetRenderPrecision(ShapeRenderPrecision precision)
+			{
+				for(auto i = this->childShapes.begin(); i != this->childShapes.end(); ++i)
+				{
+					(*i)->SetRenderPrecision(precision);
+				}
+			}
+
 			void D2DShapeContainer::SetUIState(ShapeUIState state, bool requestInvalidate)
 			{
 				D2DShape::SetUIState(state, requestInvalidate);
@@ -24,9 +24,15 @@ namespace Telerik
 				virtual void Render(D2DRenderContext^ context, Rect invalidRect) override;
 				virtual void OnDisplayInvalidated() override;
 				virtual void OnZoomFactorChanged() override;
+				virtual bool UsesModelTransform() override;
+				virtual void SetRenderPrecision(ShapeRenderPrecision precision) override;
+				virtual bool TryGetCullBounds(D2DCullBounds* bounds) override;
 
 				virtual void SetUIState(ShapeUIState state, bool requestInvalidate) override;
 
+				// refreshes the bounds of a single child; the bounds of the container only grow, so no full pass is needed
+				void InvalidateChildBounds(size_t index);
+
 			private protected:
 				virtual void InvalidateCore(bool clearCache) override;
 				virtual void InitRenderCore(D2DRenderContext^ context) override;
@@ -35,8 +41,24 @@ namespace Telerik
 				virtual void SetSelectedStyle(D2DShapeStyle^ style) override;
 
 			private:
-				Rect cachedBounds;
+				struct ChildBounds
+				{
+					D2DCullBounds Bounds;
+					bool IsKnown;
+				};
+
+				void UpdateChildBounds(size_t index);
+				void IncludeBounds(const D2DCullBounds& bounds);
+				bool TryGetModelArea(Rect rect, D2DCullBounds* area, double* paddingScale);
+				static bool Intersects(const D2DCullBounds& bounds, const D2DCullBounds& area, double paddingScale);
+
 				std::vector<D2DShape^> childShapes;
+
+				// the model-space bounds of the children, which do not change with the zoom factor
+				std::vector<ChildBounds> childBounds;
+				D2DCullBounds bounds;
+				bool hasBounds;
+				size_t unknownChildCount;
 			};
 		}
 	}
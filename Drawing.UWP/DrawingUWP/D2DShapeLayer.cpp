@@ -1,5 +1,25 @@
 #include "pch.h"
 #include "D2DShapeLayer.h"
+#include "D2DShapeStyle.h"
+#include "D2DRectangle.h"
+#include "D2DFeatureFile.h"
+#include <algorithm>
+#include <unordered_map>
+
+// the number of shapes rendered between two checks of the progressive rendering deadline
+const size_t DeadlineCheckInterval = 32;
+
+// the invalid rect is inflated by a pixel before culling to absorb the float rounding of the model transform
+const float CullSafetyMargin = 1;
+
+// shapes are queued in buckets by the binary logarithm of their area in pixels
+const int RenderQueueBucketCount = 48;
+
+// shapes narrower and shorter than this (in pixels) are not rendered through their geometry
+const float SubPixelShapeExtent = 1;
+
+// the features are loaded again after zooming in once the loaded area is this many times wider than the area needed
+const float FeatureAreaShrinkFactor = 2;
 
 namespace Telerik
 {
@@ -9,25 +29,609 @@ namespace Telerik
 		{
 			D2DShapeLayer::D2DShapeLayer(void)
 			{
+				this->isVisible = true;
+				this->opacity = 1;
+				this->isCacheValid = false;
+				this->cacheRenderOffset = D2D1::Point2F(0, 0);
+				this->hasFeatureArea = false;
+			}
+
+			void D2DShapeLayer::Render(D2DRenderContext^ context, Rect invalidRect, D2D1::Matrix3x2F modelTransform)
+			{
+				this->PushOpacity(context);
+				this->RenderShapes(context, invalidRect, modelTransform);
+				this->PopOpacity(context);
+			}
+
+			void D2DShapeLayer::RenderShapes(D2DRenderContext^ context, Rect invalidRect, D2D1::Matrix3x2F modelTransform)
+			{
+				this->CullShapes(invalidRect, modelTransform, this->parameters.SubPixelMode != SubPixelShapeMode::Render);
+
+				bool isTransformPushed = false;
+
+				// only the shapes that survived culling are dereferenced and dispatched
+				for(auto index = this->cullSurvivors.begin(); index != this->cullSurvivors.end(); ++index)
+				{
+					this->RenderCulledShape(context, *index, invalidRect, modelTransform, &isTransformPushed);
+				}
+
+				this->FlushMarkers(context, &isTransformPushed);
+
+				if(isTransformPushed)
+				{
+					context->PopTransform();
+				}
+
+				if(this->parameters.SubPixelMode == SubPixelShapeMode::Aggregate)
+				{
+					this->RenderSubPixelShapes(context, modelTransform, this->subPixelSurvivors);
+				}
 			}
 
-			void D2DShapeLayer::Render(D2DRenderContext^ context, Rect invalidRect, DoublePoint offset)
+			void D2DShapeLayer::RenderCulledShape(D2DRenderContext^ context, uint32_t index, Rect invalidRect, D2D1::Matrix3x2F modelTransform, bool* isTransformPushed)
 			{
-				/*if(this->parameters.RenderPrecision != ShapeRenderPrecision::Double)
+				D2DShape^ shape = this->shapes[index];
+				D2DRectangle^ marker = this->parameters.MarkerMode == ShapeLayerMarkerMode::Atlas ? dynamic_cast<D2DRectangle^>(shape) : nullptr;
+				if(marker != nullptr)
 				{
-					context->PushTransform(D2D1::Matrix3x2F::Translation(static_cast<float>(offset.X), static_cast<float>(offset.Y)));
-				}*/
+					marker->InitRender(context);
+				}
 
-				for(auto shapePtr = this->shapes.begin(); shapePtr != this->shapes.end(); ++shapePtr)
+				if(marker == nullptr || !this->markerBatch.TryAdd(context, marker, invalidRect))
 				{
-					(*shapePtr)->InitRender(context);
-					(*shapePtr)->Render(context, invalidRect);
+					// the markers collected so far are drawn first to keep the order of the shapes
+					this->FlushMarkers(context, isTransformPushed);
+					this->RenderShape(context, shape, invalidRect, modelTransform, isTransformPushed);
 				}
 
-				/*if(this->parameters.RenderPrecision != ShapeRenderPrecision::Double)
+				if(!this->cullTable.IsKnown(index))
+				{
+					D2DCullBounds bounds;
+					if(shape->TryGetCullBounds(&bounds))
+					{
+						this->cullTable.SetBounds(index, bounds);
+					}
+				}
+			}
+
+			void D2DShapeLayer::RenderSubPixelShapes(D2DRenderContext^ context, D2D1::Matrix3x2F modelTransform, const std::vector<uint32_t>& indices)
+			{
+				if(indices.empty())
+				{
+					return;
+				}
+
+				// the shapes are merged into one geometry of pixel-sized dots for each brush
+				std::unordered_map<ID2D1Brush*, std::vector<D2D1_POINT_2F>> batches;
+
+				float scale = modelTransform._11;
+				for(auto index = indices.begin(); index != indices.end(); ++index)
+				{
+					if(*index >= this->shapes.size())
+					{
+						continue;
+					}
+
+					D2DShape^ shape = this->shapes[*index];
+					shape->InitStyle(context);
+
+					// a stroke covers the whole of a shape this small
+					D2DShapeStyle^ style = shape->CurrentStyle;
+					D2DBrush^ brush = style->Stroke != nullptr ? style->Stroke : style->Fill;
+					if(brush == nullptr || brush->NativeBrush == nullptr)
+					{
+						continue;
+					}
+
+					D2DCullRect bounds = this->cullTable.GetBounds(*index);
+					batches[brush->NativeBrush.Get()].push_back(D2D1::Point2F(
+						floorf((bounds.MinX + bounds.MaxX) / 2 * scale + modelTransform._31),
+						floorf((bounds.MinY + bounds.MaxY) / 2 * scale + modelTransform._32)));
+				}
+
+				for(auto batch = batches.begin(); batch != batches.end(); ++batch)
+				{
+					ComPtr<ID2D1PathGeometry1> geometry;
+					if(!SUCCEEDED(context->Factory->CreatePathGeometry(&geometry)))
+					{
+						continue;
+					}
+
+					ComPtr<ID2D1GeometrySink> sink;
+					geometry->Open(&sink);
+
+					for(auto point = batch->second.begin(); point != batch->second.end(); ++point)
+					{
+						D2D1_POINT_2F corners[3] =
+						{
+							D2D1::Point2F(point->x + SubPixelShapeExtent, point->y),
+							D2D1::Point2F(point->x + SubPixelShapeExtent, point->y + SubPixelShapeExtent),
+							D2D1::Point2F(point->x, point->y + SubPixelShapeExtent)
+						};
+
+						sink->BeginFigure(*point, D2D1_FIGURE_BEGIN_FILLED);
+						sink->AddLines(corners, 3);
+						sink->EndFigure(D2D1_FIGURE_END_CLOSED);
+					}
+
+					sink->Close();
+					context->DeviceContext->FillGeometry(geometry.Get(), batch->first);
+				}
+			}
+
+			void D2DShapeLayer::FlushMarkers(D2DRenderContext^ context, bool* isTransformPushed)
+			{
+				if(this->markerBatch.IsEmpty())
+				{
+					return;
+				}
+
+				// the sprites are placed in render space
+				if(*isTransformPushed)
 				{
 					context->PopTransform();
-				}*/
+					*isTransformPushed = false;
+				}
+
+				this->markerBatch.Flush(context);
+			}
+
+			void D2DShapeLayer::RenderShape(D2DRenderContext^ context, D2DShape^ shape, Rect invalidRect, D2D1::Matrix3x2F modelTransform, bool* isTransformPushed)
+			{
+				shape->InitRender(context);
+
+				// the model transform is pushed once for each run of shapes that keep their geometry in model space
+				bool usesModelTransform = shape->UsesModelTransform();
+				if(usesModelTransform != *isTransformPushed)
+				{
+					if(usesModelTransform)
+					{
+						context->PushTransform(modelTransform);
+					}
+					else
+					{
+						context->PopTransform();
+					}
+
+					*isTransformPushed = usesModelTransform;
+				}
+
+				shape->Render(context, invalidRect);
+			}
+
+			void D2DShapeLayer::CullShapes(Rect invalidRect, D2D1::Matrix3x2F modelTransform, bool splitSubPixel)
+			{
+				this->EnsureCullTable();
+				this->cullSurvivors.clear();
+				this->subPixelSurvivors.clear();
+
+				float scale = modelTransform._11;
+				if(scale <= 0)
+				{
+					for(uint32_t i = 0; i < this->shapes.size(); i++)
+					{
+						this->cullSurvivors.push_back(i);
+					}
+
+					return;
+				}
+
+				// the invalid rect is mapped to model space, where the table keeps the bounds of the shapes
+				D2DCullRect cullRect =
+				{
+					(invalidRect.X - CullSafetyMargin - modelTransform._31) / scale,
+					(invalidRect.Y - CullSafetyMargin - modelTransform._32) / scale,
+					(invalidRect.X + invalidRect.Width + CullSafetyMargin - modelTransform._31) / scale,
+					(invalidRect.Y + invalidRect.Height + CullSafetyMargin - modelTransform._32) / scale
+				};
+
+				this->cullTable.Cull(cullRect, 1 / scale, SubPixelShapeExtent / scale, this->cullSurvivors, splitSubPixel ? &this->subPixelSurvivors : nullptr);
+			}
+
+			void D2DShapeLayer::EnsureCullTable()
+			{
+				if(this->cullTable.GetCount() != this->shapes.size())
+				{
+					this->cullTable.Resize(this->shapes.size());
+					this->staleCullRows.clear();
+
+					size_t index = 0;
+					for(auto shapePtr = this->shapes.begin(); shapePtr != this->shapes.end(); ++shapePtr, ++index)
+					{
+						(*shapePtr)->CullIndex = index;
+					}
+
+					this->UpdateCullBounds(0, this->shapes.size());
+					return;
+				}
+
+				// the shapes changed after they were invalidated, so their new bounds are only read now
+				for(auto row = this->staleCullRows.begin(); row != this->staleCullRows.end(); ++row)
+				{
+					this->UpdateCullBounds(*row, *row + 1);
+				}
+
+				this->staleCullRows.clear();
+			}
+
+			void D2DShapeLayer::UpdateCullBounds(size_t start, size_t end)
+			{
+				// the bounds known from the points of a shape are read without building its geometry, so the shapes that are
+				// never visible are culled from the first render on; the others are culled once they have been rendered
+				this->cullTable.Fill(start, end, [this](size_t index, D2DCullBounds* bounds)
+				{
+					return index < this->shapes.size() && this->shapes[index]->TryGetCullBounds(bounds);
+				});
+			}
+
+			void D2DShapeLayer::InvalidateCullBounds(D2DShape^ shape)
+			{
+				size_t index = shape->CullIndex;
+				if(index < this->shapes.size() && this->shapes[index] == shape)
+				{
+					this->cullTable.SetUnknown(index);
+					this->staleCullRows.push_back(static_cast<uint32_t>(index));
+				}
+			}
+
+			bool D2DShapeLayer::TryIntersectCullBounds(D2DShape^ shape, const D2DCullRect& rect, float paddingScale, bool* intersects)
+			{
+				size_t index = shape->CullIndex;
+				if(index >= this->cullTable.GetCount() || index >= this->shapes.size() || this->shapes[index] != shape)
+				{
+					return false;
+				}
+
+				*intersects = this->cullTable.Intersects(index, rect, paddingScale);
+				return true;
+			}
+
+			void D2DShapeLayer::ResetCullTable()
+			{
+				this->cullTable.Resize(0);
+				this->cullSurvivors.clear();
+				this->staleCullRows.clear();
+
+				// the queue holds the indices of the shapes, which refer to other shapes now
+				this->renderQueue.clear();
+				this->renderQueueSubPixel.clear();
+			}
+
+			void D2DShapeLayer::AppendShapes(const std::vector<D2DShape^>& newShapes)
+			{
+				size_t start = this->shapes.size();
+				bool isTableBuilt = this->cullTable.GetCount() == start;
+
+				this->shapes.insert(this->shapes.end(), newShapes.begin(), newShapes.end());
+
+				// a table that is not built yet is built with all the shapes by the next render; the new rows are filled from
+				// the point bounds of the shapes, so a batch that lands off screen is culled without building its geometry
+				if(isTableBuilt)
+				{
+					this->cullTable.Grow(this->shapes.size());
+					for(size_t index = start; index < this->shapes.size(); index++)
+					{
+						this->shapes[index]->CullIndex = index;
+					}
+
+					this->UpdateCullBounds(start, this->shapes.size());
+				}
+
+				this->InvalidateCache();
+			}
+
+			size_t D2DShapeLayer::RenderRange(D2DRenderContext^ context, Rect invalidRect, D2D1::Matrix3x2F modelTransform, const std::vector<uint32_t>& indices, size_t start, std::chrono::steady_clock::time_point deadline)
+			{
+				bool hasDeadline = deadline != std::chrono::steady_clock::time_point::max();
+				bool isTransformPushed = false;
+
+				size_t index = start;
+				while(index < indices.size())
+				{
+					uint32_t shapeIndex = indices[index++];
+					if(shapeIndex < this->shapes.size())
+					{
+						this->RenderCulledShape(context, shapeIndex, invalidRect, modelTransform, &isTransformPushed);
+					}
+
+					if(hasDeadline && (index - start) % DeadlineCheckInterval == 0 && std::chrono::steady_clock::now() >= deadline)
+					{
+						break;
+					}
+				}
+
+				// a slice ends with its markers drawn, so the next slice starts with an empty batch
+				this->FlushMarkers(context, &isTransformPushed);
+
+				if(isTransformPushed)
+				{
+					context->PopTransform();
+				}
+
+				return index;
+			}
+
+			void D2DShapeLayer::BuildRenderQueue(Rect invalidRect, D2D1::Matrix3x2F modelTransform)
+			{
+				this->renderQueue.clear();
+				this->renderQueueSubPixel.clear();
+
+				// the queue is built from the survivors of the culling table, so the sub-pixel mode applies as in a full render
+				bool splitSubPixel = this->parameters.SubPixelMode != SubPixelShapeMode::Render;
+				this->CullShapes(invalidRect, modelTransform, splitSubPixel);
+				this->renderQueue.reserve(this->cullSurvivors.size());
+
+				if(this->parameters.SubPixelMode == SubPixelShapeMode::Aggregate)
+				{
+					this->renderQueueSubPixel = this->subPixelSurvivors;
+				}
+
+				// bucket sort by area keeps the queue building linear in the number of shapes
+				std::vector<std::vector<uint32_t>> buckets(RenderQueueBucketCount);
+
+				float scale = modelTransform._11;
+				for(auto index = this->cullSurvivors.begin(); index != this->cullSurvivors.end(); ++index)
+				{
+					if(!this->cullTable.IsKnown(*index))
+					{
+						// the bounds are not known before the shape is initialized for rendering
+						buckets[0].push_back(*index);
+						continue;
+					}
+
+					D2DCullRect bounds = this->cullTable.GetBounds(*index);
+					float area = (bounds.MaxX - bounds.MinX) * scale * (bounds.MaxY - bounds.MinY) * scale;
+
+					int bucket = static_cast<int>(log((std::max)(area, 0.0f) + 1) / log(2.0)) + 1;
+					buckets[bucket < RenderQueueBucketCount ? bucket : RenderQueueBucketCount - 1].push_back(*index);
+				}
+
+				for(auto bucket = buckets.rbegin(); bucket != buckets.rend(); ++bucket)
+				{
+					this->renderQueue.insert(this->renderQueue.end(), bucket->begin(), bucket->end());
+				}
+			}
+
+			size_t D2DShapeLayer::RenderQueue(D2DRenderContext^ context, Rect invalidRect, D2D1::Matrix3x2F modelTransform, size_t start, std::chrono::steady_clock::time_point deadline)
+			{
+				if(start >= this->renderQueue.size() && this->renderQueueSubPixel.empty())
+				{
+					return this->renderQueue.size();
+				}
+
+				this->PushOpacity(context);
+				size_t index = this->RenderRange(context, invalidRect, modelTransform, this->renderQueue, start, deadline);
+
+				// the sub-pixel shapes are aggregated on top of the queue once it is rendered, as in a full render
+				if(index == this->renderQueue.size())
+				{
+					this->RenderSubPixelShapes(context, modelTransform, this->renderQueueSubPixel);
+				}
+
+				this->PopOpacity(context);
+
+				return index;
+			}
+
+			void D2DShapeLayer::ClearRenderQueue()
+			{
+				this->renderQueue.clear();
+				this->renderQueue.shrink_to_fit();
+				this->renderQueueSubPixel.clear();
+				this->renderQueueSubPixel.shrink_to_fit();
+			}
+
+			void D2DShapeLayer::RenderLabels(D2DRenderContext^ context, Rect invalidRect, D2D1::Matrix3x2F modelTransform)
+			{
+				this->PushOpacity(context);
+
+				// culled shapes may not have their geometry built, so their labels cannot be positioned
+				this->CullShapes(invalidRect, modelTransform, false);
+
+				for(auto index = this->cullSurvivors.begin(); index != this->cullSurvivors.end(); ++index)
+				{
+					this->shapes[*index]->RenderLabel(context, invalidRect);
+				}
+
+				this->PopOpacity(context);
+			}
+
+			void D2DShapeLayer::PushOpacity(D2DRenderContext^ context)
+			{
+				if(this->opacity < 1)
+				{
+					context->DeviceContext->PushLayer(
+						D2D1::LayerParameters1(D2D1::InfiniteRect(), nullptr, D2D1_ANTIALIAS_MODE_PER_PRIMITIVE, D2D1::IdentityMatrix(), this->opacity),
+						nullptr
+						);
+				}
+			}
+
+			void D2DShapeLayer::PopOpacity(D2DRenderContext^ context)
+			{
+				if(this->opacity < 1)
+				{
+					context->DeviceContext->PopLayer();
+				}
+			}
+
+			void D2DShapeLayer::UpdateCache(D2DRenderContext^ context, Size pixelSize, D2D1_POINT_2F renderOffset, D2D1::Matrix3x2F modelTransform)
+			{
+				if(this->HasValidCache(renderOffset))
+				{
+					return;
+				}
+
+				if(this->cacheBitmap == nullptr)
+				{
+					D2D1_BITMAP_PROPERTIES1 bitmapProperties =
+						D2D1::BitmapProperties1(
+						D2D1_BITMAP_OPTIONS_TARGET,
+						D2D1::PixelFormat(DXGI_FORMAT_B8G8R8A8_UNORM, D2D1_ALPHA_MODE_PREMULTIPLIED),
+						context->DPI,
+						context->DPI
+						);
+
+					HRESULT hr = context->DeviceContext->CreateBitmap(
+						D2D1::SizeU(static_cast<UINT32>(pixelSize.Width), static_cast<UINT32>(pixelSize.Height)),
+						nullptr,
+						0,
+						&bitmapProperties,
+						&this->cacheBitmap
+						);
+
+					if(!SUCCEEDED(hr))
+					{
+						this->cacheBitmap.Reset();
+						return;
+					}
+				}
+
+				context->DeviceContext->SetTarget(this->cacheBitmap.Get());
+				context->BeginDraw();
+				context->PushTransform(D2D1::Matrix3x2F::Translation(renderOffset.x, renderOffset.y));
+
+				this->RenderShapes(context, Rect(-renderOffset.x, -renderOffset.y, pixelSize.Width, pixelSize.Height), modelTransform);
+
+				context->PopTransform();
+				context->EndDraw();
+				context->DeviceContext->SetTarget(nullptr);
+
+				this->cacheRenderOffset = renderOffset;
+				this->isCacheValid = true;
+			}
+
+			void D2DShapeLayer::RenderCache(D2DRenderContext^ context, Rect invalidRect, D2D1_POINT_2F renderOffset)
+			{
+				auto size = this->cacheBitmap->GetSize();
+
+				// the cache is captured in viewport space while the canvas renders with the render offset applied
+				context->DeviceContext->DrawBitmap(
+					this->cacheBitmap.Get(),
+					D2D1::RectF(-renderOffset.x, -renderOffset.y, size.width - renderOffset.x, size.height - renderOffset.y),
+					this->opacity,
+					D2D1_BITMAP_INTERPOLATION_MODE_NEAREST_NEIGHBOR
+					);
+			}
+
+			bool D2DShapeLayer::HasValidCache(D2D1_POINT_2F renderOffset)
+			{
+				return this->isCacheValid &&
+					this->cacheBitmap != nullptr &&
+					this->cacheRenderOffset.x == renderOffset.x &&
+					this->cacheRenderOffset.y == renderOffset.y;
+			}
+
+			void D2DShapeLayer::InvalidateCache()
+			{
+				this->isCacheValid = false;
+			}
+
+			void D2DShapeLayer::ResetCache()
+			{
+				this->cacheBitmap.Reset();
+				this->isCacheValid = false;
+				this->markerBatch.Reset();
+			}
+
+			void D2DShapeLayer::SetFeatures(D2DFeatureFile^ features, D2DShapeStyle^ style)
+			{
+				this->featureFile = features;
+				this->featureStyle = style;
+				this->featureIndices.clear();
+				this->hasFeatureArea = false;
+			}
+
+			void D2DShapeLayer::ClearFeatures()
+			{
+				this->SetFeatures(nullptr, nullptr);
+				this->featureQuery.clear();
+				this->featureQuery.shrink_to_fit();
+			}
+
+			bool D2DShapeLayer::UpdateFeatures(D2DCanvas^ owner, const D2DCullRect& viewport, const D2DCullRect& area)
+			{
+				if(this->featureFile == nullptr)
+				{
+					return false;
+				}
+
+				if(this->hasFeatureArea &&
+					viewport.MinX >= this->featureArea.MinX && viewport.MinY >= this->featureArea.MinY &&
+					viewport.MaxX <= this->featureArea.MaxX && viewport.MaxY <= this->featureArea.MaxY &&
+					this->featureArea.MaxX - this->featureArea.MinX <= (area.MaxX - area.MinX) * FeatureAreaShrinkFactor)
+				{
+					return false;
+				}
+
+				this->featureArea = area;
+				this->hasFeatureArea = true;
+
+				this->featureQuery.clear();
+				this->featureFile->GetReader().Query(area.MinX, area.MinY, area.MaxX, area.MaxY, &this->featureQuery);
+				std::sort(this->featureQuery.begin(), this->featureQuery.end());
+
+				std::vector<D2DShape^> residentShapes;
+				std::vector<uint32_t> residentFeatures;
+				residentShapes.reserve(this->featureQuery.size());
+				residentFeatures.reserve(this->featureQuery.size());
+
+				// both lists are sorted, so the shapes to keep, create and release are found in a single merge
+				size_t current = 0;
+				for(auto feature = this->featureQuery.begin(); feature != this->featureQuery.end(); ++feature)
+				{
+					for(; current < this->featureIndices.size() && this->featureIndices[current] < *feature; current++)
+					{
+						this->shapes[current]->SetOwner(nullptr);
+					}
+
+					if(current < this->featureIndices.size() && this->featureIndices[current] == *feature)
+					{
+						residentShapes.push_back(this->shapes[current++]);
+						residentFeatures.push_back(*feature);
+						continue;
+					}
+
+					D2DShape^ shape = this->featureFile->CreateShape(static_cast<int>(*feature));
+					if(shape == nullptr)
+					{
+						continue;
+					}
+
+					shape->NormalStyle = this->featureStyle;
+					shape->SetLayerId(this->parameters.Id);
+					shape->SetOwner(owner);
+
+					if(this->parameters.RenderPrecision != ShapeRenderPrecision::Default)
+					{
+						shape->SetRenderPrecision(this->parameters.RenderPrecision);
+					}
+
+					residentShapes.push_back(shape);
+					residentFeatures.push_back(*feature);
+				}
+
+				for(; current < this->featureIndices.size(); current++)
+				{
+					this->shapes[current]->SetOwner(nullptr);
+				}
+
+				bool isChanged = residentFeatures != this->featureIndices;
+				this->shapes.swap(residentShapes);
+				this->featureIndices.swap(residentFeatures);
+
+				if(!isChanged)
+				{
+					return false;
+				}
+
+				// the kept shapes moved to other rows, so the culling table is refilled from the bounds they already know
+				this->ResetCullTable();
+				this->EnsureCullTable();
+
+				this->InvalidateCache();
+
+				return true;
 			}
 		}
 	}
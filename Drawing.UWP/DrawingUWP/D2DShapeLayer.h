@@ -2,6 +2,8 @@
 
 #include <D2DShape.h>
 #include <collection.h>
+#include <chrono>
+#include "D2DMarkerBatch.h"
 
 namespace Telerik
 {
@@ -9,18 +11,128 @@ namespace Telerik
 	{
 		namespace Drawing
 		{
+			ref class D2DFeatureFile;
+
 			ref class D2DShapeLayer
 			{
 			internal:
 				D2DShapeLayer(void);
 
-				void Render(D2DRenderContext^ context, Rect invalidRect, DoublePoint offset);
+				void Render(D2DRenderContext^ context, Rect invalidRect, D2D1::Matrix3x2F modelTransform);
+				void RenderLabels(D2DRenderContext^ context, Rect invalidRect, D2D1::Matrix3x2F modelTransform);
+
+				// progressive rendering: the shapes that survive culling against the invalid rect are queued by their size
+				// (largest first) and rendered in slices until the specified deadline passes;
+				// markers and sub-pixel shapes are rendered as in a full render
+				void BuildRenderQueue(Rect invalidRect, D2D1::Matrix3x2F modelTransform);
+				size_t RenderQueue(D2DRenderContext^ context, Rect invalidRect, D2D1::Matrix3x2F modelTransform, size_t start, std::chrono::steady_clock::time_point deadline);
+				void ClearRenderQueue();
+
+				// the culling table is rebuilt on the next render after the shapes of the layer change
+				void InvalidateCullBounds(D2DShape^ shape);
+				void ResetCullTable();
+
+				// tests the row of the shape in the culling table against a rect in model space; returns false if the shape is
+				// not a shape of the layer or the table has no row for it yet
+				bool TryIntersectCullBounds(D2DShape^ shape, const D2DCullRect& rect, float paddingScale, bool* intersects);
+
+				// adds shapes while the layer is loading; the bounds already in the culling table are kept
+				void AppendShapes(const std::vector<D2DShape^>& newShapes);
+
+				// renders the layer's shapes into its own bitmap, which is later composed onto the main surface
+				void UpdateCache(D2DRenderContext^ context, Size pixelSize, D2D1_POINT_2F renderOffset, D2D1::Matrix3x2F modelTransform);
+				void RenderCache(D2DRenderContext^ context, Rect invalidRect, D2D1_POINT_2F renderOffset);
+				bool HasValidCache(D2D1_POINT_2F renderOffset);
+				void InvalidateCache();
+
+				// releases the device resources of the layer: its cache bitmap and marker atlas
+				void ResetCache();
+
+				// streams the shapes of the layer from a feature file: only the features intersecting the area around the
+				// viewport are kept as shapes, in the order of the file, and the others are released
+				void SetFeatures(D2DFeatureFile^ features, D2DShapeStyle^ style);
+				void ClearFeatures();
+
+				// loads the features of the area once the viewport leaves the area loaded last or the loaded area is much
+				// larger than needed after zooming in; both rects are in model space. Returns true if the shapes changed
+				bool UpdateFeatures(D2DCanvas^ owner, const D2DCullRect& viewport, const D2DCullRect& area);
 
 				// used to sort the layers by z-index
 				bool operator < (D2DShapeLayer^ layer) { return this->parameters.ZIndex < layer->parameters.ZIndex; }
 
+				property bool IsVisible
+				{
+					bool get() { return this->isVisible; }
+					void set(bool value) { this->isVisible = value; }
+				}
+
+				property float Opacity
+				{
+					float get() { return this->opacity; }
+					void set(float value) { this->opacity = value; }
+				}
+
+				property size_t RenderQueueCount
+				{
+					size_t get() { return this->renderQueue.size(); }
+				}
+
+				property bool IsCacheEnabled
+				{
+					bool get() { return this->parameters.CacheMode == ShapeLayerCacheMode::Bitmap; }
+				}
+
+				property bool HasFeatures
+				{
+					bool get() { return this->featureFile != nullptr; }
+				}
+
 				ShapeLayerParameters parameters;
 				std::vector<D2DShape^> shapes;
+
+			private:
+				void RenderShapes(D2DRenderContext^ context, Rect invalidRect, D2D1::Matrix3x2F modelTransform);
+				void RenderShape(D2DRenderContext^ context, D2DShape^ shape, Rect invalidRect, D2D1::Matrix3x2F modelTransform, bool* isTransformPushed);
+				void CullShapes(Rect invalidRect, D2D1::Matrix3x2F modelTransform, bool splitSubPixel);
+				void RenderCulledShape(D2DRenderContext^ context, uint32_t index, Rect invalidRect, D2D1::Matrix3x2F modelTransform, bool* isTransformPushed);
+				void RenderSubPixelShapes(D2DRenderContext^ context, D2D1::Matrix3x2F modelTransform, const std::vector<uint32_t>& indices);
+				void FlushMarkers(D2DRenderContext^ context, bool* isTransformPushed);
+				void EnsureCullTable();
+				void UpdateCullBounds(size_t start, size_t end);
+				size_t RenderRange(D2DRenderContext^ context, Rect invalidRect, D2D1::Matrix3x2F modelTransform, const std::vector<uint32_t>& indices, size_t start, std::chrono::steady_clock::time_point deadline);
+				void PushOpacity(D2DRenderContext^ context);
+				void PopOpacity(D2DRenderContext^ context);
+
+				// the indices of the queued shapes and of the sub-pixel shapes aggregated after them
+				std::vector<uint32_t> renderQueue;
+				std::vector<uint32_t> renderQueueSubPixel;
+
+				D2DShapeTable cullTable;
+				std::vector<uint32_t> cullSurvivors;
+
+				// the rows whose shapes changed since the last culling pass
+				std::vector<uint32_t> staleCullRows;
+
+				// the survivors smaller than a pixel, which are skipped or drawn as dots depending on the layer parameters
+				std::vector<uint32_t> subPixelSurvivors;
+
+				// the rectangle markers drawn from a symbol atlas when the marker mode of the layer is Atlas
+				D2DMarkerBatch markerBatch;
+
+				// the feature file the shapes are streamed from and the feature of each shape, in the order of the shapes
+				D2DFeatureFile^ featureFile;
+				D2DShapeStyle^ featureStyle;
+				std::vector<uint32_t> featureIndices;
+				std::vector<uint32_t> featureQuery;
+				D2DCullRect featureArea;
+				bool hasFeatureArea;
+
+				ComPtr<ID2D1Bitmap1> cacheBitmap;
+				D2D1_POINT_2F cacheRenderOffset;
+				bool isCacheValid;
+
+				bool isVisible;
+				float opacity;
 			};
 		}
 	}
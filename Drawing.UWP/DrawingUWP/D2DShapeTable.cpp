@@ -0,0 +1,274 @@
+#include "pch.h"
+#include "D2DShapeTable.h"
+#include <cfloat>
+#include <cmath>
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__SSE2__) || defined(__x86_64__)
+#include <emmintrin.h>
+#define D2D_SHAPE_TABLE_SSE
+#endif
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// the number of rows culled in one iteration
+const size_t CullBatchSize = 8;
+
+namespace
+{
+	// rounds outwards so that the float bounds always contain the double ones
+	float RoundDown(double value)
+	{
+		float result = static_cast<float>(value);
+		return result > value ? nextafterf(result, -FLT_MAX) : result;
+	}
+
+	float RoundUp(double value)
+	{
+		float result = static_cast<float>(value);
+		return result < value ? nextafterf(result, FLT_MAX) : result;
+	}
+
+#ifdef D2D_SHAPE_TABLE_SSE
+	int FirstBit(unsigned int mask)
+	{
+#ifdef _MSC_VER
+		unsigned long index;
+		_BitScanForward(&index, mask);
+		return static_cast<int>(index);
+#else
+		return __builtin_ctz(mask);
+#endif
+	}
+#endif
+}
+
+namespace Telerik
+{
+	namespace UI
+	{
+		namespace Drawing
+		{
+			D2DShapeTable::D2DShapeTable()
+			{
+				this->count = 0;
+			}
+
+			void D2DShapeTable::Resize(size_t count)
+			{
+				size_t capacity = (count + CullBatchSize - 1) / CullBatchSize * CullBatchSize;
+
+				this->minX.assign(capacity, -FLT_MAX);
+				this->minY.assign(capacity, -FLT_MAX);
+				this->maxX.assign(capacity, FLT_MAX);
+				this->maxY.assign(capacity, FLT_MAX);
+				this->padding.assign(capacity, 0);
+
+				// the padding rows are inverted rects, which fail every intersection test
+				for(size_t i = count; i < capacity; i++)
+				{
+					this->minX[i] = FLT_MAX;
+					this->minY[i] = FLT_MAX;
+					this->maxX[i] = -FLT_MAX;
+					this->maxY[i] = -FLT_MAX;
+				}
+
+				this->count = count;
+			}
+
+			void D2DShapeTable::Grow(size_t count)
+			{
+				if(count <= this->count)
+				{
+					return;
+				}
+
+				size_t capacity = (count + CullBatchSize - 1) / CullBatchSize * CullBatchSize;
+
+				this->minX.resize(capacity, FLT_MAX);
+				this->minY.resize(capacity, FLT_MAX);
+				this->maxX.resize(capacity, -FLT_MAX);
+				this->maxY.resize(capacity, -FLT_MAX);
+				this->padding.resize(capacity, 0);
+
+				// the padding rows of the old capacity become rows of the table
+				size_t start = this->count;
+				this->count = count;
+
+				for(size_t i = start; i < count; i++)
+				{
+					this->SetUnknown(i);
+				}
+			}
+
+			void D2DShapeTable::SetBounds(size_t index, const D2DCullBounds& bounds)
+			{
+				if(index >= this->count)
+				{
+					return;
+				}
+
+				this->minX[index] = RoundDown(bounds.MinX);
+				this->minY[index] = RoundDown(bounds.MinY);
+				this->maxX[index] = RoundUp(bounds.MaxX);
+				this->maxY[index] = RoundUp(bounds.MaxY);
+				this->padding[index] = bounds.Padding;
+			}
+
+			void D2DShapeTable::SetUnknown(size_t index)
+			{
+				if(index >= this->count)
+				{
+					return;
+				}
+
+				this->minX[index] = -FLT_MAX;
+				this->minY[index] = -FLT_MAX;
+				this->maxX[index] = FLT_MAX;
+				this->maxY[index] = FLT_MAX;
+				this->padding[index] = 0;
+			}
+
+			void D2DShapeTable::Fill(size_t start, size_t end, const D2DCullBoundsSource& source)
+			{
+				for(size_t index = start; index < end && index < this->count; index++)
+				{
+					D2DCullBounds bounds;
+					if(source(index, &bounds))
+					{
+						this->SetBounds(index, bounds);
+					}
+					else
+					{
+						this->SetUnknown(index);
+					}
+				}
+			}
+
+			bool D2DShapeTable::IsKnown(size_t index) const
+			{
+				return index < this->count && this->minX[index] != -FLT_MAX;
+			}
+
+			bool D2DShapeTable::Intersects(size_t index, const D2DCullRect& rect, float paddingScale) const
+			{
+				if(index >= this->count)
+				{
+					return false;
+				}
+
+				float pad = this->padding[index] * paddingScale;
+				return this->minX[index] - pad <= rect.MaxX && this->maxX[index] + pad >= rect.MinX &&
+					this->minY[index] - pad <= rect.MaxY && this->maxY[index] + pad >= rect.MinY;
+			}
+
+			D2DCullRect D2DShapeTable::GetBounds(size_t index) const
+			{
+				D2DCullRect bounds = { this->minX[index], this->minY[index], this->maxX[index], this->maxY[index] };
+				return bounds;
+			}
+
+			void D2DShapeTable::Cull(const D2DCullRect& rect, float paddingScale, std::vector<uint32_t>& survivors) const
+			{
+				this->Cull(rect, paddingScale, 0, survivors, nullptr);
+			}
+
+			void D2DShapeTable::Cull(const D2DCullRect& rect, float paddingScale, float minExtent, std::vector<uint32_t>& survivors, std::vector<uint32_t>* subPixel) const
+			{
+#ifdef D2D_SHAPE_TABLE_SSE
+				// unknown rows span the whole float range and are never below the minimum extent
+				__m128 extent = _mm_set1_ps(subPixel != nullptr ? minExtent : 0);
+				__m128 rectMinX = _mm_set1_ps(rect.MinX);
+				__m128 rectMinY = _mm_set1_ps(rect.MinY);
+				__m128 rectMaxX = _mm_set1_ps(rect.MaxX);
+				__m128 rectMaxY = _mm_set1_ps(rect.MaxY);
+				__m128 scale = _mm_set1_ps(paddingScale);
+
+				const float* minXData = this->minX.data();
+				const float* minYData = this->minY.data();
+				const float* maxXData = this->maxX.data();
+				const float* maxYData = this->maxY.data();
+				const float* paddingData = this->padding.data();
+
+				for(size_t i = 0; i < this->count; i += CullBatchSize)
+				{
+					int mask = 0;
+					int smallMask = 0;
+
+					// two SSE lanes of four rows each
+					for(size_t lane = 0; lane < CullBatchSize; lane += 4)
+					{
+						size_t row = i + lane;
+						__m128 pad = _mm_mul_ps(_mm_loadu_ps(paddingData + row), scale);
+						__m128 rowMinX = _mm_loadu_ps(minXData + row);
+						__m128 rowMinY = _mm_loadu_ps(minYData + row);
+						__m128 rowMaxX = _mm_loadu_ps(maxXData + row);
+						__m128 rowMaxY = _mm_loadu_ps(maxYData + row);
+
+						__m128 intersects = _mm_and_ps(
+							_mm_and_ps(
+								_mm_cmple_ps(_mm_sub_ps(rowMinX, pad), rectMaxX),
+								_mm_cmpge_ps(_mm_add_ps(rowMaxX, pad), rectMinX)),
+							_mm_and_ps(
+								_mm_cmple_ps(_mm_sub_ps(rowMinY, pad), rectMaxY),
+								_mm_cmpge_ps(_mm_add_ps(rowMaxY, pad), rectMinY)));
+
+						__m128 isSmall = _mm_and_ps(
+							_mm_cmplt_ps(_mm_sub_ps(rowMaxX, rowMinX), extent),
+							_mm_cmplt_ps(_mm_sub_ps(rowMaxY, rowMinY), extent));
+
+						mask |= _mm_movemask_ps(intersects) << lane;
+						smallMask |= _mm_movemask_ps(_mm_and_ps(intersects, isSmall)) << lane;
+					}
+
+					if(subPixel != nullptr)
+					{
+						mask &= ~smallMask;
+
+						while(smallMask != 0)
+						{
+							int bit = FirstBit(static_cast<unsigned int>(smallMask));
+							smallMask &= smallMask - 1;
+
+							subPixel->push_back(static_cast<uint32_t>(i + bit));
+						}
+					}
+
+					while(mask != 0)
+					{
+						int bit = FirstBit(static_cast<unsigned int>(mask));
+						mask &= mask - 1;
+
+						// the padding rows never intersect, so every set bit is a real row
+						survivors.push_back(static_cast<uint32_t>(i + bit));
+					}
+				}
+#else
+				this->CullScalar(rect, paddingScale, minExtent, survivors, subPixel);
+#endif
+			}
+
+			void D2DShapeTable::CullScalar(const D2DCullRect& rect, float paddingScale, float minExtent, std::vector<uint32_t>& survivors, std::vector<uint32_t>* subPixel) const
+			{
+				for(size_t i = 0; i < this->count; i++)
+				{
+					float pad = this->padding[i] * paddingScale;
+
+					if(this->minX[i] - pad <= rect.MaxX && this->maxX[i] + pad >= rect.MinX &&
+						this->minY[i] - pad <= rect.MaxY && this->maxY[i] + pad >= rect.MinY)
+					{
+						if(subPixel != nullptr && this->maxX[i] - this->minX[i] < minExtent && this->maxY[i] - this->minY[i] < minExtent)
+						{
+							subPixel->push_back(static_cast<uint32_t>(i));
+						}
+						else
+						{
+							survivors.push_back(static_cast<uint32_t>(i));
+						}
+					}
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <vector>
+#include <functional>
+#include <cstddef>
+#include <cstdint>
+
+namespace Telerik
+{
+	namespace UI
+	{
+		namespace Drawing
+		{
+			// a rectangle in the model space of a shape layer
+			struct D2DCullRect
+			{
+				float MinX;
+				float MinY;
+				float MaxX;
+				float MaxY;
+			};
+
+			// the bounds of a shape in model space and the padding, in pixels, its rendering adds around them
+			struct D2DCullBounds
+			{
+				double MinX;
+				double MinY;
+				double MaxX;
+				double MaxY;
+				float Padding;
+			};
+
+			// fills the bounds of the shape of a row; returns false if they are not known before the shape is rendered
+			typedef std::function<bool (size_t index, D2DCullBounds* bounds)> D2DCullBoundsSource;
+
+			// keeps the culling data of the shapes in a layer as a structure of arrays, so that the shapes outside
+			// the invalid rect are rejected eight at a time without touching the shape objects; bounds are in model
+			// space, while the padding (stroke and anti-aliasing) is in pixels and is scaled by the caller
+			class D2DShapeTable
+			{
+			public:
+				D2DShapeTable();
+
+				// all rows are reset to unknown bounds, which never get culled
+				void Resize(size_t count);
+
+				// keeps the existing rows and appends rows of unknown bounds up to the count
+				void Grow(size_t count);
+				size_t GetCount() const { return this->count; }
+
+				void SetBounds(size_t index, const D2DCullBounds& bounds);
+				void SetUnknown(size_t index);
+
+				// fills the rows [start, end) from the source, so that they are culled before their shapes are ever rendered
+				void Fill(size_t start, size_t end, const D2DCullBoundsSource& source);
+				bool IsKnown(size_t index) const;
+
+				// the intersection test of Cull for a single row; unknown rows intersect every rect
+				bool Intersects(size_t index, const D2DCullRect& rect, float paddingScale) const;
+				D2DCullRect GetBounds(size_t index) const;
+
+				// appends the indices of the rows intersecting the rect, in order; when a sub-pixel list is given, the rows
+				// narrower and shorter than the minimum extent are appended to it instead of to the survivors
+				void Cull(const D2DCullRect& rect, float paddingScale, std::vector<uint32_t>& survivors) const;
+				void Cull(const D2DCullRect& rect, float paddingScale, float minExtent, std::vector<uint32_t>& survivors, std::vector<uint32_t>* subPixel) const;
+
+			private:
+				void CullScalar(const D2DCullRect& rect, float paddingScale, float minExtent, std::vector<uint32_t>& survivors, std::vector<uint32_t>* subPixel) const;
+
+				// padded to a multiple of the SIMD width with rows that never intersect
+				std::vector<float> minX;
+				std::vector<float> minY;
+				std::vector<float> maxX;
+				std::vector<float> maxY;
+				std::vector<float> padding;
+
+				size_t count;
+			};
+		}
+	}
+}
@@ -0,0 +1,179 @@
+#include "pch.h"
+#include "D2DShapefile.h"
+#include "D2DMappedFile.h"
+#include "D2DMultiPolygon.h"
+#include "D2DProjection.h"
+#include "D2DRectangle.h"
+#include <algorithm>
+#include <limits>
+
+namespace Telerik
+{
+	namespace UI
+	{
+		namespace Drawing
+		{
+			D2DShapefile::D2DShapefile(void)
+			{
+				this->table.CodePage = 0;
+				this->table.RecordCount = 0;
+			}
+
+			D2DShapefile^ D2DShapefile::Open(Platform::String^ shapePath, Platform::String^ dataPath)
+			{
+				if(shapePath == nullptr)
+				{
+					return nullptr;
+				}
+
+				D2DShapefile^ shapefile = ref new D2DShapefile();
+
+				// the files are only mapped while they are decoded
+				D2DMappedFile shapeFile;
+				if(!shapeFile.Open(shapePath->Data()) || !D2DShapefileReader::ReadShapes(shapeFile.GetData(), shapeFile.GetSize(), &shapefile->geometry))
+				{
+					return nullptr;
+				}
+
+				D2DMappedFile dataFile;
+				if(dataPath != nullptr && dataFile.Open(dataPath->Data()))
+				{
+					D2DShapefileReader::ReadTable(dataFile.GetData(), dataFile.GetSize(), &shapefile->table);
+				}
+
+				return shapefile;
+			}
+
+			Platform::String^ D2DShapefile::GetFieldName(int field)
+			{
+				const D2DDbfColumn& column = this->GetColumn(field);
+				std::wstring name(column.Name.begin(), column.Name.end());
+
+				return ref new Platform::String(name.c_str(), static_cast<unsigned int>(name.size()));
+			}
+
+			bool D2DShapefile::IsNumericField(int field)
+			{
+				return this->GetColumn(field).IsNumeric();
+			}
+
+			double D2DShapefile::GetNumber(int record, int field)
+			{
+				const D2DDbfColumn& column = this->GetColumn(record, field);
+				return column.IsNumeric() ? column.Numbers[record] : std::numeric_limits<double>::quiet_NaN();
+			}
+
+			Platform::String^ D2DShapefile::GetText(int record, int field)
+			{
+				const D2DDbfColumn& column = this->GetColumn(record, field);
+				if(column.IsNumeric() || column.TextLengths[record] == 0)
+				{
+					return nullptr;
+				}
+
+				const char* text = &column.Text[static_cast<size_t>(record) * column.Length];
+				int length = column.TextLengths[record];
+
+				int characterCount = MultiByteToWideChar(this->table.CodePage, 0, text, length, nullptr, 0);
+				if(characterCount <= 0)
+				{
+					return nullptr;
+				}
+
+				std::vector<wchar_t> characters(characterCount);
+				MultiByteToWideChar(this->table.CodePage, 0, text, length, characters.data(), characterCount);
+
+				return ref new Platform::String(characters.data(), static_cast<unsigned int>(characterCount));
+			}
+
+			void D2DShapefile::ProjectMercator(double worldSize)
+			{
+				D2DProjection::ProjectMercatorInParallel(this->geometry.Coordinates.data(), this->geometry.Coordinates.size() / 2, worldSize);
+
+				// the projected y grows to the south, so the north edge becomes the minimum
+				double corners[] = { this->geometry.MinX, this->geometry.MaxY, this->geometry.MaxX, this->geometry.MinY };
+				D2DProjection::ProjectMercator(corners, 2, worldSize);
+
+				this->geometry.MinX = corners[0];
+				this->geometry.MinY = corners[1];
+				this->geometry.MaxX = corners[2];
+				this->geometry.MaxY = corners[3];
+			}
+
+			D2DShape^ D2DShapefile::CreateShape(int record)
+			{
+				if(record < 0 || record >= this->RecordCount)
+				{
+					throw ref new Platform::OutOfBoundsException();
+				}
+
+				uint32_t firstPart = this->geometry.PartOffsets[record];
+				uint32_t partCount = this->geometry.PartOffsets[record + 1] - firstPart;
+				if(partCount == 0)
+				{
+					return nullptr;
+				}
+
+				const double* coordinates = this->geometry.Coordinates.data();
+				switch(this->geometry.RecordShapeTypes[record])
+				{
+					// point, point Z, point M
+					case 1:
+					case 11:
+					case 21:
+					{
+						const double* point = coordinates + 2 * static_cast<size_t>(this->geometry.PointOffsets[firstPart]);
+
+						DoublePoint location;
+						location.X = point[0];
+						location.Y = point[1];
+
+						D2DRectangle^ marker = ref new D2DRectangle();
+						marker->Location = location;
+						return marker;
+					}
+
+					// polyline, polygon and their Z and M variants
+					case 3:
+					case 5:
+					case 13:
+					case 15:
+					case 23:
+					case 25:
+					{
+						uint8_t shapeType = this->geometry.RecordShapeTypes[record];
+
+						D2DMultiPolygon^ shape = ref new D2DMultiPolygon();
+						shape->IsClosed = shapeType == 5 || shapeType == 15 || shapeType == 25;
+						shape->SetRings(coordinates, &this->geometry.PointOffsets[firstPart], partCount);
+						return shape;
+					}
+
+					default:
+						return nullptr;
+				}
+			}
+
+			const D2DDbfColumn& D2DShapefile::GetColumn(int field)
+			{
+				if(field < 0 || field >= this->FieldCount)
+				{
+					throw ref new Platform::OutOfBoundsException();
+				}
+
+				return this->table.Columns[field];
+			}
+
+			const D2DDbfColumn& D2DShapefile::GetColumn(int record, int field)
+			{
+				// the table may have fewer records than the shape file, or none at all
+				if(record < 0 || static_cast<size_t>(record) >= this->table.RecordCount)
+				{
+					throw ref new Platform::OutOfBoundsException();
+				}
+
+				return this->GetColumn(field);
+			}
+		}
+	}
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "D2DShape.h"
+#include "D2DShapefileReader.h"
+
+namespace Telerik
+{
+	namespace UI
+	{
+		namespace Drawing
+		{
+			// a shapefile decoded natively from memory-mapped files into flat coordinate buffers and a columnar attribute
+			// table; shapes are created from the buffers directly, without marshaling their points. Coordinates are the ones
+			// stored in the file (x is the longitude for geographic data)
+			public ref class D2DShapefile sealed
+			{
+			public:
+				// returns null if the shape file cannot be read; the data (.dbf) file is optional
+				static D2DShapefile^ Open(Platform::String^ shapePath, Platform::String^ dataPath);
+
+				property int RecordCount
+				{
+					int get() { return static_cast<int>(this->geometry.RecordShapeTypes.size()); }
+				}
+
+				// the ESRI shape type from the header of the file
+				property int ShapeType
+				{
+					int get() { return this->geometry.ShapeType; }
+				}
+
+				property int FieldCount
+				{
+					int get() { return static_cast<int>(this->table.Columns.size()); }
+				}
+
+				Platform::String^ GetFieldName(int field);
+				bool IsNumericField(int field);
+
+				// the value of a numeric or logical field, NaN if it is empty
+				double GetNumber(int record, int field);
+
+				// the trimmed value of a text, date or other non-numeric field
+				Platform::String^ GetText(int record, int field);
+
+				// a D2DRectangle for a point and a D2DMultiPolygon for a polyline or a polygon; null for other records
+				D2DShape^ CreateShape(int record);
+
+				// projects the coordinates and the bounds of the header in place from longitude and latitude to the spherical
+				// Mercator of RadMap, with the world a square of worldSize units (512 in the model space of RadMap). The shapes
+				// created afterwards are in the projected space; calling it twice projects the coordinates twice
+				void ProjectMercator(double worldSize);
+
+			internal:
+				const D2DShapefileGeometry& GetGeometry() { return this->geometry; }
+				const D2DDbfTable& GetTable() { return this->table; }
+
+			private:
+				D2DShapefile(void);
+
+				// throw when the field, or the record of the table, is out of range
+				const D2DDbfColumn& GetColumn(int field);
+				const D2DDbfColumn& GetColumn(int record, int field);
+
+				D2DShapefileGeometry geometry;
+				D2DDbfTable table;
+			};
+		}
+	}
+}
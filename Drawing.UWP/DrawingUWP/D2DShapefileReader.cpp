@@ -0,0 +1,571 @@
+#include "pch.h"
+#include "D2DShapefileReader.h"
+#include "D2DParallel.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+// the records are decoded in chunks of this many records, so that each worker is handed a sizeable piece of work
+const size_t RecordsPerChunk = 4096;
+
+const int32_t ShapefileFileCode = 9994;
+const size_t ShapefileHeaderSize = 100;
+const size_t DbfFieldDescriptorSize = 32;
+
+// the DBF versions the managed reader accepts, with and without memo files
+const uint8_t DbfVersions[] = { 0x02, 0x03, 0x30, 0x43, 0x63, 0x83, 0x8b, 0xcb, 0xf5, 0xfb };
+
+namespace Telerik
+{
+	namespace UI
+	{
+		namespace Drawing
+		{
+			// the values of shapefiles are little-endian, except for the lengths in the file and record headers
+			static int32_t ReadInt32(const uint8_t* data)
+			{
+				int32_t value;
+				memcpy(&value, data, sizeof(value));
+				return value;
+			}
+
+			static int32_t ReadBigEndianInt32(const uint8_t* data)
+			{
+				return static_cast<int32_t>((static_cast<uint32_t>(data[0]) << 24) | (static_cast<uint32_t>(data[1]) << 16) | (static_cast<uint32_t>(data[2]) << 8) | data[3]);
+			}
+
+			static double ReadDouble(const uint8_t* data)
+			{
+				double value;
+				memcpy(&value, data, sizeof(value));
+				return value;
+			}
+
+			static uint16_t ReadUInt16(const uint8_t* data)
+			{
+				return static_cast<uint16_t>(data[0] | (data[1] << 8));
+			}
+
+			bool D2DShapefileReader::ReadShapes(const uint8_t* data, size_t size, D2DShapefileGeometry* geometry)
+			{
+				if(!ReadHeader(data, size, geometry))
+				{
+					return false;
+				}
+
+				// the records can only be located one after the other, but the walk only touches their headers
+				std::vector<Record> records;
+				for(size_t offset = ShapefileHeaderSize; offset + 8 <= size;)
+				{
+					Record record = { offset + 8, static_cast<uint32_t>(ReadBigEndianInt32(data + offset + 4)) * 2, 0, 0 };
+					if(record.ContentOffset + record.ContentLength > size)
+					{
+						// a truncated file keeps the records that are complete
+						break;
+					}
+
+					records.push_back(record);
+					offset = record.ContentOffset + record.ContentLength;
+				}
+
+				size_t recordCount = records.size();
+				size_t chunkCount = (recordCount + RecordsPerChunk - 1) / RecordsPerChunk;
+				geometry->RecordShapeTypes.resize(recordCount);
+
+				// first pass: the parts and points of each record, so that every record knows where its output goes
+				std::vector<uint8_t> isChunkSupported(chunkCount, 1);
+				D2DParallel::For(chunkCount, [&](size_t chunk, size_t)
+				{
+					size_t end = (std::min)((chunk + 1) * RecordsPerChunk, recordCount);
+					for(size_t i = chunk * RecordsPerChunk; i < end; i++)
+					{
+						const uint8_t* content = data + records[i].ContentOffset;
+						geometry->RecordShapeTypes[i] = records[i].ContentLength >= 4 ? static_cast<uint8_t>(ReadInt32(content)) : 0;
+
+						if(!CountRecord(content, &records[i]))
+						{
+							isChunkSupported[chunk] = 0;
+						}
+					}
+				});
+
+				if(std::find(isChunkSupported.begin(), isChunkSupported.end(), 0) != isChunkSupported.end())
+				{
+					return false;
+				}
+
+				std::vector<uint32_t> firstPoints(recordCount);
+				geometry->PartOffsets.resize(recordCount + 1);
+
+				uint64_t partCount = 0;
+				uint64_t pointCount = 0;
+				for(size_t i = 0; i < recordCount; i++)
+				{
+					geometry->PartOffsets[i] = static_cast<uint32_t>(partCount);
+					firstPoints[i] = static_cast<uint32_t>(pointCount);
+
+					partCount += records[i].PartCount;
+					pointCount += records[i].PointCount;
+
+					// the offsets are 32-bit, which covers shapefiles of up to 64 GB of points
+					if(pointCount >= UINT32_MAX || partCount >= UINT32_MAX)
+					{
+						return false;
+					}
+				}
+
+				geometry->PartOffsets[recordCount] = static_cast<uint32_t>(partCount);
+				geometry->PointOffsets.resize(static_cast<size_t>(partCount) + 1);
+				geometry->PointOffsets[static_cast<size_t>(partCount)] = static_cast<uint32_t>(pointCount);
+				geometry->Coordinates.resize(static_cast<size_t>(pointCount) * 2);
+
+				// second pass: the records are copied to their places, so the chunks do not depend on each other
+				D2DParallel::For(chunkCount, [&](size_t chunk, size_t)
+				{
+					size_t end = (std::min)((chunk + 1) * RecordsPerChunk, recordCount);
+					for(size_t i = chunk * RecordsPerChunk; i < end; i++)
+					{
+						DecodeRecord(
+							data + records[i].ContentOffset,
+							records[i],
+							firstPoints[i],
+							geometry->PointOffsets.data() + geometry->PartOffsets[i],
+							geometry->Coordinates.data());
+					}
+				});
+
+				return true;
+			}
+
+			bool D2DShapefileReader::ReadShapeBatch(const uint8_t* data, size_t size, size_t* offset, size_t maxRecords, D2DShapefileGeometry* batch)
+			{
+				if(!ReadHeader(data, size, batch))
+				{
+					return false;
+				}
+
+				if(*offset < ShapefileHeaderSize)
+				{
+					*offset = ShapefileHeaderSize;
+				}
+
+				// the records of a batch are decoded one after the other; the batches themselves are the unit of parallel work
+				for(size_t decoded = 0; decoded < maxRecords && *offset + 8 <= size; decoded++)
+				{
+					Record record = { *offset + 8, static_cast<uint32_t>(ReadBigEndianInt32(data + *offset + 4)) * 2, 0, 0 };
+					if(record.ContentOffset + record.ContentLength > size)
+					{
+						// a truncated file keeps the records that are complete
+						*offset = size;
+						break;
+					}
+
+					const uint8_t* content = data + record.ContentOffset;
+					if(!CountRecord(content, &record))
+					{
+						return false;
+					}
+
+					uint32_t firstPoint = batch->PointOffsets.back();
+					if(static_cast<uint64_t>(firstPoint) + record.PointCount >= UINT32_MAX)
+					{
+						return false;
+					}
+
+					batch->RecordShapeTypes.push_back(record.ContentLength >= 4 ? static_cast<uint8_t>(ReadInt32(content)) : 0);
+
+					size_t firstPart = batch->PointOffsets.size() - 1;
+					batch->PointOffsets.resize(firstPart + record.PartCount + 1);
+					batch->PointOffsets.back() = firstPoint + record.PointCount;
+					batch->PartOffsets.push_back(static_cast<uint32_t>(firstPart + record.PartCount));
+					batch->Coordinates.resize(2 * (static_cast<size_t>(firstPoint) + record.PointCount));
+
+					DecodeRecord(content, record, firstPoint, batch->PointOffsets.data() + firstPart, batch->Coordinates.data());
+					*offset = record.ContentOffset + record.ContentLength;
+				}
+
+				return true;
+			}
+
+			bool D2DShapefileReader::ReadHeader(const uint8_t* data, size_t size, D2DShapefileGeometry* geometry)
+			{
+				geometry->RecordShapeTypes.clear();
+				geometry->PartOffsets.assign(1, 0);
+				geometry->PointOffsets.assign(1, 0);
+				geometry->Coordinates.clear();
+
+				if(size < ShapefileHeaderSize || ReadBigEndianInt32(data) != ShapefileFileCode)
+				{
+					return false;
+				}
+
+				geometry->ShapeType = ReadInt32(data + 32);
+				geometry->MinX = ReadDouble(data + 36);
+				geometry->MinY = ReadDouble(data + 44);
+				geometry->MaxX = ReadDouble(data + 52);
+				geometry->MaxY = ReadDouble(data + 60);
+
+				return true;
+			}
+
+			bool D2DShapefileReader::CountRecord(const uint8_t* content, Record* record)
+			{
+				record->PartCount = 0;
+				record->PointCount = 0;
+
+				if(record->ContentLength < 4)
+				{
+					return true;
+				}
+
+				size_t length = record->ContentLength;
+				switch(ReadInt32(content))
+				{
+					// null shape
+					case 0:
+						return true;
+
+					// point, point Z, point M
+					case 1:
+					case 11:
+					case 21:
+						if(length >= 20)
+						{
+							record->PartCount = 1;
+							record->PointCount = 1;
+						}
+						return true;
+
+					// multipoint, multipoint Z, multipoint M
+					case 8:
+					case 18:
+					case 28:
+						if(length >= 40)
+						{
+							int32_t points = ReadInt32(content + 36);
+							if(points > 0 && 40 + 16 * static_cast<uint64_t>(points) <= length)
+							{
+								record->PartCount = 1;
+								record->PointCount = static_cast<uint32_t>(points);
+							}
+						}
+						return true;
+
+					// polyline, polygon and their Z and M variants
+					case 3:
+					case 5:
+					case 13:
+					case 15:
+					case 23:
+					case 25:
+						if(length >= 44)
+						{
+							int32_t parts = ReadInt32(content + 36);
+							int32_t points = ReadInt32(content + 40);
+							if(parts > 0 && points > 0 && 44 + 4 * static_cast<uint64_t>(parts) + 16 * static_cast<uint64_t>(points) <= length)
+							{
+								record->PartCount = static_cast<uint32_t>(parts);
+								record->PointCount = static_cast<uint32_t>(points);
+							}
+						}
+						return true;
+
+					// multipatch, as the managed reader
+					default:
+						return false;
+				}
+			}
+
+			void D2DShapefileReader::DecodeRecord(const uint8_t* content, const Record& record, uint32_t firstPoint, uint32_t* partOffsets, double* coordinates)
+			{
+				if(record.PartCount == 0)
+				{
+					return;
+				}
+
+				// the Z and M values follow the x, y pairs and are not read
+				const uint8_t* points;
+				int32_t shapeType = ReadInt32(content);
+
+				if(shapeType == 1 || shapeType == 11 || shapeType == 21)
+				{
+					points = content + 4;
+					partOffsets[0] = firstPoint;
+				}
+				else if(shapeType == 8 || shapeType == 18 || shapeType == 28)
+				{
+					points = content + 40;
+					partOffsets[0] = firstPoint;
+				}
+				else
+				{
+					points = content + 44 + 4 * static_cast<size_t>(record.PartCount);
+
+					// damaged part indices are clamped, so that the parts stay ordered and within the record
+					uint32_t previous = 0;
+					for(uint32_t part = 0; part < record.PartCount; part++)
+					{
+						uint32_t start = static_cast<uint32_t>((std::max)(ReadInt32(content + 44 + 4 * static_cast<size_t>(part)), 0));
+						start = (std::min)((std::max)(start, previous), record.PointCount);
+
+						partOffsets[part] = firstPoint + start;
+						previous = start;
+					}
+				}
+
+				// the points are stored as interleaved little-endian doubles, the same as the buffer
+				memcpy(coordinates + 2 * static_cast<size_t>(firstPoint), points, 16 * static_cast<size_t>(record.PointCount));
+			}
+
+			bool D2DDbfColumn::IsNumeric() const
+			{
+				return this->NativeType == 'N' || this->NativeType == 'F' || this->NativeType == 'I' || this->NativeType == 'L';
+			}
+
+			bool D2DShapefileReader::ReadTable(const uint8_t* data, size_t size, D2DDbfTable* table)
+			{
+				table->Columns.clear();
+				table->RecordCount = 0;
+				table->CodePage = 0;
+
+				const uint8_t* versionsEnd = DbfVersions + sizeof(DbfVersions);
+				if(size < DbfFieldDescriptorSize || std::find(DbfVersions, versionsEnd, data[0]) == versionsEnd)
+				{
+					return false;
+				}
+
+				size_t recordCount = static_cast<uint32_t>(ReadInt32(data + 4));
+				size_t headerLength = ReadUInt16(data + 8);
+				size_t recordLength = ReadUInt16(data + 10);
+				table->CodePage = GetCodePage(data[29]);
+
+				if(headerLength > size || recordLength == 0)
+				{
+					return false;
+				}
+
+				// the field descriptors end with a carriage return; the first byte of a record is its deletion flag
+				uint32_t recordOffset = 1;
+				for(size_t offset = DbfFieldDescriptorSize; offset + DbfFieldDescriptorSize <= headerLength && data[offset] != 0x0D; offset += DbfFieldDescriptorSize)
+				{
+					const char* name = reinterpret_cast<const char*>(data + offset);
+
+					D2DDbfColumn column;
+					column.Name.assign(name, std::find(name, name + 11, '\0'));
+					column.NativeType = static_cast<char>(data[offset + 11]);
+					column.Length = data[offset + 16];
+					column.DecimalCount = data[offset + 17];
+					column.RecordOffset = recordOffset;
+
+					recordOffset += column.Length;
+					if(recordOffset > recordLength)
+					{
+						return false;
+					}
+
+					table->Columns.push_back(column);
+				}
+
+				// a truncated file keeps the records that are complete
+				recordCount = (std::min)(recordCount, (size - headerLength) / recordLength);
+				table->RecordCount = recordCount;
+
+				for(auto column = table->Columns.begin(); column != table->Columns.end(); ++column)
+				{
+					if(column->IsNumeric())
+					{
+						column->Numbers.resize(recordCount);
+					}
+					else
+					{
+						column->Text.resize(recordCount * column->Length);
+						column->TextLengths.resize(recordCount);
+					}
+				}
+
+				size_t chunkCount = (recordCount + RecordsPerChunk - 1) / RecordsPerChunk;
+				D2DParallel::For(chunkCount, [&](size_t chunk, size_t)
+				{
+					size_t end = (std::min)((chunk + 1) * RecordsPerChunk, recordCount);
+					for(size_t i = chunk * RecordsPerChunk; i < end; i++)
+					{
+						const uint8_t* record = data + headerLength + i * recordLength;
+						for(auto column = table->Columns.begin(); column != table->Columns.end(); ++column)
+						{
+							DecodeField(record + column->RecordOffset, i, &*column);
+						}
+					}
+				});
+
+				return true;
+			}
+
+			void D2DShapefileReader::DecodeField(const uint8_t* field, size_t record, D2DDbfColumn* column)
+			{
+				const char* text = reinterpret_cast<const char*>(field);
+
+				switch(column->NativeType)
+				{
+					case 'N':
+					case 'F':
+						column->Numbers[record] = ParseNumber(text, column->Length);
+						return;
+
+					case 'I':
+						// a binary integer, unlike the other numeric fields
+						column->Numbers[record] = column->Length == 4 ? ReadInt32(field) : ParseNumber(text, column->Length);
+						return;
+
+					case 'L':
+						column->Numbers[record] = column->Length > 0 && (text[0] == 'T' || text[0] == 't' || text[0] == 'Y' || text[0] == 'y') ? 1 : 0;
+						return;
+
+					default:
+					{
+						size_t length = column->Length;
+						while(length > 0 && (text[length - 1] == ' ' || text[length - 1] == '\0'))
+						{
+							length--;
+						}
+
+						memcpy(&column->Text[record * column->Length], text, length);
+						column->TextLengths[record] = static_cast<uint16_t>(length);
+						return;
+					}
+				}
+			}
+
+			double D2DShapefileReader::ParseNumber(const char* text, size_t length)
+			{
+				static const double PowersOfTen[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+
+				const char* end = text + length;
+				while(text < end && (*text == ' ' || *text == '*'))
+				{
+					text++;
+				}
+
+				bool isNegative = false;
+				if(text < end && (*text == '-' || *text == '+'))
+				{
+					isNegative = *text == '-';
+					text++;
+				}
+
+				// up to 19 significant digits are kept exactly; the digits past them only scale the value
+				uint64_t mantissa = 0;
+				int digits = 0;
+				int exponent = 0;
+				bool hasDigits = false;
+
+				for(; text < end && *text >= '0' && *text <= '9'; text++, hasDigits = true)
+				{
+					if(digits < 19)
+					{
+						mantissa = mantissa * 10 + (*text - '0');
+						digits += mantissa != 0 ? 1 : 0;
+					}
+					else
+					{
+						exponent++;
+					}
+				}
+
+				if(text < end && (*text == '.' || *text == ','))
+				{
+					for(text++; text < end && *text >= '0' && *text <= '9'; text++, hasDigits = true)
+					{
+						if(digits < 19)
+						{
+							mantissa = mantissa * 10 + (*text - '0');
+							digits += mantissa != 0 ? 1 : 0;
+							exponent--;
+						}
+					}
+				}
+
+				if(!hasDigits)
+				{
+					return std::numeric_limits<double>::quiet_NaN();
+				}
+
+				if(text < end && (*text == 'e' || *text == 'E'))
+				{
+					bool isExponentNegative = false;
+					if(++text < end && (*text == '-' || *text == '+'))
+					{
+						isExponentNegative = *text == '-';
+						text++;
+					}
+
+					int value = 0;
+					for(; text < end && *text >= '0' && *text <= '9'; text++)
+					{
+						value = (std::min)(value * 10 + (*text - '0'), 9999);
+					}
+
+					exponent += isExponentNegative ? -value : value;
+				}
+
+				double result = static_cast<double>(mantissa);
+				if(exponent > 0)
+				{
+					result *= exponent <= 22 ? PowersOfTen[exponent] : pow(10.0, exponent);
+				}
+				else if(exponent < 0)
+				{
+					result /= -exponent <= 22 ? PowersOfTen[-exponent] : pow(10.0, -exponent);
+				}
+
+				return isNegative ? -result : result;
+			}
+
+			uint32_t D2DShapefileReader::GetCodePage(uint8_t languageDriver)
+			{
+				// the same mapping as DbfEncoding of the managed reader
+				switch(languageDriver)
+				{
+					case 0x01:
+					case 0x69:
+						return 437;
+					case 0x02:
+						return 850;
+					case 0x03:
+						return 1252;
+					case 0x04:
+						return 10000;
+					case 0x64:
+					case 0x68:
+						return 852;
+					case 0x65:
+						return 865;
+					case 0x66:
+						return 866;
+					case 0x67:
+						return 861;
+					case 0x6A:
+						return 737;
+					case 0x6B:
+						return 857;
+					case 0x96:
+						return 10007;
+					case 0x97:
+						return 10029;
+					case 0x98:
+						return 10006;
+					case 0xC8:
+						return 1250;
+					case 0xC9:
+						return 1251;
+					case 0xCA:
+						return 1254;
+					case 0xCB:
+						return 1253;
+					default:
+						return 65001;
+				}
+			}
+		}
+	}
+}
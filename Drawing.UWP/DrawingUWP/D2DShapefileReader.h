@@ -0,0 +1,92 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <cstddef>
+#include <cstdint>
+
+namespace Telerik
+{
+	namespace UI
+	{
+		namespace Drawing
+		{
+			// the shapes of a shapefile decoded into flat buffers: record r owns the parts [PartOffsets[r], PartOffsets[r + 1])
+			// and part p owns the points [PointOffsets[p], PointOffsets[p + 1]). Coordinates are interleaved x, y as stored in
+			// the file; a null shape, a single point and each multipoint own zero, one and one part respectively
+			struct D2DShapefileGeometry
+			{
+				int32_t ShapeType;
+				double MinX;
+				double MinY;
+				double MaxX;
+				double MaxY;
+
+				std::vector<uint8_t> RecordShapeTypes;
+				std::vector<uint32_t> PartOffsets;
+				std::vector<uint32_t> PointOffsets;
+				std::vector<double> Coordinates;
+			};
+
+			// a field of a DBF file decoded for all records: numeric and logical fields into numbers (NaN when empty),
+			// the other fields into fixed-size slots of Length bytes, trimmed, in the encoding of the file
+			struct D2DDbfColumn
+			{
+				std::string Name;
+				char NativeType;
+				uint32_t Length;
+				uint32_t DecimalCount;
+				uint32_t RecordOffset;
+
+				std::vector<double> Numbers;
+				std::vector<char> Text;
+				std::vector<uint16_t> TextLengths;
+
+				bool IsNumeric() const;
+			};
+
+			struct D2DDbfTable
+			{
+				uint32_t CodePage;
+				size_t RecordCount;
+				std::vector<D2DDbfColumn> Columns;
+			};
+
+			// decodes the .shp and .dbf files of a shapefile from memory (usually a D2DMappedFile). Records are located by
+			// a sequential walk over their headers and then decoded in parallel chunks straight into preallocated buffers
+			class D2DShapefileReader
+			{
+			public:
+				// returns false if the data is not a shapefile or holds unsupported (MultiPatch) records
+				static bool ReadShapes(const uint8_t* data, size_t size, D2DShapefileGeometry* geometry);
+
+				// decodes the records from *offset on into the batch until maxRecords are decoded or the data ends, and moves
+				// the offset past them; an offset of 0 starts at the first record. The header fields of the batch are the ones
+				// of the file. Returns false on the same conditions as ReadShapes; the data is done once a batch comes back empty
+				static bool ReadShapeBatch(const uint8_t* data, size_t size, size_t* offset, size_t maxRecords, D2DShapefileGeometry* batch);
+				static bool ReadTable(const uint8_t* data, size_t size, D2DDbfTable* table);
+
+				// the Windows code page of a DBF language driver id; UTF-8 when the id is unknown
+				static uint32_t GetCodePage(uint8_t languageDriver);
+
+				// parses a right-aligned DBF number, where overflow is stored as asterisks; NaN if the text holds no digits
+				static double ParseNumber(const char* text, size_t length);
+
+			private:
+				static bool ReadHeader(const uint8_t* data, size_t size, D2DShapefileGeometry* geometry);
+
+				struct Record
+				{
+					size_t ContentOffset;
+					uint32_t ContentLength;
+					uint32_t PartCount;
+					uint32_t PointCount;
+				};
+
+				static bool CountRecord(const uint8_t* content, Record* record);
+				static void DecodeRecord(const uint8_t* content, const Record& record, uint32_t firstPoint, uint32_t* partOffsets, double* coordinates);
+				static void DecodeField(const uint8_t* field, size_t record, D2DDbfColumn* column);
+			};
+		}
+	}
+}
@@ -0,0 +1,826 @@
+#include "pch.h"
+#include "D2DTessellator.h"
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <limits>
+
+// polygons with more points than this look their ears up through a z-order index instead of walking the whole ring
+const size_t ZOrderIndexMinPointCount = 80;
+
+// the z-order curve is computed on a grid of this many cells per side of the bounds of the polygon
+const double ZOrderGridSize = 32767;
+
+// the area of the triangles may differ by this fraction from the one of the rings before the rings are taken as crossing
+const double TessellationAreaTolerance = 1e-6;
+
+namespace Telerik
+{
+	namespace UI
+	{
+		namespace Drawing
+		{
+			// a vertex of the remaining polygon: a circular list in ring order, and a list sorted by z-order
+			// over the same vertices. The bridges to holes and the diagonals of split polygons duplicate their end points
+			struct TessellationNode
+			{
+				uint32_t Index;
+				double X;
+				double Y;
+				TessellationNode* Previous;
+				TessellationNode* Next;
+				uint32_t Z;
+				TessellationNode* PreviousZ;
+				TessellationNode* NextZ;
+				bool IsSteiner;
+			};
+
+			typedef std::deque<TessellationNode> NodeStore;
+
+			static TessellationNode* InsertNode(NodeStore& nodes, uint32_t index, double x, double y, TessellationNode* last)
+			{
+				TessellationNode node = { index, x, y, nullptr, nullptr, 0, nullptr, nullptr, false };
+				nodes.push_back(node);
+
+				TessellationNode* p = &nodes.back();
+				if(last == nullptr)
+				{
+					p->Previous = p;
+					p->Next = p;
+				}
+				else
+				{
+					p->Next = last->Next;
+					p->Previous = last;
+					last->Next->Previous = p;
+					last->Next = p;
+				}
+
+				return p;
+			}
+
+			static void RemoveNode(TessellationNode* p)
+			{
+				p->Next->Previous = p->Previous;
+				p->Previous->Next = p->Next;
+
+				if(p->PreviousZ != nullptr)
+				{
+					p->PreviousZ->NextZ = p->NextZ;
+				}
+
+				if(p->NextZ != nullptr)
+				{
+					p->NextZ->PreviousZ = p->PreviousZ;
+				}
+			}
+
+			// twice the signed area of the triangle; negative for a convex corner of a ring in the order it is clipped in
+			static double Area(const TessellationNode* p, const TessellationNode* q, const TessellationNode* r)
+			{
+				return (q->Y - p->Y) * (r->X - q->X) - (q->X - p->X) * (r->Y - q->Y);
+			}
+
+			static bool IsEqual(const TessellationNode* p, const TessellationNode* q)
+			{
+				return p->X == q->X && p->Y == q->Y;
+			}
+
+			static bool IsPointInTriangle(double ax, double ay, double bx, double by, double cx, double cy, double px, double py)
+			{
+				return (cx - px) * (ay - py) >= (ax - px) * (cy - py) &&
+					(ax - px) * (by - py) >= (bx - px) * (ay - py) &&
+					(bx - px) * (cy - py) >= (cx - px) * (by - py);
+			}
+
+			static int Sign(double value)
+			{
+				return value > 0 ? 1 : (value < 0 ? -1 : 0);
+			}
+
+			static bool IsOnSegment(const TessellationNode* p, const TessellationNode* q, const TessellationNode* r)
+			{
+				return q->X <= (std::max)(p->X, r->X) && q->X >= (std::min)(p->X, r->X) && q->Y <= (std::max)(p->Y, r->Y) && q->Y >= (std::min)(p->Y, r->Y);
+			}
+
+			static bool Intersects(const TessellationNode* p1, const TessellationNode* q1, const TessellationNode* p2, const TessellationNode* q2)
+			{
+				int o1 = Sign(Area(p1, q1, p2));
+				int o2 = Sign(Area(p1, q1, q2));
+				int o3 = Sign(Area(p2, q2, p1));
+				int o4 = Sign(Area(p2, q2, q1));
+
+				if(o1 != o2 && o3 != o4)
+				{
+					return true;
+				}
+
+				// collinear end points only intersect if they lie on the other segment
+				return (o1 == 0 && IsOnSegment(p1, p2, q1)) || (o2 == 0 && IsOnSegment(p1, q2, q1)) ||
+					(o3 == 0 && IsOnSegment(p2, p1, q2)) || (o4 == 0 && IsOnSegment(p2, q1, q2));
+			}
+
+			static bool IntersectsPolygon(const TessellationNode* a, const TessellationNode* b)
+			{
+				const TessellationNode* p = a;
+				do
+				{
+					if(p->Index != a->Index && p->Next->Index != a->Index && p->Index != b->Index && p->Next->Index != b->Index && Intersects(p, p->Next, a, b))
+					{
+						return true;
+					}
+
+					p = p->Next;
+				}
+				while(p != a);
+
+				return false;
+			}
+
+			// whether the diagonal from a to b starts into the inside of the polygon at a
+			static bool IsLocallyInside(const TessellationNode* a, const TessellationNode* b)
+			{
+				return Area(a->Previous, a, a->Next) < 0 ?
+					Area(a, b, a->Next) >= 0 && Area(a, a->Previous, b) >= 0 :
+					Area(a, b, a->Previous) < 0 || Area(a, a->Next, b) < 0;
+			}
+
+			static bool IsMiddleInside(const TessellationNode* a, const TessellationNode* b)
+			{
+				const TessellationNode* p = a;
+				bool isInside = false;
+				double px = (a->X + b->X) / 2;
+				double py = (a->Y + b->Y) / 2;
+
+				do
+				{
+					if(((p->Y > py) != (p->Next->Y > py)) && p->Next->Y != p->Y && (px < (p->Next->X - p->X) * (py - p->Y) / (p->Next->Y - p->Y) + p->X))
+					{
+						isInside = !isInside;
+					}
+
+					p = p->Next;
+				}
+				while(p != a);
+
+				return isInside;
+			}
+
+			static bool IsValidDiagonal(const TessellationNode* a, const TessellationNode* b)
+			{
+				// the diagonal does not cross the polygon, lies inside it and leaves no zero-area piece on either side,
+				// or it joins two coincident vertices of a touching hole
+				return a->Next->Index != b->Index && a->Previous->Index != b->Index && !IntersectsPolygon(a, b) &&
+					((IsLocallyInside(a, b) && IsLocallyInside(b, a) && IsMiddleInside(a, b) && (Area(a->Previous, a, b->Previous) != 0 || Area(a, b->Previous, b) != 0)) ||
+					(IsEqual(a, b) && Area(a->Previous, a, a->Next) > 0 && Area(b->Previous, b, b->Next) > 0));
+			}
+
+			// connects a and b with a diagonal, which splits the polygon in two; returns the copy of b on the second polygon
+			static TessellationNode* SplitPolygon(NodeStore& nodes, TessellationNode* a, TessellationNode* b)
+			{
+				TessellationNode a2Node = { a->Index, a->X, a->Y, nullptr, nullptr, 0, nullptr, nullptr, false };
+				TessellationNode b2Node = { b->Index, b->X, b->Y, nullptr, nullptr, 0, nullptr, nullptr, false };
+				nodes.push_back(a2Node);
+				TessellationNode* a2 = &nodes.back();
+				nodes.push_back(b2Node);
+				TessellationNode* b2 = &nodes.back();
+
+				TessellationNode* an = a->Next;
+				TessellationNode* bp = b->Previous;
+
+				a->Next = b;
+				b->Previous = a;
+
+				a2->Next = an;
+				an->Previous = a2;
+
+				b2->Next = a2;
+				a2->Previous = b2;
+
+				bp->Next = b2;
+				b2->Previous = bp;
+
+				return b2;
+			}
+
+			// removes duplicate and collinear vertices between start and end
+			static TessellationNode* FilterPoints(TessellationNode* start, TessellationNode* end)
+			{
+				if(start == nullptr)
+				{
+					return start;
+				}
+
+				if(end == nullptr)
+				{
+					end = start;
+				}
+
+				TessellationNode* p = start;
+				bool again;
+				do
+				{
+					again = false;
+
+					if(!p->IsSteiner && (IsEqual(p, p->Next) || Area(p->Previous, p, p->Next) == 0))
+					{
+						RemoveNode(p);
+						p = end = p->Previous;
+						if(p == p->Next)
+						{
+							break;
+						}
+						again = true;
+					}
+					else
+					{
+						p = p->Next;
+					}
+				}
+				while(again || p != end);
+
+				return end;
+			}
+
+			static double SignedArea(const float* coordinates, uint32_t start, uint32_t end)
+			{
+				double sum = 0;
+				for(uint32_t i = start, j = end - 1; i < end; j = i++)
+				{
+					sum += (static_cast<double>(coordinates[2 * j]) - coordinates[2 * i]) * (static_cast<double>(coordinates[2 * i + 1]) + coordinates[2 * j + 1]);
+				}
+
+				return sum;
+			}
+
+			// links the points of a ring in the requested orientation, whatever their order in the buffer
+			static TessellationNode* LinkRing(NodeStore& nodes, const float* coordinates, uint32_t start, uint32_t end, bool isClockwise)
+			{
+				TessellationNode* last = nullptr;
+				if(isClockwise == (SignedArea(coordinates, start, end) > 0))
+				{
+					for(uint32_t i = start; i < end; i++)
+					{
+						last = InsertNode(nodes, i, coordinates[2 * i], coordinates[2 * i + 1], last);
+					}
+				}
+				else
+				{
+					for(uint32_t i = end; i-- > start;)
+					{
+						last = InsertNode(nodes, i, coordinates[2 * i], coordinates[2 * i + 1], last);
+					}
+				}
+
+				// the rings of shapefiles and GeoJSON repeat their first point at the end
+				if(last != nullptr && IsEqual(last, last->Next))
+				{
+					RemoveNode(last);
+					last = last->Next;
+				}
+
+				return last;
+			}
+
+			static uint32_t GetZOrder(double x, double y, double minX, double minY, double inverseSize)
+			{
+				// interleaves the bits of the 15-bit cell coordinates
+				uint32_t ix = static_cast<uint32_t>((x - minX) * inverseSize);
+				uint32_t iy = static_cast<uint32_t>((y - minY) * inverseSize);
+
+				ix = (ix | (ix << 8)) & 0x00FF00FF;
+				ix = (ix | (ix << 4)) & 0x0F0F0F0F;
+				ix = (ix | (ix << 2)) & 0x33333333;
+				ix = (ix | (ix << 1)) & 0x55555555;
+
+				iy = (iy | (iy << 8)) & 0x00FF00FF;
+				iy = (iy | (iy << 4)) & 0x0F0F0F0F;
+				iy = (iy | (iy << 2)) & 0x33333333;
+				iy = (iy | (iy << 1)) & 0x55555555;
+
+				return ix | (iy << 1);
+			}
+
+			static void IndexCurve(TessellationNode* start, double minX, double minY, double inverseSize, std::vector<TessellationNode*>& sorted)
+			{
+				sorted.clear();
+
+				TessellationNode* p = start;
+				do
+				{
+					if(p->Z == 0)
+					{
+						p->Z = GetZOrder(p->X, p->Y, minX, minY, inverseSize);
+					}
+
+					sorted.push_back(p);
+					p = p->Next;
+				}
+				while(p != start);
+
+				std::stable_sort(sorted.begin(), sorted.end(), [](const TessellationNode* a, const TessellationNode* b) { return a->Z < b->Z; });
+
+				for(size_t i = 0; i < sorted.size(); i++)
+				{
+					sorted[i]->PreviousZ = i > 0 ? sorted[i - 1] : nullptr;
+					sorted[i]->NextZ = i + 1 < sorted.size() ? sorted[i + 1] : nullptr;
+				}
+			}
+
+			static bool IsEar(const TessellationNode* ear)
+			{
+				const TessellationNode* a = ear->Previous;
+				const TessellationNode* b = ear;
+				const TessellationNode* c = ear->Next;
+
+				// a reflex corner is never an ear
+				if(Area(a, b, c) >= 0)
+				{
+					return false;
+				}
+
+				double minX = (std::min)((std::min)(a->X, b->X), c->X);
+				double minY = (std::min)((std::min)(a->Y, b->Y), c->Y);
+				double maxX = (std::max)((std::max)(a->X, b->X), c->X);
+				double maxY = (std::max)((std::max)(a->Y, b->Y), c->Y);
+
+				// no other reflex vertex may lie inside the ear
+				for(const TessellationNode* p = c->Next; p != a; p = p->Next)
+				{
+					if(p->X >= minX && p->X <= maxX && p->Y >= minY && p->Y <= maxY &&
+						IsPointInTriangle(a->X, a->Y, b->X, b->Y, c->X, c->Y, p->X, p->Y) && Area(p->Previous, p, p->Next) >= 0)
+					{
+						return false;
+					}
+				}
+
+				return true;
+			}
+
+			static bool IsEarHashed(const TessellationNode* ear, double zMinX, double zMinY, double inverseSize)
+			{
+				const TessellationNode* a = ear->Previous;
+				const TessellationNode* b = ear;
+				const TessellationNode* c = ear->Next;
+
+				if(Area(a, b, c) >= 0)
+				{
+					return false;
+				}
+
+				double minX = (std::min)((std::min)(a->X, b->X), c->X);
+				double minY = (std::min)((std::min)(a->Y, b->Y), c->Y);
+				double maxX = (std::max)((std::max)(a->X, b->X), c->X);
+				double maxY = (std::max)((std::max)(a->Y, b->Y), c->Y);
+
+				// only the vertices whose z-order falls within the one of the bounds of the ear can lie inside it
+				uint32_t minZ = GetZOrder(minX, minY, zMinX, zMinY, inverseSize);
+				uint32_t maxZ = GetZOrder(maxX, maxY, zMinX, zMinY, inverseSize);
+
+				auto isInside = [&](const TessellationNode* p)
+				{
+					return p != a && p != c && p->X >= minX && p->X <= maxX && p->Y >= minY && p->Y <= maxY &&
+						IsPointInTriangle(a->X, a->Y, b->X, b->Y, c->X, c->Y, p->X, p->Y) && Area(p->Previous, p, p->Next) >= 0;
+				};
+
+				const TessellationNode* p = ear->PreviousZ;
+				const TessellationNode* n = ear->NextZ;
+
+				while(p != nullptr && p->Z >= minZ && n != nullptr && n->Z <= maxZ)
+				{
+					if(isInside(p) || isInside(n))
+					{
+						return false;
+					}
+
+					p = p->PreviousZ;
+					n = n->NextZ;
+				}
+
+				for(; p != nullptr && p->Z >= minZ; p = p->PreviousZ)
+				{
+					if(isInside(p))
+					{
+						return false;
+					}
+				}
+
+				for(; n != nullptr && n->Z <= maxZ; n = n->NextZ)
+				{
+					if(isInside(n))
+					{
+						return false;
+					}
+				}
+
+				return true;
+			}
+
+			static void AddTriangle(std::vector<uint32_t>* triangles, const TessellationNode* a, const TessellationNode* b, const TessellationNode* c)
+			{
+				triangles->push_back(a->Index);
+				triangles->push_back(b->Index);
+				triangles->push_back(c->Index);
+			}
+
+			// clips the self-intersections of two adjacent edges, which leave a polygon without ears
+			static TessellationNode* CureLocalIntersections(TessellationNode* start, std::vector<uint32_t>* triangles)
+			{
+				TessellationNode* p = start;
+				do
+				{
+					TessellationNode* a = p->Previous;
+					TessellationNode* b = p->Next->Next;
+
+					if(!IsEqual(a, b) && Intersects(a, p, p->Next, b) && IsLocallyInside(a, b) && IsLocallyInside(b, a))
+					{
+						AddTriangle(triangles, a, p, b);
+
+						RemoveNode(p);
+						RemoveNode(p->Next);
+
+						p = start = b;
+					}
+
+					p = p->Next;
+				}
+				while(p != start);
+
+				return FilterPoints(p, nullptr);
+			}
+
+			struct EarClipper
+			{
+				NodeStore& Nodes;
+				std::vector<uint32_t>* Triangles;
+				std::vector<TessellationNode*> Sorted;
+				double MinX;
+				double MinY;
+				double InverseSize;
+
+				void Clip(TessellationNode* ear, int pass);
+				void Split(TessellationNode* start);
+			};
+
+			void EarClipper::Clip(TessellationNode* ear, int pass)
+			{
+				if(ear == nullptr)
+				{
+					return;
+				}
+
+				bool isHashed = this->InverseSize != 0;
+				if(pass == 0 && isHashed)
+				{
+					IndexCurve(ear, this->MinX, this->MinY, this->InverseSize, this->Sorted);
+				}
+
+				TessellationNode* stop = ear;
+				while(ear->Previous != ear->Next)
+				{
+					TessellationNode* previous = ear->Previous;
+					TessellationNode* next = ear->Next;
+
+					if(isHashed ? IsEarHashed(ear, this->MinX, this->MinY, this->InverseSize) : IsEar(ear))
+					{
+						AddTriangle(this->Triangles, previous, ear, next);
+						RemoveNode(ear);
+
+						// skipping the next vertex leaves fewer sliver triangles
+						ear = next->Next;
+						stop = next->Next;
+						continue;
+					}
+
+					ear = next;
+
+					// a full turn without an ear: the polygon is damaged, so each pass tries a stronger remedy
+					if(ear == stop)
+					{
+						if(pass == 0)
+						{
+							this->Clip(FilterPoints(ear, nullptr), 1);
+						}
+						else if(pass == 1)
+						{
+							this->Clip(CureLocalIntersections(FilterPoints(ear, nullptr), this->Triangles), 2);
+						}
+						else
+						{
+							this->Split(ear);
+						}
+
+						break;
+					}
+				}
+			}
+
+			void EarClipper::Split(TessellationNode* start)
+			{
+				// looks for a valid diagonal that divides the polygon into two that can be clipped separately
+				TessellationNode* a = start;
+				do
+				{
+					for(TessellationNode* b = a->Next->Next; b != a->Previous; b = b->Next)
+					{
+						if(a->Index != b->Index && IsValidDiagonal(a, b))
+						{
+							TessellationNode* c = SplitPolygon(this->Nodes, a, b);
+
+							a = FilterPoints(a, a->Next);
+							c = FilterPoints(c, c->Next);
+
+							this->Clip(a, 0);
+							this->Clip(c, 0);
+							return;
+						}
+					}
+
+					a = a->Next;
+				}
+				while(a != start);
+			}
+
+			static TessellationNode* GetLeftmost(TessellationNode* start)
+			{
+				TessellationNode* p = start;
+				TessellationNode* leftmost = start;
+				do
+				{
+					if(p->X < leftmost->X || (p->X == leftmost->X && p->Y < leftmost->Y))
+					{
+						leftmost = p;
+					}
+
+					p = p->Next;
+				}
+				while(p != start);
+
+				return leftmost;
+			}
+
+			static bool SectorContainsSector(const TessellationNode* m, const TessellationNode* p)
+			{
+				return Area(m->Previous, m, p->Previous) < 0 && Area(p->Next, m, m->Next) < 0;
+			}
+
+			// finds a vertex of the outer ring that can be connected to the leftmost vertex of the hole without crossing anything
+			static TessellationNode* FindHoleBridge(TessellationNode* hole, TessellationNode* outerNode)
+			{
+				TessellationNode* p = outerNode;
+				double hx = hole->X;
+				double hy = hole->Y;
+				double qx = -(std::numeric_limits<double>::infinity)();
+				TessellationNode* m = nullptr;
+
+				// the segment of the outer ring hit first by a ray from the hole to the left
+				do
+				{
+					if(hy <= p->Y && hy >= p->Next->Y && p->Next->Y != p->Y)
+					{
+						double x = p->X + (hy - p->Y) * (p->Next->X - p->X) / (p->Next->Y - p->Y);
+						if(x <= hx && x > qx)
+						{
+							qx = x;
+							m = p->X < p->Next->X ? p : p->Next;
+
+							// the hole touches the segment
+							if(x == hx)
+							{
+								return m;
+							}
+						}
+					}
+
+					p = p->Next;
+				}
+				while(p != outerNode);
+
+				if(m == nullptr)
+				{
+					return nullptr;
+				}
+
+				// the vertices inside the triangle of the hole, the hit point and its segment end may block the bridge;
+				// the one at the smallest angle to the ray is visible from the hole
+				TessellationNode* stop = m;
+				double mx = m->X;
+				double my = m->Y;
+				double minTangent = (std::numeric_limits<double>::infinity)();
+
+				p = m;
+				do
+				{
+					if(hx >= p->X && p->X >= mx && hx != p->X &&
+						IsPointInTriangle(hy < my ? hx : qx, hy, mx, my, hy < my ? qx : hx, hy, p->X, p->Y))
+					{
+						double tangent = std::abs(hy - p->Y) / (hx - p->X);
+						if(IsLocallyInside(p, hole) &&
+							(tangent < minTangent || (tangent == minTangent && (p->X > m->X || (p->X == m->X && SectorContainsSector(m, p))))))
+						{
+							m = p;
+							minTangent = tangent;
+						}
+					}
+
+					p = p->Next;
+				}
+				while(p != stop);
+
+				return m;
+			}
+
+			static TessellationNode* EliminateHole(NodeStore& nodes, TessellationNode* hole, TessellationNode* outerNode)
+			{
+				TessellationNode* bridge = FindHoleBridge(hole, outerNode);
+				if(bridge == nullptr)
+				{
+					return outerNode;
+				}
+
+				// the bridge is walked in both directions, which turns the hole into a part of the outer ring
+				TessellationNode* bridgeReverse = SplitPolygon(nodes, bridge, hole);
+				FilterPoints(bridgeReverse, bridgeReverse->Next);
+
+				return FilterPoints(bridge, bridge->Next);
+			}
+
+			struct TessellationRing
+			{
+				uint32_t Start;
+				uint32_t End;
+				double MinX;
+				double MinY;
+				double MaxX;
+				double MaxY;
+				double Area;
+				uint32_t Depth;
+				size_t Parent;
+			};
+
+			static bool IsPointInRing(const float* coordinates, const TessellationRing& ring, double x, double y)
+			{
+				bool isInside = false;
+				for(uint32_t i = ring.Start, j = ring.End - 1; i < ring.End; j = i++)
+				{
+					double xi = coordinates[2 * i];
+					double yi = coordinates[2 * i + 1];
+					double xj = coordinates[2 * j];
+					double yj = coordinates[2 * j + 1];
+
+					if((yi > y) != (yj > y) && x < (xj - xi) * (y - yi) / (yj - yi) + xi)
+					{
+						isInside = !isInside;
+					}
+				}
+
+				return isInside;
+			}
+
+			static double GetTriangleArea(const float* coordinates, const uint32_t* triangle)
+			{
+				double ax = coordinates[2 * triangle[0]];
+				double ay = coordinates[2 * triangle[0] + 1];
+
+				return std::abs((coordinates[2 * triangle[1]] - ax) * (coordinates[2 * triangle[2] + 1] - ay) - (coordinates[2 * triangle[2]] - ax) * (coordinates[2 * triangle[1] + 1] - ay)) / 2;
+			}
+
+			size_t D2DTessellator::Tessellate(const float* coordinates, const uint32_t* ringOffsets, size_t ringCount, std::vector<uint32_t>* triangles)
+			{
+				size_t firstIndex = triangles->size();
+
+				// rings with fewer than three points have no area
+				std::vector<TessellationRing> rings;
+				for(size_t r = 0; r < ringCount; r++)
+				{
+					if(ringOffsets[r + 1] < ringOffsets[r] + 3)
+					{
+						continue;
+					}
+
+					TessellationRing ring = { ringOffsets[r], ringOffsets[r + 1], 0, 0, 0, 0, 0, 0, SIZE_MAX };
+					ring.MinX = ring.MaxX = coordinates[2 * ring.Start];
+					ring.MinY = ring.MaxY = coordinates[2 * ring.Start + 1];
+					for(uint32_t i = ring.Start + 1; i < ring.End; i++)
+					{
+						ring.MinX = (std::min)(ring.MinX, static_cast<double>(coordinates[2 * i]));
+						ring.MinY = (std::min)(ring.MinY, static_cast<double>(coordinates[2 * i + 1]));
+						ring.MaxX = (std::max)(ring.MaxX, static_cast<double>(coordinates[2 * i]));
+						ring.MaxY = (std::max)(ring.MaxY, static_cast<double>(coordinates[2 * i + 1]));
+					}
+
+					ring.Area = std::abs(SignedArea(coordinates, ring.Start, ring.End));
+					rings.push_back(ring);
+				}
+
+				// the depth of a ring is the number of rings around its first point, and its parent is the smallest of them
+				for(size_t i = 0; i < rings.size(); i++)
+				{
+					double x = coordinates[2 * rings[i].Start];
+					double y = coordinates[2 * rings[i].Start + 1];
+
+					for(size_t j = 0; j < rings.size(); j++)
+					{
+						const TessellationRing& other = rings[j];
+						if(j == i || x < other.MinX || x > other.MaxX || y < other.MinY || y > other.MaxY || !IsPointInRing(coordinates, other, x, y))
+						{
+							continue;
+						}
+
+						rings[i].Depth++;
+						if(rings[i].Parent == SIZE_MAX || other.Area < rings[rings[i].Parent].Area)
+						{
+							rings[i].Parent = j;
+						}
+					}
+				}
+
+				// the area the Alternate fill mode covers when no two edges cross
+				double area = 0;
+				for(auto ring = rings.begin(); ring != rings.end(); ++ring)
+				{
+					area += ring->Depth % 2 == 0 ? ring->Area / 2 : -ring->Area / 2;
+				}
+
+				NodeStore nodes;
+				std::vector<TessellationNode*> holes;
+				EarClipper clipper = { nodes, triangles, std::vector<TessellationNode*>(), 0, 0, 0 };
+
+				for(size_t outer = 0; outer < rings.size(); outer++)
+				{
+					if(rings[outer].Depth % 2 != 0)
+					{
+						continue;
+					}
+
+					nodes.clear();
+					TessellationNode* outerNode = LinkRing(nodes, coordinates, rings[outer].Start, rings[outer].End, true);
+					if(outerNode == nullptr || outerNode->Next == outerNode->Previous)
+					{
+						continue;
+					}
+
+					size_t pointCount = rings[outer].End - rings[outer].Start;
+
+					// the holes are bridged to the outer ring from left to right, so that every bridge can see the outer ring
+					holes.clear();
+					for(size_t hole = 0; hole < rings.size(); hole++)
+					{
+						if(rings[hole].Depth % 2 == 0 || rings[hole].Parent != outer)
+						{
+							continue;
+						}
+
+						TessellationNode* list = LinkRing(nodes, coordinates, rings[hole].Start, rings[hole].End, false);
+						if(list == nullptr)
+						{
+							continue;
+						}
+
+						if(list == list->Next)
+						{
+							list->IsSteiner = true;
+						}
+
+						holes.push_back(GetLeftmost(list));
+						pointCount += rings[hole].End - rings[hole].Start;
+					}
+
+					std::sort(holes.begin(), holes.end(), [](const TessellationNode* a, const TessellationNode* b) { return a->X < b->X; });
+					for(auto hole = holes.begin(); hole != holes.end(); ++hole)
+					{
+						outerNode = EliminateHole(nodes, *hole, outerNode);
+					}
+
+					clipper.InverseSize = 0;
+					if(pointCount > ZOrderIndexMinPointCount)
+					{
+						const TessellationRing& ring = rings[outer];
+						double size = (std::max)(ring.MaxX - ring.MinX, ring.MaxY - ring.MinY);
+
+						clipper.MinX = ring.MinX;
+						clipper.MinY = ring.MinY;
+						clipper.InverseSize = size != 0 ? ZOrderGridSize / size : 0;
+					}
+
+					clipper.Clip(outerNode, 0);
+				}
+
+				// ear clipping fills crossing rings as if they were merged, which the Alternate fill mode does not
+				double triangleArea = 0;
+				for(size_t i = firstIndex; i < triangles->size(); i += 3)
+				{
+					triangleArea += GetTriangleArea(coordinates, triangles->data() + i);
+				}
+
+				if(std::abs(triangleArea - area) > TessellationAreaTolerance * area)
+				{
+					triangles->resize(firstIndex);
+					return 0;
+				}
+
+				return (triangles->size() - firstIndex) / 3;
+			}
+		}
+	}
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+namespace Telerik
+{
+	namespace UI
+	{
+		namespace Drawing
+		{
+			// splits polygons with holes into triangles by ear clipping, so that a fill can be drawn from a mesh built once
+			// instead of having its path tessellated on every draw
+			class D2DTessellator
+			{
+			public:
+				// triangulates rings of interleaved x, y points, where ring r spans the points [ringOffsets[r], ringOffsets[r + 1]),
+				// as the Alternate fill mode of Direct2D does for rings that do not cross: the rings are nested by containment and
+				// each ring inside an odd number of others is a hole of the ring around it. Appends each triangle as three indices
+				// of points and returns the number of triangles appended, or 0 without appending any when the triangles do not
+				// cover the area of the rings, as happens when their edges cross
+				static size_t Tessellate(const float* coordinates, const uint32_t* ringOffsets, size_t ringCount, std::vector<uint32_t>* triangles);
+			};
+		}
+	}
+}
@@ -0,0 +1,74 @@
+#include "pch.h"
+#include "D2DZoomGeometry.h"
+#include "D2DPointKernels.h"
+#include <cmath>
+
+const double ZoomBandsPerOctave = 4.0;
+
+// the distance, in pixels, a point of a ranked ring may be off the simplified ring before it is kept
+const double SimplificationTolerance = 0.25;
+
+namespace Telerik
+{
+	namespace UI
+	{
+		namespace Drawing
+		{
+			int D2DZoomGeometry::GetZoomBand(double zoomFactor)
+			{
+				if(zoomFactor <= 0)
+				{
+					return 0;
+				}
+
+				return static_cast<int>(floor(log(zoomFactor) / log(2.0) * ZoomBandsPerOctave + 0.5));
+			}
+
+			D2DZoomAction D2DZoomGeometry::GetZoomAction(bool usesModelTransform, double geometryZoomFactor, double zoomFactor)
+			{
+				if(usesModelTransform)
+				{
+					return D2DZoomAction::Keep;
+				}
+
+				// the transform of a geometry built within the band scales it by less than a band, which keeps its simplification and flattening
+				if(geometryZoomFactor > 0 && GetZoomBand(geometryZoomFactor) == GetZoomBand(zoomFactor))
+				{
+					return D2DZoomAction::Transform;
+				}
+
+				return D2DZoomAction::Rebuild;
+			}
+
+			float D2DZoomGeometry::GetSimplificationTolerance(double zoomFactor)
+			{
+				return static_cast<float>(SimplificationTolerance / zoomFactor);
+			}
+
+			size_t D2DZoomGeometry::BuildRingPoints(const double* coordinates, const float* ranks, size_t pointCount, double zoomFactor, double offsetX, double offsetY, float tolerance, float* output)
+			{
+				if(ranks == nullptr || tolerance <= 0)
+				{
+					// every point is kept, so the ring is transformed in bulk
+					D2DPointKernels::TransformPoints(coordinates, pointCount, zoomFactor, offsetX, offsetY, output);
+					return pointCount;
+				}
+
+				size_t count = 0;
+				for(size_t i = 0; i < pointCount; i++)
+				{
+					if(ranks[i] < tolerance)
+					{
+						continue;
+					}
+
+					output[2 * count] = static_cast<float>(coordinates[2 * i] * zoomFactor + offsetX);
+					output[2 * count + 1] = static_cast<float>(coordinates[2 * i + 1] * zoomFactor + offsetY);
+					count++;
+				}
+
+				return count;
+			}
+		}
+	}
+}
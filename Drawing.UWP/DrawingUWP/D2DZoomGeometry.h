@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+
+namespace Telerik
+{
+	namespace UI
+	{
+		namespace Drawing
+		{
+			// what a geometry shape does with its path geometry when the zoom factor of the canvas changes
+			enum class D2DZoomAction
+			{
+				// model-space geometry is scaled by the layer transform
+				Keep,
+				// pixel-space geometry built within the same zoom band is drawn through a scale transform
+				Transform,
+				// pixel-space geometry built for another zoom band is looked up in the geometry cache or built again
+				Rebuild
+			};
+
+			// the zoom-dependent part of building geometry shapes, kept apart from Direct2D so that a zoom step can be measured
+			class D2DZoomGeometry
+			{
+			public:
+				// quantizes the zoom factor so that all zoom levels within a band share the same geometry
+				static int GetZoomBand(double zoomFactor);
+
+				static D2DZoomAction GetZoomAction(bool usesModelTransform, double geometryZoomFactor, double zoomFactor);
+
+				// the simplification rank below which the points of a pixel-space ring stay within a fraction of a pixel
+				static float GetSimplificationTolerance(double zoomFactor);
+
+				// scales and offsets the points of a ring into interleaved float (x, y) output, laid out as D2D1_POINT_2F,
+				// leaving out the points ranked below the tolerance; ranks may be null. Returns the number of points written
+				static size_t BuildRingPoints(const double* coordinates, const float* ranks, size_t pointCount, double zoomFactor, double offsetX, double offsetY, float tolerance, float* output);
+			};
+		}
+	}
+}
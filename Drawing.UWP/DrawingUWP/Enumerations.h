@@ -33,6 +33,27 @@ namespace Telerik
 				Double
 			};
 
+			public enum class ShapeLayerCacheMode
+			{
+				None,
+				Bitmap
+			};
+
+			// how the shapes of a layer that are smaller than a pixel are rendered
+			public enum class SubPixelShapeMode
+			{
+				Skip,
+				Aggregate,
+				Render
+			};
+
+			// how the rectangle markers of a layer are drawn
+			public enum class ShapeLayerMarkerMode
+			{
+				Shapes,
+				Atlas
+			};
+
 			public enum class FontWeightName
 			{
 				/// <summary>
@@ -104,6 +125,9 @@ namespace Telerik
 				int Id;
 				int ZIndex;
 				ShapeRenderPrecision RenderPrecision;
+				ShapeLayerCacheMode CacheMode;
+				SubPixelShapeMode SubPixelMode;
+				ShapeLayerMarkerMode MarkerMode;
 			};
 		}
 	}
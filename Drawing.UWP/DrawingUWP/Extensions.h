@@ -43,6 +43,11 @@ public:
 		return D2D1::RectF(rect.X, rect.Y, rect.Right, rect.Bottom);
 	}
 
+	static bool Contains(Rect outer, Rect inner)
+	{
+		return inner.X >= outer.X && inner.Y >= outer.Y && inner.X + inner.Width <= outer.X + outer.Width && inner.Y + inner.Height <= outer.Y + outer.Height;
+	}
+
 	static RECT ToRectL(Rect rect)
 	{
 		RECT rectL;
@@ -1,5 +1,8 @@
 ﻿#pragma once
 
+// the native tests build the portable classes of the library without the Windows Runtime
+#ifndef DRAWING_NATIVE_TESTS
+
 #include <wrl.h>
 #include <d2d1.h>
 #include <d2d1_1.h>
@@ -28,3 +31,12 @@ namespace Telerik
 		}
 	}
 }
+
+#else
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+#include <math.h>
+
+#endif
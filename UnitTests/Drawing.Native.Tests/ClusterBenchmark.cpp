@@ -0,0 +1,65 @@
+#include "NativeTest.h"
+#include "D2DClusterIndex.h"
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+
+using namespace Telerik::UI::Drawing;
+
+// builds a cluster index over sensor-like locations in the 512 unit world of RadMap and queries a 1920 x 1080 viewport
+// at the zoom levels down to a single city, as D2DClusteredPoints does when the zoom factor changes
+int main(int argc, char** argv)
+{
+	size_t count = argc > 1 ? static_cast<size_t>(atol(argv[1])) : 500000;
+
+	// dense around a few cities and sparse elsewhere
+	std::mt19937 random(17);
+	std::uniform_real_distribution<double> uniform(0, 512);
+	std::normal_distribution<double> spread(0, 2);
+
+	std::vector<double> cities;
+	for(int i = 0; i < 50; i++)
+	{
+		cities.push_back(uniform(random));
+		cities.push_back(uniform(random));
+	}
+
+	std::vector<double> coordinates(2 * count);
+	for(size_t i = 0; i < count; i++)
+	{
+		size_t city = i % 50;
+		bool isRural = i % 5 == 0;
+		coordinates[2 * i] = isRural ? uniform(random) : cities[2 * city] + spread(random);
+		coordinates[2 * i + 1] = isRural ? uniform(random) : cities[2 * city + 1] + spread(random);
+	}
+
+	D2DClusterIndex index;
+	double buildSeconds = NativeTest::Measure(3, [&]()
+	{
+		index.Build(coordinates.data(), count, 64, 0, 20);
+	});
+
+	std::printf("%zu points, build %.1f ms\n", count, buildSeconds * 1000);
+
+	std::vector<D2DPointCluster> clusters;
+	for(int level = 0; level <= 10; level++)
+	{
+		// the viewport is centered on the first city
+		double zoomFactor = pow(2.0, level);
+		double width = 1920 / zoomFactor;
+		double height = 1080 / zoomFactor;
+		double minX = cities[0] - width / 2;
+		double minY = cities[1] - height / 2;
+
+		double querySeconds = NativeTest::Measure(20, [&]()
+		{
+			clusters.clear();
+			index.Query(index.GetLevel(zoomFactor), minX, minY, minX + width, minY + height, clusters);
+		});
+
+		std::printf("zoom level %2d: %6zu clusters in view, query %9.1f us\n", level, clusters.size(), querySeconds * 1e6);
+	}
+
+	return 0;
+}
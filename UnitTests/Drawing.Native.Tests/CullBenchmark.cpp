@@ -0,0 +1,142 @@
+#include "NativeTest.h"
+#include "D2DShapeTable.h"
+#include <algorithm>
+#include <cstdio>
+#include <memory>
+#include <random>
+
+using namespace Telerik::UI::Drawing;
+
+// the loop the shape table replaced: every shape is a separate heap object whose bounds are read through a virtual
+// call that maps its model bounds to pixels, as D2DShape::GetBounds does, before the intersection test
+namespace
+{
+	struct PixelRect
+	{
+		float X;
+		float Y;
+		float Width;
+		float Height;
+	};
+
+	class Shape
+	{
+	public:
+		virtual ~Shape() {}
+		virtual PixelRect GetBounds(double zoomFactor, double offsetX, double offsetY) const = 0;
+	};
+
+	class BoxShape : public Shape
+	{
+	public:
+		BoxShape(const D2DCullBounds& bounds) : bounds(bounds)
+		{
+			std::fill(this->state, this->state + sizeof(this->state), 0);
+		}
+
+		virtual PixelRect GetBounds(double zoomFactor, double offsetX, double offsetY) const override
+		{
+			PixelRect rect =
+			{
+				static_cast<float>(this->bounds.MinX * zoomFactor + offsetX) - this->bounds.Padding,
+				static_cast<float>(this->bounds.MinY * zoomFactor + offsetY) - this->bounds.Padding,
+				static_cast<float>((this->bounds.MaxX - this->bounds.MinX) * zoomFactor) + 2 * this->bounds.Padding,
+				static_cast<float>((this->bounds.MaxY - this->bounds.MinY) * zoomFactor) + 2 * this->bounds.Padding
+			};
+
+			return rect;
+		}
+
+	private:
+		D2DCullBounds bounds;
+
+		// the rest of a shape, which spreads the shapes over more cache lines
+		char state[128];
+	};
+}
+
+int main()
+{
+	const size_t counts[] = { 10000, 100000, 1000000 };
+	const double zoomFactor = 4;
+
+	for(size_t count : counts)
+	{
+		std::mt19937 random(11);
+		std::uniform_real_distribution<double> position(0, 512);
+		std::uniform_real_distribution<double> size(0, 2);
+
+		std::vector<D2DCullBounds> bounds(count);
+		for(size_t i = 0; i < count; i++)
+		{
+			double x = position(random);
+			double y = position(random);
+			D2DCullBounds shapeBounds = { x, y, x + size(random), y + size(random), 1 };
+			bounds[i] = shapeBounds;
+		}
+
+		// the shapes are allocated in a shuffled order, as shapes loaded over time end up scattered over the heap
+		std::vector<size_t> allocationOrder(count);
+		for(size_t i = 0; i < count; i++)
+		{
+			allocationOrder[i] = i;
+		}
+
+		std::shuffle(allocationOrder.begin(), allocationOrder.end(), random);
+
+		std::vector<std::unique_ptr<Shape>> shapes(count);
+		for(size_t i = 0; i < count; i++)
+		{
+			shapes[allocationOrder[i]].reset(new BoxShape(bounds[allocationOrder[i]]));
+		}
+
+		D2DShapeTable table;
+		table.Resize(count);
+		table.Fill(0, count, [&](size_t index, D2DCullBounds* shapeBounds)
+		{
+			*shapeBounds = bounds[index];
+			return true;
+		});
+
+		// a 1920 x 1080 viewport at the zoom factor, offset into the model
+		double offsetX = -600;
+		double offsetY = -400;
+		PixelRect viewport = { 0, 0, 1920, 1080 };
+		D2DCullRect cullRect =
+		{
+			static_cast<float>((viewport.X - offsetX) / zoomFactor),
+			static_cast<float>((viewport.Y - offsetY) / zoomFactor),
+			static_cast<float>((viewport.X + viewport.Width - offsetX) / zoomFactor),
+			static_cast<float>((viewport.Y + viewport.Height - offsetY) / zoomFactor)
+		};
+
+		std::vector<uint32_t> survivors;
+		survivors.reserve(count);
+		std::vector<Shape*> visibleShapes;
+		visibleShapes.reserve(count);
+
+		double virtualSeconds = NativeTest::Measure(5, [&]()
+		{
+			visibleShapes.clear();
+			for(auto shape = shapes.begin(); shape != shapes.end(); ++shape)
+			{
+				PixelRect rect = (*shape)->GetBounds(zoomFactor, offsetX, offsetY);
+				if(rect.X <= viewport.X + viewport.Width && rect.X + rect.Width >= viewport.X && rect.Y <= viewport.Y + viewport.Height && rect.Y + rect.Height >= viewport.Y)
+				{
+					visibleShapes.push_back(shape->get());
+				}
+			}
+		});
+
+		double tableSeconds = NativeTest::Measure(5, [&]()
+		{
+			survivors.clear();
+			table.Cull(cullRect, static_cast<float>(1 / zoomFactor), survivors);
+		});
+
+		std::printf("%8zu shapes, %7zu visible: virtual bounds loop %8.3f ms, shape table %8.3f ms (%.1fx)\n",
+			count, survivors.size(), virtualSeconds * 1000, tableSeconds * 1000, virtualSeconds / tableSeconds);
+	}
+
+	return 0;
+}
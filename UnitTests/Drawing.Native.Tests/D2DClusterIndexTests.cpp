@@ -0,0 +1,169 @@
+#include "NativeTest.h"
+#include "D2DClusterIndex.h"
+#include <cmath>
+#include <map>
+#include <random>
+
+using namespace Telerik::UI::Drawing;
+
+static std::vector<double> CreatePoints(size_t count)
+{
+	// clumps of points around a few centers, so that the levels merge them at different zoom levels
+	std::mt19937 random(5);
+	std::normal_distribution<double> spread(0, 4);
+	std::uniform_int_distribution<int> center(0, 4);
+
+	std::vector<double> coordinates;
+	for(size_t i = 0; i < count; i++)
+	{
+		int c = center(random);
+		coordinates.push_back(100 + c * 60 + spread(random) * (c + 1));
+		coordinates.push_back(200 + c * 15 + spread(random));
+	}
+
+	return coordinates;
+}
+
+static std::vector<D2DPointCluster> QueryAll(const D2DClusterIndex& index, int level)
+{
+	std::vector<D2DPointCluster> clusters;
+	index.Query(level, -1e9, -1e9, 1e9, 1e9, clusters);
+	return clusters;
+}
+
+TEST(EveryLevelMatchesAGridOfItsCellSize)
+{
+	std::vector<double> coordinates = CreatePoints(2000);
+	size_t count = coordinates.size() / 2;
+
+	D2DClusterIndex index;
+	index.Build(coordinates.data(), count, 32, 0, 6);
+
+	double originX, originY, maxX, maxY;
+	index.GetBounds(&originX, &originY, &maxX, &maxY);
+
+	for(int level = 0; level <= 6; level++)
+	{
+		struct Cell
+		{
+			double X;
+			double Y;
+			uint32_t Count;
+			uint32_t PointIndex;
+		};
+
+		// the cells of the level are cellSize pixels wide at the zoom factor 2 ^ level
+		double cellSize = 32 / pow(2.0, level);
+		std::map<std::pair<uint32_t, uint32_t>, Cell> cells;
+		for(size_t i = 0; i < count; i++)
+		{
+			auto key = std::make_pair(static_cast<uint32_t>((coordinates[2 * i + 1] - originY) / cellSize), static_cast<uint32_t>((coordinates[2 * i] - originX) / cellSize));
+			auto cell = cells.find(key);
+			if(cell == cells.end())
+			{
+				Cell newCell = { 0, 0, 0, static_cast<uint32_t>(i) };
+				cell = cells.insert(std::make_pair(key, newCell)).first;
+			}
+
+			cell->second.X += coordinates[2 * i];
+			cell->second.Y += coordinates[2 * i + 1];
+			cell->second.Count++;
+		}
+
+		std::vector<D2DPointCluster> clusters = QueryAll(index, level);
+		CHECK_EQUAL(cells.size(), clusters.size());
+
+		uint32_t pointCount = 0;
+		size_t matched = 0;
+		for(auto cluster = clusters.begin(); cluster != clusters.end(); ++cluster)
+		{
+			pointCount += cluster->Count;
+
+			auto key = std::make_pair(static_cast<uint32_t>((cluster->Y - originY) / cellSize), static_cast<uint32_t>((cluster->X - originX) / cellSize));
+			auto cell = cells.find(key);
+			if(cell != cells.end() && cell->second.Count == cluster->Count && cell->second.PointIndex == cluster->PointIndex)
+			{
+				CHECK_CLOSE(cell->second.X / cell->second.Count, cluster->X, 1e-9);
+				CHECK_CLOSE(cell->second.Y / cell->second.Count, cluster->Y, 1e-9);
+				matched++;
+			}
+		}
+
+		CHECK_EQUAL(count, pointCount);
+		CHECK_EQUAL(cells.size(), matched);
+	}
+}
+
+TEST(CoarserLevelsHaveFewerClusters)
+{
+	std::vector<double> coordinates = CreatePoints(5000);
+
+	D2DClusterIndex index;
+	index.Build(coordinates.data(), coordinates.size() / 2, 64, -4, 12);
+
+	size_t previousCount = QueryAll(index, 12).size();
+	for(int level = 11; level >= -4; level--)
+	{
+		size_t clusterCount = QueryAll(index, level).size();
+		CHECK(clusterCount <= previousCount);
+		previousCount = clusterCount;
+	}
+
+	// the whole set, a few hundred units wide, fits in a single 64 pixel cell at 1/16 of the zoom
+	CHECK_EQUAL(1u, previousCount);
+
+	// levels beyond the built ones answer with the nearest one
+	CHECK_EQUAL(QueryAll(index, 12).size(), QueryAll(index, 20).size());
+	CHECK_EQUAL(1u, QueryAll(index, -5).size());
+}
+
+TEST(QueryReturnsTheClustersCenteredInTheRect)
+{
+	std::vector<double> coordinates = CreatePoints(3000);
+
+	D2DClusterIndex index;
+	index.Build(coordinates.data(), coordinates.size() / 2, 16, 0, 8);
+
+	std::vector<D2DPointCluster> all = QueryAll(index, 5);
+
+	std::vector<D2DPointCluster> clusters;
+	index.Query(5, 150, 195, 260, 230, clusters);
+
+	size_t expected = 0;
+	for(auto cluster = all.begin(); cluster != all.end(); ++cluster)
+	{
+		expected += cluster->X >= 150 && cluster->X <= 260 && cluster->Y >= 195 && cluster->Y <= 230 ? 1 : 0;
+	}
+
+	CHECK(expected > 0);
+	CHECK_EQUAL(expected, clusters.size());
+	for(auto cluster = clusters.begin(); cluster != clusters.end(); ++cluster)
+	{
+		CHECK(cluster->X >= 150 && cluster->X <= 260 && cluster->Y >= 195 && cluster->Y <= 230);
+	}
+
+	clusters.clear();
+	index.Query(5, 1000, 1000, 2000, 2000, clusters);
+	CHECK(clusters.empty());
+}
+
+TEST(GetLevelIsTheBinaryLogarithmOfTheZoom)
+{
+	D2DClusterIndex index;
+	CHECK_EQUAL(0, index.GetLevel(1));
+	CHECK_EQUAL(0, index.GetLevel(1.99));
+	CHECK_EQUAL(3, index.GetLevel(8));
+	CHECK_EQUAL(-2, index.GetLevel(0.25));
+	CHECK_EQUAL(0, index.GetLevel(0));
+}
+
+TEST(AnIndexWithoutPointsIsEmpty)
+{
+	D2DClusterIndex index;
+	index.Build(nullptr, 0, 32, 0, 10);
+	CHECK(index.IsEmpty());
+
+	std::vector<D2DPointCluster> clusters;
+	index.Query(0, -1e9, -1e9, 1e9, 1e9, clusters);
+	CHECK(clusters.empty());
+}
@@ -0,0 +1,224 @@
+#include "NativeTest.h"
+#include "D2DDensityGrid.h"
+#include <algorithm>
+#include <random>
+
+using namespace Telerik::UI::Drawing;
+
+// the density of a pixel at the zoom factor, summed point by point with the truncated Gaussian of the grid
+static double GetDensity(const std::vector<double>& coordinates, const std::vector<float>& weights, double zoomFactor, float radius, int pixelX, int pixelY)
+{
+	int kernelRadius = static_cast<int>(ceilf(radius));
+	double sigma = kernelRadius / 3.0;
+
+	double density = 0;
+	for(size_t i = 0; i < coordinates.size() / 2; i++)
+	{
+		int dx = static_cast<int>(floor(coordinates[2 * i] * zoomFactor)) - pixelX;
+		int dy = static_cast<int>(floor(coordinates[2 * i + 1] * zoomFactor)) - pixelY;
+		if(std::abs(dx) <= kernelRadius && std::abs(dy) <= kernelRadius)
+		{
+			density += weights[i] * exp(-(dx * dx) / (2 * sigma * sigma)) * exp(-(dy * dy) / (2 * sigma * sigma));
+		}
+	}
+
+	return density;
+}
+
+// computes the tiles covering the bounds of the points and returns the highest value of all of them
+static float AccumulateAll(const D2DDensityGrid& grid, double zoomFactor, float radius, uint32_t tileSize, std::vector<D2DDensityTile>* tiles, std::vector<float>* values)
+{
+	double minX, minY, maxX, maxY;
+	grid.GetBounds(&minX, &minY, &maxX, &maxY);
+
+	int kernelRadius = static_cast<int>(ceilf(radius));
+	int firstX = static_cast<int>(floor((minX * zoomFactor - kernelRadius) / tileSize));
+	int firstY = static_cast<int>(floor((minY * zoomFactor - kernelRadius) / tileSize));
+	int lastX = static_cast<int>(floor((maxX * zoomFactor + kernelRadius) / tileSize));
+	int lastY = static_cast<int>(floor((maxY * zoomFactor + kernelRadius) / tileSize));
+
+	size_t tileCount = static_cast<size_t>(lastX - firstX + 1) * (lastY - firstY + 1);
+	values->assign(tileCount * tileSize * tileSize, 0.0f);
+	tiles->clear();
+	for(int y = firstY; y <= lastY; y++)
+	{
+		for(int x = firstX; x <= lastX; x++)
+		{
+			D2DDensityTile tile = { x, y, &(*values)[tiles->size() * tileSize * tileSize], 0 };
+			tiles->push_back(tile);
+		}
+	}
+
+	grid.AccumulateTiles(tiles->data(), tiles->size(), tileSize, zoomFactor, radius);
+
+	float maxValue = 0;
+	for(size_t i = 0; i < tiles->size(); i++)
+	{
+		maxValue = (std::max)(maxValue, (*tiles)[i].MaxValue);
+	}
+
+	return maxValue;
+}
+
+static void CreatePoints(size_t count, double spread, std::vector<double>* coordinates, std::vector<float>* weights)
+{
+	std::mt19937 random(23);
+	std::normal_distribution<double> normal(0, spread);
+	std::uniform_real_distribution<float> weight(0.5f, 2);
+
+	coordinates->resize(2 * count);
+	weights->resize(count);
+	for(size_t i = 0; i < count; i++)
+	{
+		(*coordinates)[2 * i] = 100 + normal(random);
+		(*coordinates)[2 * i + 1] = 50 + normal(random);
+		(*weights)[i] = weight(random);
+	}
+}
+
+TEST(ALonePointOfWeightOnePeaksAtOne)
+{
+	double coordinates[] = { 10.5, 20.5 };
+	D2DDensityGrid grid;
+	grid.SetPoints(coordinates, nullptr, 1);
+
+	std::vector<D2DDensityTile> tiles;
+	std::vector<float> values;
+	CHECK_CLOSE(1, AccumulateAll(grid, 2, 6, 16, &tiles, &values), 1e-6);
+	CHECK_CLOSE(1, grid.GetMaxDensity(2, 6), 1e-6);
+}
+
+TEST(TilesMatchTheDensitySummedPointByPoint)
+{
+	std::vector<double> coordinates;
+	std::vector<float> weights;
+	CreatePoints(2000, 3, &coordinates, &weights);
+
+	D2DDensityGrid grid;
+	grid.SetPoints(coordinates.data(), weights.data(), weights.size());
+
+	const double zoomFactor = 4;
+	const float radius = 10;
+	const uint32_t tileSize = 32;
+
+	std::vector<D2DDensityTile> tiles;
+	std::vector<float> values;
+	AccumulateAll(grid, zoomFactor, radius, tileSize, &tiles, &values);
+
+	// every third pixel of every tile, so that the seams between the tiles are covered
+	int checkedCount = 0;
+	for(size_t i = 0; i < tiles.size(); i++)
+	{
+		for(uint32_t y = 0; y < tileSize; y += 3)
+		{
+			for(uint32_t x = 0; x < tileSize; x += 3)
+			{
+				double expected = GetDensity(coordinates, weights, zoomFactor, radius, tiles[i].X * tileSize + x, tiles[i].Y * tileSize + y);
+				CHECK_CLOSE(expected, tiles[i].Values[y * tileSize + x], 1e-4 * (1 + expected));
+				checkedCount++;
+			}
+		}
+	}
+
+	CHECK(checkedCount > 1000);
+}
+
+TEST(MissingWeightsWeighOne)
+{
+	std::vector<double> coordinates;
+	std::vector<float> weights;
+	CreatePoints(500, 2, &coordinates, &weights);
+	std::fill(weights.begin(), weights.end(), 1.0f);
+
+	D2DDensityGrid weighted;
+	weighted.SetPoints(coordinates.data(), weights.data(), weights.size());
+	D2DDensityGrid unweighted;
+	unweighted.SetPoints(coordinates.data(), nullptr, weights.size());
+
+	CHECK_EQUAL(weighted.GetMaxDensity(3, 8), unweighted.GetMaxDensity(3, 8));
+}
+
+TEST(TheMaxDensityOfClusteredPointsIsTheMaxOfAllTiles)
+{
+	std::vector<double> coordinates;
+	std::vector<float> weights;
+	CreatePoints(5000, 4, &coordinates, &weights);
+
+	D2DDensityGrid grid;
+	grid.SetPoints(coordinates.data(), weights.data(), weights.size());
+
+	std::vector<D2DDensityTile> tiles;
+	std::vector<float> values;
+	for(double zoomFactor = 0.5; zoomFactor <= 16; zoomFactor *= 2)
+	{
+		float expected = AccumulateAll(grid, zoomFactor, 12, 64, &tiles, &values);
+		CHECK_CLOSE(expected, grid.GetMaxDensity(zoomFactor, 12), 1e-4 * expected);
+	}
+}
+
+TEST(TheMaxDensityOfUniformPointsIsCloseToTheMaxOfAllTiles)
+{
+	// many blocks are about as dense as the densest one, so the estimate may miss the exact peak but never exceeds it
+	std::mt19937 random(3);
+	std::uniform_real_distribution<double> uniform(0, 200);
+	std::vector<double> coordinates(2 * 20000);
+	for(size_t i = 0; i < coordinates.size(); i++)
+	{
+		coordinates[i] = uniform(random);
+	}
+
+	D2DDensityGrid grid;
+	grid.SetPoints(coordinates.data(), nullptr, coordinates.size() / 2);
+
+	std::vector<D2DDensityTile> tiles;
+	std::vector<float> values;
+	float expected = AccumulateAll(grid, 2, 10, 64, &tiles, &values);
+	float estimate = grid.GetMaxDensity(2, 10);
+
+	CHECK(estimate <= expected * (1 + 1e-5f));
+	CHECK(estimate >= expected * 0.9f);
+}
+
+TEST(AnEmptyGridHasNoDensity)
+{
+	D2DDensityGrid grid;
+	CHECK(grid.IsEmpty());
+	CHECK_EQUAL(0.0f, grid.GetMaxDensity(1, 10));
+}
+
+TEST(TheColorMapIsPremultipliedAndInterpolated)
+{
+	// transparent blue to opaque red
+	uint32_t stops[] = { 0x000000FF, 0xFFFF0000 };
+	uint32_t colorMap[256];
+	D2DDensityGrid::BuildColorMap(stops, 2, colorMap);
+
+	CHECK_EQUAL(0x00000000u, colorMap[0]);
+	CHECK_EQUAL(0xFFFF0000u, colorMap[255]);
+
+	// halfway the alpha is 128 and both color channels, themselves halfway, are scaled by it
+	uint32_t middle = colorMap[128];
+	CHECK_EQUAL(128u, middle >> 24);
+	CHECK_CLOSE(64, (middle >> 16) & 0xFF, 1);
+	CHECK_EQUAL(0u, (middle >> 8) & 0xFF);
+	CHECK_CLOSE(63, middle & 0xFF, 1);
+}
+
+TEST(ColorizeSaturatesAndLeavesZeroTransparent)
+{
+	uint32_t colorMap[256];
+	for(uint32_t i = 0; i < 256; i++)
+	{
+		colorMap[i] = 0xFF000000 | i;
+	}
+
+	float values[] = { 0, 0.5f, 1, 4, 1e-6f };
+	uint32_t pixels[5];
+	D2DDensityGrid::Colorize(values, 5, 1, colorMap, pixels);
+
+	CHECK_EQUAL(0u, pixels[0]);
+	CHECK_EQUAL(colorMap[127], pixels[1]);
+	CHECK_EQUAL(colorMap[255], pixels[2]);
+	CHECK_EQUAL(colorMap[255], pixels[3]);
+	CHECK_EQUAL(colorMap[0], pixels[4]);
+}
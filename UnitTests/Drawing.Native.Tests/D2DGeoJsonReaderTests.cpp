@@ -0,0 +1,214 @@
+#include "NativeTest.h"
+#include "D2DGeoJsonReader.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+
+using namespace Telerik::UI::Drawing;
+
+static bool Read(const std::string& json, D2DGeoJsonData* data)
+{
+	return D2DGeoJsonReader::Read(json.data(), json.size(), data);
+}
+
+static std::string GetText(const D2DGeoJsonColumn& column, size_t feature)
+{
+	return column.Text.substr(column.TextOffsets[feature], column.TextOffsets[feature + 1] - column.TextOffsets[feature]);
+}
+
+static const D2DGeoJsonColumn* FindColumn(const D2DGeoJsonData& data, const char* name)
+{
+	for(auto column = data.Columns.begin(); column != data.Columns.end(); ++column)
+	{
+		if(column->Name == name)
+		{
+			return &*column;
+		}
+	}
+
+	return nullptr;
+}
+
+TEST(EveryGeometryTypeIsReadIntoParts)
+{
+	std::string json =
+		"{ \"type\": \"FeatureCollection\", \"features\": [\n"
+		"  { \"type\": \"Feature\", \"geometry\": { \"type\": \"Point\", \"coordinates\": [1, 2, 300] } },\n"
+		"  { \"type\": \"Feature\", \"geometry\": { \"coordinates\": [[0, 0], [1, 1], [2, 0]], \"type\": \"LineString\" } },\n"
+		"  { \"type\": \"Feature\", \"geometry\": { \"type\": \"Polygon\", \"coordinates\": [[[0, 0], [4, 0], [4, 4], [0, 0]], [[1, 1], [2, 1], [1, 2], [1, 1]]] } },\n"
+		"  { \"type\": \"Feature\", \"geometry\": { \"type\": \"MultiPolygon\", \"coordinates\": [[[[0, 0], [1, 0], [0, 1], [0, 0]]], [[[5, 5], [6, 5], [5, 6], [5, 5]]]] } },\n"
+		"  { \"type\": \"Feature\", \"geometry\": null },\n"
+		"  { \"type\": \"Feature\", \"geometry\": { \"type\": \"MultiPoint\", \"coordinates\": [[7, 8], [9, 10]] } }\n"
+		"] }";
+
+	D2DGeoJsonData data;
+	CHECK(Read(json, &data));
+
+	const D2DGeoJsonGeometry& geometry = data.Geometry;
+	CHECK_EQUAL(6u, geometry.FeatureTypes.size());
+	CHECK(geometry.FeatureTypes[0] == D2DGeoJsonGeometryType::Point);
+	CHECK(geometry.FeatureTypes[1] == D2DGeoJsonGeometryType::LineString);
+	CHECK(geometry.FeatureTypes[2] == D2DGeoJsonGeometryType::Polygon);
+	CHECK(geometry.FeatureTypes[3] == D2DGeoJsonGeometryType::MultiPolygon);
+	CHECK(geometry.FeatureTypes[4] == D2DGeoJsonGeometryType::None);
+	CHECK(geometry.FeatureTypes[5] == D2DGeoJsonGeometryType::MultiPoint);
+
+	// the parts of the features: 1 point, 1 line, 2 rings, 2 rings, none and 1 multipoint
+	uint32_t partOffsets[] = { 0, 1, 2, 4, 6, 6, 7 };
+	CHECK(std::vector<uint32_t>(partOffsets, partOffsets + 7) == geometry.PartOffsets);
+
+	uint32_t pointOffsets[] = { 0, 1, 4, 8, 12, 16, 20, 22 };
+	CHECK(std::vector<uint32_t>(pointOffsets, pointOffsets + 8) == geometry.PointOffsets);
+
+	// the altitude of the point is skipped
+	CHECK_EQUAL(1.0, geometry.Coordinates[0]);
+	CHECK_EQUAL(2.0, geometry.Coordinates[1]);
+	CHECK_EQUAL(0.0, geometry.Coordinates[2]);
+	CHECK_EQUAL(10.0, geometry.Coordinates.back());
+}
+
+TEST(TheMembersOfACollectionArePartsOfTheFeature)
+{
+	std::string json =
+		"{ \"type\": \"Feature\", \"properties\": { \"name\": \"both\" }, \"geometry\": { \"type\": \"GeometryCollection\", \"geometries\": ["
+		"{ \"type\": \"Point\", \"coordinates\": [1, 1] }, { \"type\": \"LineString\", \"coordinates\": [[2, 2], [3, 3]] } ] } }";
+
+	D2DGeoJsonData data;
+	CHECK(Read(json, &data));
+	CHECK_EQUAL(1u, data.Geometry.FeatureTypes.size());
+	CHECK_EQUAL(2u, data.Geometry.PartOffsets[1]);
+	CHECK_EQUAL(3u, data.Geometry.PointOffsets[2]);
+	CHECK_EQUAL(std::string("both"), GetText(data.Columns[0], 0));
+}
+
+TEST(ABareGeometryIsACollectionOfOne)
+{
+	D2DGeoJsonData data;
+	CHECK(Read("\xEF\xBB\xBF { \"type\": \"Polygon\", \"coordinates\": [[[0, 0], [1, 0], [0, 1], [0, 0]]] }", &data));
+	CHECK_EQUAL(1u, data.Geometry.FeatureTypes.size());
+	CHECK(data.Geometry.FeatureTypes[0] == D2DGeoJsonGeometryType::Polygon);
+	CHECK_EQUAL(4u, data.Geometry.PointOffsets[1]);
+	CHECK(data.Columns.empty());
+}
+
+TEST(PropertiesAreReadIntoColumns)
+{
+	std::string json =
+		"{ \"features\": [\n"
+		"  { \"type\": \"Feature\", \"geometry\": null, \"properties\": { \"name\": \"Caf\\u00e9 \\\"Z\\\"\\n\", \"population\": 1.5e3, \"capital\": true, \"tags\": [1, {\"a\": 2}] } },\n"
+		"  { \"type\": \"Feature\", \"geometry\": null, \"properties\": { \"population\": -7, \"name\": \"\\ud83d\\ude00\", \"population\": 8, \"capital\": false } },\n"
+		"  { \"type\": \"Feature\", \"geometry\": null, \"properties\": { \"capital\": null, \"rank\": 3 } },\n"
+		"  { \"type\": \"Feature\", \"geometry\": null, \"properties\": null }\n"
+		"], \"type\": \"FeatureCollection\" }";
+
+	D2DGeoJsonData data;
+	CHECK(Read(json, &data));
+	CHECK_EQUAL(4u, data.Geometry.FeatureTypes.size());
+	CHECK_EQUAL(5u, data.Columns.size());
+
+	const D2DGeoJsonColumn* name = FindColumn(data, "name");
+	CHECK(name != nullptr && name->HasText);
+	CHECK_EQUAL(5u, name->TextOffsets.size());
+	CHECK_EQUAL(std::string("Caf\xC3\xA9 \"Z\"\n"), GetText(*name, 0));
+	CHECK_EQUAL(std::string("\xF0\x9F\x98\x80"), GetText(*name, 1));
+	CHECK(GetText(*name, 2).empty());
+	CHECK(std::isnan(name->Numbers[0]));
+
+	// the first of two values of a property is kept, and a missing value is NaN
+	const D2DGeoJsonColumn* population = FindColumn(data, "population");
+	CHECK(population != nullptr && !population->HasText);
+	CHECK_EQUAL(1500.0, population->Numbers[0]);
+	CHECK_EQUAL(-7.0, population->Numbers[1]);
+	CHECK(std::isnan(population->Numbers[2]));
+	CHECK(std::isnan(population->Numbers[3]));
+
+	const D2DGeoJsonColumn* capital = FindColumn(data, "capital");
+	CHECK_EQUAL(1.0, capital->Numbers[0]);
+	CHECK_EQUAL(0.0, capital->Numbers[1]);
+	CHECK(std::isnan(capital->Numbers[2]));
+
+	// nested values are kept as their JSON
+	const D2DGeoJsonColumn* tags = FindColumn(data, "tags");
+	CHECK(tags->HasText);
+	CHECK_EQUAL(std::string("[1, {\"a\": 2}]"), GetText(*tags, 0));
+
+	const D2DGeoJsonColumn* rank = FindColumn(data, "rank");
+	CHECK(std::isnan(rank->Numbers[0]));
+	CHECK_EQUAL(3.0, rank->Numbers[2]);
+}
+
+TEST(ChunksAreMergedInOrder)
+{
+	// more features than a chunk holds, with a property that only the last features have
+	const size_t featureCount = 5000;
+	std::string json = "{ \"type\": \"FeatureCollection\", \"features\": [";
+	for(size_t i = 0; i < featureCount; i++)
+	{
+		char feature[256];
+		snprintf(feature, sizeof(feature),
+			"%s{ \"type\": \"Feature\", \"properties\": { \"id\": %zu%s }, \"geometry\": { \"type\": \"LineString\", \"coordinates\": [[%zu, 0], [%zu, 1]] } }",
+			i > 0 ? "," : "", i, i >= 4500 ? ", \"late\": \"x\"" : "", i, i);
+		json += feature;
+	}
+
+	json += "] }";
+
+	D2DGeoJsonData data;
+	CHECK(Read(json, &data));
+	CHECK_EQUAL(featureCount, data.Geometry.FeatureTypes.size());
+	CHECK_EQUAL(featureCount, data.Geometry.PartOffsets.back());
+	CHECK_EQUAL(2 * featureCount, data.Geometry.PointOffsets.back());
+
+	bool isInOrder = true;
+	const D2DGeoJsonColumn* id = FindColumn(data, "id");
+	for(size_t i = 0; i < featureCount; i++)
+	{
+		isInOrder &= id->Numbers[i] == static_cast<double>(i);
+		isInOrder &= data.Geometry.PartOffsets[i] == i && data.Geometry.PointOffsets[i] == 2 * i;
+		isInOrder &= data.Geometry.Coordinates[4 * i] == static_cast<double>(i);
+	}
+
+	CHECK(isInOrder);
+
+	const D2DGeoJsonColumn* late = FindColumn(data, "late");
+	CHECK_EQUAL(featureCount, late->Numbers.size());
+	CHECK_EQUAL(featureCount + 1, late->TextOffsets.size());
+	CHECK(GetText(*late, 4499).empty());
+	CHECK_EQUAL(std::string("x"), GetText(*late, 4500));
+}
+
+TEST(NumbersAreReadAsTheCLibraryReadsThem)
+{
+	std::mt19937 random(31);
+	std::uniform_real_distribution<double> coordinate(-180, 180);
+
+	const char* formats[] = { "%.6f", "%.17g", "%.3e", "%.15g" };
+	bool isExact = true;
+	for(int i = 0; i < 10000; i++)
+	{
+		char number[64];
+		snprintf(number, sizeof(number), formats[i % 4], coordinate(random));
+
+		std::string json = std::string("{ \"type\": \"Point\", \"coordinates\": [") + number + ", 0] }";
+		D2DGeoJsonData data;
+		isExact &= Read(json, &data) && data.Geometry.Coordinates[0] == strtod(number, nullptr);
+	}
+
+	CHECK(isExact);
+}
+
+TEST(InvalidDataIsRejected)
+{
+	D2DGeoJsonData data;
+	CHECK(!Read("", &data));
+	CHECK(!Read("[1, 2]", &data));
+	CHECK(!Read("{ \"type\": \"FeatureCollection\" }", &data));
+	CHECK(!Read("{ \"type\": \"FeatureCollection\", \"features\": [ { \"type\": \"Feature\" } ", &data));
+	CHECK(!Read("{ \"type\": \"Feature\", \"properties\": { \"name\": \"unclosed } }", &data));
+	CHECK(!Read("{ \"type\": \"Point\", \"coordinates\": [1 2] }", &data));
+
+	// an empty collection is valid
+	CHECK(Read("{ \"type\": \"FeatureCollection\", \"features\": [ ] }", &data));
+	CHECK(data.Geometry.FeatureTypes.empty());
+}
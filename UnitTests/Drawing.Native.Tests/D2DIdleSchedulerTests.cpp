@@ -0,0 +1,114 @@
+#include "NativeTest.h"
+#include "D2DIdleScheduler.h"
+
+using namespace Telerik::UI::Drawing;
+
+// a clock that only moves when the test moves it
+struct FakeClock
+{
+	FakeClock() : now(D2DIdleScheduler::TimePoint()) {}
+
+	D2DIdleScheduler::Clock Get() { return [this]() { return this->now; }; }
+	void Advance(int milliseconds) { this->now += std::chrono::milliseconds(milliseconds); }
+
+	D2DIdleScheduler::TimePoint now;
+};
+
+TEST(RunsWorkByPriorityThenByPostingOrder)
+{
+	FakeClock clock;
+	D2DIdleScheduler scheduler(clock.Get());
+	std::vector<int> order;
+
+	scheduler.Post(IdleWorkPriority::WarmUp, [&]() { order.push_back(3); });
+	scheduler.Post(IdleWorkPriority::Prefetch, [&]() { order.push_back(1); });
+	scheduler.Post(IdleWorkPriority::WarmUp, [&]() { order.push_back(4); });
+	scheduler.Post(IdleWorkPriority::Prefetch, [&]() { order.push_back(2); });
+
+	CHECK_EQUAL(4u, scheduler.RunUntil(clock.now + std::chrono::milliseconds(10), nullptr));
+	CHECK(scheduler.IsEmpty());
+
+	std::vector<int> expected = { 1, 2, 3, 4 };
+	CHECK(expected == order);
+}
+
+TEST(StopsOnceTheDeadlinePasses)
+{
+	FakeClock clock;
+	D2DIdleScheduler scheduler(clock.Get());
+
+	// each item takes 4 ms of the 10 ms budget, and the one that starts before the deadline is not interrupted
+	int runCount = 0;
+	for(int i = 0; i < 5; i++)
+	{
+		scheduler.Post(IdleWorkPriority::WarmUp, [&]() { runCount++; clock.Advance(4); });
+	}
+
+	CHECK_EQUAL(3u, scheduler.RunUntil(clock.now + std::chrono::milliseconds(10), nullptr));
+	CHECK_EQUAL(3, runCount);
+	CHECK_EQUAL(2u, scheduler.GetPendingCount());
+
+	CHECK_EQUAL(2u, scheduler.RunUntil(clock.now + std::chrono::milliseconds(10), nullptr));
+	CHECK(scheduler.IsEmpty());
+}
+
+TEST(RunsNothingAfterTheDeadline)
+{
+	FakeClock clock;
+	D2DIdleScheduler scheduler(clock.Get());
+	scheduler.Post(IdleWorkPriority::Prefetch, []() {});
+
+	CHECK_EQUAL(0u, scheduler.RunUntil(clock.now, nullptr));
+	CHECK_EQUAL(1u, scheduler.GetPendingCount());
+}
+
+TEST(YieldsAsSoonAsInputArrives)
+{
+	FakeClock clock;
+	D2DIdleScheduler scheduler(clock.Get());
+
+	bool hasInput = false;
+	scheduler.Post(IdleWorkPriority::Prefetch, [&]() { hasInput = true; });
+	scheduler.Post(IdleWorkPriority::Prefetch, []() {});
+	scheduler.Post(IdleWorkPriority::WarmUp, []() {});
+
+	CHECK_EQUAL(1u, scheduler.RunUntil(clock.now + std::chrono::seconds(1), [&]() { return hasInput; }));
+	CHECK_EQUAL(2u, scheduler.GetPendingCount());
+
+	hasInput = false;
+	CHECK_EQUAL(2u, scheduler.RunUntil(clock.now + std::chrono::seconds(1), [&]() { return hasInput; }));
+}
+
+TEST(RunsWorkPostedByRunningWork)
+{
+	FakeClock clock;
+	D2DIdleScheduler scheduler(clock.Get());
+	std::vector<int> order;
+
+	// a prefetch posted by warm-up work still runs before the remaining warm-up work
+	scheduler.Post(IdleWorkPriority::WarmUp, [&]()
+	{
+		order.push_back(1);
+		scheduler.Post(IdleWorkPriority::Prefetch, [&]() { order.push_back(2); });
+	});
+	scheduler.Post(IdleWorkPriority::WarmUp, [&]() { order.push_back(3); });
+
+	CHECK_EQUAL(3u, scheduler.RunUntil(clock.now + std::chrono::milliseconds(1), nullptr));
+
+	std::vector<int> expected = { 1, 2, 3 };
+	CHECK(expected == order);
+}
+
+TEST(ClearDropsThePendingWork)
+{
+	FakeClock clock;
+	D2DIdleScheduler scheduler(clock.Get());
+	bool hasRun = false;
+	scheduler.Post(IdleWorkPriority::Prefetch, [&]() { hasRun = true; });
+
+	scheduler.Clear();
+
+	CHECK(scheduler.IsEmpty());
+	CHECK_EQUAL(0u, scheduler.RunUntil(clock.now + std::chrono::milliseconds(1), nullptr));
+	CHECK(!hasRun);
+}
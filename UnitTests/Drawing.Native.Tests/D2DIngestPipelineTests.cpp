@@ -0,0 +1,225 @@
+#include "NativeTest.h"
+#include "D2DIngestPipeline.h"
+#include "D2DLayerCacheFile.h"
+#include "D2DShapefileReader.h"
+#include <chrono>
+#include <mutex>
+
+using namespace Telerik::UI::Drawing;
+
+// decodes the world sample a few records at a time, as the streaming shapefile import does
+class WorldDecoder
+{
+public:
+	WorldDecoder(size_t recordsPerBatch) : recordsPerBatch(recordsPerBatch), offset(0)
+	{
+		NativeTest::ReadFile(NativeTest::GetDataPath("world.shp"), &this->data);
+	}
+
+	D2DDecodeResult Decode(D2DIngestBatch* batch)
+	{
+		D2DShapefileGeometry geometry;
+		if(!D2DShapefileReader::ReadShapeBatch(this->data.data(), this->data.size(), &this->offset, this->recordsPerBatch, &geometry))
+		{
+			return D2DDecodeResult::Failed;
+		}
+
+		if(geometry.RecordShapeTypes.empty())
+		{
+			return D2DDecodeResult::Done;
+		}
+
+		for(auto type = geometry.RecordShapeTypes.begin(); type != geometry.RecordShapeTypes.end(); ++type)
+		{
+			batch->Kinds.push_back(*type == 5 ? D2DFeatureKind::Polygon : D2DFeatureKind::None);
+		}
+
+		batch->PartOffsets.swap(geometry.PartOffsets);
+		batch->PointOffsets.swap(geometry.PointOffsets);
+		batch->Coordinates.swap(geometry.Coordinates);
+		return D2DDecodeResult::Decoded;
+	}
+
+private:
+	std::vector<uint8_t> data;
+	size_t recordsPerBatch;
+	size_t offset;
+};
+
+// a batch of a single point
+static void FillPoint(D2DIngestBatch* batch)
+{
+	batch->Kinds.assign(1, D2DFeatureKind::Point);
+	batch->PartOffsets.assign(1, 0);
+	batch->PartOffsets.push_back(1);
+	batch->PointOffsets.assign(1, 0);
+	batch->PointOffsets.push_back(1);
+	batch->Coordinates.assign(2, 1.0);
+}
+
+// the batches the consumer received and how the pipeline ended
+struct Published
+{
+	std::vector<std::unique_ptr<D2DIngestBatch>> Batches;
+	std::vector<D2DIngestStatus> Completions;
+};
+
+TEST(BatchesArePublishedInOrderWithTheirRanksAndBounds)
+{
+	WorldDecoder decoder(8);
+	Published published;
+
+	// a projector that finishes the batches out of order
+	D2DIngestPipeline pipeline;
+	CHECK(pipeline.Start(
+		[&](D2DIngestBatch* batch) { return decoder.Decode(batch); },
+		[](D2DIngestBatch* batch) { std::this_thread::sleep_for(std::chrono::microseconds(batch->Sequence % 3 == 0 ? 2000 : 0)); },
+		[&](std::unique_ptr<D2DIngestBatch> batch) { published.Batches.push_back(std::move(batch)); return true; },
+		[&](D2DIngestStatus status) { published.Completions.push_back(status); },
+		4));
+
+	CHECK(pipeline.Wait() == D2DIngestStatus::Completed);
+	CHECK_EQUAL(1u, published.Completions.size());
+	CHECK(published.Completions[0] == D2DIngestStatus::Completed);
+	CHECK_EQUAL(252u, pipeline.GetPublishedFeatureCount());
+	CHECK_EQUAL(32u, published.Batches.size());
+
+	bool isInOrder = true;
+	bool isRanked = true;
+	size_t firstFeature = 0;
+	for(size_t i = 0; i < published.Batches.size(); i++)
+	{
+		const D2DIngestBatch& batch = *published.Batches[i];
+		isInOrder &= batch.Sequence == i && batch.FirstFeature == firstFeature;
+		firstFeature += batch.GetFeatureCount();
+
+		std::vector<float> ranks(batch.Coordinates.size() / 2);
+		for(size_t part = 0; part + 1 < batch.PointOffsets.size(); part++)
+		{
+			uint32_t first = batch.PointOffsets[part];
+			D2DLayerCacheWriter::RankPoints(&batch.Coordinates[2 * first], batch.PointOffsets[part + 1] - first, ranks.data() + first);
+		}
+
+		isRanked &= ranks == batch.Ranks && batch.Bounds.size() == 4 * batch.GetFeatureCount();
+	}
+
+	CHECK(isInOrder);
+	CHECK(isRanked);
+
+	// the first batch holds Russia, with the first null record the fourth
+	CHECK_EQUAL(-180.0, published.Batches[0]->Bounds[0]);
+	CHECK(std::isnan(published.Batches[0]->Bounds[4 * 3]));
+
+	// a pipeline runs once at a time
+	CHECK(!pipeline.Start(nullptr, nullptr, nullptr, nullptr, 1));
+}
+
+TEST(ASlowConsumerHoldsBackTheDecoder)
+{
+	const size_t workerCount = 2;
+	std::mutex mutex;
+	size_t decodedCount = 0;
+	size_t consumedCount = 0;
+	size_t maxInFlight = 0;
+
+	D2DIngestPipeline pipeline;
+	pipeline.Start(
+		[&](D2DIngestBatch* batch)
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			if(decodedCount == 200)
+			{
+				return D2DDecodeResult::Done;
+			}
+
+			FillPoint(batch);
+			decodedCount++;
+			maxInFlight = (std::max)(maxInFlight, decodedCount - consumedCount);
+			return D2DDecodeResult::Decoded;
+		},
+		nullptr,
+		[&](std::unique_ptr<D2DIngestBatch>)
+		{
+			std::this_thread::sleep_for(std::chrono::microseconds(200));
+			std::lock_guard<std::mutex> lock(mutex);
+			consumedCount++;
+			return true;
+		},
+		nullptr,
+		workerCount);
+
+	CHECK(pipeline.Wait() == D2DIngestStatus::Completed);
+	CHECK_EQUAL(200u, consumedCount);
+
+	// the queues of the two stages and of the publisher hold two batches per worker, and the workers of the two stages,
+	// the decoder and the consumer one each, however late a worker is scheduled
+	CHECK(maxInFlight <= 3 * 2 * workerCount + 2 * workerCount + 2);
+}
+
+TEST(AConsumerThatRefusesABatchCancelsThePipeline)
+{
+	WorldDecoder decoder(4);
+	size_t consumedCount = 0;
+	std::vector<D2DIngestStatus> completions;
+
+	D2DIngestPipeline pipeline;
+	pipeline.Start(
+		[&](D2DIngestBatch* batch) { return decoder.Decode(batch); },
+		nullptr,
+		[&](std::unique_ptr<D2DIngestBatch>) { return ++consumedCount < 5; },
+		[&](D2DIngestStatus status) { completions.push_back(status); },
+		2);
+
+	CHECK(pipeline.Wait() == D2DIngestStatus::Cancelled);
+	CHECK_EQUAL(5u, consumedCount);
+	CHECK_EQUAL(1u, completions.size());
+	CHECK(completions[0] == D2DIngestStatus::Cancelled);
+}
+
+TEST(AnEndlessSourceStopsWhenCancelled)
+{
+	D2DIngestPipeline pipeline;
+	std::atomic<size_t> consumedCount(0);
+	pipeline.Start(
+		[](D2DIngestBatch* batch) { FillPoint(batch); return D2DDecodeResult::Decoded; },
+		nullptr,
+		[&](std::unique_ptr<D2DIngestBatch>) { consumedCount++; return true; },
+		nullptr,
+		2);
+
+	while(consumedCount.load() < 10)
+	{
+		std::this_thread::yield();
+	}
+
+	pipeline.Cancel();
+	CHECK(pipeline.Wait() == D2DIngestStatus::Cancelled);
+}
+
+TEST(ADecoderFailureFailsThePipeline)
+{
+	size_t decodedCount = 0;
+	std::vector<D2DIngestStatus> completions;
+
+	D2DIngestPipeline pipeline;
+	pipeline.Start(
+		[&](D2DIngestBatch* batch) { FillPoint(batch); return ++decodedCount < 3 ? D2DDecodeResult::Decoded : D2DDecodeResult::Failed; },
+		nullptr,
+		[](std::unique_ptr<D2DIngestBatch>) { return true; },
+		[&](D2DIngestStatus status) { completions.push_back(status); },
+		2);
+
+	CHECK(pipeline.Wait() == D2DIngestStatus::Failed);
+	CHECK_EQUAL(1u, completions.size());
+	CHECK(completions[0] == D2DIngestStatus::Failed);
+}
+
+TEST(AnEmptySourceCompletes)
+{
+	D2DIngestPipeline pipeline;
+	bool isConsumed = false;
+	CHECK(pipeline.Start([](D2DIngestBatch*) { return D2DDecodeResult::Done; }, nullptr, [&](std::unique_ptr<D2DIngestBatch>) { isConsumed = true; return true; }, nullptr, 0));
+	CHECK(pipeline.Wait() == D2DIngestStatus::Completed);
+	CHECK(!isConsumed);
+	CHECK_EQUAL(0u, pipeline.GetPublishedFeatureCount());
+}
@@ -0,0 +1,212 @@
+#include "NativeTest.h"
+#include "D2DLayerCacheFile.h"
+#include "D2DShapefileReader.h"
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <random>
+
+using namespace Telerik::UI::Drawing;
+
+const uint64_t WorldStamp = 0x5EED0001;
+
+static double GetSegmentDistance(const double* point, const double* first, const double* last)
+{
+	double dx = last[0] - first[0];
+	double dy = last[1] - first[1];
+	double px = point[0] - first[0];
+	double py = point[1] - first[1];
+	double length = dx * dx + dy * dy;
+	double t = length > 0 ? (std::max)(0.0, (std::min)(1.0, (px * dx + py * dy) / length)) : 0;
+
+	return sqrt((px - t * dx) * (px - t * dx) + (py - t * dy) * (py - t * dy));
+}
+
+struct World
+{
+	std::vector<uint8_t> Data;
+	D2DShapefileGeometry Geometry;
+	std::vector<D2DFeatureKind> Kinds;
+
+	D2DFeatureSource GetSource() const
+	{
+		D2DFeatureSource source = { this->Kinds.size(), this->Kinds.data(), this->Geometry.PartOffsets.data(), this->Geometry.PointOffsets.data(), this->Geometry.Coordinates.data() };
+		return source;
+	}
+};
+
+static bool ReadWorld(World* world)
+{
+	if(!NativeTest::ReadFile(NativeTest::GetDataPath("world.shp"), &world->Data) || !D2DShapefileReader::ReadShapes(world->Data.data(), world->Data.size(), &world->Geometry))
+	{
+		return false;
+	}
+
+	for(auto type = world->Geometry.RecordShapeTypes.begin(); type != world->Geometry.RecordShapeTypes.end(); ++type)
+	{
+		world->Kinds.push_back(*type == 5 ? D2DFeatureKind::Polygon : D2DFeatureKind::None);
+	}
+
+	return true;
+}
+
+// writes the bytes of a file with one of its 32-bit values replaced
+template<class Path> static bool WriteChanged(const std::vector<uint8_t>& data, size_t offset, uint32_t value, const Path& path)
+{
+	std::vector<uint8_t> changed(data);
+	memcpy(&changed[offset], &value, sizeof(value));
+
+	D2DFeatureFileOutput output(path.c_str());
+	output.Write(changed.data(), changed.size());
+	return output.Close();
+}
+
+TEST(RanksSimplifyAsDouglasPeucker)
+{
+	double coordinates[] = { 0, 0, 1, 0, 2, 1, 3, 0, 4, 0 };
+	float ranks[5];
+	D2DLayerCacheWriter::RankPoints(coordinates, 5, ranks);
+
+	CHECK_EQUAL((std::numeric_limits<float>::max)(), ranks[0]);
+	CHECK_EQUAL((std::numeric_limits<float>::max)(), ranks[4]);
+	CHECK_CLOSE(1, ranks[2], 1e-6);
+	CHECK_CLOSE(1 / sqrt(5.0), ranks[1], 1e-6);
+	CHECK_CLOSE(1 / sqrt(5.0), ranks[3], 1e-6);
+}
+
+TEST(ThePointsLeftOutAreWithinTheToleranceOfTheSimplifiedLine)
+{
+	// a random walk, simplified at several tolerances by keeping the points ranked above them
+	std::mt19937 random(19);
+	std::normal_distribution<double> step(0, 1);
+
+	const size_t pointCount = 2000;
+	std::vector<double> coordinates(2 * pointCount);
+	for(size_t i = 1; i < pointCount; i++)
+	{
+		coordinates[2 * i] = coordinates[2 * i - 2] + step(random);
+		coordinates[2 * i + 1] = coordinates[2 * i - 1] + step(random);
+	}
+
+	std::vector<float> ranks(pointCount);
+	D2DLayerCacheWriter::RankPoints(coordinates.data(), pointCount, ranks.data());
+
+	double tolerances[] = { 0.1, 1, 5, 25 };
+	size_t previousCount = pointCount + 1;
+	for(int t = 0; t < 4; t++)
+	{
+		bool isWithin = true;
+		size_t keptCount = 1;
+		size_t previous = 0;
+		for(size_t i = 1; i < pointCount; i++)
+		{
+			if(ranks[i] <= tolerances[t])
+			{
+				continue;
+			}
+
+			for(size_t skipped = previous + 1; skipped < i; skipped++)
+			{
+				isWithin &= GetSegmentDistance(&coordinates[2 * skipped], &coordinates[2 * previous], &coordinates[2 * i]) <= tolerances[t] * (1 + 1e-6);
+			}
+
+			previous = i;
+			keptCount++;
+		}
+
+		CHECK(isWithin);
+		CHECK(keptCount < previousCount);
+		previousCount = keptCount;
+	}
+}
+
+TEST(TheCacheHoldsTheLayerAndWhatIsDerivedFromIt)
+{
+	World world;
+	CHECK(ReadWorld(&world));
+
+	auto path = NativeTest::GetOutputPath("world.layercache");
+	CHECK(D2DLayerCacheWriter::Write(world.GetSource(), WorldStamp, path.c_str()));
+
+	D2DLayerCacheReader reader;
+	CHECK(reader.Open(path.c_str(), WorldStamp));
+
+	const D2DLayerCacheView& view = reader.GetView();
+	CHECK_EQUAL(252u, view.FeatureCount);
+	CHECK_EQUAL(320u, view.PartCount);
+	CHECK_EQUAL(8229u, view.PointCount);
+	CHECK(std::equal(world.Geometry.PartOffsets.begin(), world.Geometry.PartOffsets.end(), view.PartOffsets));
+	CHECK(std::equal(world.Geometry.PointOffsets.begin(), world.Geometry.PointOffsets.end(), view.PointOffsets));
+	CHECK(std::equal(world.Geometry.Coordinates.begin(), world.Geometry.Coordinates.end(), view.Coordinates));
+	CHECK(view.Kinds[0] == D2DFeatureKind::Polygon && view.Kinds[3] == D2DFeatureKind::None);
+
+	// the null records have empty bounds, the others the bounds of their points
+	CHECK(std::isnan(view.Bounds[4 * 3]));
+	CHECK_EQUAL(-180.0, view.Bounds[0]);
+	CHECK_EQUAL(180.0, view.Bounds[2]);
+
+	// the end points of every part get the highest rank
+	bool areEndsKept = true;
+	for(size_t part = 0; part < view.PartCount; part++)
+	{
+		areEndsKept &= view.Ranks[view.PointOffsets[part]] == (std::numeric_limits<float>::max)();
+		areEndsKept &= view.Ranks[view.PointOffsets[part + 1] - 1] == (std::numeric_limits<float>::max)();
+	}
+
+	CHECK(areEndsKept);
+
+	// a query finds the features whose bounds intersect the rect, in ascending order
+	std::vector<uint32_t> features;
+	reader.Query(0, 40, 20, 55, &features);
+
+	std::vector<uint32_t> expected;
+	for(uint32_t feature = 0; feature < view.FeatureCount; feature++)
+	{
+		const double* bounds = &view.Bounds[4 * feature];
+		if(bounds[0] <= 20 && bounds[1] <= 55 && bounds[2] >= 0 && bounds[3] >= 40)
+		{
+			expected.push_back(feature);
+		}
+	}
+
+	CHECK(!expected.empty());
+	CHECK(expected == features);
+}
+
+TEST(AStaleOrDamagedCacheIsNotOpened)
+{
+	World world;
+	CHECK(ReadWorld(&world));
+
+	auto path = NativeTest::GetOutputPath("world.layercache");
+	CHECK(D2DLayerCacheWriter::Write(world.GetSource(), WorldStamp, path.c_str()));
+
+	D2DLayerCacheReader reader;
+	CHECK(!reader.Open(path.c_str(), WorldStamp + 1));
+	CHECK_EQUAL(0u, reader.GetView().FeatureCount);
+
+	std::vector<uint8_t> data;
+	std::string textPath(path.begin(), path.end());
+	CHECK(NativeTest::ReadFile(textPath, &data));
+
+	// the version follows the magic
+	auto changedPath = NativeTest::GetOutputPath("changed.layercache");
+	CHECK(WriteChanged(data, 8, 2, changedPath));
+	CHECK(!reader.Open(changedPath.c_str(), WorldStamp));
+
+	// the offset of the last point of the first part reaches past the coordinates of the file
+	uint64_t pointOffsetsOffset;
+	memcpy(&pointOffsetsOffset, &data[112], sizeof(pointOffsetsOffset));
+	CHECK(WriteChanged(data, static_cast<size_t>(pointOffsetsOffset) + 4, 1u << 30, changedPath));
+	CHECK(!reader.Open(changedPath.c_str(), WorldStamp));
+
+	// a truncated file
+	std::vector<uint8_t> truncated(data.begin(), data.end() - 100);
+	D2DFeatureFileOutput output(changedPath.c_str());
+	output.Write(truncated.data(), truncated.size());
+	CHECK(output.Close());
+	CHECK(!reader.Open(changedPath.c_str(), WorldStamp));
+
+	// the original still opens
+	CHECK(reader.Open(path.c_str(), WorldStamp));
+}
@@ -0,0 +1,48 @@
+#include "NativeTest.h"
+#include "D2DMappedFile.h"
+#include <cstring>
+#include <fstream>
+
+using namespace Telerik::UI::Drawing;
+
+// the output path is wide on Windows, where the mapped file opens wide paths
+template<class Path> static void WriteFile(const Path& path, const std::vector<uint8_t>& data)
+{
+	std::ofstream stream(path.c_str(), std::ios::binary | std::ios::trunc);
+	stream.write(reinterpret_cast<const char*>(data.data()), data.size());
+}
+
+TEST(TheMappedBytesAreTheFile)
+{
+	std::vector<uint8_t> data;
+	CHECK(NativeTest::ReadFile(NativeTest::GetDataPath("world.shp"), &data));
+	auto path = NativeTest::GetOutputPath("world.mapped");
+	WriteFile(path, data);
+
+	D2DMappedFile file;
+	CHECK(!file.IsOpen());
+	CHECK(file.Open(path.c_str()));
+	CHECK(file.IsOpen());
+	CHECK_EQUAL(data.size(), file.GetSize());
+	CHECK(memcmp(data.data(), file.GetData(), data.size()) == 0);
+
+	// a file is mapped again after it is closed
+	file.Close();
+	CHECK(!file.IsOpen());
+	CHECK_EQUAL(0, file.GetSize());
+	CHECK(file.Open(path.c_str()));
+	CHECK_EQUAL(data.size(), file.GetSize());
+}
+
+TEST(MissingAndEmptyFilesAreNotMapped)
+{
+	D2DMappedFile file;
+	auto missing = NativeTest::GetOutputPath("missing.mapped");
+	CHECK(!file.Open(missing.c_str()));
+	CHECK(!file.IsOpen());
+
+	auto empty = NativeTest::GetOutputPath("empty.mapped");
+	WriteFile(empty, std::vector<uint8_t>());
+	CHECK(!file.Open(empty.c_str()));
+	CHECK(!file.IsOpen());
+}
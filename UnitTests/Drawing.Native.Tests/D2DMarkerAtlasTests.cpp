@@ -0,0 +1,115 @@
+#include "NativeTest.h"
+#include "D2DMarkerAtlas.h"
+
+using namespace Telerik::UI::Drawing;
+
+static bool Overlaps(const D2DAtlasRect& first, const D2DAtlasRect& second)
+{
+	return first.Left < second.Right && second.Left < first.Right && first.Top < second.Bottom && second.Top < first.Bottom;
+}
+
+TEST(SymbolsArePackedInShelvesWithAGutter)
+{
+	D2DMarkerAtlas atlas;
+	atlas.Reset(64, 64);
+
+	// three 20 pixel symbols fill the first shelf, 22 pixels a slot, so the third starts the second shelf
+	CHECK_EQUAL(0, atlas.AddSymbol(20, 20));
+	CHECK_EQUAL(1, atlas.AddSymbol(20, 10));
+	CHECK_EQUAL(2, atlas.AddSymbol(20, 20));
+
+	const D2DAtlasRect& first = atlas.GetSymbol(0);
+	CHECK_EQUAL(1u, first.Left);
+	CHECK_EQUAL(1u, first.Top);
+	CHECK_EQUAL(21u, first.Right);
+	CHECK_EQUAL(21u, first.Bottom);
+
+	const D2DAtlasRect& second = atlas.GetSymbol(1);
+	CHECK_EQUAL(23u, second.Left);
+	CHECK_EQUAL(1u, second.Top);
+
+	// the second shelf starts below the tallest slot of the first
+	const D2DAtlasRect& third = atlas.GetSymbol(2);
+	CHECK_EQUAL(1u, third.Left);
+	CHECK_EQUAL(23u, third.Top);
+}
+
+TEST(SymbolsNeverOverlapAndStayInTheAtlas)
+{
+	D2DMarkerAtlas atlas;
+	atlas.Reset(256, 256);
+
+	for(uint32_t i = 0; i < 200; i++)
+	{
+		if(atlas.AddSymbol(4 + i % 13, 4 + i % 7) < 0)
+		{
+			break;
+		}
+	}
+
+	CHECK(atlas.GetSymbolCount() > 100);
+	for(size_t i = 0; i < atlas.GetSymbolCount(); i++)
+	{
+		const D2DAtlasRect& symbol = atlas.GetSymbol(static_cast<int>(i));
+		CHECK(symbol.Left >= 1 && symbol.Top >= 1);
+		CHECK(symbol.Right + 1 <= atlas.GetWidth() && symbol.Bottom + 1 <= atlas.GetHeight());
+
+		for(size_t j = 0; j < i; j++)
+		{
+			CHECK(!Overlaps(symbol, atlas.GetSymbol(static_cast<int>(j))));
+		}
+	}
+}
+
+TEST(AFullAtlasRejectsSymbols)
+{
+	D2DMarkerAtlas atlas;
+	atlas.Reset(32, 32);
+
+	// a symbol wider than the atlas never fits
+	CHECK_EQUAL(-1, atlas.AddSymbol(31, 4));
+
+	// two shelves of two 14 pixel symbols fill it
+	for(int i = 0; i < 4; i++)
+	{
+		CHECK_EQUAL(i, atlas.AddSymbol(14, 14));
+	}
+
+	CHECK_EQUAL(-1, atlas.AddSymbol(14, 14));
+	CHECK_EQUAL(4u, atlas.GetSymbolCount());
+
+	// a reset empties it again
+	atlas.Reset(32, 32);
+	CHECK_EQUAL(0u, atlas.GetSymbolCount());
+	CHECK_EQUAL(0, atlas.AddSymbol(14, 14));
+}
+
+TEST(SpritesDrawTheSymbolAtItsSize)
+{
+	D2DMarkerAtlas atlas;
+	atlas.Reset(64, 64);
+	atlas.AddSymbol(8, 8);
+	int symbol = atlas.AddSymbol(12, 6);
+
+	atlas.AddSprite(100.5f, 20, symbol);
+	atlas.AddSprite(-3, -4, 0);
+
+	CHECK_EQUAL(2u, atlas.GetSpriteCount());
+
+	const D2DSpriteRect& destination = atlas.GetDestinations()[0];
+	CHECK_CLOSE(100.5, destination.Left, 0);
+	CHECK_CLOSE(20, destination.Top, 0);
+	CHECK_CLOSE(112.5, destination.Right, 0);
+	CHECK_CLOSE(26, destination.Bottom, 0);
+
+	const D2DAtlasRect& source = atlas.GetSources()[0];
+	CHECK_EQUAL(atlas.GetSymbol(symbol).Left, source.Left);
+	CHECK_EQUAL(atlas.GetSymbol(symbol).Bottom, source.Bottom);
+
+	CHECK_CLOSE(5, atlas.GetDestinations()[1].Right, 0);
+
+	// clearing the sprites keeps the symbols
+	atlas.ClearSprites();
+	CHECK_EQUAL(0u, atlas.GetSpriteCount());
+	CHECK_EQUAL(2u, atlas.GetSymbolCount());
+}
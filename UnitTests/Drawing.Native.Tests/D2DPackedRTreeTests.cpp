@@ -0,0 +1,222 @@
+#include "NativeTest.h"
+#include "D2DFeatureStream.h"
+#include "D2DPackedRTree.h"
+#include "D2DShapefileReader.h"
+#include <algorithm>
+#include <random>
+
+using namespace Telerik::UI::Drawing;
+
+static bool Intersects(const D2DRTreeNode& box, double minX, double minY, double maxX, double maxY)
+{
+	return !(box.MaxX < minX || box.MaxY < minY || box.MinX > maxX || box.MinY > maxY);
+}
+
+// random boxes stored as the leaves of a tree in Hilbert order, as the feature file writer stores them
+static void BuildTree(size_t count, uint16_t nodeSize, std::vector<D2DRTreeNode>* leaves, std::vector<D2DRTreeNode>* nodes)
+{
+	std::mt19937 random(static_cast<uint32_t>(count));
+	std::uniform_real_distribution<double> position(0, 1000);
+	std::uniform_real_distribution<double> size(0, 20);
+
+	std::vector<D2DRTreeNode> boxes(count);
+	for(size_t i = 0; i < count; i++)
+	{
+		boxes[i].MinX = position(random);
+		boxes[i].MinY = position(random);
+		boxes[i].MaxX = boxes[i].MinX + size(random);
+		boxes[i].MaxY = boxes[i].MinY + size(random);
+		boxes[i].Offset = i;
+	}
+
+	std::vector<uint32_t> order;
+	D2DPackedRTree::SortByHilbert(boxes.data(), count, 0, 0, 1020, 1020, &order);
+
+	nodes->assign(D2DPackedRTree::GetNodeCount(count, nodeSize), D2DRTreeNode());
+	leaves->resize(count);
+	for(size_t i = 0; i < count; i++)
+	{
+		(*leaves)[i] = boxes[order[i]];
+		(*nodes)[nodes->size() - count + i] = boxes[order[i]];
+	}
+
+	D2DPackedRTree::Build(nodes->data(), nodes->size(), count, nodeSize);
+}
+
+TEST(TheNodeCountCoversEveryLevel)
+{
+	CHECK_EQUAL(0u, D2DPackedRTree::GetNodeCount(0, 16));
+	CHECK_EQUAL(2u, D2DPackedRTree::GetNodeCount(1, 16));
+	CHECK_EQUAL(17u, D2DPackedRTree::GetNodeCount(16, 16));
+	CHECK_EQUAL(20u, D2DPackedRTree::GetNodeCount(17, 16));
+	CHECK_EQUAL(1000u + 63 + 4 + 1, D2DPackedRTree::GetNodeCount(1000, 16));
+}
+
+TEST(TheHilbertOrderIsAPermutation)
+{
+	std::vector<D2DRTreeNode> leaves;
+	std::vector<D2DRTreeNode> nodes;
+	BuildTree(5000, 16, &leaves, &nodes);
+
+	std::vector<bool> isStored(leaves.size(), false);
+	for(auto leaf = leaves.begin(); leaf != leaves.end(); ++leaf)
+	{
+		isStored[static_cast<size_t>(leaf->Offset)] = true;
+	}
+
+	CHECK(std::find(isStored.begin(), isStored.end(), false) == isStored.end());
+
+	// the root bounds all leaves
+	CHECK(nodes[0].MinX >= 0 && nodes[0].MaxX <= 1020);
+	for(auto leaf = leaves.begin(); leaf != leaves.end(); ++leaf)
+	{
+		CHECK(leaf->MinX >= nodes[0].MinX && leaf->MaxY <= nodes[0].MaxY);
+	}
+}
+
+TEST(SearchFindsTheLeavesABruteForceScanFinds)
+{
+	uint16_t nodeSizes[] = { 2, 4, 16 };
+	size_t counts[] = { 1, 15, 16, 17, 1000, 20000 };
+
+	std::mt19937 random(7);
+	std::uniform_real_distribution<double> position(-50, 1050);
+	std::uniform_real_distribution<double> size(0, 200);
+
+	for(int n = 0; n < 3; n++)
+	{
+		for(int c = 0; c < 6; c++)
+		{
+			std::vector<D2DRTreeNode> leaves;
+			std::vector<D2DRTreeNode> nodes;
+			BuildTree(counts[c], nodeSizes[n], &leaves, &nodes);
+
+			bool isSame = true;
+			for(int query = 0; query < 50; query++)
+			{
+				double minX = position(random);
+				double minY = position(random);
+				double maxX = minX + size(random);
+				double maxY = minY + size(random);
+
+				std::vector<uint32_t> expected;
+				for(size_t i = 0; i < leaves.size(); i++)
+				{
+					if(Intersects(leaves[i], minX, minY, maxX, maxY))
+					{
+						expected.push_back(static_cast<uint32_t>(i));
+					}
+				}
+
+				std::vector<uint32_t> found;
+				D2DPackedRTree::Search(nodes.data(), nodes.size(), leaves.size(), nodeSizes[n], minX, minY, maxX, maxY, &found);
+				std::sort(found.begin(), found.end());
+
+				isSame &= expected == found;
+			}
+
+			CHECK(isSame);
+		}
+	}
+}
+
+TEST(AFeatureFileRoundTripsTheWorld)
+{
+	std::vector<uint8_t> data;
+	D2DShapefileGeometry geometry;
+	CHECK(NativeTest::ReadFile(NativeTest::GetDataPath("world.shp"), &data) && D2DShapefileReader::ReadShapes(data.data(), data.size(), &geometry));
+
+	size_t recordCount = geometry.RecordShapeTypes.size();
+	std::vector<D2DFeatureKind> kinds(recordCount);
+	size_t polygonCount = 0;
+	for(size_t i = 0; i < recordCount; i++)
+	{
+		kinds[i] = geometry.RecordShapeTypes[i] == 5 ? D2DFeatureKind::Polygon : D2DFeatureKind::None;
+		polygonCount += geometry.RecordShapeTypes[i] == 5 ? 1 : 0;
+	}
+
+	D2DFeatureSource source = { recordCount, kinds.data(), geometry.PartOffsets.data(), geometry.PointOffsets.data(), geometry.Coordinates.data() };
+	auto path = NativeTest::GetOutputPath("world.features");
+	CHECK(D2DFeatureStreamWriter::Write(source, path.c_str()));
+
+	D2DFeatureStreamReader reader;
+	CHECK(reader.Open(path.c_str()));
+	CHECK_EQUAL(polygonCount, reader.GetFeatureCount());
+
+	double minX, minY, maxX, maxY;
+	reader.GetBounds(&minX, &minY, &maxX, &maxY);
+	CHECK_EQUAL(-180.0, minX);
+	CHECK_EQUAL(180.0, maxX);
+
+	// every record holds the parts and points of its source feature
+	bool isSame = true;
+	std::vector<bool> isRead(recordCount, false);
+	for(uint32_t feature = 0; feature < reader.GetFeatureCount(); feature++)
+	{
+		D2DFeatureRecord record;
+		if(!reader.GetFeature(feature, &record))
+		{
+			isSame = false;
+			continue;
+		}
+
+		uint32_t firstPart = geometry.PartOffsets[record.SourceIndex];
+		uint32_t firstPoint = geometry.PointOffsets[firstPart];
+		isSame &= record.Kind == D2DFeatureKind::Polygon;
+		isSame &= record.PartCount == geometry.PartOffsets[record.SourceIndex + 1] - firstPart;
+		for(uint32_t part = 0; part <= record.PartCount; part++)
+		{
+			isSame &= record.PointOffsets[part] + firstPoint == geometry.PointOffsets[firstPart + part];
+		}
+
+		isSame &= std::equal(record.Coordinates, record.Coordinates + 2 * record.PointCount, &geometry.Coordinates[2 * firstPoint]);
+		isRead[record.SourceIndex] = true;
+	}
+
+	CHECK(isSame);
+	CHECK(!reader.GetFeature(static_cast<uint32_t>(reader.GetFeatureCount()), nullptr));
+
+	// a query around Europe finds the features whose points are in it
+	std::vector<uint32_t> features;
+	reader.Query(0, 40, 20, 55, &features);
+	CHECK(!features.empty() && features.size() < polygonCount / 2);
+
+	size_t expectedCount = 0;
+	for(size_t i = 0; i < recordCount; i++)
+	{
+		if(kinds[i] == D2DFeatureKind::None)
+		{
+			continue;
+		}
+
+		bool intersects = false;
+		for(uint32_t point = geometry.PointOffsets[geometry.PartOffsets[i]]; point < geometry.PointOffsets[geometry.PartOffsets[i + 1]]; point++)
+		{
+			intersects |= geometry.Coordinates[2 * point] >= 0 && geometry.Coordinates[2 * point] <= 20 && geometry.Coordinates[2 * point + 1] >= 40 && geometry.Coordinates[2 * point + 1] <= 55;
+		}
+
+		expectedCount += intersects ? 1 : 0;
+	}
+
+	// the query is by bounds, so it finds at least the features with points in the rect
+	CHECK(features.size() >= expectedCount);
+}
+
+TEST(AFileThatIsNotAFeatureFileIsNotOpened)
+{
+	std::vector<uint8_t> data;
+	CHECK(NativeTest::ReadFile(NativeTest::GetDataPath("world.shp"), &data));
+
+	auto path = NativeTest::GetOutputPath("world.notfeatures");
+	D2DFeatureFileOutput output(path.c_str());
+	output.Write(data.data(), data.size());
+	CHECK(output.Close());
+
+	D2DFeatureStreamReader reader;
+	CHECK(!reader.Open(path.c_str()));
+	CHECK_EQUAL(0u, reader.GetFeatureCount());
+
+	std::vector<uint32_t> features;
+	reader.Query(-1000, -1000, 1000, 1000, &features);
+	CHECK(features.empty());
+}
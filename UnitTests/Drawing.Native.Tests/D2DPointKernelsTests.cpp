@@ -0,0 +1,72 @@
+#include "NativeTest.h"
+#include "D2DPointKernels.h"
+#include <algorithm>
+#include <random>
+
+using namespace Telerik::UI::Drawing;
+
+static std::vector<double> CreatePoints(size_t count)
+{
+	std::mt19937 random(7);
+	std::uniform_real_distribution<double> coordinate(-180, 180);
+
+	std::vector<double> coordinates(2 * count);
+	for(size_t i = 0; i < coordinates.size(); i++)
+	{
+		coordinates[i] = coordinate(random);
+	}
+
+	return coordinates;
+}
+
+TEST(ComputeBoundsMatchesTheExtremes)
+{
+	// odd and even counts end the paired loop differently
+	for(size_t count = 1; count <= 9; count++)
+	{
+		std::vector<double> coordinates = CreatePoints(count);
+
+		D2DPointBounds bounds;
+		CHECK(D2DPointKernels::ComputeBounds(coordinates.data(), count, &bounds));
+
+		double minX = coordinates[0], minY = coordinates[1], maxX = coordinates[0], maxY = coordinates[1];
+		for(size_t i = 1; i < count; i++)
+		{
+			minX = (std::min)(minX, coordinates[2 * i]);
+			minY = (std::min)(minY, coordinates[2 * i + 1]);
+			maxX = (std::max)(maxX, coordinates[2 * i]);
+			maxY = (std::max)(maxY, coordinates[2 * i + 1]);
+		}
+
+		CHECK_EQUAL(minX, bounds.MinX);
+		CHECK_EQUAL(minY, bounds.MinY);
+		CHECK_EQUAL(maxX, bounds.MaxX);
+		CHECK_EQUAL(maxY, bounds.MaxY);
+	}
+}
+
+TEST(ComputeBoundsFailsWithoutPoints)
+{
+	D2DPointBounds bounds;
+	CHECK(!D2DPointKernels::ComputeBounds(nullptr, 0, &bounds));
+}
+
+TEST(TransformPointsMatchesTheScalarFormula)
+{
+	for(size_t count = 0; count <= 9; count++)
+	{
+		std::vector<double> coordinates = CreatePoints(count);
+		std::vector<float> output(2 * count + 1, -1.0f);
+
+		D2DPointKernels::TransformPoints(coordinates.data(), count, 3.5, -120.25, 64.5, output.data());
+
+		for(size_t i = 0; i < count; i++)
+		{
+			CHECK_EQUAL(static_cast<float>(coordinates[2 * i] * 3.5 - 120.25), output[2 * i]);
+			CHECK_EQUAL(static_cast<float>(coordinates[2 * i + 1] * 3.5 + 64.5), output[2 * i + 1]);
+		}
+
+		// nothing is written past the points
+		CHECK_EQUAL(-1.0f, output[2 * count]);
+	}
+}
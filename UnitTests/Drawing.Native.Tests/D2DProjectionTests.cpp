@@ -0,0 +1,120 @@
+#include "NativeTest.h"
+#include "D2DProjection.h"
+#include <cstring>
+#include <limits>
+#include <random>
+
+using namespace Telerik::UI::Drawing;
+
+const double WorldSize = 512;
+const double Pi = 3.14159265358979323846;
+
+// the largest difference between the bulk projection and the scalar formula applied point by point
+static double GetMaxError(std::vector<double> coordinates)
+{
+	std::vector<double> expected(coordinates);
+	for(size_t i = 0; i < expected.size(); i += 2)
+	{
+		D2DProjection::ProjectMercatorPoint(&expected[i], WorldSize);
+	}
+
+	D2DProjection::ProjectMercator(coordinates.data(), coordinates.size() / 2, WorldSize);
+
+	double maxError = 0;
+	for(size_t i = 0; i < coordinates.size(); i++)
+	{
+		maxError = (std::max)(maxError, std::fabs(coordinates[i] - expected[i]));
+	}
+
+	return maxError;
+}
+
+static std::vector<double> CreatePoints(size_t count, double maxLatitude, uint32_t seed)
+{
+	std::mt19937 random(seed);
+	std::uniform_real_distribution<double> longitude(-180, 180);
+	std::uniform_real_distribution<double> latitude(-maxLatitude, maxLatitude);
+
+	std::vector<double> coordinates(2 * count);
+	for(size_t i = 0; i < count; i++)
+	{
+		coordinates[2 * i] = longitude(random);
+		coordinates[2 * i + 1] = latitude(random);
+	}
+
+	return coordinates;
+}
+
+TEST(TheScalarFormulaIsTheMercatorProjectionOfTheMap)
+{
+	// the managed formula: the world is [0, 1] on both axes, y = 1/2 - ln(tan(pi / 4 + phi / 2)) / 2pi
+	std::vector<double> coordinates = CreatePoints(1000, 85, 1);
+	bool isSame = true;
+	for(size_t i = 0; i < coordinates.size(); i += 2)
+	{
+		double point[] = { coordinates[i], coordinates[i + 1] };
+		D2DProjection::ProjectMercatorPoint(point, WorldSize);
+
+		double phi = coordinates[i + 1] * Pi / 180;
+		isSame &= std::fabs(point[0] - (coordinates[i] / 360 + 0.5) * WorldSize) < 1e-9;
+		isSame &= std::fabs(point[1] - (0.5 - log(tan(Pi / 4 + phi / 2)) / (2 * Pi)) * WorldSize) < 1e-9;
+	}
+
+	CHECK(isSame);
+
+	double center[] = { 0, 0 };
+	D2DProjection::ProjectMercatorPoint(center, WorldSize);
+	CHECK_CLOSE(256, center[0], 1e-12);
+	CHECK_CLOSE(256, center[1], 1e-12);
+
+	// the square world of the map ends at 85.0511 degrees
+	double corner[] = { 180, 85.0511287798066 };
+	D2DProjection::ProjectMercatorPoint(corner, WorldSize);
+	CHECK_CLOSE(512, corner[0], 1e-9);
+	CHECK_CLOSE(0, corner[1], 1e-9);
+}
+
+TEST(TheBulkProjectionMatchesTheScalarFormula)
+{
+	// a unit of the 512 unit world is 2^20 pixels at zoom level 20: over the latitudes maps show the difference stays
+	// below a millionth of a pixel there, and it grows towards the 89 degrees of the vector path as 1 - sin(latitude) cancels
+	CHECK(GetMaxError(CreatePoints(100000, 85.0511, 2)) < 1e-14 * WorldSize);
+	CHECK(GetMaxError(CreatePoints(100000, 89, 3)) < 1e-12 * WorldSize);
+	CHECK(GetMaxError(CreatePoints(100000, 1e-6, 4)) < 1e-16 * WorldSize);
+}
+
+TEST(PolesAndDamagedValuesTakeTheScalarFormula)
+{
+	// a group of four points with one outside of the vector range, and a tail shorter than a group
+	double values[] = { 89.5, 90, -90, std::numeric_limits<double>::quiet_NaN(), std::numeric_limits<double>::infinity() };
+	for(int v = 0; v < 5; v++)
+	{
+		std::vector<double> coordinates = CreatePoints(7, 60, 5 + v);
+		coordinates[5] = values[v];
+
+		std::vector<double> expected(coordinates);
+		for(size_t i = 0; i < expected.size(); i += 2)
+		{
+			D2DProjection::ProjectMercatorPoint(&expected[i], WorldSize);
+		}
+
+		D2DProjection::ProjectMercator(coordinates.data(), 7, WorldSize);
+		CHECK(memcmp(&expected[0], &coordinates[0], 8 * sizeof(double)) == 0);
+	}
+
+	// the south pole is clamped to the bottom edge
+	double southPole[] = { 0, -90 };
+	D2DProjection::ProjectMercatorPoint(southPole, WorldSize);
+	CHECK_EQUAL(WorldSize, southPole[1]);
+}
+
+TEST(TheParallelProjectionIsTheSameAsTheSequentialOne)
+{
+	std::vector<double> sequential = CreatePoints(300001, 85, 11);
+	std::vector<double> parallel(sequential);
+
+	D2DProjection::ProjectMercator(sequential.data(), sequential.size() / 2, WorldSize);
+	D2DProjection::ProjectMercatorInParallel(parallel.data(), parallel.size() / 2, WorldSize);
+
+	CHECK(sequential == parallel);
+}
@@ -0,0 +1,228 @@
+#include "NativeTest.h"
+#include "D2DShapeTable.h"
+#include <random>
+
+using namespace Telerik::UI::Drawing;
+
+static D2DCullBounds CreateBounds(double minX, double minY, double maxX, double maxY, float padding)
+{
+	D2DCullBounds bounds = { minX, minY, maxX, maxY, padding };
+	return bounds;
+}
+
+TEST(UnknownRowsAreNeverCulled)
+{
+	D2DShapeTable table;
+	table.Resize(11);
+
+	std::vector<uint32_t> survivors;
+	D2DCullRect rect = { 0, 0, 1, 1 };
+	table.Cull(rect, 1, survivors);
+
+	CHECK_EQUAL(11u, survivors.size());
+	CHECK(!table.IsKnown(0));
+}
+
+TEST(RowsFilledFromTheirSourceAreCulledBeforeAnyShapeIsRendered)
+{
+	// a layer of shapes in a row, 10 units apart, of which the source knows all but every fifth from their points
+	const size_t shapeCount = 100;
+	D2DShapeTable table;
+	table.Resize(shapeCount);
+	table.Fill(0, shapeCount, [](size_t index, D2DCullBounds* bounds)
+	{
+		*bounds = CreateBounds(index * 10.0, 0, index * 10.0 + 5, 5, 0);
+		return index % 5 != 0;
+	});
+
+	// the viewport covers the shapes 10 to 19
+	std::vector<uint32_t> survivors;
+	D2DCullRect viewport = { 100, 0, 195, 5 };
+	table.Cull(viewport, 1, survivors);
+
+	std::vector<uint32_t> expected;
+	for(uint32_t i = 0; i < shapeCount; i++)
+	{
+		if(i % 5 == 0 || (i >= 10 && i <= 19))
+		{
+			expected.push_back(i);
+		}
+	}
+
+	CHECK(expected == survivors);
+}
+
+TEST(GrowKeepsTheRowsAndAppendsUnknownOnes)
+{
+	D2DShapeTable table;
+	table.Resize(3);
+	table.SetBounds(1, CreateBounds(50, 50, 60, 60, 0));
+
+	table.Grow(13);
+	CHECK_EQUAL(13u, table.GetCount());
+	CHECK(table.IsKnown(1));
+	CHECK(!table.IsKnown(12));
+
+	table.Fill(3, 13, [](size_t, D2DCullBounds* bounds)
+	{
+		*bounds = CreateBounds(50, 50, 60, 60, 0);
+		return true;
+	});
+
+	std::vector<uint32_t> survivors;
+	D2DCullRect rect = { 0, 0, 10, 10 };
+	table.Cull(rect, 1, survivors);
+
+	std::vector<uint32_t> expected = { 0, 2 };
+	CHECK(expected == survivors);
+}
+
+TEST(ThePaddingIsScaledToModelSpace)
+{
+	D2DShapeTable table;
+	table.Resize(1);
+
+	// 4 pixels of padding at a zoom of 2 reach 2 units around the bounds
+	table.SetBounds(0, CreateBounds(10, 10, 20, 20, 4));
+
+	std::vector<uint32_t> survivors;
+	D2DCullRect touching = { 21.5f, 0, 30, 30 };
+	table.Cull(touching, 0.5f, survivors);
+	CHECK_EQUAL(1u, survivors.size());
+
+	survivors.clear();
+	D2DCullRect outside = { 22.5f, 0, 30, 30 };
+	table.Cull(outside, 0.5f, survivors);
+	CHECK(survivors.empty());
+}
+
+TEST(TheBoundsAreRoundedOutwards)
+{
+	D2DShapeTable table;
+	table.Resize(1);
+
+	double minX = 0.1, maxX = 1e8 + 1;
+	table.SetBounds(0, CreateBounds(minX, minX, maxX, maxX, 0));
+
+	D2DCullRect bounds = table.GetBounds(0);
+	CHECK(bounds.MinX <= minX);
+	CHECK(bounds.MinY <= minX);
+	CHECK(bounds.MaxX >= maxX);
+	CHECK(bounds.MaxY >= maxX);
+}
+
+TEST(SubPixelRowsAreSplitFromTheSurvivors)
+{
+	D2DShapeTable table;
+	table.Resize(3);
+	table.SetBounds(0, CreateBounds(0, 0, 10, 10, 0));
+	table.SetBounds(1, CreateBounds(5, 5, 5.1, 5.1, 0));
+	table.SetBounds(2, CreateBounds(100, 100, 100.1, 100.1, 0));
+
+	std::vector<uint32_t> survivors;
+	std::vector<uint32_t> subPixel;
+	D2DCullRect rect = { 0, 0, 20, 20 };
+	table.Cull(rect, 1, 1, survivors, &subPixel);
+
+	CHECK(std::vector<uint32_t>(1, 0) == survivors);
+	CHECK(std::vector<uint32_t>(1, 1) == subPixel);
+
+	// without a sub-pixel list the small rows survive with the others
+	survivors.clear();
+	table.Cull(rect, 1, 1, survivors, nullptr);
+	CHECK_EQUAL(2u, survivors.size());
+}
+
+TEST(CullMatchesAnIntersectionTestOfEveryRow)
+{
+	std::mt19937 random(3);
+	std::uniform_real_distribution<double> position(0, 1000);
+	std::uniform_real_distribution<double> size(0, 20);
+
+	// a count that leaves padding rows in the last batch
+	const size_t count = 1003;
+	std::vector<D2DCullBounds> rows(count);
+
+	D2DShapeTable table;
+	table.Resize(count);
+	for(size_t i = 0; i < count; i++)
+	{
+		double x = position(random);
+		double y = position(random);
+		rows[i] = CreateBounds(x, y, x + size(random), y + size(random), static_cast<float>(size(random)));
+		table.SetBounds(i, rows[i]);
+	}
+
+	D2DCullRect rect = { 250, 300, 600, 450 };
+	float paddingScale = 0.25f;
+
+	std::vector<uint32_t> survivors;
+	table.Cull(rect, paddingScale, survivors);
+
+	std::vector<uint32_t> expected;
+	for(uint32_t i = 0; i < count; i++)
+	{
+		D2DCullRect bounds = table.GetBounds(i);
+		float pad = rows[i].Padding * paddingScale;
+		if(bounds.MinX - pad <= rect.MaxX && bounds.MaxX + pad >= rect.MinX && bounds.MinY - pad <= rect.MaxY && bounds.MaxY + pad >= rect.MinY)
+		{
+			expected.push_back(i);
+		}
+	}
+
+	CHECK(!expected.empty());
+	CHECK(expected == survivors);
+}
+
+TEST(IntersectsMatchesCull)
+{
+	D2DShapeTable table;
+	table.Resize(3);
+	table.SetBounds(0, CreateBounds(0, 0, 10, 10, 2));
+	table.SetBounds(1, CreateBounds(50, 50, 60, 60, 0));
+
+	D2DCullRect rect = { 10.5f, 0, 20, 20 };
+	CHECK(table.Intersects(0, rect, 1));
+	CHECK(!table.Intersects(0, rect, 0.1f));
+	CHECK(!table.Intersects(1, rect, 1));
+	CHECK(table.Intersects(2, rect, 1));
+	CHECK(!table.Intersects(3, rect, 1));
+}
+
+TEST(TheGeometryOfTheFirstFrameIsBoundedByTheShapesNearTheViewport)
+{
+	// a freshly set layer: 10,000 shapes on a 100 x 100 grid of 10 unit cells, with the table filled from their points
+	const size_t side = 100;
+	D2DShapeTable table;
+	table.Resize(side * side);
+	table.Fill(0, side * side, [](size_t index, D2DCullBounds* bounds)
+	{
+		double x = static_cast<double>(index % side) * 10;
+		double y = static_cast<double>(index / side) * 10;
+		*bounds = CreateBounds(x, y, x + 8, y + 8, 1);
+		return true;
+	});
+
+	// the first frame builds the geometry of the survivors only, as D2DShapeLayer::RenderShapes does
+	float paddingScale = 0.5f;
+	D2DCullRect viewport = { 200, 300, 400, 420 };
+	std::vector<uint32_t> rendered;
+	table.Cull(viewport, paddingScale, rendered);
+
+	// the warm-up and the eviction of D2DCanvas keep the geometry of the shapes in the viewport inflated by half its size
+	D2DCullRect area = { 100, 240, 500, 480 };
+	size_t nearCount = 0;
+	for(size_t i = 0; i < table.GetCount(); i++)
+	{
+		nearCount += table.Intersects(i, area, paddingScale) ? 1 : 0;
+	}
+
+	for(auto index = rendered.begin(); index != rendered.end(); ++index)
+	{
+		CHECK(table.Intersects(*index, area, paddingScale));
+	}
+
+	// 21 x 13 cells reach the viewport and 41 x 25 the area around it, out of 10,000
+	CHECK_EQUAL(21u * 13u, rendered.size());
+	CHECK_EQUAL(41u * 25u, nearCount);
+}
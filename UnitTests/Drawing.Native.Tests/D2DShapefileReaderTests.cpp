@@ -0,0 +1,239 @@
+#include "NativeTest.h"
+#include "D2DShapefileReader.h"
+#include <cstring>
+
+using namespace Telerik::UI::Drawing;
+
+static void AppendInt32(std::vector<uint8_t>* data, int32_t value)
+{
+	data->resize(data->size() + 4);
+	memcpy(&data->back() - 3, &value, 4);
+}
+
+static void AppendDouble(std::vector<uint8_t>* data, double value)
+{
+	data->resize(data->size() + 8);
+	memcpy(&data->back() - 7, &value, 8);
+}
+
+// a shapefile header of the shape type with empty bounds; the file length is not read
+static std::vector<uint8_t> CreateHeader(int32_t shapeType)
+{
+	std::vector<uint8_t> data(100, 0);
+	data[2] = 0x27;
+	data[3] = 0x0A;
+	memcpy(&data[32], &shapeType, 4);
+	return data;
+}
+
+// appends a record of the content, whose big-endian length is counted in 16-bit words
+static void AppendRecord(std::vector<uint8_t>* data, const std::vector<uint8_t>& content)
+{
+	uint32_t words = static_cast<uint32_t>(content.size() / 2);
+	uint8_t header[8] = { 0, 0, 0, 0, static_cast<uint8_t>(words >> 24), static_cast<uint8_t>(words >> 16), static_cast<uint8_t>(words >> 8), static_cast<uint8_t>(words) };
+	data->insert(data->end(), header, header + 8);
+	data->insert(data->end(), content.begin(), content.end());
+}
+
+static std::vector<uint8_t> CreatePoint(double x, double y)
+{
+	std::vector<uint8_t> content;
+	AppendInt32(&content, 1);
+	AppendDouble(&content, x);
+	AppendDouble(&content, y);
+	return content;
+}
+
+static bool ReadWorld(std::vector<uint8_t>* data, D2DShapefileGeometry* geometry)
+{
+	return NativeTest::ReadFile(NativeTest::GetDataPath("world.shp"), data) && D2DShapefileReader::ReadShapes(data->data(), data->size(), geometry);
+}
+
+TEST(TheWorldIsReadIntoFlatBuffers)
+{
+	std::vector<uint8_t> data;
+	D2DShapefileGeometry geometry;
+	CHECK(ReadWorld(&data, &geometry));
+
+	CHECK_EQUAL(5, geometry.ShapeType);
+	CHECK_EQUAL(-180.0, geometry.MinX);
+	CHECK_EQUAL(180.0, geometry.MaxX);
+
+	CHECK_EQUAL(252u, geometry.RecordShapeTypes.size());
+	CHECK_EQUAL(253u, geometry.PartOffsets.size());
+	CHECK_EQUAL(320u, geometry.PartOffsets.back());
+	CHECK_EQUAL(321u, geometry.PointOffsets.size());
+	CHECK_EQUAL(8229u, geometry.PointOffsets.back());
+	CHECK_EQUAL(2 * 8229u, geometry.Coordinates.size());
+
+	// the first record is Russia, with 26 parts; the fourth one is a null shape
+	CHECK_EQUAL(5, geometry.RecordShapeTypes[0]);
+	CHECK_EQUAL(26u, geometry.PartOffsets[1]);
+	CHECK_EQUAL(0, geometry.RecordShapeTypes[3]);
+	CHECK_EQUAL(geometry.PartOffsets[3], geometry.PartOffsets[4]);
+
+	bool isInBounds = true;
+	for(size_t i = 0; i < geometry.Coordinates.size(); i += 2)
+	{
+		isInBounds &= geometry.Coordinates[i] >= geometry.MinX && geometry.Coordinates[i] <= geometry.MaxX;
+		isInBounds &= geometry.Coordinates[i + 1] >= geometry.MinY && geometry.Coordinates[i + 1] <= geometry.MaxY;
+	}
+
+	CHECK(isInBounds);
+}
+
+TEST(BatchesReadTheSameShapesAsTheWholeFile)
+{
+	std::vector<uint8_t> data;
+	D2DShapefileGeometry geometry;
+	CHECK(ReadWorld(&data, &geometry));
+
+	size_t offset = 0;
+	size_t recordCount = 0;
+	D2DShapefileGeometry batch;
+	bool isSame = true;
+
+	while(D2DShapefileReader::ReadShapeBatch(data.data(), data.size(), &offset, 10, &batch) && !batch.RecordShapeTypes.empty())
+	{
+		CHECK(batch.RecordShapeTypes.size() <= 10);
+
+		// the offsets of a batch start at its first record
+		uint32_t firstPart = geometry.PartOffsets[recordCount];
+		uint32_t firstPoint = geometry.PointOffsets[firstPart];
+		for(size_t i = 0; i < batch.RecordShapeTypes.size(); i++)
+		{
+			isSame &= batch.RecordShapeTypes[i] == geometry.RecordShapeTypes[recordCount + i];
+			isSame &= batch.PartOffsets[i] + firstPart == geometry.PartOffsets[recordCount + i];
+		}
+
+		for(size_t i = 0; i < batch.PointOffsets.size(); i++)
+		{
+			isSame &= batch.PointOffsets[i] + firstPoint == geometry.PointOffsets[firstPart + i];
+		}
+
+		isSame &= memcmp(batch.Coordinates.data(), &geometry.Coordinates[2 * firstPoint], batch.Coordinates.size() * sizeof(double)) == 0;
+		recordCount += batch.RecordShapeTypes.size();
+	}
+
+	CHECK(isSame);
+	CHECK_EQUAL(252u, recordCount);
+	CHECK_EQUAL(data.size(), offset);
+}
+
+TEST(ATruncatedFileKeepsItsCompleteRecords)
+{
+	std::vector<uint8_t> data = CreateHeader(1);
+	AppendRecord(&data, CreatePoint(1, 2));
+	AppendRecord(&data, CreatePoint(3, 4));
+	data.resize(data.size() - 3);
+
+	D2DShapefileGeometry geometry;
+	CHECK(D2DShapefileReader::ReadShapes(data.data(), data.size(), &geometry));
+	CHECK_EQUAL(1u, geometry.RecordShapeTypes.size());
+	CHECK_EQUAL(1, geometry.RecordShapeTypes[0]);
+	CHECK_EQUAL(1u, geometry.PartOffsets[1]);
+	CHECK_EQUAL(1.0, geometry.Coordinates[0]);
+	CHECK_EQUAL(2.0, geometry.Coordinates[1]);
+}
+
+TEST(AMultipointIsASinglePart)
+{
+	std::vector<uint8_t> content;
+	AppendInt32(&content, 8);
+	for(int i = 0; i < 4; i++)
+	{
+		AppendDouble(&content, 0);
+	}
+
+	AppendInt32(&content, 3);
+	for(int i = 0; i < 6; i++)
+	{
+		AppendDouble(&content, i);
+	}
+
+	std::vector<uint8_t> data = CreateHeader(8);
+	AppendRecord(&data, content);
+
+	D2DShapefileGeometry geometry;
+	CHECK(D2DShapefileReader::ReadShapes(data.data(), data.size(), &geometry));
+	CHECK_EQUAL(1u, geometry.PartOffsets[1]);
+	CHECK_EQUAL(3u, geometry.PointOffsets[1]);
+	CHECK_EQUAL(5.0, geometry.Coordinates[5]);
+}
+
+TEST(OtherFilesAndMultipatchRecordsAreRejected)
+{
+	D2DShapefileGeometry geometry;
+
+	std::vector<uint8_t> text(200, 'x');
+	CHECK(!D2DShapefileReader::ReadShapes(text.data(), text.size(), &geometry));
+
+	std::vector<uint8_t> content;
+	AppendInt32(&content, 31);
+	content.resize(44, 0);
+
+	std::vector<uint8_t> data = CreateHeader(31);
+	AppendRecord(&data, content);
+	CHECK(!D2DShapefileReader::ReadShapes(data.data(), data.size(), &geometry));
+
+	size_t offset = 0;
+	CHECK(!D2DShapefileReader::ReadShapeBatch(data.data(), data.size(), &offset, 10, &geometry));
+}
+
+TEST(TheWorldTableIsReadIntoColumns)
+{
+	std::vector<uint8_t> data;
+	CHECK(NativeTest::ReadFile(NativeTest::GetDataPath("world.dbf"), &data));
+
+	D2DDbfTable table;
+	CHECK(D2DShapefileReader::ReadTable(data.data(), data.size(), &table));
+	CHECK_EQUAL(252u, table.RecordCount);
+	CHECK_EQUAL(15u, table.Columns.size());
+
+	const D2DDbfColumn& name = table.Columns[4];
+	CHECK_EQUAL(std::string("CNTRY_NAME"), name.Name);
+	CHECK(!name.IsNumeric());
+	CHECK_EQUAL(6u, name.TextLengths[0]);
+	CHECK(memcmp(name.Text.data(), "Russia", 6) == 0);
+
+	const D2DDbfColumn& population = table.Columns[7];
+	CHECK(population.IsNumeric());
+	CHECK_EQUAL(151827600.0, population.Numbers[0]);
+
+	const D2DDbfColumn& area = table.Columns[11];
+	CHECK_EQUAL(2u, area.DecimalCount);
+	CHECK_EQUAL(16911282.0, area.Numbers[0]);
+}
+
+TEST(ATableWithoutRecordsKeepsItsColumns)
+{
+	std::vector<uint8_t> data;
+	CHECK(NativeTest::ReadFile(NativeTest::GetDataPath("world.dbf"), &data));
+
+	// the header alone, with a record count of zero
+	size_t headerLength = data[8] | (data[9] << 8);
+	data.resize(headerLength);
+	memset(&data[4], 0, 4);
+
+	D2DDbfTable table;
+	CHECK(D2DShapefileReader::ReadTable(data.data(), data.size(), &table));
+	CHECK_EQUAL(0u, table.RecordCount);
+	CHECK_EQUAL(15u, table.Columns.size());
+	CHECK(table.Columns[7].Numbers.empty());
+}
+
+TEST(NumbersAreParsedAsTheManagedReaderDoes)
+{
+	CHECK_EQUAL(42.0, D2DShapefileReader::ParseNumber("        42", 10));
+	CHECK_EQUAL(-3.25, D2DShapefileReader::ParseNumber("  -3.25", 7));
+	CHECK_EQUAL(3.25, D2DShapefileReader::ParseNumber("3,25", 4));
+	CHECK_EQUAL(1.5e10, D2DShapefileReader::ParseNumber("1.5E+10", 7));
+	CHECK_EQUAL(0.000125, D2DShapefileReader::ParseNumber("1.25e-4", 7));
+	CHECK_CLOSE(12345678901234567890.0, D2DShapefileReader::ParseNumber("12345678901234567890", 20), 1e5);
+
+	// the length bounds the text, and overflow or blanks hold no number
+	CHECK_EQUAL(12.0, D2DShapefileReader::ParseNumber("123", 2));
+	CHECK(std::isnan(D2DShapefileReader::ParseNumber("**********", 10)));
+	CHECK(std::isnan(D2DShapefileReader::ParseNumber("     ", 5)));
+	CHECK(std::isnan(D2DShapefileReader::ParseNumber("-.", 2)));
+}
@@ -0,0 +1,257 @@
+#include "NativeTest.h"
+#include "D2DTessellator.h"
+#include "D2DShapefileReader.h"
+#include <cmath>
+
+using namespace Telerik::UI::Drawing;
+
+// a polygon of rings in the float coordinates the tessellator takes
+struct TestPolygon
+{
+	std::vector<float> Coordinates;
+	std::vector<uint32_t> RingOffsets;
+
+	TestPolygon() : RingOffsets(1, 0)
+	{
+	}
+
+	void AddRing(std::initializer_list<float> points)
+	{
+		this->Coordinates.insert(this->Coordinates.end(), points.begin(), points.end());
+		this->RingOffsets.push_back(static_cast<uint32_t>(this->Coordinates.size() / 2));
+	}
+
+	size_t Tessellate(std::vector<uint32_t>* triangles) const
+	{
+		return D2DTessellator::Tessellate(this->Coordinates.data(), this->RingOffsets.data(), this->RingOffsets.size() - 1, triangles);
+	}
+};
+
+static double GetTrianglesArea(const std::vector<float>& coordinates, const std::vector<uint32_t>& triangles)
+{
+	double area = 0;
+	for(size_t i = 0; i < triangles.size(); i += 3)
+	{
+		double ax = coordinates[2 * triangles[i]];
+		double ay = coordinates[2 * triangles[i] + 1];
+		double bx = coordinates[2 * triangles[i + 1]];
+		double by = coordinates[2 * triangles[i + 1] + 1];
+		double cx = coordinates[2 * triangles[i + 2]];
+		double cy = coordinates[2 * triangles[i + 2] + 1];
+		area += std::fabs((bx - ax) * (cy - ay) - (cx - ax) * (by - ay)) / 2;
+	}
+
+	return area;
+}
+
+// whether the point is inside an odd number of the rings, which is what the Alternate fill mode fills
+static bool IsFilled(const std::vector<float>& coordinates, const std::vector<uint32_t>& ringOffsets, double x, double y)
+{
+	bool isInside = false;
+	for(size_t r = 0; r + 1 < ringOffsets.size(); r++)
+	{
+		for(uint32_t i = ringOffsets[r], j = ringOffsets[r + 1] - 1; i < ringOffsets[r + 1]; j = i++)
+		{
+			double xi = coordinates[2 * i];
+			double yi = coordinates[2 * i + 1];
+			double xj = coordinates[2 * j];
+			double yj = coordinates[2 * j + 1];
+			if((yi > y) != (yj > y) && x < (xj - xi) * (y - yi) / (yj - yi) + xi)
+			{
+				isInside = !isInside;
+			}
+		}
+	}
+
+	return isInside;
+}
+
+// the number of triangles whose centroid is not filled by the rings
+static size_t CountStrayTriangles(const std::vector<float>& coordinates, const std::vector<uint32_t>& ringOffsets, const std::vector<uint32_t>& triangles)
+{
+	size_t count = 0;
+	for(size_t i = 0; i < triangles.size(); i += 3)
+	{
+		double x = (coordinates[2 * triangles[i]] + coordinates[2 * triangles[i + 1]] + coordinates[2 * triangles[i + 2]]) / 3.0;
+		double y = (coordinates[2 * triangles[i] + 1] + coordinates[2 * triangles[i + 1] + 1] + coordinates[2 * triangles[i + 2] + 1]) / 3.0;
+		if(!IsFilled(coordinates, ringOffsets, x, y))
+		{
+			count++;
+		}
+	}
+
+	return count;
+}
+
+static int GetOrientation(const float* p, const float* q, const float* r)
+{
+	double value = (static_cast<double>(q[1]) - p[1]) * (static_cast<double>(r[0]) - q[0]) - (static_cast<double>(q[0]) - p[0]) * (static_cast<double>(r[1]) - q[1]);
+	return value > 0 ? 1 : (value < 0 ? -1 : 0);
+}
+
+// whether any two edges of the rings cross properly, by testing every pair
+static bool HasCrossingEdges(const std::vector<float>& coordinates, const std::vector<uint32_t>& ringOffsets)
+{
+	std::vector<uint32_t> edges;
+	for(size_t r = 0; r + 1 < ringOffsets.size(); r++)
+	{
+		for(uint32_t i = ringOffsets[r]; i + 1 < ringOffsets[r + 1]; i++)
+		{
+			edges.push_back(i);
+		}
+	}
+
+	const float* points = coordinates.data();
+	for(size_t a = 0; a < edges.size(); a++)
+	{
+		const float* p1 = points + 2 * edges[a];
+		const float* q1 = p1 + 2;
+		for(size_t b = a + 1; b < edges.size(); b++)
+		{
+			const float* p2 = points + 2 * edges[b];
+			const float* q2 = p2 + 2;
+			if(GetOrientation(p1, q1, p2) * GetOrientation(p1, q1, q2) < 0 && GetOrientation(p2, q2, p1) * GetOrientation(p2, q2, q1) < 0)
+			{
+				return true;
+			}
+		}
+	}
+
+	return false;
+}
+
+TEST(ASquareIsTwoTriangles)
+{
+	TestPolygon square;
+	square.AddRing({ 0, 0, 10, 0, 10, 10, 0, 10 });
+
+	std::vector<uint32_t> triangles(3, 7);
+	CHECK_EQUAL(2, square.Tessellate(&triangles));
+
+	// triangles are appended after the existing indices
+	CHECK_EQUAL(9, triangles.size());
+	CHECK_EQUAL(7, triangles[0]);
+	triangles.erase(triangles.begin(), triangles.begin() + 3);
+	CHECK_CLOSE(100, GetTrianglesArea(square.Coordinates, triangles), 1e-9);
+}
+
+TEST(HolesAndIslandsInHolesAreFilledAlternately)
+{
+	// the rings are wound either way, as Direct2D does not read the winding in the Alternate fill mode
+	TestPolygon polygon;
+	polygon.AddRing({ 0, 0, 100, 0, 100, 100, 0, 100 });
+	polygon.AddRing({ 10, 10, 10, 90, 90, 90, 90, 10 });
+	polygon.AddRing({ 40, 40, 60, 40, 60, 60, 40, 60 });
+	polygon.AddRing({ 95, 95, 98, 95, 98, 98 });
+
+	std::vector<uint32_t> triangles;
+	CHECK(polygon.Tessellate(&triangles) > 0);
+	CHECK_CLOSE(10000 - 6400 + 400 - 4.5, GetTrianglesArea(polygon.Coordinates, triangles), 1e-6);
+	CHECK_EQUAL(0, CountStrayTriangles(polygon.Coordinates, polygon.RingOffsets, triangles));
+}
+
+TEST(RingsWithoutAreaAreSkipped)
+{
+	TestPolygon polygon;
+	polygon.AddRing({ 5, 5 });
+	polygon.AddRing({ 0, 0, 4, 0, 4, 4 });
+	polygon.AddRing({ 1, 1, 2, 2 });
+
+	std::vector<uint32_t> triangles;
+	CHECK_EQUAL(1, polygon.Tessellate(&triangles));
+
+	TestPolygon empty;
+	CHECK_EQUAL(0, empty.Tessellate(&triangles));
+	CHECK_EQUAL(3, triangles.size());
+}
+
+TEST(CrossingRingsAreLeftToThePathFill)
+{
+	std::vector<uint32_t> triangles(6, 1);
+
+	TestPolygon bowTie;
+	bowTie.AddRing({ 0, 0, 10, 10, 10, 0, 0, 10 });
+	CHECK_EQUAL(0, bowTie.Tessellate(&triangles));
+
+	TestPolygon overlapping;
+	overlapping.AddRing({ 0, 0, 10, 0, 10, 10, 0, 10 });
+	overlapping.AddRing({ 5, 5, 15, 5, 15, 15, 5, 15 });
+	CHECK_EQUAL(0, overlapping.Tessellate(&triangles));
+
+	// nothing is appended
+	CHECK_EQUAL(6, triangles.size());
+}
+
+TEST(TheOutlinesOfTheWorldAreCoveredExactly)
+{
+	std::vector<uint8_t> data;
+	D2DShapefileGeometry geometry;
+	CHECK(NativeTest::ReadFile(NativeTest::GetDataPath("world.shp"), &data) && D2DShapefileReader::ReadShapes(data.data(), data.size(), &geometry));
+
+	size_t recordCount = geometry.PartOffsets.size() - 1;
+	size_t polygonCount = 0;
+	size_t tessellatedCount = 0;
+	size_t strayCount = 0;
+	double maxAreaError = 0;
+	bool isInRange = true;
+	bool isRejectionCrossing = true;
+
+	for(size_t record = 0; record < recordCount; record++)
+	{
+		uint32_t firstPart = geometry.PartOffsets[record];
+		uint32_t lastPart = geometry.PartOffsets[record + 1];
+		if(firstPart == lastPart)
+		{
+			continue;
+		}
+
+		polygonCount++;
+		uint32_t firstPoint = geometry.PointOffsets[firstPart];
+		uint32_t pointCount = geometry.PointOffsets[lastPart] - firstPoint;
+
+		std::vector<float> coordinates(geometry.Coordinates.begin() + 2 * firstPoint, geometry.Coordinates.begin() + 2 * (firstPoint + pointCount));
+		std::vector<uint32_t> ringOffsets;
+		for(uint32_t part = firstPart; part <= lastPart; part++)
+		{
+			ringOffsets.push_back(geometry.PointOffsets[part] - firstPoint);
+		}
+
+		// the rings of a shapefile are wound one way around the area and the other way around holes, so the signed
+		// areas of the rings add up to the area of the polygon without any test of containment
+		double area = 0;
+		for(size_t r = 0; r + 1 < ringOffsets.size(); r++)
+		{
+			for(uint32_t i = ringOffsets[r], j = ringOffsets[r + 1] - 1; i < ringOffsets[r + 1]; j = i++)
+			{
+				area += (static_cast<double>(coordinates[2 * j]) - coordinates[2 * i]) * (static_cast<double>(coordinates[2 * j + 1]) + coordinates[2 * i + 1]) / 2;
+			}
+		}
+
+		area = std::fabs(area);
+
+		std::vector<uint32_t> triangles;
+		if(D2DTessellator::Tessellate(coordinates.data(), ringOffsets.data(), ringOffsets.size() - 1, &triangles) == 0)
+		{
+			isRejectionCrossing &= HasCrossingEdges(coordinates, ringOffsets);
+			continue;
+		}
+
+		tessellatedCount++;
+		for(auto index = triangles.begin(); index != triangles.end(); ++index)
+		{
+			isInRange &= *index < pointCount;
+		}
+
+		maxAreaError = (std::max)(maxAreaError, std::fabs(GetTrianglesArea(coordinates, triangles) - area) / area);
+		strayCount += CountStrayTriangles(coordinates, ringOffsets, triangles);
+	}
+
+	// the null shapes of the sample own no parts
+	// a few outlines of the sample cross themselves over an area large enough to be left to the path fill
+	CHECK_EQUAL(172, polygonCount);
+	CHECK_EQUAL(169, tessellatedCount);
+	CHECK(isRejectionCrossing);
+	CHECK(isInRange);
+	CHECK(maxAreaError < 1e-9);
+	CHECK_EQUAL(0, strayCount);
+}
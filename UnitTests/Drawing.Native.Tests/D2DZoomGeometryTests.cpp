@@ -0,0 +1,73 @@
+#include "NativeTest.h"
+#include "D2DZoomGeometry.h"
+#include "D2DPointKernels.h"
+
+using namespace Telerik::UI::Drawing;
+
+TEST(ModelSpaceGeometryIsKeptAtEveryZoomFactor)
+{
+	CHECK(D2DZoomGeometry::GetZoomAction(true, 1, 1) == D2DZoomAction::Keep);
+	CHECK(D2DZoomGeometry::GetZoomAction(true, 1, 1000) == D2DZoomAction::Keep);
+}
+
+TEST(PixelSpaceGeometryIsTransformedWithinItsZoomBand)
+{
+	// four bands per octave, so a factor of 2^(1/8) either way stays within the band of 1
+	CHECK(D2DZoomGeometry::GetZoomAction(false, 1, 1.05) == D2DZoomAction::Transform);
+	CHECK(D2DZoomGeometry::GetZoomAction(false, 1, 0.95) == D2DZoomAction::Transform);
+	CHECK(D2DZoomGeometry::GetZoomAction(false, 1, 1.25) == D2DZoomAction::Rebuild);
+	CHECK(D2DZoomGeometry::GetZoomAction(false, 1, 0.8) == D2DZoomAction::Rebuild);
+
+	// geometry that was never built has no band
+	CHECK(D2DZoomGeometry::GetZoomAction(false, 0, 1) == D2DZoomAction::Rebuild);
+}
+
+TEST(ZoomBandsAreQuarterOctaves)
+{
+	CHECK_EQUAL(0, D2DZoomGeometry::GetZoomBand(1));
+	CHECK_EQUAL(4, D2DZoomGeometry::GetZoomBand(2));
+	CHECK_EQUAL(-4, D2DZoomGeometry::GetZoomBand(0.5));
+	CHECK_EQUAL(40, D2DZoomGeometry::GetZoomBand(1024));
+	CHECK_EQUAL(0, D2DZoomGeometry::GetZoomBand(0));
+}
+
+TEST(RingPointsWithoutRanksMatchTheTransformKernel)
+{
+	const double coordinates[] = { 0, 0, 1.5, -2, 3.25, 4, -7, 8.5, 10, 10 };
+	const size_t count = 5;
+
+	float expected[2 * count];
+	D2DPointKernels::TransformPoints(coordinates, count, 3, -10, 20, expected);
+
+	float output[2 * count];
+	CHECK_EQUAL(count, D2DZoomGeometry::BuildRingPoints(coordinates, nullptr, count, 3, -10, 20, 0.5f, output));
+	for(size_t i = 0; i < 2 * count; i++)
+	{
+		CHECK_EQUAL(expected[i], output[i]);
+	}
+
+	// a zero tolerance keeps every ranked point as well
+	const float ranks[] = { 10, 0, 0.1f, 0, 10 };
+	CHECK_EQUAL(count, D2DZoomGeometry::BuildRingPoints(coordinates, ranks, count, 3, -10, 20, 0, output));
+}
+
+TEST(RingPointsRankedBelowTheToleranceAreLeftOut)
+{
+	const double coordinates[] = { 0, 0, 1, 1, 2, 0, 3, 1, 4, 0 };
+	const float ranks[] = { 100, 0.01f, 2, 0.5f, 100 };
+
+	// at a zoom factor of 1 the tolerance is a quarter of a pixel, so only the point ranked 0.01 is left out
+	float tolerance = D2DZoomGeometry::GetSimplificationTolerance(1);
+	CHECK_CLOSE(0.25, tolerance, 1e-7);
+
+	float output[10];
+	CHECK_EQUAL(static_cast<size_t>(4), D2DZoomGeometry::BuildRingPoints(coordinates, ranks, 5, 1, 0, 0, tolerance, output));
+	CHECK_EQUAL(2.0f, output[2]);
+	CHECK_EQUAL(3.0f, output[4]);
+
+	// zoomed out by 8 the tolerance is 2, which leaves out the point ranked 0.5 as well
+	float farTolerance = D2DZoomGeometry::GetSimplificationTolerance(0.125);
+	CHECK_EQUAL(static_cast<size_t>(3), D2DZoomGeometry::BuildRingPoints(coordinates, ranks, 5, 0.125, 0, 0, farTolerance, output));
+	CHECK_EQUAL(0.5f, output[4]);
+	CHECK_EQUAL(0.0f, output[5]);
+}
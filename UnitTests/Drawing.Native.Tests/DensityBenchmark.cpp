@@ -0,0 +1,74 @@
+#include "NativeTest.h"
+#include "D2DDensityGrid.h"
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+
+using namespace Telerik::UI::Drawing;
+
+// accumulates the 256 pixel tiles of a 1920 x 1080 viewport over weighted points in the 512 unit world of RadMap, as
+// D2DHeatmap does when the zoom factor changes, and measures the scale of the heatmap at that zoom
+int main(int argc, char** argv)
+{
+	size_t count = argc > 1 ? static_cast<size_t>(atol(argv[1])) : 1000000;
+
+	std::mt19937 random(11);
+	std::uniform_real_distribution<double> uniform(0, 512);
+	std::normal_distribution<double> spread(0, 3);
+	std::vector<double> coordinates(2 * count);
+	for(size_t i = 0; i < count; i++)
+	{
+		// half of the points around a city at the center of the viewport
+		bool isCity = i % 2 == 0;
+		coordinates[2 * i] = isCity ? 256 + spread(random) : uniform(random);
+		coordinates[2 * i + 1] = isCity ? 256 + spread(random) : uniform(random);
+	}
+
+	D2DDensityGrid grid;
+	double setSeconds = NativeTest::Measure(3, [&]()
+	{
+		grid.SetPoints(coordinates.data(), nullptr, count);
+	});
+
+	std::printf("%zu points, set %.1f ms\n", count, setSeconds * 1000);
+
+	const uint32_t tileSize = 256;
+	const float radius = 20;
+	for(int level = 2; level <= 8; level += 2)
+	{
+		double zoomFactor = 1 << level;
+
+		// the tiles of the viewport centered on the city
+		int firstX = static_cast<int>(floor((256 * zoomFactor - 960) / tileSize));
+		int firstY = static_cast<int>(floor((256 * zoomFactor - 540) / tileSize));
+		int lastX = static_cast<int>(floor((256 * zoomFactor + 960) / tileSize));
+		int lastY = static_cast<int>(floor((256 * zoomFactor + 540) / tileSize));
+
+		std::vector<D2DDensityTile> tiles;
+		std::vector<float> values(static_cast<size_t>(lastX - firstX + 1) * (lastY - firstY + 1) * tileSize * tileSize);
+		for(int y = firstY; y <= lastY; y++)
+		{
+			for(int x = firstX; x <= lastX; x++)
+			{
+				D2DDensityTile tile = { x, y, &values[tiles.size() * tileSize * tileSize], 0 };
+				tiles.push_back(tile);
+			}
+		}
+
+		double tileSeconds = NativeTest::Measure(5, [&]()
+		{
+			grid.AccumulateTiles(tiles.data(), tiles.size(), tileSize, zoomFactor, radius);
+		});
+
+		float maxDensity = 0;
+		double maxSeconds = NativeTest::Measure(3, [&]()
+		{
+			maxDensity = grid.GetMaxDensity(zoomFactor, radius);
+		});
+
+		std::printf("zoom level %d: %zu tiles %.1f ms (%.2f ms a tile), max density %.0f in %.1f ms\n",
+			level, tiles.size(), tileSeconds * 1000, tileSeconds * 1000 / tiles.size(), maxDensity, maxSeconds * 1000);
+	}
+
+	return 0;
+}
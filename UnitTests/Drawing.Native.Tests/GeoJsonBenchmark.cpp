@@ -0,0 +1,95 @@
+#include "NativeTest.h"
+#include "D2DGeoJsonReader.h"
+#include "D2DShapefileReader.h"
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+
+using namespace Telerik::UI::Drawing;
+
+// writes the polygons of the world sample as GeoJSON features with a few properties, compact or indented as the
+// exports of GIS tools usually are
+static void AppendWorld(const D2DShapefileGeometry& geometry, size_t copy, bool isIndented, std::string* json)
+{
+	const char* newLine = isIndented ? "\n" : "";
+	const char* indent = isIndented ? "        " : "";
+	char buffer[256];
+
+	for(size_t record = 0; record + 1 < geometry.PartOffsets.size(); record++)
+	{
+		uint32_t firstPart = geometry.PartOffsets[record];
+		uint32_t lastPart = geometry.PartOffsets[record + 1];
+
+		snprintf(buffer, sizeof(buffer), "%s{%s%s\"type\": \"Feature\",%s%s\"properties\": { \"name\": \"country %zu\", \"copy\": %zu, \"area\": %.2f },%s%s\"geometry\": ",
+			json->back() == '[' ? "" : ",", newLine, indent, newLine, indent, record, copy, record * 1234.5, newLine, indent);
+		json->append(buffer);
+
+		if(firstPart == lastPart)
+		{
+			json->append("null");
+		}
+		else
+		{
+			json->append("{ \"type\": \"Polygon\", \"coordinates\": [");
+			for(uint32_t part = firstPart; part < lastPart; part++)
+			{
+				json->append(part > firstPart ? ", [" : "[");
+				for(uint32_t point = geometry.PointOffsets[part]; point < geometry.PointOffsets[part + 1]; point++)
+				{
+					snprintf(buffer, sizeof(buffer), "%s%s%s[%.6f, %.6f]", point > geometry.PointOffsets[part] ? "," : "", newLine, indent,
+						geometry.Coordinates[2 * point], geometry.Coordinates[2 * point + 1]);
+					json->append(buffer);
+				}
+
+				json->append("]");
+			}
+
+			json->append("] }");
+		}
+
+		json->append(newLine);
+		json->append("}");
+	}
+}
+
+// reads a FeatureCollection of the world sample repeated, compact and indented; the rates are in bytes of the text per second
+int main(int argc, char** argv)
+{
+	size_t copies = argc > 1 ? static_cast<size_t>(atol(argv[1])) : 500;
+
+	std::vector<uint8_t> shapes;
+	D2DShapefileGeometry geometry;
+	if(!NativeTest::ReadFile(NativeTest::GetDataPath("world.shp"), &shapes) || !D2DShapefileReader::ReadShapes(shapes.data(), shapes.size(), &geometry))
+	{
+		std::printf("the sample shapefile is missing\n");
+		return 1;
+	}
+
+	// the features are parsed in parallel, so the rate scales with the hardware threads
+	std::printf("%u hardware threads\n", std::thread::hardware_concurrency());
+
+	for(int isIndented = 0; isIndented <= 1; isIndented++)
+	{
+		std::string json = "{ \"type\": \"FeatureCollection\", \"name\": \"world\", \"features\": [";
+		for(size_t copy = 0; copy < copies; copy++)
+		{
+			AppendWorld(geometry, copy, isIndented != 0, &json);
+		}
+
+		json.append("] }");
+
+		D2DGeoJsonData data;
+		bool isRead = false;
+		double seconds = NativeTest::Measure(5, [&]()
+		{
+			isRead = D2DGeoJsonReader::Read(json.data(), json.size(), &data);
+		});
+
+		double megabytes = json.size() / 1e6;
+		std::printf("%s: %zu features, %zu points, %.1f MB in %.1f ms, %.2f GB/s%s\n",
+			isIndented ? "indented" : "compact ", data.Geometry.FeatureTypes.size(), data.Geometry.Coordinates.size() / 2,
+			megabytes, seconds * 1000, megabytes / seconds / 1000, isRead ? "" : " (not read)");
+	}
+
+	return 0;
+}
@@ -0,0 +1,104 @@
+#include "NativeTest.h"
+#include "D2DIngestPipeline.h"
+#include "D2DLayerCacheFile.h"
+#include "D2DProjection.h"
+#include "D2DShapefileReader.h"
+#include <cstdio>
+#include <cstdlib>
+
+using namespace Telerik::UI::Drawing;
+
+static void CopyBatch(D2DShapefileGeometry* geometry, D2DIngestBatch* batch)
+{
+	for(auto type = geometry->RecordShapeTypes.begin(); type != geometry->RecordShapeTypes.end(); ++type)
+	{
+		batch->Kinds.push_back(*type == 5 ? D2DFeatureKind::Polygon : D2DFeatureKind::None);
+	}
+
+	batch->PartOffsets.swap(geometry->PartOffsets);
+	batch->PointOffsets.swap(geometry->PointOffsets);
+	batch->Coordinates.swap(geometry->Coordinates);
+}
+
+// loads the world sample repeated through the ingest pipeline and through the same stages one after the other, and
+// compares the time until the first features can be shown and until the whole source is loaded
+int main(int argc, char** argv)
+{
+	size_t copies = argc > 1 ? static_cast<size_t>(atol(argv[1])) : 200;
+
+	std::vector<uint8_t> shapes;
+	if(!NativeTest::ReadFile(NativeTest::GetDataPath("world.shp"), &shapes))
+	{
+		std::printf("the sample shapefile is missing\n");
+		return 1;
+	}
+
+	std::vector<uint8_t> data(shapes.begin(), shapes.begin() + 100);
+	for(size_t i = 0; i < copies; i++)
+	{
+		data.insert(data.end(), shapes.begin() + 100, shapes.end());
+	}
+
+	typedef std::chrono::steady_clock Clock;
+
+	// the whole file decoded, projected, ranked and bounded before anything is shown
+	Clock::time_point start = Clock::now();
+	D2DShapefileGeometry geometry;
+	D2DShapefileReader::ReadShapes(data.data(), data.size(), &geometry);
+
+	D2DIngestBatch whole;
+	CopyBatch(&geometry, &whole);
+	D2DProjection::ProjectMercatorInParallel(whole.Coordinates.data(), whole.Coordinates.size() / 2, 512);
+	D2DIngestPipeline::RankBatch(&whole);
+	D2DIngestPipeline::BoundBatch(&whole);
+
+	std::chrono::duration<double> sequential = Clock::now() - start;
+	std::printf("%zu features, %zu points\n", whole.GetFeatureCount(), whole.Coordinates.size() / 2);
+	std::printf("one stage after the other: first features after %.1f ms, all after %.1f ms\n", sequential.count() * 1000, sequential.count() * 1000);
+
+	// the pipeline, in batches of 1024 records
+	start = Clock::now();
+	size_t offset = 0;
+	Clock::time_point firstBatch;
+	size_t featureCount = 0;
+
+	D2DIngestPipeline pipeline;
+	pipeline.Start(
+		[&](D2DIngestBatch* batch)
+		{
+			D2DShapefileGeometry batchGeometry;
+			if(!D2DShapefileReader::ReadShapeBatch(data.data(), data.size(), &offset, 1024, &batchGeometry))
+			{
+				return D2DDecodeResult::Failed;
+			}
+
+			if(batchGeometry.RecordShapeTypes.empty())
+			{
+				return D2DDecodeResult::Done;
+			}
+
+			CopyBatch(&batchGeometry, batch);
+			return D2DDecodeResult::Decoded;
+		},
+		[](D2DIngestBatch* batch) { D2DProjection::ProjectMercator(batch->Coordinates.data(), batch->Coordinates.size() / 2, 512); },
+		[&](std::unique_ptr<D2DIngestBatch> batch)
+		{
+			if(featureCount == 0)
+			{
+				firstBatch = Clock::now();
+			}
+
+			featureCount += batch->GetFeatureCount();
+			return true;
+		},
+		nullptr,
+		0);
+
+	D2DIngestStatus status = pipeline.Wait();
+	std::chrono::duration<double> total = Clock::now() - start;
+	std::chrono::duration<double> first = firstBatch - start;
+	std::printf("pipeline: first features after %.1f ms, all %zu after %.1f ms%s\n",
+		first.count() * 1000, featureCount, total.count() * 1000, status == D2DIngestStatus::Completed ? "" : " (not completed)");
+
+	return 0;
+}
@@ -0,0 +1,72 @@
+#include "NativeTest.h"
+#include "D2DLayerCacheFile.h"
+#include "D2DShapefileReader.h"
+#include <cstdio>
+#include <cstdlib>
+
+using namespace Telerik::UI::Drawing;
+
+// the start of a layer from its cache against decoding and ranking its shapefile again, for the world sample repeated:
+// opening the cache and querying a viewport only touches the header, the offsets and the pages the query needs
+int main(int argc, char** argv)
+{
+	size_t copies = argc > 1 ? static_cast<size_t>(atol(argv[1])) : 200;
+
+	std::vector<uint8_t> shapes;
+	if(!NativeTest::ReadFile(NativeTest::GetDataPath("world.shp"), &shapes))
+	{
+		std::printf("the sample shapefile is missing\n");
+		return 1;
+	}
+
+	std::vector<uint8_t> data(shapes.begin(), shapes.begin() + 100);
+	for(size_t i = 0; i < copies; i++)
+	{
+		data.insert(data.end(), shapes.begin() + 100, shapes.end());
+	}
+
+	// the first start: the shapefile is decoded and the points are ranked for simplification
+	D2DShapefileGeometry geometry;
+	std::vector<float> ranks;
+	double decodeSeconds = NativeTest::Measure(3, [&]()
+	{
+		D2DShapefileReader::ReadShapes(data.data(), data.size(), &geometry);
+
+		ranks.resize(geometry.Coordinates.size() / 2);
+		for(size_t part = 0; part + 1 < geometry.PointOffsets.size(); part++)
+		{
+			uint32_t first = geometry.PointOffsets[part];
+			D2DLayerCacheWriter::RankPoints(&geometry.Coordinates[2 * static_cast<size_t>(first)], geometry.PointOffsets[part + 1] - first, &ranks[first]);
+		}
+	});
+
+	std::vector<D2DFeatureKind> kinds;
+	for(auto type = geometry.RecordShapeTypes.begin(); type != geometry.RecordShapeTypes.end(); ++type)
+	{
+		kinds.push_back(*type == 5 ? D2DFeatureKind::Polygon : D2DFeatureKind::None);
+	}
+
+	D2DFeatureSource source = { kinds.size(), kinds.data(), geometry.PartOffsets.data(), geometry.PointOffsets.data(), geometry.Coordinates.data() };
+	auto path = NativeTest::GetOutputPath("benchmark.layercache");
+
+	double writeSeconds = NativeTest::Measure(1, [&]()
+	{
+		D2DLayerCacheWriter::Write(source, 1, path.c_str());
+	});
+
+	// the later starts: the cache is mapped and the viewport queried
+	D2DLayerCacheReader reader;
+	std::vector<uint32_t> features;
+	double openSeconds = NativeTest::Measure(10, [&]()
+	{
+		reader.Open(path.c_str(), 1);
+		features.clear();
+		reader.Query(0, 40, 20, 55, &features);
+	});
+
+	std::printf("%zu features, %zu points\n", kinds.size(), geometry.Coordinates.size() / 2);
+	std::printf("decode and rank %.1f ms, write the cache %.1f ms\n", decodeSeconds * 1000, writeSeconds * 1000);
+	std::printf("open the cache and query %zu features %.2f ms\n", features.size(), openSeconds * 1000);
+
+	return 0;
+}
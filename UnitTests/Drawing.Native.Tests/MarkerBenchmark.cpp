@@ -0,0 +1,47 @@
+#include "NativeTest.h"
+#include "D2DMarkerAtlas.h"
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+
+using namespace Telerik::UI::Drawing;
+
+// builds the sprite list of a frame of markers drawn from a few symbols of the atlas, as D2DShapeLayer does before it
+// hands the list to a single sprite batch call
+int main(int argc, char** argv)
+{
+	size_t count = argc > 1 ? static_cast<size_t>(atol(argv[1])) : 1000000;
+
+	D2DMarkerAtlas atlas;
+	atlas.Reset(1024, 1024);
+
+	const int symbolCount = 16;
+	for(int i = 0; i < symbolCount; i++)
+	{
+		atlas.AddSymbol(8 + i, 8 + i);
+	}
+
+	std::mt19937 random(5);
+	std::uniform_real_distribution<float> position(0, 1920);
+	std::vector<float> locations(2 * count);
+	for(size_t i = 0; i < locations.size(); i++)
+	{
+		locations[i] = position(random);
+	}
+
+	for(size_t markerCount = count / 100; markerCount <= count; markerCount *= 10)
+	{
+		double seconds = NativeTest::Measure(10, [&]()
+		{
+			atlas.ClearSprites();
+			for(size_t i = 0; i < markerCount; i++)
+			{
+				atlas.AddSprite(locations[2 * i], locations[2 * i + 1], static_cast<int>(i % symbolCount));
+			}
+		});
+
+		std::printf("%8zu markers: sprite list %8.3f ms, %.1f ns a marker\n", markerCount, seconds * 1000, seconds * 1e9 / markerCount);
+	}
+
+	return 0;
+}
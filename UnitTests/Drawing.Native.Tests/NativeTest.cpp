@@ -0,0 +1,77 @@
+#include "NativeTest.h"
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+
+namespace NativeTest
+{
+	struct TestCase
+	{
+		const char* Name;
+		TestBody Body;
+	};
+
+	static std::vector<TestCase>& GetTests()
+	{
+		static std::vector<TestCase> tests;
+		return tests;
+	}
+
+	static int failureCount = 0;
+
+	Registration::Registration(const char* name, TestBody body)
+	{
+		TestCase test = { name, body };
+		GetTests().push_back(test);
+	}
+
+	void Fail(const char* file, int line, const char* expression)
+	{
+		std::printf("%s(%d): check failed: %s\n", file, line, expression);
+		failureCount++;
+	}
+
+	std::string GetDataPath(const char* fileName)
+	{
+		return std::string(DRAWING_TEST_DATA_DIR) + "/" + fileName;
+	}
+
+#ifdef _WIN32
+	std::wstring GetOutputPath(const char* fileName)
+	{
+		std::string path = std::string(DRAWING_TEST_OUTPUT_DIR) + "/" + fileName;
+		return std::wstring(path.begin(), path.end());
+	}
+#else
+	std::string GetOutputPath(const char* fileName)
+	{
+		return std::string(DRAWING_TEST_OUTPUT_DIR) + "/" + fileName;
+	}
+#endif
+
+	bool ReadFile(const std::string& path, std::vector<uint8_t>* data)
+	{
+		std::ifstream stream(path.c_str(), std::ios::binary);
+		if(!stream)
+		{
+			return false;
+		}
+
+		data->assign(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+		return true;
+	}
+
+	int RunTests()
+	{
+		std::vector<TestCase>& tests = GetTests();
+		for(auto test = tests.begin(); test != tests.end(); ++test)
+		{
+			int failuresBefore = failureCount;
+			test->Body();
+			std::printf("%s %s\n", failureCount == failuresBefore ? "passed" : "FAILED", test->Name);
+		}
+
+		std::printf("%d check(s) failed\n", failureCount);
+		return failureCount;
+	}
+}
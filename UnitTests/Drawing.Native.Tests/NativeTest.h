@@ -0,0 +1,66 @@
+#pragma once
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// a minimal test runner for the portable classes of the drawing library: each test file is an executable of its own,
+// whose TEST bodies run in the order they are defined and whose exit code is the number of failed checks. The benchmarks
+// are executables of their own too, which print their measurements instead of checking them
+namespace NativeTest
+{
+	typedef void (*TestBody)();
+
+	struct Registration
+	{
+		Registration(const char* name, TestBody body);
+	};
+
+	void Fail(const char* file, int line, const char* expression);
+
+	// runs the registered tests and returns the number of failed checks
+	int RunTests();
+
+	// the path of a file in the sample data of the repository
+	std::string GetDataPath(const char* fileName);
+
+	// the path of a file the tests write in the build directory, in the characters the file classes of the library take
+#ifdef _WIN32
+	std::wstring GetOutputPath(const char* fileName);
+#else
+	std::string GetOutputPath(const char* fileName);
+#endif
+
+	// returns false if the file cannot be read
+	bool ReadFile(const std::string& path, std::vector<uint8_t>* data);
+
+	// the shortest of the runs, in seconds; the first run warms the caches and is not measured
+	template<class Body> double Measure(int runs, Body body)
+	{
+		body();
+
+		double best = 1e300;
+		for(int i = 0; i < runs; i++)
+		{
+			auto start = std::chrono::steady_clock::now();
+			body();
+			std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+			best = elapsed.count() < best ? elapsed.count() : best;
+		}
+
+		return best;
+	}
+}
+
+#define TEST(name) \
+	static void name(); \
+	static NativeTest::Registration name##Registration(#name, name); \
+	static void name()
+
+#define CHECK(expression) \
+	do { if(!(expression)) { NativeTest::Fail(__FILE__, __LINE__, #expression); } } while(false)
+
+#define CHECK_EQUAL(expected, actual) CHECK((expected) == (actual))
+#define CHECK_CLOSE(expected, actual, tolerance) CHECK(std::fabs(static_cast<double>(expected) - static_cast<double>(actual)) <= (tolerance))
@@ -0,0 +1,6 @@
+#include "NativeTest.h"
+
+int main()
+{
+	return NativeTest::RunTests();
+}
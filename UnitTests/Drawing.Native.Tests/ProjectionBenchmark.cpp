@@ -0,0 +1,60 @@
+#include "NativeTest.h"
+#include "D2DProjection.h"
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+
+using namespace Telerik::UI::Drawing;
+
+// projects points spread over the latitudes RadMap shows with the bulk projection, sequentially and over the hardware
+// threads, and with the scalar formula point by point as the managed code does
+int main(int argc, char** argv)
+{
+	size_t count = argc > 1 ? static_cast<size_t>(atol(argv[1])) : 4000000;
+
+	std::mt19937 random(3);
+	std::uniform_real_distribution<double> longitude(-180, 180);
+	std::uniform_real_distribution<double> latitude(-85, 85);
+	std::vector<double> source(2 * count);
+	for(size_t i = 0; i < count; i++)
+	{
+		source[2 * i] = longitude(random);
+		source[2 * i + 1] = latitude(random);
+	}
+
+	std::vector<double> coordinates(source.size());
+
+	// each run projects a fresh copy, whose cost is measured on its own and taken out
+	double copySeconds = NativeTest::Measure(5, [&]()
+	{
+		coordinates.assign(source.begin(), source.end());
+	});
+
+	double scalarSeconds = NativeTest::Measure(5, [&]()
+	{
+		coordinates.assign(source.begin(), source.end());
+		for(size_t i = 0; i < count; i++)
+		{
+			D2DProjection::ProjectMercatorPoint(&coordinates[2 * i], 512);
+		}
+	}) - copySeconds;
+
+	double bulkSeconds = NativeTest::Measure(5, [&]()
+	{
+		coordinates.assign(source.begin(), source.end());
+		D2DProjection::ProjectMercator(coordinates.data(), count, 512);
+	}) - copySeconds;
+
+	double parallelSeconds = NativeTest::Measure(5, [&]()
+	{
+		coordinates.assign(source.begin(), source.end());
+		D2DProjection::ProjectMercatorInParallel(coordinates.data(), count, 512);
+	}) - copySeconds;
+
+	std::printf("%zu points\n", count);
+	std::printf("scalar formula %7.1f ms, %6.1f M points/s\n", scalarSeconds * 1000, count / scalarSeconds / 1e6);
+	std::printf("bulk           %7.1f ms, %6.1f M points/s, %.1fx\n", bulkSeconds * 1000, count / bulkSeconds / 1e6, scalarSeconds / bulkSeconds);
+	std::printf("bulk, parallel %7.1f ms, %6.1f M points/s, %.1fx\n", parallelSeconds * 1000, count / parallelSeconds / 1e6, scalarSeconds / parallelSeconds);
+
+	return 0;
+}
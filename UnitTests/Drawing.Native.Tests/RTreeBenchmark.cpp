@@ -0,0 +1,86 @@
+#include "NativeTest.h"
+#include "D2DFeatureStream.h"
+#include "D2DPackedRTree.h"
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+
+using namespace Telerik::UI::Drawing;
+
+// writes a feature file of small polygons scattered over the 512 unit world of RadMap and queries viewports of a
+// decreasing size from the mapped file, against a scan of the bounds of all features
+int main(int argc, char** argv)
+{
+	size_t count = argc > 1 ? static_cast<size_t>(atol(argv[1])) : 1000000;
+
+	// squares of 5 points
+	std::mt19937 random(13);
+	std::uniform_real_distribution<double> position(0, 512);
+	std::vector<D2DFeatureKind> kinds(count, D2DFeatureKind::Polygon);
+	std::vector<uint32_t> partOffsets(count + 1);
+	std::vector<uint32_t> pointOffsets(count + 1);
+	std::vector<double> coordinates(10 * count);
+	std::vector<D2DRTreeNode> boxes(count);
+	for(size_t i = 0; i < count; i++)
+	{
+		partOffsets[i] = static_cast<uint32_t>(i);
+		pointOffsets[i] = static_cast<uint32_t>(5 * i);
+
+		double x = position(random);
+		double y = position(random);
+		double corners[] = { x, y, x + 0.05, y, x + 0.05, y + 0.05, x, y + 0.05, x, y };
+		std::copy(corners, corners + 10, &coordinates[10 * i]);
+
+		D2DRTreeNode box = { x, y, x + 0.05, y + 0.05, i };
+		boxes[i] = box;
+	}
+
+	partOffsets[count] = static_cast<uint32_t>(count);
+	pointOffsets[count] = static_cast<uint32_t>(5 * count);
+
+	D2DFeatureSource source = { count, kinds.data(), partOffsets.data(), pointOffsets.data(), coordinates.data() };
+	auto path = NativeTest::GetOutputPath("benchmark.features");
+
+	double writeSeconds = NativeTest::Measure(1, [&]()
+	{
+		D2DFeatureStreamWriter::Write(source, path.c_str());
+	});
+
+	D2DFeatureStreamReader reader;
+	if(!reader.Open(path.c_str()))
+	{
+		std::printf("the feature file cannot be opened\n");
+		return 1;
+	}
+
+	std::printf("%zu features, written in %.1f ms\n", count, writeSeconds * 1000);
+
+	std::vector<uint32_t> features;
+	for(double size = 256; size >= 0.25; size /= 4)
+	{
+		double minX = 256 - size / 2;
+		double minY = 256 - size / 2;
+
+		double querySeconds = NativeTest::Measure(10, [&]()
+		{
+			features.clear();
+			reader.Query(minX, minY, minX + size, minY + size, &features);
+		});
+
+		size_t scanCount = 0;
+		double scanSeconds = NativeTest::Measure(3, [&]()
+		{
+			scanCount = 0;
+			for(size_t i = 0; i < count; i++)
+			{
+				const D2DRTreeNode& box = boxes[i];
+				scanCount += box.MaxX < minX || box.MaxY < minY || box.MinX > minX + size || box.MinY > minY + size ? 0 : 1;
+			}
+		});
+
+		std::printf("viewport of %6.2f units: %7zu features, query %9.1f us, scan %9.1f us, %s\n",
+			size, features.size(), querySeconds * 1e6, scanSeconds * 1e6, features.size() == scanCount ? "same" : "DIFFERENT");
+	}
+
+	return 0;
+}
@@ -0,0 +1,75 @@
+#include "NativeTest.h"
+#include "D2DShapefileReader.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+using namespace Telerik::UI::Drawing;
+
+// decodes a large shapefile, synthesized from the records of the world sample repeated, as a whole and in the batches
+// of the streaming import, and its table; the rates are in bytes of the file per second
+int main(int argc, char** argv)
+{
+	size_t copies = argc > 1 ? static_cast<size_t>(atol(argv[1])) : 1000;
+
+	std::vector<uint8_t> shapes;
+	std::vector<uint8_t> table;
+	if(!NativeTest::ReadFile(NativeTest::GetDataPath("world.shp"), &shapes) || !NativeTest::ReadFile(NativeTest::GetDataPath("world.dbf"), &table))
+	{
+		std::printf("the sample shapefile is missing\n");
+		return 1;
+	}
+
+	// the records follow the header of 100 bytes; their numbers are not read, so the copies keep them
+	std::vector<uint8_t> data(shapes.begin(), shapes.begin() + 100);
+	for(size_t i = 0; i < copies; i++)
+	{
+		data.insert(data.end(), shapes.begin() + 100, shapes.end());
+	}
+
+	// the records of the table follow its header; the record count is a little-endian 32-bit value at offset 4
+	size_t headerLength = table[8] | (table[9] << 8);
+	size_t recordLength = table[10] | (table[11] << 8);
+	size_t recordCount = (table.size() - headerLength) / recordLength;
+	std::vector<uint8_t> records(table.begin() + headerLength, table.begin() + headerLength + recordCount * recordLength);
+	table.resize(headerLength);
+	for(size_t i = 0; i < copies; i++)
+	{
+		table.insert(table.end(), records.begin(), records.end());
+	}
+
+	uint32_t tableRecordCount = static_cast<uint32_t>(recordCount * copies);
+	memcpy(&table[4], &tableRecordCount, 4);
+
+	D2DShapefileGeometry geometry;
+	double wholeSeconds = NativeTest::Measure(5, [&]()
+	{
+		D2DShapefileReader::ReadShapes(data.data(), data.size(), &geometry);
+	});
+
+	double megabytes = data.size() / 1e6;
+	std::printf("%zu records, %zu points, %.1f MB: whole file %.1f ms, %.0f MB/s\n",
+		geometry.RecordShapeTypes.size(), geometry.Coordinates.size() / 2, megabytes, wholeSeconds * 1000, megabytes / wholeSeconds);
+
+	D2DShapefileGeometry batch;
+	double batchSeconds = NativeTest::Measure(5, [&]()
+	{
+		size_t offset = 0;
+		while(D2DShapefileReader::ReadShapeBatch(data.data(), data.size(), &offset, 4096, &batch) && !batch.RecordShapeTypes.empty())
+		{
+		}
+	});
+
+	std::printf("batches of 4096 records %.1f ms, %.0f MB/s\n", batchSeconds * 1000, megabytes / batchSeconds);
+
+	D2DDbfTable columns;
+	double tableSeconds = NativeTest::Measure(5, [&]()
+	{
+		D2DShapefileReader::ReadTable(table.data(), table.size(), &columns);
+	});
+
+	double tableMegabytes = table.size() / 1e6;
+	std::printf("table of %zu records, %.1f MB: %.1f ms, %.0f MB/s\n", columns.RecordCount, tableMegabytes, tableSeconds * 1000, tableMegabytes / tableSeconds);
+
+	return 0;
+}
@@ -0,0 +1,112 @@
+#include "NativeTest.h"
+#include "D2DTessellator.h"
+#include "D2DShapefileReader.h"
+#include <cstdio>
+#include <cstdlib>
+
+using namespace Telerik::UI::Drawing;
+
+struct BenchmarkPolygon
+{
+	std::vector<float> Coordinates;
+	std::vector<uint32_t> RingOffsets;
+};
+
+// the polygon with the edges of the outline split into the number of pieces, which keeps it free of crossings
+static BenchmarkPolygon Densify(const BenchmarkPolygon& polygon, size_t pieces)
+{
+	BenchmarkPolygon dense;
+	dense.RingOffsets.push_back(0);
+	for(size_t r = 0; r + 1 < polygon.RingOffsets.size(); r++)
+	{
+		for(uint32_t i = polygon.RingOffsets[r]; i + 1 < polygon.RingOffsets[r + 1]; i++)
+		{
+			for(size_t k = 0; k < pieces; k++)
+			{
+				float t = static_cast<float>(k) / pieces;
+				dense.Coordinates.push_back(polygon.Coordinates[2 * i] + t * (polygon.Coordinates[2 * i + 2] - polygon.Coordinates[2 * i]));
+				dense.Coordinates.push_back(polygon.Coordinates[2 * i + 1] + t * (polygon.Coordinates[2 * i + 3] - polygon.Coordinates[2 * i + 1]));
+			}
+		}
+
+		dense.RingOffsets.push_back(static_cast<uint32_t>(dense.Coordinates.size() / 2));
+	}
+
+	return dense;
+}
+
+// tessellates the outlines of the world sample, as the meshes of a shape layer are built once when it is loaded, and the
+// largest of them with its edges split, to show how the ear search scales with the points of a polygon
+int main(int argc, char** argv)
+{
+	size_t pieces = argc > 1 ? static_cast<size_t>(atol(argv[1])) : 16;
+
+	std::vector<uint8_t> data;
+	D2DShapefileGeometry geometry;
+	if(!NativeTest::ReadFile(NativeTest::GetDataPath("world.shp"), &data) || !D2DShapefileReader::ReadShapes(data.data(), data.size(), &geometry))
+	{
+		std::printf("the sample shapefile is missing\n");
+		return 1;
+	}
+
+	std::vector<BenchmarkPolygon> polygons;
+	size_t largest = 0;
+	size_t pointCount = 0;
+	for(size_t record = 0; record + 1 < geometry.PartOffsets.size(); record++)
+	{
+		uint32_t firstPart = geometry.PartOffsets[record];
+		uint32_t lastPart = geometry.PartOffsets[record + 1];
+		if(firstPart == lastPart)
+		{
+			continue;
+		}
+
+		uint32_t firstPoint = geometry.PointOffsets[firstPart];
+		BenchmarkPolygon polygon;
+		polygon.Coordinates.assign(geometry.Coordinates.begin() + 2 * firstPoint, geometry.Coordinates.begin() + 2 * geometry.PointOffsets[lastPart]);
+		for(uint32_t part = firstPart; part <= lastPart; part++)
+		{
+			polygon.RingOffsets.push_back(geometry.PointOffsets[part] - firstPoint);
+		}
+
+		pointCount += polygon.Coordinates.size() / 2;
+		if(polygons.empty() || polygon.Coordinates.size() > polygons[largest].Coordinates.size())
+		{
+			largest = polygons.size();
+		}
+
+		polygons.push_back(polygon);
+	}
+
+	std::vector<uint32_t> triangles;
+	size_t triangleCount = 0;
+	double worldSeconds = NativeTest::Measure(20, [&]()
+	{
+		triangleCount = 0;
+		for(auto polygon = polygons.begin(); polygon != polygons.end(); ++polygon)
+		{
+			triangles.clear();
+			triangleCount += D2DTessellator::Tessellate(polygon->Coordinates.data(), polygon->RingOffsets.data(), polygon->RingOffsets.size() - 1, &triangles);
+		}
+	});
+
+	std::printf("world: %zu polygons, %zu points, %zu triangles in %.2f ms, %.1f M points/s\n",
+		polygons.size(), pointCount, triangleCount, worldSeconds * 1000, pointCount / worldSeconds / 1e6);
+
+	BenchmarkPolygon dense = Densify(polygons[largest], pieces);
+	for(size_t p = 0; p < 2; p++)
+	{
+		const BenchmarkPolygon& polygon = p == 0 ? polygons[largest] : dense;
+		size_t densePointCount = polygon.Coordinates.size() / 2;
+		double seconds = NativeTest::Measure(5, [&]()
+		{
+			triangles.clear();
+			triangleCount = D2DTessellator::Tessellate(polygon.Coordinates.data(), polygon.RingOffsets.data(), polygon.RingOffsets.size() - 1, &triangles);
+		});
+
+		std::printf("largest outline%s: %zu rings, %zu points, %zu triangles in %.2f ms, %.1f M points/s\n", p == 0 ? "" : ", split",
+			polygon.RingOffsets.size() - 1, densePointCount, triangleCount, seconds * 1000, densePointCount / seconds / 1e6);
+	}
+
+	return 0;
+}
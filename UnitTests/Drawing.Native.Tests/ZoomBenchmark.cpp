@@ -0,0 +1,127 @@
+#include "NativeTest.h"
+#include "D2DShapefileReader.h"
+#include "D2DProjection.h"
+#include "D2DLayerCacheFile.h"
+#include "D2DZoomGeometry.h"
+#include <cstdio>
+#include <cstdlib>
+
+using namespace Telerik::UI::Drawing;
+
+// a pinch zoom moves in steps smaller than the quarter octave of a zoom band
+const int ZoomSteps = 32;
+const double ZoomStepFactor = 1.1;
+
+struct ZoomStepCounts
+{
+	size_t Kept;
+	size_t Transformed;
+	size_t Rebuilt;
+	size_t Points;
+};
+
+// zooms a layer of the shapes in ZoomSteps steps of ZoomStepFactor the way D2DGeometryShape::OnZoomFactorChanged and
+// D2DMultiPolygon::PopulateRing do: each shape asks D2DZoomGeometry what to do with its geometry and the shapes that
+// are rebuilt produce their simplified pixel-space rings. The Direct2D path building that consumes the ring points is
+// not measured, and the geometry cache is left out as zooming in visits each band for the first time
+static ZoomStepCounts ZoomLayer(const D2DShapefileGeometry& geometry, const std::vector<float>& ranks, bool usesModelTransform, int copies, std::vector<double>* geometryZoomFactors, std::vector<float>* figurePoints)
+{
+	ZoomStepCounts counts = { 0, 0, 0, 0 };
+	size_t recordCount = geometry.PartOffsets.size() - 1;
+
+	// the geometry of every shape is built at the initial zoom factor
+	geometryZoomFactors->assign(recordCount * copies, 1.0);
+
+	double zoomFactor = 1;
+	for(int step = 0; step < ZoomSteps; step++)
+	{
+		zoomFactor *= ZoomStepFactor;
+		double offset = -256 * zoomFactor;
+		float tolerance = D2DZoomGeometry::GetSimplificationTolerance(zoomFactor);
+
+		for(size_t shape = 0; shape < geometryZoomFactors->size(); shape++)
+		{
+			double& geometryZoomFactor = (*geometryZoomFactors)[shape];
+			D2DZoomAction action = D2DZoomGeometry::GetZoomAction(usesModelTransform, geometryZoomFactor, zoomFactor);
+			if(action == D2DZoomAction::Keep)
+			{
+				counts.Kept++;
+				continue;
+			}
+
+			if(action == D2DZoomAction::Transform)
+			{
+				counts.Transformed++;
+				continue;
+			}
+
+			size_t record = shape % recordCount;
+			for(uint32_t part = geometry.PartOffsets[record]; part < geometry.PartOffsets[record + 1]; part++)
+			{
+				uint32_t start = geometry.PointOffsets[part];
+				uint32_t end = geometry.PointOffsets[part + 1];
+
+				figurePoints->resize(2 * static_cast<size_t>(end - start));
+				counts.Points += D2DZoomGeometry::BuildRingPoints(&geometry.Coordinates[2 * static_cast<size_t>(start)], &ranks[start], end - start, zoomFactor, offset, offset, tolerance, figurePoints->data());
+			}
+
+			geometryZoomFactor = zoomFactor;
+			counts.Rebuilt++;
+		}
+	}
+
+	return counts;
+}
+
+static void Report(const char* precision, const ZoomStepCounts& counts, double seconds)
+{
+	std::printf("%s: %.3f ms per zoom step, %zu shapes kept, %zu transformed, %zu rebuilt with %zu points over %d steps\n",
+		precision, seconds * 1000 / ZoomSteps, counts.Kept, counts.Transformed, counts.Rebuilt, counts.Points, ZoomSteps);
+}
+
+// the cost of zooming a layer of the world outlines in the two render precisions: Single keeps its model-space
+// geometry, Double transforms its pixel-space geometry within a zoom band and rebuilds it when it leaves the band
+int main(int argc, char** argv)
+{
+	// the world shapes are repeated to reach the point counts of large layers
+	int copies = argc > 1 ? atoi(argv[1]) : 100;
+
+	std::vector<uint8_t> data;
+	D2DShapefileGeometry geometry;
+	if(!NativeTest::ReadFile(NativeTest::GetDataPath("world.shp"), &data) || !D2DShapefileReader::ReadShapes(data.data(), data.size(), &geometry))
+	{
+		std::printf("world.shp cannot be read\n");
+		return 1;
+	}
+
+	D2DProjection::ProjectMercator(geometry.Coordinates.data(), geometry.Coordinates.size() / 2, 512);
+
+	// the ranks a layer cache stores for the points, which pixel-space rings are simplified with
+	std::vector<float> ranks(geometry.Coordinates.size() / 2);
+	for(size_t part = 0; part + 1 < geometry.PointOffsets.size(); part++)
+	{
+		uint32_t start = geometry.PointOffsets[part];
+		D2DLayerCacheWriter::RankPoints(&geometry.Coordinates[2 * static_cast<size_t>(start)], geometry.PointOffsets[part + 1] - start, &ranks[start]);
+	}
+
+	std::vector<double> geometryZoomFactors;
+	std::vector<float> figurePoints;
+
+	ZoomStepCounts doubleCounts;
+	double doubleSeconds = NativeTest::Measure(5, [&]()
+	{
+		doubleCounts = ZoomLayer(geometry, ranks, false, copies, &geometryZoomFactors, &figurePoints);
+	});
+
+	ZoomStepCounts singleCounts;
+	double singleSeconds = NativeTest::Measure(5, [&]()
+	{
+		singleCounts = ZoomLayer(geometry, ranks, true, copies, &geometryZoomFactors, &figurePoints);
+	});
+
+	std::printf("%zu shapes, %zu points\n", (geometry.PartOffsets.size() - 1) * copies, geometry.Coordinates.size() / 2 * copies);
+	Report("Double", doubleCounts, doubleSeconds);
+	Report("Single", singleCounts, singleSeconds);
+
+	return 0;
+}